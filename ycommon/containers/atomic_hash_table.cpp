@@ -1,6 +1,7 @@
 #include "ycommon/containers/atomic_hash_table.h"
 
-#include <string>
+#include <new>
+#include <string.h>
 
 #include "ycommon/headers/atomics.h"
 #include "ycommon/utils/hash.h"
@@ -8,27 +9,41 @@
 #define EMPTY_VALUE static_cast<uint64_t>(0)
 #define REMOVED_VALUE static_cast<uint64_t>(-1)
 #define PLACEHOLDER_VALUE static_cast<uint64_t>(-2)
+#define MOVED_VALUE static_cast<uint64_t>(-3) // Look in the next table.
 #define MAX_TRIES 10
 
+#define MOVE_CHUNK_SIZE 64
+#define NUM_CHUNKS(num_entries) \
+    (((num_entries) + MOVE_CHUNK_SIZE - 1) / MOVE_CHUNK_SIZE)
+
 namespace ycommon { namespace containers {
 
 AtomicHashTable::AtomicHashTable()
-    : mBuffer(NULL),
+    : mTable(NULL),
+      mMaxValueSize(0),
       mCurrentEntries(0),
-      mNumEntries(0),
-      mMaxValueSize(0) {
+      mGrowing(0),
+      mAllocateFunc(NULL),
+      mReleaseFunc(NULL),
+      mAllocatorArg(NULL) {
+  InitTable(&mInitialTable, NULL, 0, 0);
 }
 
 AtomicHashTable::AtomicHashTable(void* buffer, size_t buffer_size,
                                  size_t num_entries, size_t max_value_size)
-    : mBuffer(NULL),
+    : mTable(NULL),
+      mMaxValueSize(0),
       mCurrentEntries(0),
-      mNumEntries(0),
-      mMaxValueSize(0) {
+      mGrowing(0),
+      mAllocateFunc(NULL),
+      mReleaseFunc(NULL),
+      mAllocatorArg(NULL) {
+  InitTable(&mInitialTable, NULL, 0, 0);
   Init(buffer, buffer_size, num_entries, max_value_size);
 }
 
 AtomicHashTable::~AtomicHashTable() {
+  ReleaseTables();
 }
 
 void AtomicHashTable::Init(void* buffer, size_t buffer_size,
@@ -42,32 +57,61 @@ void AtomicHashTable::Init(void* buffer, size_t buffer_size,
           static_cast<uint32_t>(MAX_TRIES),
           static_cast<uint32_t>(num_entries));
 
-  const size_t entry_size = sizeof(uint64_t) + max_value_size;
-  const size_t total_table_size = entry_size * num_entries;
+  const size_t total_table_size = GetAllocationSize(num_entries,
+                                                    max_value_size);
 
   YASSERT(total_table_size <= buffer_size,
           "Atomic Hash Table requires %u bytes, supplied %u bytes.",
           static_cast<uint32_t>(total_table_size),
           static_cast<uint32_t>(buffer_size));
 
-  mBuffer = buffer;
+  ReleaseTables();
+  InitTable(&mInitialTable, buffer, num_entries, 0);
+  mTable = &mInitialTable;
   mCurrentEntries = 0;
-  mNumEntries = num_entries;
   mMaxValueSize = max_value_size;
+  mGrowing = 0;
 
   Clear();
 }
 
 void AtomicHashTable::Reset() {
-  mBuffer = NULL;
+  ReleaseTables();
+  InitTable(&mInitialTable, NULL, 0, 0);
+  mTable = NULL;
   mCurrentEntries = 0;
-  mNumEntries = 0;
   mMaxValueSize = 0;
+  mAllocateFunc = NULL;
+  mReleaseFunc = NULL;
+  mAllocatorArg = NULL;
 }
 
 void AtomicHashTable::Clear() {
+  ReleaseTables();
+  InitTable(&mInitialTable, mInitialTable.mBuffer,
+            mInitialTable.mNumEntries, 0);
+  mTable = &mInitialTable;
   mCurrentEntries = 0;
-  memset(mBuffer, EMPTY_VALUE, sizeof(uint64_t) * mNumEntries);
+  memset(mInitialTable.mBuffer, EMPTY_VALUE,
+         sizeof(uint64_t) * mInitialTable.mNumEntries);
+}
+
+void AtomicHashTable::SetGrowthAllocator(AllocateFunc allocate_func,
+                                         ReleaseFunc release_func,
+                                         void* allocator_arg) {
+  mAllocateFunc = allocate_func;
+  mReleaseFunc = release_func;
+  mAllocatorArg = allocator_arg;
+}
+
+size_t AtomicHashTable::GetNumEntries() const {
+  const TableData* table = mTable;
+  if (table == NULL)
+    return 0;
+
+  while (table->mNextTable)
+    table = table->mNextTable;
+  return table->mNumEntries;
 }
 
 void* AtomicHashTable::Insert(const void* key, size_t key_size,
@@ -86,33 +130,44 @@ void* AtomicHashTable::Insert(uint64_t hash_key,
                static_cast<uint32_t>(mMaxValueSize),
                static_cast<uint32_t>(value_size));
 
-  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  volatile uint64_t* hash_table = static_cast<volatile uint64_t*>(mBuffer);
-  uint8_t* hash_value_table = static_cast<uint8_t*>(mBuffer) + key_table_size;
+  bool counted = false;
+  for (;;) {
+    TableData* table = PrepareWrite(hash_key);
 
-  for (uint64_t i = 0; i < MAX_TRIES; ++i) {
-    const uint64_t try_index = (hash_key + i) % mNumEntries;
-    const uint64_t hash_table_value = hash_table[try_index];
+    // Keep tables at most half full so probing rarely runs out of tries.
+    if (mAllocateFunc &&
+        static_cast<size_t>(mCurrentEntries + 1) * 2 > table->mNumEntries) {
+      Grow(table);
+      table = PrepareWrite(hash_key);
+    }
 
-    if (hash_table_value == hash_key ||
-        (hash_table_value == EMPTY_VALUE &&
-         ycommon::AtomicCmpSet64(&hash_table[try_index],
-                                 EMPTY_VALUE,
-                                 PLACEHOLDER_VALUE)) ||
-        (hash_table_value == REMOVED_VALUE &&
-         ycommon::AtomicCmpSet64(&hash_table[try_index],
-                                 REMOVED_VALUE,
-                                 PLACEHOLDER_VALUE))) {
-      void* hash_data = hash_value_table + (try_index * mMaxValueSize);
-      memcpy(hash_data, value, value_size);
-      ycommon::AtomicAdd32(&mCurrentEntries, 1); // Has implicit memory barrier.
-      hash_table[try_index] = hash_key;
-      return hash_data;
+    bool inserted = false;
+    const int64_t index = InsertIndex(table, hash_key, value, value_size,
+                                      true, &inserted);
+    if (index == -1) {
+      if (table->mNextTable == NULL) {
+        if (mAllocateFunc == NULL) {
+          YFATAL("Atomic Hash Table is too full, "
+                 "maximum amount of tries reached!");
+          return nullptr;
+        }
+        Grow(table);
+      }
+      continue;
     }
-  }
 
-  YFATAL("Atomic Hash Table is too full, maximum amount of tries reached!");
-  return nullptr;
+    if (inserted && !counted) {
+      ycommon::AtomicAdd32(&mCurrentEntries, 1);
+      counted = true;
+    }
+
+    // The table started moving while the value was written, write it again
+    // once it has been moved so the new table does not hold a stale value.
+    if (table->mNextTable)
+      continue;
+
+    return GetTableValue(table, index);
+  }
 }
 
 bool AtomicHashTable::Remove(const void* key, size_t key_size) {
@@ -121,48 +176,55 @@ bool AtomicHashTable::Remove(const void* key, size_t key_size) {
 }
 
 bool AtomicHashTable::Remove(uint64_t hash_key) {
-  volatile uint64_t* hash_table = static_cast<volatile uint64_t*>(mBuffer);
-  for (uint64_t i = 0; i < MAX_TRIES; ++i) {
-    const uint64_t try_index = (hash_key + i) % mNumEntries;
-    const uint64_t hash_table_value = hash_table[try_index];
-
-    if (hash_table_value == hash_key &&
-        ycommon::AtomicCmpSet64(&hash_table[try_index],
-                                hash_key,
-                                REMOVED_VALUE)) {
-      ycommon::AtomicAdd32(&mCurrentEntries, -1);
-      return true;
-    } else if (hash_table_value == EMPTY_VALUE) {
-      return false;
-    }
+  if (RemoveFromTables(hash_key)) {
+    ycommon::AtomicAdd32(&mCurrentEntries, -1);
+    return true;
   }
-
   return false;
 }
 
 bool AtomicHashTable::Remove(const void* hash_table_value) {
-  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  const uint8_t* hash_value_table =
-      static_cast<const uint8_t*>(mBuffer) + key_table_size;
-  const uint8_t* hash_value_end =
-      hash_value_table + (mMaxValueSize * mNumEntries);
   const uint8_t* value_ptr = static_cast<const uint8_t*>(hash_table_value);
-  YASSERT(value_ptr >= hash_value_table &&
-          value_ptr < hash_value_end,
+
+  // Values from before a move can still point into an older table.
+  TableData* table = &mInitialTable;
+  const uint8_t* hash_value_table = NULL;
+  while (table) {
+    const size_t key_table_size = sizeof(uint64_t) * table->mNumEntries;
+    hash_value_table = static_cast<const uint8_t*>(table->mBuffer) +
+                       key_table_size;
+    const uint8_t* hash_value_end =
+        hash_value_table + (mMaxValueSize * table->mNumEntries);
+    if (value_ptr >= hash_value_table && value_ptr < hash_value_end)
+      break;
+    table = table->mNextTable;
+  }
+  YASSERT(table != NULL,
           "Cannot remove hash table value that is out of range.");
   YASSERT((value_ptr - hash_value_table) % mMaxValueSize == 0,
           "Invalid hash table value pointer.");
 
-  uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
+  volatile uint64_t* hash_table =
+      static_cast<volatile uint64_t*>(table->mBuffer);
   const uint64_t index = (value_ptr - hash_value_table) / mMaxValueSize;
   const uint64_t hash_key = hash_table[index];
 
-  if (hash_key == REMOVED_VALUE || hash_key == EMPTY_VALUE)
+  if (hash_key == REMOVED_VALUE || hash_key == EMPTY_VALUE ||
+      hash_key == PLACEHOLDER_VALUE || hash_key == MOVED_VALUE)
     return false;
 
+  // Entries in a moved chunk are only removed from the new table.
+  if (table->mNextTable && IsMoved(table, index))
+    return Remove(hash_key);
+
   if (ycommon::AtomicCmpSet64(&hash_table[index],
                               hash_key,
                               REMOVED_VALUE)) {
+    // Remove the copy if the entry was moved at the same time.
+    if (table->mNextTable) {
+      FinishMove(table);
+      RemoveFromTables(hash_key);
+    }
     ycommon::AtomicAdd32(&mCurrentEntries, -1);
     return true;
   }
@@ -175,21 +237,16 @@ const void* const AtomicHashTable::GetValue(const void* key,
 }
 
 const void* const AtomicHashTable::GetValue(uint64_t hash_key) const {
-  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  volatile uint64_t* hash_table = static_cast<volatile uint64_t*>(mBuffer);
-  const uint8_t* hash_value_table =
-      static_cast<const uint8_t*>(mBuffer) + key_table_size;
-
-  for (uint64_t i = 0; i < MAX_TRIES; ++i) {
-    const uint64_t try_index = (hash_key + i) % mNumEntries;
-    const uint64_t hash_table_value = hash_table[try_index];
-
-    if (hash_table_value == hash_key) {
+  const TableData* table = mTable;
+  while (table) {
+    const int64_t index = FindIndex(table, hash_key);
+    const TableData* next_table = table->mNextTable;
+    AcquireFence();
+    if (index != -1 && (next_table == NULL || !IsMoved(table, index))) {
       ycommon::MemoryBarrier(); // Make sure other thread is finished writing
-      return hash_value_table + (try_index * mMaxValueSize);
-    } else if (hash_table_value == EMPTY_VALUE) {
-      return NULL;
+      return GetTableValue(table, index);
     }
+    table = next_table;
   }
 
   return NULL;
@@ -200,23 +257,260 @@ void* AtomicHashTable::GetValue(const void* key, size_t key_size) {
 }
 
 void* AtomicHashTable::GetValue(uint64_t hash_key) {
-  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  volatile uint64_t* hash_table = static_cast<volatile uint64_t*>(mBuffer);
-  uint8_t* hash_value_table = static_cast<uint8_t*>(mBuffer) + key_table_size;
+  const AtomicHashTable* const_this = this;
+  return const_cast<void*>(const_this->GetValue(hash_key));
+}
+
+void AtomicHashTable::InitTable(TableData* table, void* buffer,
+                                size_t num_entries, size_t allocation_size) {
+  table->mBuffer = buffer;
+  table->mNumEntries = num_entries;
+  table->mAllocationSize = allocation_size;
+  table->mNextTable = NULL;
+  table->mMovedChunks = NULL;
+  table->mClaimedChunks = 0;
+  table->mFinishedChunks = 0;
+}
+
+void AtomicHashTable::ReleaseTables() {
+  TableData* table = mInitialTable.mNextTable;
+  mInitialTable.mNextTable = NULL;
+  while (table) {
+    TableData* next_table = table->mNextTable;
+    const size_t allocation_size = table->mAllocationSize;
+
+    // Explicitly call destructor for placement new.
+    table->~TableData();
+    if (mReleaseFunc)
+      mReleaseFunc(mAllocatorArg, table, allocation_size);
+    table = next_table;
+  }
+}
 
+int64_t AtomicHashTable::FindIndex(const TableData* table,
+                                   uint64_t hash_key) const {
+  const volatile uint64_t* hash_table =
+      static_cast<const volatile uint64_t*>(table->mBuffer);
   for (uint64_t i = 0; i < MAX_TRIES; ++i) {
-    const uint64_t try_index = (hash_key + i) % mNumEntries;
+    const uint64_t try_index = (hash_key + i) % table->mNumEntries;
     const uint64_t hash_table_value = hash_table[try_index];
 
     if (hash_table_value == hash_key) {
-      ycommon::MemoryBarrier(); // Make sure other thread is finished writing
-      return hash_value_table + (try_index * mMaxValueSize);
+      return static_cast<int64_t>(try_index);
     } else if (hash_table_value == EMPTY_VALUE) {
-      return NULL;
+      return -1;
     }
   }
 
-  return NULL;
+  return -1;
+}
+
+int64_t AtomicHashTable::InsertIndex(TableData* table, uint64_t hash_key,
+                                     const void* value, size_t value_size,
+                                     bool replace, bool* inserted) {
+  volatile uint64_t* hash_table =
+      static_cast<volatile uint64_t*>(table->mBuffer);
+
+  const int64_t existing_index = FindIndex(table, hash_key);
+  if (existing_index != -1) {
+    *inserted = false;
+    if (replace) {
+      memcpy(GetTableValue(table, existing_index), value, value_size);
+      ycommon::MemoryBarrier();
+    }
+    return existing_index;
+  }
+
+  for (uint64_t i = 0; i < MAX_TRIES; ++i) {
+    const uint64_t try_index = (hash_key + i) % table->mNumEntries;
+    const uint64_t hash_table_value = hash_table[try_index];
+
+    if ((hash_table_value == EMPTY_VALUE &&
+         ycommon::AtomicCmpSet64(&hash_table[try_index],
+                                 EMPTY_VALUE,
+                                 PLACEHOLDER_VALUE)) ||
+        (hash_table_value == REMOVED_VALUE &&
+         ycommon::AtomicCmpSet64(&hash_table[try_index],
+                                 REMOVED_VALUE,
+                                 PLACEHOLDER_VALUE))) {
+      memcpy(GetTableValue(table, try_index), value, value_size);
+      ycommon::MemoryBarrier();
+      hash_table[try_index] = hash_key;
+      *inserted = true;
+      return static_cast<int64_t>(try_index);
+    } else if (hash_table_value == MOVED_VALUE) {
+      break; // The table is being moved, retry on the next table.
+    }
+  }
+
+  *inserted = false;
+  return -1;
+}
+
+bool AtomicHashTable::RemoveFromTables(uint64_t hash_key) {
+  bool removed = false;
+  for (;;) {
+    TableData* table = PrepareWrite(hash_key);
+    volatile uint64_t* hash_table =
+        static_cast<volatile uint64_t*>(table->mBuffer);
+
+    const int64_t index = FindIndex(table, hash_key);
+    if (index != -1 &&
+        ycommon::AtomicCmpSet64(&hash_table[index], hash_key, REMOVED_VALUE)) {
+      removed = true;
+
+      // A move which started at the same time may have copied the entry,
+      // let it finish so the copy can be removed from the next table.
+      if (table->mNextTable)
+        FinishMove(table);
+    }
+
+    if (table->mNextTable == NULL)
+      return removed;
+  }
+}
+
+void* AtomicHashTable::GetTableValue(const TableData* table,
+                                     int64_t index) const {
+  const size_t key_table_size = sizeof(uint64_t) * table->mNumEntries;
+  uint8_t* hash_value_table = static_cast<uint8_t*>(table->mBuffer) +
+                              key_table_size;
+  return hash_value_table + (index * mMaxValueSize);
+}
+
+AtomicHashTable::TableData* AtomicHashTable::PrepareWrite(uint64_t hash_key) {
+  TableData* table = mTable;
+  TableData* next_table = table->mNextTable;
+  if (next_table == NULL)
+    return table;
+  AcquireFence();
+
+  // Every write moves a chunk so the old table empties out over time.
+  MoveChunk(table);
+
+  // Entries still in the old table must be moved before they are changed.
+  const int64_t index = FindIndex(table, hash_key);
+  if (index != -1 && !IsMoved(table, index))
+    FinishMove(table);
+
+  if (table->mFinishedChunks ==
+      static_cast<int32_t>(NUM_CHUNKS(table->mNumEntries))) {
+    ycommon::AtomicCmpSetPtr(reinterpret_cast<void* volatile*>(&mTable),
+                             table, next_table);
+  }
+  return next_table;
+}
+
+void AtomicHashTable::Grow(TableData* table) {
+  if (!ycommon::AtomicCmpSet32(&mGrowing, 0, 1)) {
+    while (mGrowing != 0) {}
+    return;
+  }
+
+  if (table->mNextTable == NULL) {
+    // Only two tables are in use at once, finish the previous move first.
+    TableData* oldest_table = mTable;
+    if (oldest_table != table) {
+      FinishMove(oldest_table);
+      mTable = table;
+    }
+
+    const size_t num_entries = table->mNumEntries * 2;
+    const size_t num_chunks = NUM_CHUNKS(table->mNumEntries);
+    const size_t header_size = ROUND_UP(sizeof(TableData) +
+                                        sizeof(uint32_t) * num_chunks,
+                                        sizeof(uint64_t));
+    const size_t allocation_size =
+        header_size + GetAllocationSize(num_entries, mMaxValueSize);
+    void* buffer = mAllocateFunc(mAllocatorArg, allocation_size);
+    YASSERT(buffer != NULL,
+            "Atomic Hash Table could not allocate %u bytes to grow.",
+            static_cast<uint32_t>(allocation_size));
+    YASSERT(reinterpret_cast<uintptr_t>(buffer) % sizeof(uint64_t) == 0,
+            "Atomic Hash Table memory must be aligned to %u bytes - got %p.",
+            static_cast<uint32_t>(sizeof(uint64_t)),
+            buffer);
+
+    uint8_t* buffer_data = static_cast<uint8_t*>(buffer);
+    TableData* next_table = new (buffer_data) TableData;
+    InitTable(next_table, buffer_data + header_size, num_entries,
+              allocation_size);
+    memset(next_table->mBuffer, EMPTY_VALUE, sizeof(uint64_t) * num_entries);
+
+    uint32_t* moved_chunks =
+        reinterpret_cast<uint32_t*>(buffer_data + sizeof(TableData));
+    memset(moved_chunks, 0, sizeof(uint32_t) * num_chunks);
+    table->mMovedChunks = moved_chunks;
+
+    ycommon::ReleaseFence();
+    table->mNextTable = next_table;
+  }
+
+  ycommon::MemoryBarrier();
+  mGrowing = 0;
+}
+
+bool AtomicHashTable::MoveChunk(TableData* table) {
+  const int32_t num_chunks =
+      static_cast<int32_t>(NUM_CHUNKS(table->mNumEntries));
+  if (table->mClaimedChunks >= num_chunks)
+    return false;
+
+  const int32_t chunk = ycommon::AtomicAdd32(&table->mClaimedChunks, 1);
+  if (chunk >= num_chunks)
+    return false;
+
+  TableData* next_table = table->mNextTable;
+  volatile uint64_t* hash_table =
+      static_cast<volatile uint64_t*>(table->mBuffer);
+  const size_t begin = static_cast<size_t>(chunk) * MOVE_CHUNK_SIZE;
+  const size_t end = begin + MOVE_CHUNK_SIZE < table->mNumEntries ?
+                     begin + MOVE_CHUNK_SIZE : table->mNumEntries;
+  for (size_t i = begin; i < end; ++i) {
+    for (;;) {
+      const uint64_t hash_table_value = hash_table[i];
+      if (hash_table_value == PLACEHOLDER_VALUE) {
+        continue; // Wait for the insert to finish writing.
+      } else if (hash_table_value == EMPTY_VALUE ||
+                 hash_table_value == REMOVED_VALUE) {
+        // Seal free entries so late inserts go to the new table.
+        if (ycommon::AtomicCmpSet64(&hash_table[i],
+                                    hash_table_value,
+                                    MOVED_VALUE)) {
+          break;
+        }
+      } else {
+        // Keys stay in place so lookups can still read the old value.
+        ycommon::MemoryBarrier();
+        bool inserted = false;
+        const int64_t index = InsertIndex(next_table, hash_table_value,
+                                          GetTableValue(table, i),
+                                          mMaxValueSize, false, &inserted);
+        YASSERT(index != -1,
+                "Atomic Hash Table could not move entry, "
+                "maximum amount of tries reached!");
+        break;
+      }
+    }
+  }
+
+  ycommon::ReleaseFence();
+  table->mMovedChunks[chunk] = 1;
+  ycommon::AtomicAdd32(&table->mFinishedChunks, 1);
+  return true;
+}
+
+void AtomicHashTable::FinishMove(TableData* table) {
+  while (MoveChunk(table)) {}
+
+  const int32_t num_chunks =
+      static_cast<int32_t>(NUM_CHUNKS(table->mNumEntries));
+  while (table->mFinishedChunks != num_chunks) {}
+  ycommon::MemoryBarrier();
+}
+
+bool AtomicHashTable::IsMoved(const TableData* table, int64_t index) const {
+  return table->mMovedChunks[index / MOVE_CHUNK_SIZE] != 0;
 }
 
 }} // namespace ycommon { namespace containers {
@@ -1,6 +1,7 @@
 #ifndef YCOMMON_CONTAINERS_ATOMIC_HASH_TABLE_H
 #define YCOMMON_CONTAINERS_ATOMIC_HASH_TABLE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "ycommon/headers/macros.h"
@@ -10,12 +11,23 @@
 * AtomicHashTable atomically inserts/retrieves hash values.
 *   - It is undefined when the same hash value is inserted at the same time.
 *   - buffer size: (max_value_size + sizeof(uint64_t)) * num_entries.
+*   - With a growth allocator set, a table which gets half full allocates a
+*     table of twice the size. Inserts and removes each move a chunk of
+*     entries into the new table until the old one is empty, lookups check
+*     both tables and never wait on a move.
+*   - Value pointers handed out before a move point into the old table.
+*     Old tables stay allocated until Clear() or Reset().
 ********/
 
 namespace ycommon { namespace containers {
 
 class AtomicHashTable {
  public:
+  // Allocates memory for a grown table, must be aligned to 8 bytes.
+  typedef void* (*AllocateFunc)(void* arg, size_t size);
+  // Releases memory returned by the AllocateFunc.
+  typedef void (*ReleaseFunc)(void* arg, void* buffer, size_t size);
+
   static size_t GetAllocationSize(size_t num_entries, size_t max_value_size) {
     return (max_value_size + sizeof(uint64_t)) * num_entries;
   }
@@ -28,7 +40,12 @@ class AtomicHashTable {
   void Init(void* buffer, size_t buffer_size,
             size_t num_entries, size_t max_value_size);
   void Reset();
-  void Clear();
+  void Clear(); // Also releases any grown tables, must not run concurrently.
+
+  // Lets the table grow instead of failing once it is full, release is
+  // optional. Must be set before the table is used concurrently.
+  void SetGrowthAllocator(AllocateFunc allocate_func, ReleaseFunc release_func,
+                          void* allocator_arg);
 
   void* Insert(const void* key, size_t key_size,
                const void* value, size_t value_size,
@@ -47,12 +64,48 @@ class AtomicHashTable {
   void* GetValue(uint64_t hash_key);
 
   int32_t GetCurrentSize() const { return mCurrentEntries; }
+  size_t GetNumEntries() const; // Entries of the newest table.
 
  private:
-  void* mBuffer;
-  size_t mNumEntries;
+  struct TableData {
+    void* mBuffer;
+    size_t mNumEntries;
+    size_t mAllocationSize; // Zero for the table supplied to Init().
+    TableData* volatile mNextTable;
+
+    // Moving this table into mNextTable, one flag per chunk of entries.
+    volatile uint32_t* mMovedChunks;
+    volatile int32_t mClaimedChunks;
+    volatile int32_t mFinishedChunks;
+  };
+
+  void InitTable(TableData* table, void* buffer, size_t num_entries,
+                 size_t allocation_size);
+  void ReleaseTables();
+
+  int64_t FindIndex(const TableData* table, uint64_t hash_key) const;
+  int64_t InsertIndex(TableData* table, uint64_t hash_key,
+                      const void* value, size_t value_size,
+                      bool replace, bool* inserted);
+  bool RemoveFromTables(uint64_t hash_key);
+  void* GetTableValue(const TableData* table, int64_t index) const;
+
+  // Helps move the oldest table and returns the table writes should go to.
+  TableData* PrepareWrite(uint64_t hash_key);
+  void Grow(TableData* table);
+  bool MoveChunk(TableData* table);
+  void FinishMove(TableData* table);
+  bool IsMoved(const TableData* table, int64_t index) const;
+
+  TableData mInitialTable;
+  TableData* volatile mTable; // Oldest table still in use.
   size_t mMaxValueSize;
   volatile int32_t mCurrentEntries;
+  volatile int32_t mGrowing;
+
+  AllocateFunc mAllocateFunc;
+  ReleaseFunc mReleaseFunc;
+  void* mAllocatorArg;
 };
 
 template <typename T>
@@ -105,13 +158,13 @@ class FullTypedAtomicHashTable : public TypedAtomicHashTable<T2> {
     return AtomicHashTable::GetAllocationSize(num_entries, sizeof(T2));
   }
 
-  FullTypedAtomicHashTable() : TypedAtomicHashTable() {}
+  FullTypedAtomicHashTable() : TypedAtomicHashTable<T2>() {}
   FullTypedAtomicHashTable(void* buffer, size_t buffer_size, size_t num_entries)
-      : TypedAtomicHashTable(buffer, buffer_size, num_entries) {}
+      : TypedAtomicHashTable<T2>(buffer, buffer_size, num_entries) {}
   ~FullTypedAtomicHashTable() {}
 
   T2* Insert(const T1& key, const T2& value, uint64_t* hash_key = nullptr) {
-    return TypedAtomicHashTable::Insert(&key, sizeof(key), value, hash_key);
+    return TypedAtomicHashTable<T2>::Insert(&key, sizeof(key), value, hash_key);
   }
 
   const T2* const GetValue(const T1& key) const {
@@ -132,11 +185,11 @@ class ContainedAtomicHashTable : public TypedAtomicHashTable<T> {
   }
 
   ContainedAtomicHashTable()
-      : TypedAtomicHashTable(mBuffer, sizeof(mBuffer), entries) {}
+      : TypedAtomicHashTable<T>(mBuffer, sizeof(mBuffer), entries) {}
   ~ContainedAtomicHashTable() {}
 
   void Reset() {
-    Init(mBuffer, sizeof(mBuffer), entries, sizeof(T));
+    this->Init(mBuffer, sizeof(mBuffer), entries, sizeof(T));
   }
 
  private:
@@ -152,11 +205,11 @@ class ContainedFullAtomicHashTable : public FullTypedAtomicHashTable<T1, T2> {
   }
 
   ContainedFullAtomicHashTable()
-      : FullTypedAtomicHashTable(mBuffer, sizeof(mBuffer), entries) {}
+      : FullTypedAtomicHashTable<T1, T2>(mBuffer, sizeof(mBuffer), entries) {}
   ~ContainedFullAtomicHashTable() {}
 
   void Reset() {
-    Init(mBuffer, sizeof(mBuffer), entries);
+    this->Init(mBuffer, sizeof(mBuffer), entries);
   }
 
  private:
@@ -1,6 +1,7 @@
 #include "ycommon/containers/atomic_hash_table.h"
 
 #include <gtest/gtest.h>
+#include <stdlib.h>
 
 #include "ycommon/headers/atomics.h"
 #include "ycommon/platform/thread.h"
@@ -64,6 +65,45 @@ uintptr_t RemovalRoutine(void* arg) {
 
 }
 
+struct LookupArg {
+  AtomicHashTable* hash_table;
+  volatile uint32_t* begin_running;
+  volatile uint32_t* keep_looking;
+  uint32_t num_keys;
+};
+
+uintptr_t LookupRoutine(void* arg) {
+  LookupArg* arg_data = static_cast<LookupArg*>(arg);
+
+  while (*arg_data->begin_running == 0);
+
+  MemoryBarrier();
+
+  AtomicHashTable* hash_table = arg_data->hash_table;
+  const uint32_t count = arg_data->num_keys;
+
+  // Keys inserted before the threads started must always be found.
+  do {
+    for (uint32_t i = 0; i < count; ++i) {
+      const void* value = hash_table->GetValue(&i, sizeof(i));
+      if (value == nullptr || *static_cast<const uint32_t*>(value) != i)
+        return 1;
+    }
+  } while (*arg_data->keep_looking);
+
+  return 0;
+}
+
+void* AllocateTable(void* arg, size_t size) {
+  AtomicAdd32(static_cast<volatile int32_t*>(arg), 1);
+  return malloc(size);
+}
+
+void ReleaseTable(void* arg, void* buffer, size_t /*size*/) {
+  AtomicAdd32(static_cast<volatile int32_t*>(arg), -1);
+  free(buffer);
+}
+
 /************
 * Test Definitions
 *************/
@@ -88,6 +128,78 @@ TEST(AtomicHashTableTest, InsertionTest) {
   }
 }
 
+TEST(AtomicHashTableTest, GrowthTest) {
+  volatile int32_t num_allocations = 0;
+  ContainedFullAtomicHashTable<uint32_t, uint32_t, 16> hash_table;
+  hash_table.SetGrowthAllocator(AllocateTable, ReleaseTable,
+                                const_cast<int32_t*>(&num_allocations));
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    hash_table.Insert(i, i);
+  }
+  EXPECT_EQ(1000, hash_table.GetCurrentSize());
+  EXPECT_LE(2000u, hash_table.GetNumEntries());
+  EXPECT_LT(0, num_allocations);
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    const uint32_t* value = hash_table.GetValue(i);
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(i, *value);
+  }
+
+  for (uint32_t i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(hash_table.Remove(&i, sizeof(i)));
+  }
+  EXPECT_EQ(500, hash_table.GetCurrentSize());
+  for (uint32_t i = 0; i < 1000; ++i) {
+    const uint32_t* value = hash_table.GetValue(i);
+    if (i % 2) {
+      ASSERT_NE(nullptr, value);
+      EXPECT_EQ(i, *value);
+    } else {
+      EXPECT_EQ(nullptr, value);
+    }
+  }
+
+  // Clearing goes back to the initial buffer.
+  hash_table.Clear();
+  EXPECT_EQ(0, num_allocations);
+  EXPECT_EQ(16u, hash_table.GetNumEntries());
+  EXPECT_EQ(0, hash_table.GetCurrentSize());
+}
+
+TEST(AtomicHashTableTest, GrowthReleaseTest) {
+  volatile int32_t num_allocations = 0;
+  {
+    ContainedFullAtomicHashTable<uint32_t, uint32_t, 16> hash_table;
+    hash_table.SetGrowthAllocator(AllocateTable, ReleaseTable,
+                                  const_cast<int32_t*>(&num_allocations));
+    for (uint32_t i = 0; i < 100; ++i) {
+      hash_table.Insert(i, i);
+    }
+    EXPECT_LT(0, num_allocations);
+  }
+  EXPECT_EQ(0, num_allocations);
+}
+
+TEST(AtomicHashTableTest, GrowthRemoveValueTest) {
+  volatile int32_t num_allocations = 0;
+  ContainedFullAtomicHashTable<uint32_t, uint32_t, 16> hash_table;
+  hash_table.SetGrowthAllocator(AllocateTable, ReleaseTable,
+                                const_cast<int32_t*>(&num_allocations));
+
+  uint32_t first_key = 0;
+  uint32_t* first_value = hash_table.Insert(first_key, 123);
+  for (uint32_t i = 1; i < 100; ++i) {
+    hash_table.Insert(i, i);
+  }
+
+  // Values from before the table grew can still be removed.
+  EXPECT_TRUE(hash_table.Remove(first_value));
+  EXPECT_EQ(nullptr, hash_table.GetValue(first_key));
+  EXPECT_EQ(99, hash_table.GetCurrentSize());
+}
+
 /*************
 * Test simultaneous insertions
 **************/
@@ -218,6 +330,76 @@ class ThreadedHashTableTest : public ::testing::Test {
   ycommon::platform::Thread mTestThreads[NUM_THREADS];
 };
 
+template <uint32_t TEST_SIZE>
+class GrowingHashTableTest : public ThreadedHashTableTest<16, TEST_SIZE> {
+ public:
+  GrowingHashTableTest() : mNumAllocations(0) {}
+
+  void SetUp() override {
+    this->mHashTable.SetGrowthAllocator(
+        AllocateTable, ReleaseTable, const_cast<int32_t*>(&mNumAllocations));
+  }
+
+  void TearDown() override {
+    this->mHashTable.Clear();
+    EXPECT_EQ(0, mNumAllocations);
+  }
+
+  void RunGrowthLookupTest() {
+    const uint32_t num_lookup_keys = TEST_SIZE / 2;
+    ASSERT_EQ(0, num_lookup_keys % NUM_THREADS);
+    const uint32_t count_per_thread = num_lookup_keys / NUM_THREADS;
+
+    this->mHashTable.Reset();
+    this->mBeginRunning = 0;
+    mKeepLooking = 1;
+
+    for (uint32_t i = 0; i < num_lookup_keys; ++i) {
+      this->mHashTable.Insert(i, i);
+    }
+
+    // Half the threads grow the table while the other half look up keys.
+    for (uint32_t i = 0; i < NUM_THREADS; i += 2) {
+      this->mArgDatas[i].Init(&this->mHashTable, &this->mBeginRunning,
+                              num_lookup_keys + count_per_thread * i,
+                              count_per_thread * 2);
+      ASSERT_TRUE(this->mTestThreads[i].Initialize(InsertionRoutine,
+                                                   &this->mArgDatas[i]));
+      this->mTestThreads[i].Run();
+
+      mLookupArgs[i].hash_table = &this->mHashTable;
+      mLookupArgs[i].begin_running = &this->mBeginRunning;
+      mLookupArgs[i].keep_looking = &mKeepLooking;
+      mLookupArgs[i].num_keys = num_lookup_keys;
+      ASSERT_TRUE(this->mTestThreads[i+1].Initialize(LookupRoutine,
+                                                     &mLookupArgs[i]));
+      this->mTestThreads[i+1].Run();
+    }
+
+    this->mBeginRunning = 1;
+    for (uint32_t i = 0; i < NUM_THREADS; i += 2) {
+      this->mTestThreads[i].Join();
+      EXPECT_EQ(0, this->mTestThreads[i].ReturnValue());
+    }
+    mKeepLooking = 0;
+    for (uint32_t i = 1; i < NUM_THREADS; i += 2) {
+      this->mTestThreads[i].Join();
+      EXPECT_EQ(0, this->mTestThreads[i].ReturnValue());
+    }
+
+    ASSERT_EQ(TEST_SIZE, this->mHashTable.GetCurrentSize());
+    for (uint32_t i = 0; i < TEST_SIZE; ++i) {
+      uint32_t* test_value = this->mHashTable.GetValue(i);
+      ASSERT_NE(nullptr, test_value);
+      EXPECT_EQ(i, *test_value);
+    }
+  }
+
+  volatile int32_t mNumAllocations;
+  volatile uint32_t mKeepLooking;
+  LookupArg mLookupArgs[NUM_THREADS];
+};
+
 class MinimalAtomicHashTest : public ThreadedHashTableTest<50, 10> {};
 class SmallAtomicHashTest : public ThreadedHashTableTest<1000, 200> {};
 class LargeAtomicHashTest : public ThreadedHashTableTest<50000, 10000> {};
@@ -237,4 +419,16 @@ ATOMIC_HASH_TABLE_TEST(InsertionTest);
 ATOMIC_HASH_TABLE_TEST(RemovalTest);
 ATOMIC_HASH_TABLE_TEST(InsertRemovalTest);
 
+class GrowingAtomicHashTest : public GrowingHashTableTest<2000> {};
+
+#define GROWING_HASH_TABLE_TEST(NAME) \
+  TEST_F(GrowingAtomicHashTest, Growing ## NAME) { \
+    for (int i = 0; i < 20; ++i) { Run ## NAME(); } \
+  }
+
+GROWING_HASH_TABLE_TEST(InsertionTest);
+GROWING_HASH_TABLE_TEST(RemovalTest);
+GROWING_HASH_TABLE_TEST(InsertRemovalTest);
+GROWING_HASH_TABLE_TEST(GrowthLookupTest);
+
 }} // namespace ycommon { namespace containers {
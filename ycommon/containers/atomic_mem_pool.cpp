@@ -1,12 +1,17 @@
 #include "ycommon/containers/atomic_mem_pool.h"
 
 #include <algorithm>
-#include <string>
+#include <string.h>
 
 #include "ycommon/headers/atomics.h"
 #include "ycommon/headers/atomic_number_mask.h"
+#include "ycommon/platform/thread.h"
 #include "ycommon/utils/assert.h"
 
+// Caches move half their capacity at a time so that alternating allocations
+// and removals do not go back to the shared pool every time.
+#define CACHE_BATCH_SIZE (ATOMIC_MEM_POOL_CACHE_SIZE / 2)
+
 namespace ycommon { namespace containers {
 
 /*************
@@ -136,6 +141,84 @@ void AtomicMemPool::Remove(uint32_t index) {
   }
 }
 
+uint32_t AtomicMemPool::AllocateBatch(uint32_t* indexes, uint32_t max_count) {
+  const size_t item_size = mItemSize;
+  const uint32_t num_items = mNumItems;
+  uint8_t* buffer_ptr = static_cast<uint8_t*>(mBuffer);
+
+  // Take a chain of up to max_count free items off the free list head.
+  uint32_t count = 0;
+  uint64_t next_free_index_value = mNextFreeIndex;
+  MemoryBarrier();
+  for (;;) {
+    uint32_t next_num = static_cast<uint32_t>(GET_NUM(next_free_index_value));
+    count = 0;
+    while (count < max_count && next_num < num_items) {
+      indexes[count++] = next_num;
+      next_num = *reinterpret_cast<uint32_t*>(&buffer_ptr[item_size*next_num]);
+    }
+
+    // Links of items allocated by other threads can be garbage, but then the
+    // head has changed and the swap fails.
+    if (count == 0 ||
+        AtomicCmpSet64(&mNextFreeIndex,
+                       next_free_index_value,
+                       CONSTRUCT_NEXT_VALUE(GET_CNT(next_free_index_value),
+                                            static_cast<uint64_t>(next_num)))) {
+      break;
+    }
+
+    next_free_index_value = mNextFreeIndex;
+    MemoryBarrier();
+  }
+
+  // Fill the rest from the part of the array which was never used.
+  if (count < max_count && mUsedIndexes < num_items) {
+    const uint32_t num_wanted = max_count - count;
+    const uint32_t first_index = AtomicAdd32(&mUsedIndexes, num_wanted);
+    for (uint32_t i = first_index;
+         i < first_index + num_wanted && i < num_items; ++i) {
+      indexes[count++] = i;
+    }
+  }
+
+  return count;
+}
+
+void AtomicMemPool::RemoveBatch(const uint32_t* indexes, uint32_t count) {
+  if (count == 0)
+    return;
+
+  const size_t item_size = mItemSize;
+  uint8_t* buffer_ptr = static_cast<uint8_t*>(mBuffer);
+
+  // Link the items together first so only the last link changes on retries.
+  for (uint32_t i = 0; i + 1 < count; ++i) {
+    uint8_t* remove_loc = &buffer_ptr[item_size*indexes[i]];
+    *reinterpret_cast<uint32_t*>(remove_loc) = indexes[i + 1];
+  }
+
+  uint8_t* last_loc = &buffer_ptr[item_size*indexes[count - 1]];
+  const uint64_t first_index = indexes[0];
+  uint64_t next_free_index_value = mNextFreeIndex;
+  MemoryBarrier();
+
+  for (;;) {
+    *reinterpret_cast<uint32_t*>(last_loc) =
+        static_cast<uint32_t>(GET_NUM(next_free_index_value));
+
+    if (AtomicCmpSet64(&mNextFreeIndex,
+                       next_free_index_value,
+                       CONSTRUCT_NEXT_VALUE(GET_CNT(next_free_index_value),
+                                            first_index))) {
+      break;
+    }
+
+    next_free_index_value = mNextFreeIndex;
+    MemoryBarrier();
+  }
+}
+
 uint32_t AtomicMemPool::Insert(const void* data_item) {
   const size_t item_size = mItemSize;
   uint32_t free_index = Allocate();
@@ -162,7 +245,74 @@ uint32_t AtomicMemPool::GetIndex(const void* buffer_item) {
 }
 
 uint32_t AtomicMemPool::GetNumIndexesUsed() {
-  return min(mUsedIndexes, mNumItems);
+  return (mUsedIndexes < mNumItems) ? mUsedIndexes : mNumItems;
+}
+
+AtomicMemPoolCache::AtomicMemPoolCache()
+    : mMemPool(NULL),
+      mNumCached(0) {
+}
+
+AtomicMemPoolCache::AtomicMemPoolCache(AtomicMemPool* mem_pool)
+    : mMemPool(mem_pool),
+      mNumCached(0) {
+}
+
+AtomicMemPoolCache::~AtomicMemPoolCache() {
+  Flush();
+}
+
+void AtomicMemPoolCache::Init(AtomicMemPool* mem_pool) {
+  Flush();
+  mMemPool = mem_pool;
+}
+
+uint32_t AtomicMemPoolCache::Allocate() {
+  if (mNumCached == 0) {
+    mNumCached = mMemPool->AllocateBatch(mIndexes, CACHE_BATCH_SIZE);
+    if (mNumCached == 0)
+      return static_cast<uint32_t>(-1);
+  }
+  return mIndexes[--mNumCached];
+}
+
+void AtomicMemPoolCache::Remove(uint32_t index) {
+  if (mNumCached == ATOMIC_MEM_POOL_CACHE_SIZE) {
+    mNumCached -= CACHE_BATCH_SIZE;
+    mMemPool->RemoveBatch(&mIndexes[mNumCached], CACHE_BATCH_SIZE);
+  }
+  mIndexes[mNumCached++] = index;
+}
+
+uint32_t AtomicMemPoolCache::Insert(const void* data_item) {
+  const uint32_t free_index = Allocate();
+
+  // Copy data if index is reserved successfully.
+  if (free_index != static_cast<uint32_t>(-1)) {
+    const size_t item_size = mMemPool->GetItemSize();
+    memcpy(static_cast<uint8_t*>(mMemPool->GetBuffer()) +
+               (item_size * free_index),
+           data_item,
+           item_size);
+  }
+
+  return free_index;
+}
+
+void AtomicMemPoolCache::Flush() {
+  if (mNumCached > 0) {
+    mMemPool->RemoveBatch(mIndexes, mNumCached);
+    mNumCached = 0;
+  }
+}
+
+bool AtomicMemPoolCache::FlushOnThreadExit() {
+  return platform::Thread::AddExitRoutine(FlushRoutine, this);
+}
+
+uintptr_t AtomicMemPoolCache::FlushRoutine(void* arg) {
+  static_cast<AtomicMemPoolCache*>(arg)->Flush();
+  return 0;
 }
 
 }} // namespace ycommon { namespace containers {
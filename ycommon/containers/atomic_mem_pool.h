@@ -1,12 +1,19 @@
 #ifndef YCOMMON_CONTAINERS_ATOMIC_MEM_POOL_H
 #define YCOMMON_CONTAINERS_ATOMIC_MEM_POOL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /*******
 * Atomic Array able to store and remove fixed size elements.
 *   - buffer size requirement: item_size * num_items
+*   - AtomicMemPoolCache is a per thread front end which moves indexes to and
+*     from the shared pool in batches, so threads rarely touch the shared
+*     free list. Indexes held in a cache cannot be allocated by other threads
+*     until the cache is flushed.
 ********/
+#define ATOMIC_MEM_POOL_CACHE_SIZE 32
+
 namespace ycommon { namespace containers {
 
 class AtomicMemPool {
@@ -24,6 +31,10 @@ class AtomicMemPool {
   uint32_t Allocate(); // returns -1 on failure.
   void Remove(uint32_t index);
 
+  // Allocates or Removes many indexes with a single swap of the free list.
+  uint32_t AllocateBatch(uint32_t* indexes, uint32_t max_count);
+  void RemoveBatch(const uint32_t* indexes, uint32_t count);
+
   // Returns inserted index or -1.
   uint32_t Insert(const void* data_item);
   uint32_t GetIndex(const void* buffer_item);
@@ -33,6 +44,7 @@ class AtomicMemPool {
 
   size_t GetItemSize() { return mItemSize; }
   uint32_t GetNumItems() { return mNumItems; }
+  void* GetBuffer() { return mBuffer; }
 
  protected:
   void* mBuffer;
@@ -43,6 +55,35 @@ class AtomicMemPool {
   volatile uint64_t mNextFreeIndex;
 };
 
+class AtomicMemPoolCache {
+ public:
+  AtomicMemPoolCache();
+  explicit AtomicMemPoolCache(AtomicMemPool* mem_pool);
+  ~AtomicMemPoolCache(); // Flushes the cache.
+
+  void Init(AtomicMemPool* mem_pool);
+
+  uint32_t Allocate(); // returns -1 on failure.
+  void Remove(uint32_t index);
+  uint32_t Insert(const void* data_item);
+
+  // Returns every cached index to the pool.
+  void Flush();
+
+  // Flushes when the calling platform::Thread exits, the cache must outlive
+  // the thread.
+  bool FlushOnThreadExit();
+
+  uint32_t GetNumCached() const { return mNumCached; }
+
+ private:
+  static uintptr_t FlushRoutine(void* arg);
+
+  AtomicMemPool* mMemPool;
+  uint32_t mNumCached;
+  uint32_t mIndexes[ATOMIC_MEM_POOL_CACHE_SIZE];
+};
+
 template<typename T>
 class TypedAtomicMemPool : public AtomicMemPool {
  public:
@@ -77,11 +118,12 @@ class TypedAtomicMemPool : public AtomicMemPool {
 template<typename T, size_t items>
 class ContainedAtomicMemPool : public TypedAtomicMemPool<T> {
  public:
-  ContainedAtomicMemPool() : TypedAtomicMemPool(mData, sizeof(mData), items) {}
+  ContainedAtomicMemPool()
+      : TypedAtomicMemPool<T>(mData, sizeof(mData), items) {}
   ~ContainedAtomicMemPool() {}
 
   void Init() {
-    TypedAtomicMemPool::Init(mData, sizeof(mData), items);
+    TypedAtomicMemPool<T>::Init(mData, sizeof(mData), items);
   }
 
  private:
@@ -59,6 +59,55 @@ uintptr_t AllocRemoveRoutine(void* arg) {
   return retvalue;
 }
 
+/* Same as AllocRemoveRoutine but going through a per thread cache. */
+struct CachedAllocRemoveArg {
+  AllocRemoveArg* alloc_remove_arg;
+  AtomicMemPoolCache* cache;
+};
+
+uintptr_t CachedAllocRemoveRoutine(void* arg) {
+  int retvalue = 0;
+  CachedAllocRemoveArg* cached_arg = static_cast<CachedAllocRemoveArg*>(arg);
+  AllocRemoveArg* arg_data = cached_arg->alloc_remove_arg;
+  AtomicMemPoolCache* cache = cached_arg->cache;
+  if (!cache->FlushOnThreadExit())
+    return 1;
+
+  const uint32_t mem_pool_size = arg_data->mem_pool->GetNumItems();
+  uint32_t* allocated_data = new uint32_t[mem_pool_size];
+
+  const uint32_t num_allocations = arg_data->num_allocations;
+  const int num_iterations = arg_data->num_iterations;
+  int insert_data = 0;
+  for (int i = 0; i < num_iterations; ++i) {
+    uint32_t allocated_size = 0;
+
+    // Allocate data until it is full
+    for (uint32_t index = cache->Insert(&insert_data);
+         index != static_cast<uint32_t>(-1);
+         index = cache->Insert(&insert_data)) {
+      allocated_data[allocated_size++] = index;
+      if (allocated_size > mem_pool_size) {
+        retvalue = 1;
+        break;
+      } else if (allocated_size >= num_allocations) {
+        break;
+      }
+    }
+
+    if (retvalue != 0)
+      break;
+
+    // Remove all the allocated data
+    for (uint32_t n = 0; n < allocated_size; ++n) {
+      cache->Remove(allocated_data[n]);
+    }
+  }
+
+  delete [] allocated_data;
+  return retvalue;
+}
+
 /************
 * Test Definitions
 *************/
@@ -76,6 +125,50 @@ TEST(AtomicMemPoolTest, AllocRemoveTest) {
   ASSERT_EQ(static_cast<uint32_t>(-1), mem_pool.Insert(data));
 }
 
+TEST(AtomicMemPoolTest, BatchTest) {
+  ContainedAtomicMemPool<int, 100> mem_pool;
+  uint32_t indexes[100];
+
+  ASSERT_EQ(60u, mem_pool.AllocateBatch(indexes, 60));
+  ASSERT_EQ(40u, mem_pool.AllocateBatch(indexes + 60, 60));
+  ASSERT_EQ(0u, mem_pool.AllocateBatch(indexes, 1));
+  for (uint32_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, indexes[i]);
+  }
+
+  // Removed batches are allocated again before anything else.
+  mem_pool.RemoveBatch(indexes + 10, 20);
+  uint32_t reallocated[30];
+  ASSERT_EQ(20u, mem_pool.AllocateBatch(reallocated, 30));
+  for (uint32_t i = 0; i < 20; ++i) {
+    EXPECT_EQ(indexes[10 + i], reallocated[i]);
+  }
+  ASSERT_EQ(static_cast<uint32_t>(-1), mem_pool.Allocate());
+}
+
+TEST(AtomicMemPoolTest, CacheAllocRemoveTest) {
+  ContainedAtomicMemPool<int, 100> mem_pool;
+
+  {
+    AtomicMemPoolCache cache(&mem_pool);
+    AllocRemoveArg arg_data(&mem_pool, 100, 10);
+    CachedAllocRemoveArg cached_arg = { &arg_data, &cache };
+    ASSERT_EQ(0, CachedAllocRemoveRoutine(&cached_arg));
+    EXPECT_LT(0u, cache.GetNumCached());
+
+    cache.Flush();
+    EXPECT_EQ(0u, cache.GetNumCached());
+    platform::Thread::RunExitRoutines();
+  }
+
+  // Make sure we can still allocate 100 items
+  uint32_t data = 123;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_NE(static_cast<uint32_t>(-1), mem_pool.Insert(data));
+  }
+  ASSERT_EQ(static_cast<uint32_t>(-1), mem_pool.Insert(data));
+}
+
 /*************
 * Test constant adding and removing
 **************/
@@ -106,6 +199,36 @@ class ThreadedAllocRemoveTest : public ::testing::Test {
     ASSERT_EQ(static_cast<uint32_t>(-1), mMemPool.Insert(data));
   }
 
+  void RunCachedTest(int iterations) {
+    AllocRemoveArg arg_data(&mMemPool, POOL_SIZE, iterations);
+    AllocRemoveArg arg_half_data(&mMemPool, POOL_SIZE / 2, iterations);
+
+    AtomicMemPoolCache caches[NUM_THREADS];
+    CachedAllocRemoveArg cached_args[NUM_THREADS];
+    ycommon::platform::Thread test_threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; ++i) {
+      caches[i].Init(&mMemPool);
+      cached_args[i].alloc_remove_arg =
+          (i % 2 == 0 ? &arg_data : &arg_half_data);
+      cached_args[i].cache = &caches[i];
+      test_threads[i].Initialize(CachedAllocRemoveRoutine, &cached_args[i]);
+      test_threads[i].Run();
+    }
+
+    // Caches are flushed as each thread exits.
+    for (int i = 0; i < NUM_THREADS; ++i) {
+      test_threads[i].Join();
+      EXPECT_EQ(0, test_threads[i].ReturnValue());
+      EXPECT_EQ(0u, caches[i].GetNumCached());
+    }
+
+    uint32_t data = 123;
+    for (size_t i = 0; i < POOL_SIZE; ++i) {
+      ASSERT_NE(static_cast<uint32_t>(-1), mMemPool.Insert(data));
+    }
+    ASSERT_EQ(static_cast<uint32_t>(-1), mMemPool.Insert(data));
+  }
+
   ContainedAtomicMemPool<int, POOL_SIZE> mMemPool;
 };
 
@@ -125,4 +248,16 @@ TEST_F(LargeAtomicMemPoolTest, LargeTests) {
   RunTest(100000);
 }
 
+TEST_F(MinimalAtomicMemPoolTest , MinimalCachedTests) {
+  RunCachedTest(10);
+}
+
+TEST_F(SmallAtomicMemPoolTest, SmallCachedTests) {
+  RunCachedTest(100000);
+}
+
+TEST_F(LargeAtomicMemPoolTest, LargeCachedTests) {
+  RunCachedTest(100000);
+}
+
 }} // namespace ycommon { namespace containers {
@@ -0,0 +1,112 @@
+#include "ycommon/containers/atomic_mem_pool.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/platform/thread.h"
+#include "ycommon/platform/timer.h"
+
+#define MAX_THREADS 8
+#define POOL_SIZE 4096
+#define ITEMS_PER_ROUND 8
+#define NUM_ROUNDS 100000
+
+namespace ycommon { namespace containers {
+
+struct PoolPerfArg {
+  AtomicMemPool* mem_pool;
+  AtomicMemPoolCache* cache; // Allocates straight from the pool when NULL.
+  volatile uint32_t* begin_running;
+};
+
+static uintptr_t PoolPerfRoutine(void* arg) {
+  PoolPerfArg* arg_data = static_cast<PoolPerfArg*>(arg);
+  AtomicMemPool* mem_pool = arg_data->mem_pool;
+  AtomicMemPoolCache* cache = arg_data->cache;
+
+  while (*arg_data->begin_running == 0) {}
+  MemoryBarrier();
+
+  uint32_t indexes[ITEMS_PER_ROUND];
+  for (int round = 0; round < NUM_ROUNDS; ++round) {
+    for (int i = 0; i < ITEMS_PER_ROUND; ++i) {
+      indexes[i] = cache ? cache->Allocate() : mem_pool->Allocate();
+      if (indexes[i] == static_cast<uint32_t>(-1))
+        return 1;
+    }
+    for (int i = 0; i < ITEMS_PER_ROUND; ++i) {
+      if (cache)
+        cache->Remove(indexes[i]);
+      else
+        mem_pool->Remove(indexes[i]);
+    }
+  }
+
+  if (cache)
+    cache->Flush();
+  return 0;
+}
+
+class AtomicMemPoolPerfTest : public ::testing::Test {
+ public:
+  // Returns the time in microseconds for every thread to finish its rounds.
+  float TimeThreads(uint32_t num_threads, bool use_caches) {
+    ContainedAtomicMemPool<uint32_t, POOL_SIZE> mem_pool;
+    AtomicMemPoolCache caches[MAX_THREADS];
+    PoolPerfArg args[MAX_THREADS];
+    platform::Thread threads[MAX_THREADS];
+    volatile uint32_t begin_running = 0;
+
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      caches[i].Init(&mem_pool);
+      args[i].mem_pool = &mem_pool;
+      args[i].cache = use_caches ? &caches[i] : nullptr;
+      args[i].begin_running = &begin_running;
+      threads[i].Initialize(PoolPerfRoutine, &args[i]);
+      threads[i].Run();
+    }
+
+    platform::Timer timer;
+    timer.Start();
+    MemoryBarrier();
+    begin_running = 1;
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads[i].Join();
+      EXPECT_EQ(0u, threads[i].ReturnValue());
+    }
+    timer.Pulse();
+    return timer.GetDiffTimeMicroFloat();
+  }
+
+  void RunBenchmark(uint32_t num_threads) {
+    const float pool_time = TimeThreads(num_threads, false);
+    const float cache_time = TimeThreads(num_threads, true);
+
+    const float num_ops =
+        static_cast<float>(num_threads) * NUM_ROUNDS * ITEMS_PER_ROUND * 2;
+    printf("[ATOMICPOOL] %u threads: shared pool %7.2f Mops/s, "
+           "thread caches %7.2f Mops/s\n",
+           num_threads,
+           num_ops / pool_time,
+           num_ops / cache_time);
+  }
+};
+
+TEST_F(AtomicMemPoolPerfTest, AllocRemove1Thread) {
+  RunBenchmark(1);
+}
+
+TEST_F(AtomicMemPoolPerfTest, AllocRemove2Threads) {
+  RunBenchmark(2);
+}
+
+TEST_F(AtomicMemPoolPerfTest, AllocRemove4Threads) {
+  RunBenchmark(4);
+}
+
+TEST_F(AtomicMemPoolPerfTest, AllocRemove8Threads) {
+  RunBenchmark(8);
+}
+
+}} // namespace ycommon { namespace containers {
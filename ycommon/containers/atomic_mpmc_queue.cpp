@@ -0,0 +1,127 @@
+#include "ycommon/containers/atomic_mpmc_queue.h"
+
+#include <string.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/utils/assert.h"
+
+namespace ycommon { namespace containers {
+
+AtomicMPMCQueue::AtomicMPMCQueue()
+    : mBuffer(NULL),
+      mItemSize(0),
+      mSlotSize(0),
+      mNumItems(0),
+      mIndexMask(0),
+      mTail(0),
+      mHead(0) {
+}
+
+AtomicMPMCQueue::AtomicMPMCQueue(void* buffer, size_t buffer_size,
+                                 size_t item_size, size_t num_items)
+    : mBuffer(NULL),
+      mItemSize(0),
+      mSlotSize(0),
+      mNumItems(0),
+      mIndexMask(0),
+      mTail(0),
+      mHead(0) {
+  Initialize(buffer, buffer_size, item_size, num_items);
+}
+
+AtomicMPMCQueue::~AtomicMPMCQueue() {
+}
+
+void AtomicMPMCQueue::Initialize(void* buffer, size_t buffer_size,
+                                 size_t item_size, size_t num_items) {
+  const size_t slot_size = GetSlotSize(item_size);
+  YASSERT(buffer_size >= (slot_size * num_items),
+          "Atomic MPMC Queue %u[%u] requires at least %u bytes, "
+          "supplied %u bytes.",
+          static_cast<uint32_t>(item_size), static_cast<uint32_t>(num_items),
+          static_cast<uint32_t>(slot_size * num_items),
+          static_cast<uint32_t>(buffer_size));
+  YASSERT(num_items > 0, "Atomic MPMC Queue must hold at least 1 item.");
+
+  mBuffer = static_cast<uint8_t*>(buffer);
+  mItemSize = item_size;
+  mSlotSize = slot_size;
+  mNumItems = num_items;
+  mIndexMask = IS_POWER_OF_2(num_items) ? (num_items - 1) : 0;
+  mTail = 0;
+  mHead = 0;
+
+  // Slot i is first free for the producer at position i.
+  for (size_t i = 0; i < num_items; ++i) {
+    uint64_t* sequence = reinterpret_cast<uint64_t*>(mBuffer + i * slot_size);
+    *sequence = static_cast<uint64_t>(i);
+  }
+  MemoryBarrier();
+}
+
+bool AtomicMPMCQueue::Enqueue(const void* data_item) {
+  for (;;) {
+    const uint64_t cur_tail = mTail;
+    uint8_t* slot = GetSlot(cur_tail);
+    volatile uint64_t* sequence = reinterpret_cast<volatile uint64_t*>(slot);
+    const uint64_t cur_sequence = *sequence;
+    AcquireFence();
+
+    const int64_t diff = static_cast<int64_t>(cur_sequence - cur_tail);
+    if (diff == 0) {
+      if (AtomicCmpSet64(&mTail, cur_tail, cur_tail + 1)) {
+        memcpy(slot + sizeof(uint64_t), data_item, mItemSize);
+
+        // Publish the item to consumers.
+        ReleaseFence();
+        *sequence = cur_tail + 1;
+        return true;
+      }
+    } else if (diff < 0) {
+      // Slot has not been consumed since the last lap, the queue is full.
+      return false;
+    }
+    // Otherwise another producer claimed this position, try again.
+  }
+}
+
+bool AtomicMPMCQueue::Dequeue(void* data_item) {
+  for (;;) {
+    const uint64_t cur_head = mHead;
+    uint8_t* slot = GetSlot(cur_head);
+    volatile uint64_t* sequence = reinterpret_cast<volatile uint64_t*>(slot);
+    const uint64_t cur_sequence = *sequence;
+    AcquireFence();
+
+    const int64_t diff = static_cast<int64_t>(cur_sequence - (cur_head + 1));
+    if (diff == 0) {
+      if (AtomicCmpSet64(&mHead, cur_head, cur_head + 1)) {
+        memcpy(data_item, slot + sizeof(uint64_t), mItemSize);
+
+        // Hand the slot back to producers for the next lap.
+        ReleaseFence();
+        *sequence = cur_head + mNumItems;
+        return true;
+      }
+    } else if (diff < 0) {
+      // Slot has not been filled yet, the queue is empty.
+      return false;
+    }
+    // Otherwise another consumer claimed this position, try again.
+  }
+}
+
+size_t AtomicMPMCQueue::CurrentSize() const {
+  const uint64_t cur_head = mHead;
+  const uint64_t cur_tail = mTail;
+  MemoryBarrier();
+
+  // Only a snapshot, both ends may be moving concurrently.
+  if (cur_tail <= cur_head)
+    return 0;
+
+  const uint64_t size = cur_tail - cur_head;
+  return static_cast<size_t>(size < mNumItems ? size : mNumItems);
+}
+
+}} // namespace ycommon { namespace containers {
@@ -0,0 +1,113 @@
+#ifndef YCOMMON_CONTAINERS_ATOMIC_MPMC_QUEUE_H
+#define YCOMMON_CONTAINERS_ATOMIC_MPMC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ycommon/headers/macros.h"
+
+#define MPMC_CACHE_LINE_SIZE 64
+
+/*******
+* Bounded Atomic Queue with fixed size elements.
+*  - Multiple producers (Any number of threads can Enqueue)
+*  - Multiple consumers (Any number of threads can Dequeue)
+*  - Every slot stores a sequence number next to the item, the sequence tells
+*    producers and consumers whose turn it is to use the slot.
+*  - Space Requirements: (ROUND_UP(item_size, 8) + 8) * num_items
+********/
+namespace ycommon { namespace containers {
+
+class AtomicMPMCQueue {
+ public:
+  static size_t GetSlotSize(size_t item_size) {
+    return ROUND_UP(item_size, sizeof(uint64_t)) + sizeof(uint64_t);
+  }
+
+  static size_t GetAllocationSize(size_t item_size, size_t num_items) {
+    return GetSlotSize(item_size) * num_items;
+  }
+
+  AtomicMPMCQueue();
+  AtomicMPMCQueue(void* buffer, size_t buffer_size,
+                  size_t item_size, size_t num_items);
+  ~AtomicMPMCQueue();
+
+  void Initialize(void* buffer, size_t buffer_size,
+                  size_t item_size, size_t num_items);
+  bool Enqueue(const void* data_item);
+  bool Dequeue(void* data_item);
+  size_t CurrentSize() const;
+
+  size_t ItemSize() const { return mItemSize; }
+  size_t Size() const { return mNumItems; }
+
+ private:
+  uint8_t* GetSlot(uint64_t position) const {
+    const uint64_t index = mIndexMask ? (position & mIndexMask) :
+                                        (position % mNumItems);
+    return mBuffer + static_cast<size_t>(index) * mSlotSize;
+  }
+
+  uint8_t* mBuffer;
+  size_t mItemSize;
+  size_t mSlotSize;
+  size_t mNumItems;
+  uint64_t mIndexMask;
+
+  // Producers and consumers update separate cache lines.
+  uint8_t mPadding0[MPMC_CACHE_LINE_SIZE];
+  volatile uint64_t mTail; // Next position to enqueue into.
+  uint8_t mPadding1[MPMC_CACHE_LINE_SIZE - sizeof(uint64_t)];
+  volatile uint64_t mHead; // Next position to dequeue from.
+  uint8_t mPadding2[MPMC_CACHE_LINE_SIZE - sizeof(uint64_t)];
+};
+
+template<typename T>
+class TypedAtomicMPMCQueue : public AtomicMPMCQueue {
+ public:
+  static size_t GetAllocationSize(size_t num_items) {
+    return AtomicMPMCQueue::GetAllocationSize(sizeof(T), num_items);
+  }
+
+  TypedAtomicMPMCQueue() : AtomicMPMCQueue() {}
+  TypedAtomicMPMCQueue(void* buffer, size_t buffer_size, size_t num_items)
+      : AtomicMPMCQueue(buffer, buffer_size, sizeof(T), num_items) {}
+
+  void Initialize(void* buffer, size_t buffer_size, size_t num_items) {
+    AtomicMPMCQueue::Initialize(buffer, buffer_size, sizeof(T), num_items);
+  }
+
+  bool Enqueue(const T* data_item) {
+    return AtomicMPMCQueue::Enqueue(static_cast<const void*>(data_item));
+  }
+
+  bool Enqueue(const T& data_item) {
+    return Enqueue(&data_item);
+  }
+
+  bool Dequeue(T* data_item) {
+    return AtomicMPMCQueue::Dequeue(static_cast<void*>(data_item));
+  }
+
+  bool Dequeue(T& data_item) {
+    return Dequeue(&data_item);
+  }
+};
+
+template<typename T, size_t items>
+class ContainedAtomicMPMCQueue : public TypedAtomicMPMCQueue<T> {
+ public:
+  ContainedAtomicMPMCQueue()
+      : TypedAtomicMPMCQueue<T>(mBuffer, sizeof(mBuffer), items) {}
+  ~ContainedAtomicMPMCQueue() {}
+
+ private:
+  ALIGN_FRONT(8)
+  uint8_t mBuffer[(ROUND_UP(sizeof(T), sizeof(uint64_t)) +
+                   sizeof(uint64_t)) * items] ALIGN_BACK(8);
+};
+
+}} // namespace ycommon { namespace containers {
+
+#endif // YCOMMON_CONTAINERS_ATOMIC_MPMC_QUEUE_H
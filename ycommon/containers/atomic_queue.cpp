@@ -1,6 +1,6 @@
 #include "ycommon/containers/atomic_queue.h"
 
-#include <string>
+#include <string.h>
 
 #include "ycommon/headers/atomic_number_mask.h"
 #include "ycommon/headers/atomics.h"
@@ -61,6 +61,9 @@ bool AtomicQueue::Enqueue(const void* data_item) {
   const uint64_t new_tail_num = cur_tail_num + mItemSize;
   const uint64_t tail_cnt = GET_CNT(cur_tail);
 
+  // Item must be visible before the tail is moved past it.
+  ReleaseFence();
+
   // Check if looped through buffer.
   mTail = (new_tail_num == (mItemSize * mNumItems)) ?
           CONSTRUCT_NEXT_VALUE(tail_cnt, 0) :
@@ -110,7 +113,7 @@ size_t AtomicQueue::CurrentSize() const {
 
   if (cur_head_num == cur_tail_num) {
     // Empty if the counters match, full otherwise.
-    return (cur_head == cur_tail) ? 0 : mItemSize;
+    return (cur_head == cur_tail) ? 0 : mNumItems;
   } else if (cur_tail_num > cur_head_num) {
     return static_cast<size_t>((cur_tail_num - cur_head_num) / size);
   } else {
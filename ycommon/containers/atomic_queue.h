@@ -1,6 +1,7 @@
 #ifndef YCOMMON_CONTAINERS_ATOMIC_QUEUE_H
 #define YCOMMON_CONTAINERS_ATOMIC_QUEUE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /*******
@@ -68,7 +69,7 @@ class TypedAtomicQueue : public AtomicQueue {
 template<typename T, size_t items>
 class ContainedAtomicQueue : public TypedAtomicQueue<T> {
  public:
-  ContainedAtomicQueue() : TypedAtomicQueue(mData, sizeof(mData), items) {}
+  ContainedAtomicQueue() : TypedAtomicQueue<T>(mData, sizeof(mData), items) {}
   ~ContainedAtomicQueue() {}
 
  private:
@@ -1,7 +1,9 @@
 #include "ycommon/containers/atomic_queue.h"
 
 #include <gtest/gtest.h>
+#include <string.h>
 
+#include "ycommon/containers/atomic_mpmc_queue.h"
 #include "ycommon/headers/macros.h"
 
 namespace ycommon { namespace containers {
@@ -143,4 +145,95 @@ TEST(BasicAtomicQueueTest, ReuseTest) {
   EXPECT_FALSE(queue.Dequeue(dequeue_data));
 }
 
+TEST(BasicAtomicMPMCQueueTest, ConstructorTest) {
+  uint8_t queue_data[sizeof(uint64_t) * 2] ALIGN_BACK(8);
+  AtomicMPMCQueue atomic_queue(queue_data, sizeof(queue_data),
+                               sizeof(int), 1);
+
+  uint64_t typed_data[2];
+  TypedAtomicMPMCQueue<int> typed_queue(typed_data, sizeof(typed_data), 1);
+
+  ContainedAtomicMPMCQueue<int, 1> contained_queue;
+}
+
+TEST(BasicAtomicMPMCQueueTest, SizeTest) {
+  uint64_t queue_data[4];
+  EXPECT_EQ(sizeof(queue_data),
+            AtomicMPMCQueue::GetAllocationSize(sizeof(int), 2));
+  AtomicMPMCQueue atomic_queue(queue_data, sizeof(queue_data),
+                               sizeof(int), 2);
+
+  EXPECT_EQ(sizeof(int), atomic_queue.ItemSize());
+  EXPECT_EQ(2, atomic_queue.Size());
+
+  ContainedAtomicMPMCQueue<int, 6> contained_queue;
+  EXPECT_EQ(sizeof(int), contained_queue.ItemSize());
+  EXPECT_EQ(6, contained_queue.Size());
+}
+
+TEST(BasicAtomicMPMCQueueTest, EnqueueDequeueTest) {
+  uint64_t queue_data[4];
+  AtomicMPMCQueue queue(queue_data, sizeof(queue_data), sizeof(int), 2);
+
+  int data = 1;
+  ASSERT_TRUE(queue.Enqueue(&data));
+  EXPECT_EQ(1, queue.CurrentSize());
+
+  int dequeued_data = 0;
+  ASSERT_TRUE(queue.Dequeue(&dequeued_data));
+  EXPECT_EQ(data, dequeued_data);
+  EXPECT_EQ(0, queue.CurrentSize());
+}
+
+TEST(BasicAtomicMPMCQueueTest, FullEnqueueTest) {
+  ContainedAtomicMPMCQueue<int, 2> queue;
+
+  int data = 1;
+  ASSERT_TRUE(queue.Enqueue(data));
+  ASSERT_TRUE(queue.Enqueue(data));
+  EXPECT_EQ(2, queue.CurrentSize());
+  ASSERT_FALSE(queue.Enqueue(data));
+}
+
+TEST(BasicAtomicMPMCQueueTest, EmptyDequeueTest) {
+  ContainedAtomicMPMCQueue<int, 2> queue;
+
+  int data = 0;
+  ASSERT_FALSE(queue.Dequeue(data));
+  ASSERT_TRUE(queue.Enqueue(data));
+  ASSERT_TRUE(queue.Dequeue(data));
+  ASSERT_FALSE(queue.Dequeue(data));
+}
+
+TEST(BasicAtomicMPMCQueueTest, LargeItemTest) {
+  struct LargeItem {
+    uint32_t values[5];
+  };
+  ContainedAtomicMPMCQueue<LargeItem, 2> queue;
+
+  LargeItem item = { { 1, 2, 3, 4, 5 } };
+  ASSERT_TRUE(queue.Enqueue(item));
+
+  LargeItem dequeued_item = { { 0 } };
+  ASSERT_TRUE(queue.Dequeue(dequeued_item));
+  EXPECT_EQ(0, memcmp(&item, &dequeued_item, sizeof(item)));
+}
+
+TEST(BasicAtomicMPMCQueueTest, ReuseTest) {
+  // Non power of 2 sizes wrap around without an index mask.
+  ContainedAtomicMPMCQueue<int, 3> queue;
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.Enqueue(i));
+    ASSERT_TRUE(queue.Enqueue(i + 100));
+
+    int data = -1;
+    ASSERT_TRUE(queue.Dequeue(data));
+    EXPECT_EQ(i, data);
+    ASSERT_TRUE(queue.Dequeue(data));
+    EXPECT_EQ(i + 100, data);
+    ASSERT_FALSE(queue.Dequeue(data));
+  }
+}
+
 }} // namespace ycommon { namespace containers {
@@ -1,12 +1,20 @@
 #include "ycommon/containers/atomic_queue.h"
 
 #include <gtest/gtest.h>
+#include <stdio.h>
 
+#include "ycommon/containers/atomic_mpmc_queue.h"
 #include "ycommon/headers/atomics.h"
 #include "ycommon/platform/thread.h"
+#include "ycommon/platform/timer.h"
 
 #define NUM_THREADS 5
 
+#define MAX_PRODUCERS 8
+#define MAX_CONSUMERS 8
+#define PRODUCER_SHIFT 24
+#define SEQUENCE_MASK ((1 << PRODUCER_SHIFT) - 1)
+
 namespace ycommon { namespace containers {
 
 struct DequeueThreadArg {
@@ -26,17 +34,22 @@ uintptr_t DequeueThreadRoutine(void* arg) {
   uint32_t prev_value = 0;
   uint32_t current_value = 0;
 
-  do {
+  // Drain once more after keep_going is cleared so the final items enqueued
+  // before it was cleared are not left behind.
+  uint32_t keep_going = 1;
+  while (keep_going) {
+    keep_going = *arg_data->keep_going;
     MemoryBarrier();
     while (arg_data->queue->Dequeue(current_value)) {
       if (current_value <= prev_value) {
         ret = 1;
         *arg_data->keep_going = 0;
+        keep_going = 0;
         break;
       }
       prev_value = current_value;
     }
-  } while (*arg_data->keep_going);
+  }
 
   return ret;
 }
@@ -144,4 +157,154 @@ TEST_F(LargeAtomicQueueTest, LargeTests) {
   RunTest(10000);
 }
 
+/*************
+* Test multiple producers and multiple consumers
+**************/
+struct MPMCProducerArg {
+  TypedAtomicMPMCQueue<uint32_t>* queue;
+  uint32_t producer_id;
+  uint32_t num_items;
+};
+
+struct MPMCConsumerArg {
+  TypedAtomicMPMCQueue<uint32_t>* queue;
+  volatile uint32_t* items_left;
+  uint64_t sum;
+  uint32_t count;
+};
+
+uintptr_t MPMCProducerRoutine(void* arg) {
+  MPMCProducerArg* arg_data = static_cast<MPMCProducerArg*>(arg);
+  const uint32_t producer_bits = arg_data->producer_id << PRODUCER_SHIFT;
+  for (uint32_t i = 1; i <= arg_data->num_items; ++i) {
+    while (!arg_data->queue->Enqueue(producer_bits | i)) {}
+  }
+  return 0;
+}
+
+uintptr_t MPMCConsumerRoutine(void* arg) {
+  MPMCConsumerArg* arg_data = static_cast<MPMCConsumerArg*>(arg);
+
+  // Items from each producer must come out in the order they went in.
+  uint32_t prev_sequence[MAX_PRODUCERS] = { 0 };
+  uintptr_t ret = 0;
+  uint32_t value = 0;
+  while (*arg_data->items_left) {
+    if (!arg_data->queue->Dequeue(value))
+      continue;
+
+    AtomicAdd32(arg_data->items_left, static_cast<uint32_t>(-1));
+    const uint32_t producer_id = value >> PRODUCER_SHIFT;
+    const uint32_t sequence = value & SEQUENCE_MASK;
+    if (producer_id >= MAX_PRODUCERS ||
+        sequence <= prev_sequence[producer_id]) {
+      ret = 1;
+    } else {
+      prev_sequence[producer_id] = sequence;
+    }
+    arg_data->sum += sequence;
+    ++arg_data->count;
+  }
+  return ret;
+}
+
+template <uint32_t QUEUE_SIZE>
+class ThreadedMPMCTest : public ::testing::Test {
+ public:
+  // Returns the microseconds taken to pass all the items through the queue.
+  int64_t RunTest(uint32_t num_producers, uint32_t num_consumers,
+                  uint32_t items_per_producer) {
+    MPMCProducerArg producer_args[MAX_PRODUCERS];
+    MPMCConsumerArg consumer_args[MAX_CONSUMERS];
+    ycommon::platform::Thread producers[MAX_PRODUCERS];
+    ycommon::platform::Thread consumers[MAX_CONSUMERS];
+    volatile uint32_t items_left = num_producers * items_per_producer;
+
+    platform::Timer timer;
+    timer.Start();
+    for (uint32_t n = 0; n < num_consumers; ++n) {
+      consumer_args[n].queue = &mQueue;
+      consumer_args[n].items_left = &items_left;
+      consumer_args[n].sum = 0;
+      consumer_args[n].count = 0;
+      consumers[n].Initialize(MPMCConsumerRoutine, &consumer_args[n]);
+      consumers[n].Run();
+    }
+    for (uint32_t n = 0; n < num_producers; ++n) {
+      producer_args[n].queue = &mQueue;
+      producer_args[n].producer_id = n;
+      producer_args[n].num_items = items_per_producer;
+      producers[n].Initialize(MPMCProducerRoutine, &producer_args[n]);
+      producers[n].Run();
+    }
+
+    for (uint32_t n = 0; n < num_producers; ++n) {
+      producers[n].Join();
+    }
+
+    uint64_t sum = 0;
+    uint32_t count = 0;
+    for (uint32_t n = 0; n < num_consumers; ++n) {
+      consumers[n].Join();
+      EXPECT_EQ(0, consumers[n].ReturnValue());
+      sum += consumer_args[n].sum;
+      count += consumer_args[n].count;
+    }
+    timer.Pulse();
+
+    const uint64_t items = items_per_producer;
+    EXPECT_EQ(num_producers * items_per_producer, count);
+    EXPECT_EQ(num_producers * (items * (items + 1) / 2), sum);
+
+    uint32_t last_item = 0;
+    EXPECT_FALSE(mQueue.Dequeue(last_item));
+    return timer.GetPulsedTimeMicro();
+  }
+
+  ContainedAtomicMPMCQueue<uint32_t, QUEUE_SIZE> mQueue;
+};
+
+class SmallMPMCQueueTest : public ThreadedMPMCTest<16> {};
+class LargeMPMCQueueTest : public ThreadedMPMCTest<1000> {};
+
+TEST_F(SmallMPMCQueueTest, SingleProducerTests) {
+  for (int i = 0; i < 20; ++i) {
+    RunTest(1, 4, 1000);
+  }
+}
+
+TEST_F(SmallMPMCQueueTest, SingleConsumerTests) {
+  for (int i = 0; i < 20; ++i) {
+    RunTest(4, 1, 1000);
+  }
+}
+
+TEST_F(SmallMPMCQueueTest, ContendedTests) {
+  for (int i = 0; i < 20; ++i) {
+    RunTest(4, 4, 1000);
+  }
+}
+
+TEST_F(LargeMPMCQueueTest, LargeTests) {
+  for (int i = 0; i < 5; ++i) {
+    RunTest(MAX_PRODUCERS, MAX_CONSUMERS, 20000);
+  }
+}
+
+TEST_F(LargeMPMCQueueTest, ThroughputTests) {
+  const uint32_t kItemsPerRun = 400000;
+  const uint32_t thread_counts[] = { 1, 2, 4, 8 };
+  for (size_t p = 0; p < sizeof(thread_counts) / sizeof(uint32_t); ++p) {
+    for (size_t c = 0; c < sizeof(thread_counts) / sizeof(uint32_t); ++c) {
+      const uint32_t producers = thread_counts[p];
+      const uint32_t consumers = thread_counts[c];
+      const int64_t micro = RunTest(producers, consumers,
+                                    kItemsPerRun / producers);
+      printf("[ MPMCQUEUE] %u producers, %u consumers: %8.2f Mitems/s\n",
+             producers, consumers,
+             micro ? static_cast<double>(kItemsPerRun) / micro : 0.0);
+    }
+  }
+}
+
 }} // namespace ycommon { namespace containers {
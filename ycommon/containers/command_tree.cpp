@@ -1,35 +1,95 @@
 #include "ycommon/containers/command_tree.h"
 
 #include "ycommon/headers/atomics.h"
+#include "ycommon/headers/macros.h"
+#include "ycommon/platform/profiler.h"
 #include "ycommon/platform/timer.h"
 #include "ycommon/utils/assert.h"
 
+#define MAX_READY_LOCK_BACKOFF 64
+
 namespace ycommon { namespace containers {
 
+namespace {
+  // User priorities come first, then measured priorities, then the order of
+  // the nodes array.
+  template <typename Node>
+  bool IsHigherPriority(const Node* node, const Node* other) {
+    if (node->mPriority != other->mPriority)
+      return node->mPriority > other->mPriority;
+    if (node->mMeasuredPriority != other->mMeasuredPriority)
+      return node->mMeasuredPriority > other->mMeasuredPriority;
+    return node->mIndex < other->mIndex;
+  }
+
+  // Waiting threads only read the lock, backing off between reads.
+  void LockReadyNodes(volatile uint32_t* lock) {
+    uint32_t backoff = 1;
+    while (!AtomicCmpSet32(lock, 0, 1)) {
+      do {
+        for (uint32_t i = 0; i < backoff; ++i) {
+          CpuPause();
+        }
+        if (backoff < MAX_READY_LOCK_BACKOFF)
+          backoff *= 2;
+      } while (*lock);
+    }
+  }
+
+  void UnlockReadyNodes(volatile uint32_t* lock) {
+    ReleaseFence();
+    *lock = 0;
+  }
+}
+
+size_t CommandTree::GetAllocationSize(size_t num_threads, size_t num_nodes,
+                                      size_t num_dependencies) {
+  // Root node, ordered node and ready node pointers are each bounded by the
+  // number of nodes.
+  return sizeof(ThreadPool) +
+         ThreadPool::GetAllocationSize(num_threads, num_nodes) +
+         sizeof(CommandNode) * num_nodes +
+         sizeof(NodeTiming) * num_nodes +
+         ROUND_UP(sizeof(uint32_t) * num_nodes, sizeof(CommandNode*)) +
+         sizeof(CommandNode*) * (num_nodes * 3 + num_dependencies);
+}
+
 CommandTree::CommandTree()
     : mBuffer(NULL),
       mBufferSize(0),
       mCommandTreeState(kCommandTreeState_Uninitialized),
       mSemaphore(0, 1),
+      mHasTimings(false),
+      mAutoPriorities(false),
+      mCommandNodes(NULL),
+      mOrderedNodes(NULL),
       mNumRootNodes(0),
       mRootNodes(NULL) {
 }
 
-CommandTree::CommandTree(size_t num_threads, void* buffer, size_t buffer_size)
+CommandTree::CommandTree(size_t num_threads, void* buffer, size_t buffer_size,
+                         size_t max_nodes)
     : mBuffer(NULL),
       mBufferSize(0),
       mCommandTreeState(kCommandTreeState_Uninitialized),
       mSemaphore(0, 1),
+      mHasTimings(false),
+      mAutoPriorities(false),
+      mCommandNodes(NULL),
+      mOrderedNodes(NULL),
       mNumRootNodes(0),
       mRootNodes(NULL) {
-  Initialize(num_threads, buffer, buffer_size);
+  Initialize(num_threads, buffer, buffer_size, max_nodes);
 }
 
 CommandTree::~CommandTree() {
+  // Explicitly call destructor for placement new.
+  if (mTreeData.mThreadPool)
+    mTreeData.mThreadPool->~ThreadPool();
 }
 
-void CommandTree::Initialize(size_t num_threads,
-                             void* buffer, size_t buffer_size) {
+void CommandTree::Initialize(size_t num_threads, void* buffer,
+                             size_t buffer_size, size_t max_nodes) {
   YASSERT(mCommandTreeState == kCommandTreeState_Uninitialized,
           "Command Tree cannot be initialized twice.");
 
@@ -45,8 +105,8 @@ void CommandTree::Initialize(size_t num_threads,
          static_cast<int>(used_buffer), static_cast<int>(buffer_size));
 
   uint8_t* thread_pool_data = buffer_iter;
-  buffer_iter += sizeof(ycommon::platform::Thread) * num_threads +
-                 sizeof(ThreadPool::RunArgs) * MAX_NODES;
+  // Every node could be ready at the same time.
+  buffer_iter += ThreadPool::GetAllocationSize(num_threads, max_nodes);
 
   used_buffer = buffer_iter - static_cast<uint8_t*>(buffer);
   YASSERT(used_buffer <= buffer_size,
@@ -60,13 +120,18 @@ void CommandTree::Initialize(size_t num_threads,
   mBufferSize = buffer_size - used_buffer;
 
   mCommandTreeState = kCommandTreeState_Initialized;
-  mTreeData.Initialize(thread_pool, &mSemaphore);
+  mTreeData.Initialize(thread_pool, &mSemaphore,
+                       static_cast<uint32_t>(max_nodes));
 }
 
 void CommandTree::ConstructTree(uint32_t num_nodes,
                                 const TreeConstructorNode* nodes) {
   YASSERT(mCommandTreeState == kCommandTreeState_Initialized,
           "Command Tree cannot be initialized twice.");
+  YASSERT(num_nodes <= mTreeData.mMaxNodes,
+          "Maximum number of nodes exceeded: %d > %d",
+          static_cast<int>(num_nodes),
+          static_cast<int>(mTreeData.mMaxNodes));
 
   uint8_t* buffer_iter = static_cast<uint8_t*>(mBuffer);
   uint8_t* buffer_end = buffer_iter + mBufferSize;
@@ -76,26 +141,48 @@ void CommandTree::ConstructTree(uint32_t num_nodes,
   buffer_iter += sizeof(CommandNode) * num_nodes;
   YASSERT(buffer_iter <= buffer_end,
           "Buffer size not large enough to contain command nodes.");
-  for (size_t i = 0; i < num_nodes; ++i) {
+  for (uint32_t i = 0; i < num_nodes; ++i) {
     const TreeConstructorNode& node = nodes[i];
-    YASSERT(node.mNumDependencies <= MAX_DEPENDS,
+    YASSERT(node.mDependencyList || node.mNumDependencies <= MAX_DEPENDS,
             "Maximum number of dependencies per node exceeded: %d > %d",
             static_cast<int>(node.mNumDependencies),
             static_cast<int>(MAX_DEPENDS));
 
     command_nodes[i].Initialize(&mTreeData, node.mCommandRoutine,
-                                node.mCommandArg, node.mNumDependencies);
+                                node.mCommandArg,
+                                node.mName ? node.mName : "CommandTree Node",
+                                node.mPriority, i, node.mNumDependencies);
   }
 
+  // Allocate the node timings, a node without dependencies is never released
+  // by one.
+  NodeTiming* node_timings = reinterpret_cast<NodeTiming*>(buffer_iter);
+  buffer_iter += sizeof(NodeTiming) * num_nodes;
+  YASSERT(buffer_iter <= buffer_end,
+          "Buffer size not large enough to contain node timings.");
+  memset(node_timings, 0, sizeof(NodeTiming) * num_nodes);
+  for (uint32_t i = 0; i < num_nodes; ++i) {
+    node_timings[i].mThreadIndex = INVALID_THREAD_INDEX;
+    node_timings[i].mLastDependency = INVALID_NODE_INDEX;
+  }
+
+  // Allocate the dependency counters.
+  volatile uint32_t* deps_finished =
+      reinterpret_cast<volatile uint32_t*>(buffer_iter);
+  buffer_iter += ROUND_UP(sizeof(uint32_t) * num_nodes, sizeof(CommandNode*));
+  YASSERT(buffer_iter <= buffer_end,
+          "Buffer size not large enough to contain dependency counters.");
+
   // Count the number of children per node and root nodes.
   size_t total_num_dependencies = 0;
   size_t num_root_nodes = 0;
-  for (size_t i = 0; i < num_nodes; ++i) {
+  for (uint32_t i = 0; i < num_nodes; ++i) {
     const TreeConstructorNode& node = nodes[i];
-    const uint8_t num_dependencies = node.mNumDependencies;
+    const uint32_t num_dependencies = node.mNumDependencies;
     if (num_dependencies) {
-      for (uint8_t n = 0; n < num_dependencies; ++n) {
-        const uint32_t dependent_index = node.mDependencies[n];
+      const uint32_t* dependencies = node.GetDependencies();
+      for (uint32_t n = 0; n < num_dependencies; ++n) {
+        const uint32_t dependent_index = dependencies[n];
         YASSERT(dependent_index < num_nodes,
                 "Invalid Dependent Node Index: %d. Max %d.",
                 static_cast<int>(dependent_index), static_cast<int>(num_nodes));
@@ -118,42 +205,77 @@ void CommandTree::ConstructTree(uint32_t num_nodes,
   mNumRootNodes = num_root_nodes;
   mRootNodes = root_nodes;
 
-  // Allocate children nodes.
+  // Allocate children nodes, children counts are refilled below.
   CommandNode** children_nodes = reinterpret_cast<CommandNode**>(buffer_iter);
   buffer_iter += total_num_dependencies * sizeof(CommandNode*);
   YASSERT(buffer_iter <= buffer_end,
           "Buffer size not large enough to contain all children nodes.");
 
-  int used_children_nodes = 0;
-  for (size_t i = 0; i < num_nodes; ++i) {
+  size_t used_children_nodes = 0;
+  for (uint32_t i = 0; i < num_nodes; ++i) {
     CommandNode& command_node = command_nodes[i];
 
     if (command_node.mNumChildren) {
       command_node.mChildren = &children_nodes[used_children_nodes];
       used_children_nodes += command_node.mNumChildren;
+      command_node.mNumChildren = 0;
     }
   }
 
   // Assign Children Nodes and root nodes.
-  int current_root_nodes = 0;
-  int current_children_nodes_array[MAX_NODES] = { 0 };
-  for (size_t i = 0; i < num_nodes; ++i) {
+  size_t current_root_nodes = 0;
+  for (uint32_t i = 0; i < num_nodes; ++i) {
     CommandNode& command_node = command_nodes[i];
 
     const TreeConstructorNode& node = nodes[i];
-    const uint8_t num_dependencies = node.mNumDependencies;
+    const uint32_t num_dependencies = node.mNumDependencies;
     if (num_dependencies) {
-      for (uint8_t n = 0; n < num_dependencies; ++n) {
-        const uint32_t dep_index = node.mDependencies[n];
-        int& children_node = current_children_nodes_array[dep_index];
-        command_nodes[dep_index].mChildren[children_node++] = &command_node;
+      const uint32_t* dependencies = node.GetDependencies();
+      for (uint32_t n = 0; n < num_dependencies; ++n) {
+        CommandNode& dep_node = command_nodes[dependencies[n]];
+        dep_node.mChildren[dep_node.mNumChildren++] = &command_node;
       }
     } else {
       root_nodes[current_root_nodes++] = &command_node;
     }
   }
 
-  mTreeData.SetNumNodes(num_nodes);
+  // Order the nodes after their dependencies, the dependency counters are
+  // reset before every execution so they can count here.
+  CommandNode** ordered_nodes = reinterpret_cast<CommandNode**>(buffer_iter);
+  buffer_iter += num_nodes * sizeof(CommandNode*);
+  YASSERT(buffer_iter <= buffer_end,
+          "Buffer size not large enough to contain ordered nodes.");
+
+  memset(const_cast<uint32_t*>(deps_finished), 0,
+         sizeof(uint32_t) * num_nodes);
+  uint32_t num_ordered_nodes = 0;
+  for (size_t i = 0; i < num_root_nodes; ++i) {
+    ordered_nodes[num_ordered_nodes++] = root_nodes[i];
+  }
+  for (uint32_t i = 0; i < num_ordered_nodes; ++i) {
+    const CommandNode* command_node = ordered_nodes[i];
+    for (uint32_t n = 0; n < command_node->mNumChildren; ++n) {
+      CommandNode* child_node = command_node->mChildren[n];
+      if (++deps_finished[child_node->mIndex] ==
+          child_node->mNumDependencies) {
+        ordered_nodes[num_ordered_nodes++] = child_node;
+      }
+    }
+  }
+  YASSERT(num_ordered_nodes == num_nodes,
+          "Command Tree dependencies contain a cycle.");
+
+  // Allocate the ready nodes heap, every node could be ready at once.
+  CommandNode** ready_nodes = reinterpret_cast<CommandNode**>(buffer_iter);
+  buffer_iter += num_nodes * sizeof(CommandNode*);
+  YASSERT(buffer_iter <= buffer_end,
+          "Buffer size not large enough to contain ready nodes.");
+
+  mCommandNodes = command_nodes;
+  mOrderedNodes = ordered_nodes;
+  mTreeData.SetNodes(num_nodes, deps_finished, node_timings, ready_nodes);
+  mHasTimings = false;
   mCommandTreeState = kCommandTreeState_ReadyToExecute;
 }
 
@@ -168,12 +290,18 @@ uintptr_t CommandTree::ExecuteCommands(size_t milliseconds, bool* timed_out) {
   YASSERT(mCommandTreeState == kCommandTreeState_ReadyToExecute,
           "Command Tree is not ready to execute yet.");
   mCommandTreeState = kCommandTreeState_Executing;
+  mHasTimings = false;
+  mTreeData.mStartTime = platform::Profiler::GetTimestamp();
 
   ret = mTreeData.mThreadPool->Start();
   YASSERT(ret, "Thread Pool failed to start.");
 
+  // Every root is ready before the first run takes one.
   for (size_t i = 0; i < mNumRootNodes; ++i) {
-    ret = mTreeData.mThreadPool->EnqueueRun(CommandTreeThread, mRootNodes[i]);
+    mTreeData.PushReadyNode(mRootNodes[i]);
+  }
+  for (size_t i = 0; i < mNumRootNodes; ++i) {
+    ret = mTreeData.mThreadPool->EnqueueRun(CommandTreeThread, &mTreeData);
     YASSERT(ret, "Thread Pool failed to enqueue root node.");
   }
 
@@ -207,6 +335,9 @@ uintptr_t CommandTree::ExecuteCommands(size_t milliseconds, bool* timed_out) {
 
     if (mTreeData.mReturnValue == 0) {
       mCommandTreeState = kCommandTreeState_ReadyToExecute;
+      mHasTimings = true;
+      if (mAutoPriorities)
+        UpdateAutoPriorities();
     } else {
       // Must be reinitialized.
       mCommandTreeState = kCommandTreeState_Initialized;
@@ -220,43 +351,247 @@ uintptr_t CommandTree::ExecuteCommands(size_t milliseconds, bool* timed_out) {
   return 1;
 }
 
-uintptr_t CommandTree::CommandTreeThread(void* arg) {
-  CommandNode* node_data = static_cast<CommandNode*>(arg);
-  CommandData* tree_data = node_data->mCmdTreeData;
-
-  // Reinitialize node data.
-  node_data->mNumDependenciesFinished = 0;
-
-  // Execute the command.
-  const uintptr_t ret_value = node_data->mCmdRoutine(node_data->mCmdArg);
-  if (ret_value != 0) {
-    tree_data->mReturnValue = ret_value;
-    tree_data->mSemaphore->Release();
-    return 0;
+const CommandTree::NodeTiming& CommandTree::GetNodeTiming(
+    uint32_t node_index) const {
+  YASSERT(node_index < mTreeData.mNumNodes,
+          "Invalid Node Index: %d. Max %d.",
+          static_cast<int>(node_index),
+          static_cast<int>(mTreeData.mNumNodes));
+  return mTreeData.mNodeTimings[node_index];
+}
+
+void CommandTree::GetExecutionReport(ExecutionReport& report) const {
+  YASSERT(mHasTimings, "Command Tree has no successful execution timed.");
+  const NodeTiming* node_timings = mTreeData.mNodeTimings;
+  const uint32_t num_nodes = mTreeData.mNumNodes;
+
+  report.mBusyTime = 0;
+  for (uint32_t i = 0; i < num_nodes; ++i) {
+    report.mBusyTime += node_timings[i].mEndTime - node_timings[i].mStartTime;
   }
 
-  // If total number of nodes are done executing, finish.
-  const uint32_t num_nodes = tree_data->mNumNodes;
-  if (AtomicAdd32(&tree_data->mNumNodesFinished, 1) == num_nodes - 1) {
-    tree_data->mSemaphore->Release();
-    return 0;
+  const uint32_t last_node = GetLastFinishedNode();
+  report.mStartTime = mTreeData.mStartTime;
+  report.mEndTime = node_timings[last_node].mEndTime;
+  report.mCriticalPathTime = 0;
+  report.mNumCriticalPathNodes = 0;
+  for (uint32_t i = last_node; i != INVALID_NODE_INDEX;
+       i = node_timings[i].mLastDependency) {
+    report.mCriticalPathTime +=
+        node_timings[i].mEndTime - node_timings[i].mStartTime;
+    report.mNumCriticalPathNodes++;
   }
 
-  // If return value is non-zero, do not enqueue more commands.
-  if (tree_data->mReturnValue) {
-    return 0;
+  const size_t num_threads = mTreeData.mThreadPool->GetNumThreads();
+  const uint64_t total_time = (report.mEndTime - report.mStartTime) *
+                              static_cast<uint64_t>(num_threads);
+  report.mNumThreads = static_cast<uint32_t>(num_threads);
+  report.mParallelEfficiency = total_time ?
+      static_cast<float>(static_cast<double>(report.mBusyTime) /
+                         static_cast<double>(total_time)) : 0.0f;
+}
+
+uint32_t CommandTree::GetCriticalPath(uint32_t* node_indexes,
+                                      uint32_t max_node_indexes) const {
+  YASSERT(mHasTimings, "Command Tree has no successful execution timed.");
+  const NodeTiming* node_timings = mTreeData.mNodeTimings;
+  const uint32_t last_node = GetLastFinishedNode();
+
+  uint32_t num_path_nodes = 0;
+  for (uint32_t i = last_node; i != INVALID_NODE_INDEX;
+       i = node_timings[i].mLastDependency) {
+    num_path_nodes++;
   }
 
-  // Everything was normal, enqueue any dependent children.
-  const uint32_t num_children = node_data->mNumChildren;
-  for (uint32_t i = 0; i < num_children; ++i) {
-    CommandNode* dep_node = node_data->mChildren[i];
-    const uint32_t num_deps = dep_node->mNumDependencies;
-    if (AtomicAdd32(&dep_node->mNumDependenciesFinished, 1) == num_deps-1) {
+  // Walk back from the sink, only the root side fits if the path is longer.
+  uint32_t path_index = num_path_nodes;
+  for (uint32_t i = last_node; i != INVALID_NODE_INDEX;
+       i = node_timings[i].mLastDependency) {
+    --path_index;
+    if (path_index < max_node_indexes)
+      node_indexes[path_index] = i;
+  }
+  return num_path_nodes;
+}
+
+uint64_t CommandTree::GetNodePriority(uint32_t node_index) const {
+  YASSERT(node_index < mTreeData.mNumNodes,
+          "Invalid Node Index: %d. Max %d.",
+          static_cast<int>(node_index),
+          static_cast<int>(mTreeData.mNumNodes));
+  return mCommandNodes[node_index].mPriority;
+}
+
+uint64_t CommandTree::GetNodeMeasuredPriority(uint32_t node_index) const {
+  YASSERT(node_index < mTreeData.mNumNodes,
+          "Invalid Node Index: %d. Max %d.",
+          static_cast<int>(node_index),
+          static_cast<int>(mTreeData.mNumNodes));
+  return mCommandNodes[node_index].mMeasuredPriority;
+}
+
+void CommandTree::SetAutoPriorities(bool auto_priorities) {
+  mAutoPriorities = auto_priorities;
+  if (!auto_priorities) {
+    for (uint32_t i = 0; i < mTreeData.mNumNodes; ++i) {
+      mCommandNodes[i].mMeasuredPriority = 0;
+    }
+  }
+}
+
+void CommandTree::UpdateAutoPriorities() {
+  // Children come after their parents, so walking the order backwards
+  // finishes every child before its parents.
+  const NodeTiming* node_timings = mTreeData.mNodeTimings;
+  for (uint32_t i = mTreeData.mNumNodes; i > 0; --i) {
+    CommandNode* command_node = mOrderedNodes[i - 1];
+    const NodeTiming& timing = node_timings[command_node->mIndex];
+
+    uint64_t longest_child = 0;
+    for (uint32_t n = 0; n < command_node->mNumChildren; ++n) {
+      const uint64_t child_priority =
+          command_node->mChildren[n]->mMeasuredPriority;
+      if (child_priority > longest_child)
+        longest_child = child_priority;
+    }
+    command_node->mMeasuredPriority =
+        (timing.mEndTime - timing.mStartTime) + longest_child;
+  }
+}
+
+void CommandTree::CommandData::PushReadyNode(CommandNode* command_node) {
+  LockReadyNodes(&mReadyLock);
+
+  // Sift the new node up from the end of the heap.
+  uint32_t index = mNumReadyNodes++;
+  YASSERT(index < mNumNodes, "Ready nodes heap overflowed.");
+  while (index > 0) {
+    const uint32_t parent = (index - 1) / 2;
+    if (!IsHigherPriority(command_node, mReadyNodes[parent]))
+      break;
+    mReadyNodes[index] = mReadyNodes[parent];
+    index = parent;
+  }
+  mReadyNodes[index] = command_node;
+  UnlockReadyNodes(&mReadyLock);
+}
+
+CommandTree::CommandNode* CommandTree::CommandData::PopReadyNode() {
+  LockReadyNodes(&mReadyLock);
+
+  CommandNode* top_node = NULL;
+  if (mNumReadyNodes) {
+    top_node = mReadyNodes[0];
+
+    // Sift the last node down from the top of the heap.
+    const uint32_t num_ready_nodes = --mNumReadyNodes;
+    CommandNode* last_node = mReadyNodes[num_ready_nodes];
+    uint32_t index = 0;
+    for (;;) {
+      uint32_t child = index * 2 + 1;
+      if (child >= num_ready_nodes)
+        break;
+      if (child + 1 < num_ready_nodes &&
+          IsHigherPriority(mReadyNodes[child + 1], mReadyNodes[child]))
+        child++;
+      if (!IsHigherPriority(mReadyNodes[child], last_node))
+        break;
+      mReadyNodes[index] = mReadyNodes[child];
+      index = child;
+    }
+    mReadyNodes[index] = last_node;
+  }
+  UnlockReadyNodes(&mReadyLock);
+  return top_node;
+}
+
+uint32_t CommandTree::GetLastFinishedNode() const {
+  const NodeTiming* node_timings = mTreeData.mNodeTimings;
+  uint32_t last_node = 0;
+  for (uint32_t i = 1; i < mTreeData.mNumNodes; ++i) {
+    if (node_timings[i].mEndTime > node_timings[last_node].mEndTime)
+      last_node = i;
+  }
+  return last_node;
+}
+
+uintptr_t CommandTree::CommandTreeThread(void* arg) {
+  CommandData* tree_data = static_cast<CommandData*>(arg);
+  const bool inline_dispatch = tree_data->mInlineDispatch;
+
+  // Runs are not tied to nodes, each one takes the highest priority node
+  // which is ready by the time it starts.
+  CommandNode* node_data = tree_data->PopReadyNode();
+
+  while (node_data) {
+    // Execute the command.
+    NodeTiming& timing = tree_data->mNodeTimings[node_data->mIndex];
+    timing.mThreadIndex = ThreadPool::GetCurrentThreadIndex();
+    timing.mStartTime = platform::Profiler::GetTimestamp();
+    uintptr_t ret_value = 0;
+    {
+      YPROFILE_ZONE(node_data->mName);
+      ret_value = node_data->mCmdRoutine(node_data->mCmdArg);
+    }
+    timing.mEndTime = platform::Profiler::GetTimestamp();
+    if (ret_value != 0) {
+      tree_data->mReturnValue = ret_value;
+      tree_data->mSemaphore->Release();
+      return 0;
+    }
+
+    // If total number of nodes are done executing, finish.
+    const uint32_t num_nodes = tree_data->mNumNodes;
+    if (AtomicAdd32(&tree_data->mNumNodesFinished, 1) == num_nodes - 1) {
+      tree_data->mSemaphore->Release();
+      return 0;
+    }
+
+    // If return value is non-zero, do not enqueue more commands.
+    if (tree_data->mReturnValue) {
+      return 0;
+    }
+
+    // Everything was normal, make any dependent children ready. With inline
+    // dispatch the first ready child is kept locally instead of shared.
+    uint32_t num_ready = 0;
+    CommandNode* local_node = NULL;
+    const uint32_t num_children = node_data->mNumChildren;
+    for (uint32_t i = 0; i < num_children; ++i) {
+      CommandNode* dep_node = node_data->mChildren[i];
+      const uint32_t num_deps = dep_node->mNumDependencies;
+      volatile uint32_t* deps_finished =
+          &tree_data->mDependenciesFinished[dep_node->mIndex];
+      if (AtomicAdd32(deps_finished, 1) == num_deps-1) {
+        tree_data->mNodeTimings[dep_node->mIndex].mLastDependency =
+            node_data->mIndex;
+        if (inline_dispatch && local_node == NULL)
+          local_node = dep_node;
+        else
+          tree_data->PushReadyNode(dep_node);
+        num_ready++;
+      }
+    }
+
+    // Inline dispatch runs one of the ready children itself. The local child
+    // only skips the shared heap while it is empty, otherwise it is shared
+    // so a higher priority node readied elsewhere can run first.
+    if (local_node && tree_data->mNumReadyNodes) {
+      tree_data->PushReadyNode(local_node);
+      local_node = NULL;
+    }
+    const bool pop_inline = inline_dispatch && num_ready;
+    if (pop_inline)
+      num_ready--;
+    for (uint32_t i = 0; i < num_ready; ++i) {
       bool ret = tree_data->mThreadPool->EnqueueRun(
-          CommandTreeThread, dep_node);
+          CommandTreeThread, tree_data);
       YASSERT(ret, "Thread Pool failed to enqueue dependent node.");
     }
+    if (local_node)
+      node_data = local_node;
+    else
+      node_data = pop_inline ? tree_data->PopReadyNode() : NULL;
   }
 
   return 0;
@@ -1,6 +1,7 @@
 #ifndef YCOMMON_CONTAINERS_COMMAND_TREE_H
 #define YCOMMON_CONTAINERS_COMMAND_TREE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 
@@ -9,23 +10,66 @@
 
 #define MAX_DEPENDS 8
 #define MAX_NODES 256
+#define INVALID_NODE_INDEX static_cast<uint32_t>(-1)
+
+/***********************
+* CommandTree executes a dependency graph of routines on a thread pool.
+*
+*   - The tree is constructed once and can be executed any number of times,
+*     dependency counters are reset in a single pass before every execution.
+*   - Nodes are limited by the max_nodes the tree was initialized with and
+*     by the buffer size, dependencies are only limited by the buffer size.
+*   - Every execution times its nodes, the timings and the critical path
+*     through them can be queried until the next execution.
+*   - Ready nodes wait in a priority heap shared by the whole execution,
+*     every pool run takes the highest priority node that is ready.
+*   - Space Requirements: see GetAllocationSize().
+************************/
 
 namespace ycommon { namespace containers {
 
 class CommandTree {
  public:
+  // Buffer size needed for a tree of num_nodes nodes with num_dependencies
+  // dependencies in total, the tree must be initialized with the same
+  // num_nodes as its max_nodes.
+  static size_t GetAllocationSize(size_t num_threads, size_t num_nodes,
+                                  size_t num_dependencies);
+
   CommandTree();
-  CommandTree(size_t num_threads, void* buffer, size_t buffer_size);
+  CommandTree(size_t num_threads, void* buffer, size_t buffer_size,
+              size_t max_nodes);
   ~CommandTree();
 
-  void Initialize(size_t num_threads, void* buffer, size_t buffer_size);
+  void Initialize(size_t num_threads, void* buffer, size_t buffer_size,
+                  size_t max_nodes);
 
   struct TreeConstructorNode {
     ycommon::platform::ThreadRoutine mCommandRoutine;
     void* mCommandArg;
-    uint8_t mNumDependencies;
+    uint32_t mNumDependencies;
     uint32_t mDependencies[MAX_DEPENDS]; // Index in nodes array.
 
+    // Used instead of mDependencies when set, for nodes with more than
+    // MAX_DEPENDS dependencies. Only needs to live through ConstructTree().
+    const uint32_t* mDependencyList;
+
+    // Name of the node's profiler zone, must outlive the tree.
+    const char* mName;
+
+    // Ready nodes with higher priorities are run first, equal priorities
+    // keep the order of the nodes array.
+    uint64_t mPriority;
+
+    TreeConstructorNode()
+        : mCommandRoutine(NULL),
+          mCommandArg(NULL),
+          mNumDependencies(0),
+          mDependencyList(NULL),
+          mName(NULL),
+          mPriority(0) {
+    }
+
     void Initialize(ycommon::platform::ThreadRoutine routine,
                     void* arg,
                     uint8_t num_deps = 0,
@@ -33,6 +77,7 @@ class CommandTree {
       mCommandRoutine = routine;
       mCommandArg = arg;
       mNumDependencies = num_deps;
+      mDependencyList = NULL;
       memcpy(mDependencies, dep_indexes, sizeof(uint32_t) * num_deps);
     }
     void InitializeWithDependency(ycommon::platform::ThreadRoutine routine,
@@ -41,14 +86,85 @@ class CommandTree {
       mCommandRoutine = routine;
       mCommandArg = arg;
       mNumDependencies = 1;
+      mDependencyList = NULL;
       mDependencies[0] = dep_index;
     }
+    void InitializeWithDependencyList(ycommon::platform::ThreadRoutine routine,
+                                      void* arg,
+                                      uint32_t num_deps,
+                                      const uint32_t* dep_indexes) {
+      mCommandRoutine = routine;
+      mCommandArg = arg;
+      mNumDependencies = num_deps;
+      mDependencyList = dep_indexes;
+    }
+
+    const uint32_t* GetDependencies() const {
+      return mDependencyList ? mDependencyList : mDependencies;
+    }
+
+    void SetName(const char* name) {
+      mName = name;
+    }
+
+    void SetPriority(uint64_t priority) {
+      mPriority = priority;
+    }
   };
   void ConstructTree(uint32_t num_nodes, const TreeConstructorNode* nodes);
 
+  // When enabled, a finishing node which readied children runs the highest
+  // priority ready node on the same thread instead of enqueueing a run for
+  // it. Runs are still enqueued for the other ready children.
+  void SetInlineDispatch(bool inline_dispatch) {
+    mTreeData.mInlineDispatch = inline_dispatch;
+  }
+
+  // When enabled, every successful execution measures the run time along
+  // the longest path from each node to the end of the tree, so long chains
+  // start first on the next execution. Priorities set by the user still come
+  // first, measured priorities only order nodes of equal user priority.
+  void SetAutoPriorities(bool auto_priorities);
+
+  uint64_t GetNodePriority(uint32_t node_index) const;
+  uint64_t GetNodeMeasuredPriority(uint32_t node_index) const;
+
   // Returns 0 on success, failures stop execution and returns error code.
   uintptr_t ExecuteCommands(size_t milliseconds = -1, bool* timed_out = NULL);
 
+  // Times are in platform::Profiler::GetTimestamp() counts.
+  struct NodeTiming {
+    uint64_t mStartTime;
+    uint64_t mEndTime;
+    uint32_t mThreadIndex; // Index of the pool thread which ran the node.
+    uint32_t mLastDependency; // Dependency which released the node.
+  };
+
+  struct ExecutionReport {
+    uint64_t mStartTime; // ExecuteCommands() was called.
+    uint64_t mEndTime; // The last node finished.
+    uint64_t mBusyTime; // Sum of every node's run time.
+    uint64_t mCriticalPathTime; // Sum of the critical path's run times.
+    uint32_t mNumCriticalPathNodes;
+    uint32_t mNumThreads;
+
+    // Busy time over the time every thread had during the execution.
+    float mParallelEfficiency;
+  };
+
+  // Only valid after an execution which ran every node successfully.
+  bool HasExecutionReport() const {
+    return mHasTimings;
+  }
+  const NodeTiming& GetNodeTiming(uint32_t node_index) const;
+  void GetExecutionReport(ExecutionReport& report) const;
+
+  // The critical path follows the dependency which released each node, back
+  // from the last node to finish. Indexes are written from root to sink and
+  // the full number of critical path nodes is returned.
+  uint32_t GetCriticalPath(uint32_t* node_indexes,
+                           uint32_t max_node_indexes) const;
+
  private:
   struct CommandData;
 
@@ -57,18 +173,25 @@ class CommandTree {
     CommandData* mCmdTreeData;
     ycommon::platform::ThreadRoutine mCmdRoutine;
     void* mCmdArg;
+    const char* mName;
+    uint64_t mPriority;
+    uint64_t mMeasuredPriority; // Set by auto priorities.
     CommandNode** mChildren;
-    volatile uint32_t mNumDependenciesFinished;
+    uint32_t mIndex; // Index of the node's dependency counter.
     uint32_t mNumDependencies;
     uint32_t mNumChildren;
 
     void Initialize(CommandData* command_tree_data,
                     ycommon::platform::ThreadRoutine command_routine,
-                    void* command_arg, uint8_t num_dependencies) {
+                    void* command_arg, const char* name, uint64_t priority,
+                    uint32_t index, uint32_t num_dependencies) {
       mCmdTreeData = command_tree_data;
       mCmdRoutine = command_routine;
       mCmdArg = command_arg;
-      mNumDependenciesFinished = 0;
+      mName = name;
+      mPriority = priority;
+      mMeasuredPriority = 0;
+      mIndex = index;
       mNumDependencies = num_dependencies;
       mNumChildren = 0;
       mChildren = NULL;
@@ -78,6 +201,12 @@ class CommandTree {
   static uintptr_t CommandTreeThread(void* arg);
 
  private:
+  // Sink of the critical path.
+  uint32_t GetLastFinishedNode() const;
+
+  // Sets measured priorities from the last execution's timings.
+  void UpdateAutoPriorities();
+
   void* mBuffer;
   size_t mBufferSize;
 
@@ -93,35 +222,84 @@ class CommandTree {
     platform::Semaphore* mSemaphore;
     volatile uintptr_t mReturnValue;
     volatile uint32_t mNumNodesFinished;
+    uint64_t mStartTime;
     uint32_t mNumNodes;
+    uint32_t mMaxNodes;
+    bool mInlineDispatch;
+
+    // Number of finished dependencies for each node, contiguous so every
+    // counter can be reset at once.
+    volatile uint32_t* mDependenciesFinished;
+    NodeTiming* mNodeTimings;
+
+    // Max heap of the ready nodes, guarded by the ready lock. The count is
+    // also read unlocked to check if the heap is empty.
+    CommandNode** mReadyNodes;
+    volatile uint32_t mNumReadyNodes;
+    volatile uint32_t mReadyLock;
 
     CommandData()
         : mThreadPool(NULL),
           mSemaphore(NULL),
           mReturnValue(0),
           mNumNodesFinished(0),
-          mNumNodes(0) {
+          mStartTime(0),
+          mNumNodes(0),
+          mMaxNodes(0),
+          mInlineDispatch(false),
+          mDependenciesFinished(NULL),
+          mNodeTimings(NULL),
+          mReadyNodes(NULL),
+          mNumReadyNodes(0),
+          mReadyLock(0) {
     }
 
-    void Initialize(ThreadPool* thread_pool, platform::Semaphore* semaphore) {
+    void Initialize(ThreadPool* thread_pool, platform::Semaphore* semaphore,
+                    uint32_t max_nodes) {
       mThreadPool = thread_pool;
       mSemaphore = semaphore;
       mReturnValue = 0;
       mNumNodesFinished = 0;
       mNumNodes = 0;
+      mMaxNodes = max_nodes;
+      mDependenciesFinished = NULL;
+      mNodeTimings = NULL;
+      mReadyNodes = NULL;
+      mNumReadyNodes = 0;
+      mReadyLock = 0;
     }
 
-    void SetNumNodes(uint32_t num_nodes) {
+    void SetNodes(uint32_t num_nodes, volatile uint32_t* deps_finished,
+                  NodeTiming* node_timings, CommandNode** ready_nodes) {
       mNumNodes = num_nodes;
+      mDependenciesFinished = deps_finished;
+      mNodeTimings = node_timings;
+      mReadyNodes = ready_nodes;
     }
 
     void PrepareStart() {
       mReturnValue = 0;
       mNumNodesFinished = 0;
+      mNumReadyNodes = 0;
+      mReadyLock = 0;
+      memset(const_cast<uint32_t*>(mDependenciesFinished), 0,
+             sizeof(uint32_t) * mNumNodes);
     }
+
+    // Every pushed node must be followed by one pop, through an enqueued
+    // CommandTreeThread run or inline dispatch.
+    void PushReadyNode(CommandNode* command_node);
+    CommandNode* PopReadyNode();
   } mTreeData;
 
   platform::Semaphore mSemaphore;
+  bool mHasTimings;
+  bool mAutoPriorities;
+
+  CommandNode* mCommandNodes;
+
+  // Every node after all of its dependencies.
+  CommandNode** mOrderedNodes;
 
   // Root nodes are nodes without any dependencies.
   size_t mNumRootNodes;
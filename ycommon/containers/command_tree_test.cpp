@@ -2,7 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include "ycommon/headers/atomics.h"
 #include "ycommon/headers/macros.h"
+#include "ycommon/platform/sleep.h"
 
 namespace ycommon { namespace containers {
 
@@ -45,14 +47,37 @@ static uintptr_t Expect2Routine(void* arg) {
   return 1;
 }
 
+static uintptr_t CountRoutine(void* arg) {
+  AtomicAdd32(static_cast<volatile uint32_t*>(arg), 1);
+  return 0;
+}
+
+struct OrderArg {
+  uint32_t node_index;
+  volatile uint32_t* num_executed;
+  uint32_t* executed_nodes;
+};
+
+static uintptr_t OrderRoutine(void* arg) {
+  OrderArg* order_arg = static_cast<OrderArg*>(arg);
+  const uint32_t executed = AtomicAdd32(order_arg->num_executed, 1);
+  order_arg->executed_nodes[executed] = order_arg->node_index;
+  return 0;
+}
+
+static uintptr_t SleepRoutine(void* arg) {
+  platform::Sleep::MicroSleep(*static_cast<int64_t*>(arg));
+  return 0;
+}
+
 TEST(BasicCommandTreeTest, ConstructorTest) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 }
 
 TEST(BasicCommandTreeTest, TreeConstructionTest) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 
   // Thread Argument
   const uint32_t magic_num = 123;
@@ -69,7 +94,7 @@ TEST(BasicCommandTreeTest, TreeConstructionTest) {
 
 TEST(BasicCommandTreeTest, TreeExecutionTest) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 
   // Thread Argument
   const uint32_t magic_num = 123;
@@ -96,7 +121,7 @@ TEST(BasicCommandTreeTest, TreeExecutionTest) {
 
 TEST(BasicCommandTreeTest, TreeExecutionOrder) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 
   // Thread Argument
   const uint32_t magic_num = 123;
@@ -125,7 +150,7 @@ TEST(BasicCommandTreeTest, TreeExecutionOrder) {
 
 TEST(BasicCommandTreeTest, TreeExecutionMultipleStreams) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 
   // Thread Argument
   const uint32_t magic_num1 = 123;
@@ -165,7 +190,7 @@ TEST(BasicCommandTreeTest, TreeExecutionMultipleStreams) {
 
 TEST(BasicCommandTreeTest, MultipleDependencyTest) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 
   // Thread Argument
   const uint32_t magic_num1 = 123;
@@ -219,7 +244,7 @@ TEST(BasicCommandTreeTest, MultipleDependencyTest) {
 
 TEST(BasicCommandTreeTest, FailingCommandStopsExecution) {
   char buffer[10240];
-  CommandTree command_tree(2, buffer, sizeof(buffer));
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
 
   // Thread Argument
   const uint32_t magic_num = 123;
@@ -249,4 +274,291 @@ TEST(BasicCommandTreeTest, FailingCommandStopsExecution) {
   EXPECT_EQ(current_num, magic_num + 1) << "Commands did not execute at all.";
 }
 
+TEST(BasicCommandTreeTest, ReExecuteTest) {
+  char buffer[10240];
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
+
+  const uint32_t magic_num = 123;
+  volatile uint32_t current_num = magic_num;
+
+  ThreadArg arg1 = { magic_num, &current_num };
+  ThreadArg arg2 = { magic_num + 1, &current_num };
+  ThreadArg arg3 = { magic_num + 2, &current_num };
+
+  CommandTree::TreeConstructorNode tree_nodes[3];
+  tree_nodes[0].Initialize(ExpectRoutine, &arg1);
+  tree_nodes[1].InitializeWithDependency(ExpectRoutine, &arg2, 0);
+  tree_nodes[2].InitializeWithDependency(ExpectRoutine, &arg3, 1);
+  command_tree.ConstructTree(ARRAY_SIZE(tree_nodes), tree_nodes);
+
+  // The same tree executes again without being constructed again.
+  for (int i = 0; i < 3; ++i) {
+    current_num = magic_num;
+
+    bool timed_out = false;
+    const uintptr_t ret = command_tree.ExecuteCommands(500, &timed_out);
+    ASSERT_FALSE(timed_out) << "Execution has timed out.";
+    ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+    EXPECT_EQ(current_num, magic_num + 3) << "Commands did not execute.";
+  }
+}
+
+TEST(BasicCommandTreeTest, InlineDispatchTest) {
+  char buffer[10240];
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
+  command_tree.SetInlineDispatch(true);
+
+  const uint32_t magic_num1 = 123;
+  const uint32_t magic_num2 = 234;
+  volatile uint32_t current_num1 = magic_num1;
+  volatile uint32_t current_num2 = magic_num2;
+
+  ThreadArg arg1_1 = { magic_num1, &current_num1 };
+  ThreadArg arg1_2 = { magic_num1 + 1, &current_num1 };
+  ThreadArg arg2_1 = { magic_num2, &current_num2 };
+  ThreadArg arg2_2 = { magic_num2 + 1, &current_num2 };
+  ThreadArg2 arg_dep = { magic_num1 + 2, magic_num2 + 2,
+                         &current_num1, &current_num2 };
+
+  CommandTree::TreeConstructorNode tree_nodes[5];
+  tree_nodes[0].Initialize(ExpectRoutine, &arg1_1);
+  tree_nodes[1].InitializeWithDependency(ExpectRoutine, &arg1_2, 0);
+  tree_nodes[2].Initialize(ExpectRoutine, &arg2_1);
+  tree_nodes[3].InitializeWithDependency(ExpectRoutine, &arg2_2, 2);
+
+  uint32_t deps[] = { 1, 3 };
+  tree_nodes[4].Initialize(Expect2Routine, &arg_dep, ARRAY_SIZE(deps), deps);
+  command_tree.ConstructTree(ARRAY_SIZE(tree_nodes), tree_nodes);
+
+  for (int i = 0; i < 3; ++i) {
+    current_num1 = magic_num1;
+    current_num2 = magic_num2;
+
+    bool timed_out = false;
+    const uintptr_t ret = command_tree.ExecuteCommands(500, &timed_out);
+    ASSERT_FALSE(timed_out) << "Execution has timed out.";
+    ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+    EXPECT_EQ(current_num1, magic_num1 + 3) << "Commands 1 did not execute.";
+    EXPECT_EQ(current_num2, magic_num2 + 3) << "Commands 2 did not execute.";
+  }
+}
+
+TEST(BasicCommandTreeTest, LargeTreeTest) {
+  // Layers of fan out nodes which all join into a single final node.
+  const uint32_t kNumLayers = 4;
+  const uint32_t kLayerSize = 300;
+  const uint32_t kNumNodes = kNumLayers * kLayerSize + 1;
+  const uint32_t kNumDeps = (kNumLayers - 1) * kLayerSize + kLayerSize;
+
+  const size_t buffer_size = CommandTree::GetAllocationSize(2, kNumNodes,
+                                                            kNumDeps);
+  uint64_t* buffer = new uint64_t[(buffer_size + 7) / 8];
+  uint32_t* join_deps = new uint32_t[kLayerSize];
+  CommandTree::TreeConstructorNode* tree_nodes =
+      new CommandTree::TreeConstructorNode[kNumNodes];
+
+  volatile uint32_t layer_counts[kNumLayers + 1] = { 0 };
+  for (uint32_t layer = 0; layer < kNumLayers; ++layer) {
+    for (uint32_t i = 0; i < kLayerSize; ++i) {
+      const uint32_t index = layer * kLayerSize + i;
+      void* arg = const_cast<uint32_t*>(&layer_counts[layer]);
+      if (layer == 0) {
+        tree_nodes[index].Initialize(CountRoutine, arg);
+      } else {
+        tree_nodes[index].InitializeWithDependency(CountRoutine, arg,
+                                                   index - kLayerSize);
+      }
+    }
+  }
+  for (uint32_t i = 0; i < kLayerSize; ++i) {
+    join_deps[i] = (kNumLayers - 1) * kLayerSize + i;
+  }
+  tree_nodes[kNumNodes - 1].InitializeWithDependencyList(
+      CountRoutine, const_cast<uint32_t*>(&layer_counts[kNumLayers]),
+      kLayerSize, join_deps);
+
+  {
+    CommandTree command_tree(2, buffer, buffer_size, kNumNodes);
+    command_tree.SetInlineDispatch(true);
+    command_tree.ConstructTree(kNumNodes, tree_nodes);
+
+    for (int i = 0; i < 2; ++i) {
+      bool timed_out = false;
+      const uintptr_t ret = command_tree.ExecuteCommands(5000, &timed_out);
+      ASSERT_FALSE(timed_out) << "Execution has timed out.";
+      ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+    }
+  }
+
+  for (uint32_t layer = 0; layer < kNumLayers; ++layer) {
+    EXPECT_EQ(2 * kLayerSize, layer_counts[layer]);
+  }
+  EXPECT_EQ(2, layer_counts[kNumLayers]);
+
+  delete [] tree_nodes;
+  delete [] join_deps;
+  delete [] buffer;
+}
+
+TEST(BasicCommandTreeTest, ExecutionReportTest) {
+  char buffer[10240];
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
+
+  // A diamond where the long side is the critical path.
+  int64_t short_time = 100;
+  int64_t long_time = 20000;
+  uint32_t sides[] = { 1, 2 };
+  CommandTree::TreeConstructorNode tree_nodes[4];
+  tree_nodes[0].Initialize(SleepRoutine, &short_time);
+  tree_nodes[1].InitializeWithDependency(SleepRoutine, &long_time, 0);
+  tree_nodes[2].InitializeWithDependency(SleepRoutine, &short_time, 0);
+  tree_nodes[3].Initialize(SleepRoutine, &short_time, 2, sides);
+  command_tree.ConstructTree(ARRAY_SIZE(tree_nodes), tree_nodes);
+  EXPECT_FALSE(command_tree.HasExecutionReport());
+
+  bool timed_out = false;
+  const uintptr_t ret = command_tree.ExecuteCommands(5000, &timed_out);
+  ASSERT_FALSE(timed_out) << "Execution has timed out.";
+  ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+  ASSERT_TRUE(command_tree.HasExecutionReport());
+
+  uint32_t critical_path[4] = { 0 };
+  ASSERT_EQ(3u, command_tree.GetCriticalPath(critical_path,
+                                             ARRAY_SIZE(critical_path)));
+  EXPECT_EQ(0u, critical_path[0]);
+  EXPECT_EQ(1u, critical_path[1]);
+  EXPECT_EQ(3u, critical_path[2]);
+
+  for (uint32_t i = 0; i < ARRAY_SIZE(tree_nodes); ++i) {
+    const CommandTree::NodeTiming& timing = command_tree.GetNodeTiming(i);
+    EXPECT_LE(timing.mStartTime, timing.mEndTime);
+    EXPECT_GT(2u, timing.mThreadIndex);
+  }
+  EXPECT_EQ(INVALID_NODE_INDEX, command_tree.GetNodeTiming(0).mLastDependency);
+  EXPECT_EQ(1u, command_tree.GetNodeTiming(3).mLastDependency);
+
+  CommandTree::ExecutionReport report;
+  command_tree.GetExecutionReport(report);
+  EXPECT_EQ(3u, report.mNumCriticalPathNodes);
+  EXPECT_EQ(2u, report.mNumThreads);
+  EXPECT_LE(report.mCriticalPathTime, report.mBusyTime);
+  EXPECT_LE(report.mCriticalPathTime, report.mEndTime - report.mStartTime);
+  EXPECT_LT(0.0f, report.mParallelEfficiency);
+  EXPECT_GE(1.0f, report.mParallelEfficiency);
+}
+
+TEST(BasicCommandTreeTest, PriorityOrderTest) {
+  char buffer[10240];
+  CommandTree command_tree(1, buffer, sizeof(buffer), MAX_NODES);
+
+  // Two roots and the children of the first root, out of priority order.
+  const uint64_t priorities[] = { 1, 5, 2, 3, 4 };
+  uint32_t dependencies[] = { 0, 0, 0 };
+  volatile uint32_t num_executed = 0;
+  uint32_t executed_nodes[ARRAY_SIZE(priorities)] = { 0 };
+  OrderArg args[ARRAY_SIZE(priorities)];
+  CommandTree::TreeConstructorNode tree_nodes[ARRAY_SIZE(priorities)];
+  for (uint32_t i = 0; i < ARRAY_SIZE(tree_nodes); ++i) {
+    OrderArg arg = { i, &num_executed, executed_nodes };
+    args[i] = arg;
+    tree_nodes[i].Initialize(OrderRoutine, &args[i], i < 2 ? 0 : 1,
+                             dependencies);
+    tree_nodes[i].SetPriority(priorities[i]);
+  }
+  command_tree.ConstructTree(ARRAY_SIZE(tree_nodes), tree_nodes);
+
+  bool timed_out = false;
+  const uintptr_t ret = command_tree.ExecuteCommands(5000, &timed_out);
+  ASSERT_FALSE(timed_out) << "Execution has timed out.";
+  ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+
+  // A single thread runs the ready nodes in the order they were dispatched.
+  const uint32_t expected_nodes[] = { 1, 0, 4, 3, 2 };
+  ASSERT_EQ(ARRAY_SIZE(expected_nodes), num_executed);
+  for (uint32_t i = 0; i < ARRAY_SIZE(expected_nodes); ++i) {
+    EXPECT_EQ(expected_nodes[i], executed_nodes[i]);
+  }
+}
+
+TEST(BasicCommandTreeTest, AutoPrioritiesTest) {
+  char buffer[10240];
+  CommandTree command_tree(2, buffer, sizeof(buffer), MAX_NODES);
+  command_tree.SetAutoPriorities(true);
+
+  // The long side of the diamond is constructed last.
+  int64_t short_time = 100;
+  int64_t long_time = 5000;
+  uint32_t sides[] = { 1, 2 };
+  CommandTree::TreeConstructorNode tree_nodes[4];
+  tree_nodes[0].Initialize(SleepRoutine, &short_time);
+  tree_nodes[1].InitializeWithDependency(SleepRoutine, &short_time, 0);
+  tree_nodes[2].InitializeWithDependency(SleepRoutine, &long_time, 0);
+  tree_nodes[3].Initialize(SleepRoutine, &short_time, 2, sides);
+  tree_nodes[1].SetPriority(7);
+  command_tree.ConstructTree(ARRAY_SIZE(tree_nodes), tree_nodes);
+  EXPECT_EQ(0u, command_tree.GetNodeMeasuredPriority(2));
+
+  bool timed_out = false;
+  const uintptr_t ret = command_tree.ExecuteCommands(5000, &timed_out);
+  ASSERT_FALSE(timed_out) << "Execution has timed out.";
+  ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+
+  // Measured priorities are the time from each node to the end of the tree.
+  EXPECT_LT(command_tree.GetNodeMeasuredPriority(1),
+            command_tree.GetNodeMeasuredPriority(2));
+  EXPECT_LT(command_tree.GetNodeMeasuredPriority(2),
+            command_tree.GetNodeMeasuredPriority(0));
+  EXPECT_LT(command_tree.GetNodeMeasuredPriority(3),
+            command_tree.GetNodeMeasuredPriority(1));
+  EXPECT_LT(0u, command_tree.GetNodeMeasuredPriority(3));
+
+  // User priorities are kept.
+  EXPECT_EQ(7u, command_tree.GetNodePriority(1));
+  EXPECT_EQ(0u, command_tree.GetNodePriority(2));
+
+  command_tree.SetAutoPriorities(false);
+  EXPECT_EQ(0u, command_tree.GetNodeMeasuredPriority(0));
+}
+
+TEST(BasicCommandTreeTest, LatePriorityOrderTest) {
+  for (int inline_dispatch = 0; inline_dispatch < 2; ++inline_dispatch) {
+    char buffer[10240];
+    CommandTree command_tree(1, buffer, sizeof(buffer), MAX_NODES);
+    command_tree.SetInlineDispatch(inline_dispatch != 0);
+
+    // Root 0 readies the low priority nodes 2 and 3, root 1 then readies the
+    // high priority node 4 while they are still waiting.
+    const uint64_t priorities[] = { 10, 5, 1, 1, 8 };
+    const uint32_t dependencies[] = { 0, 0, 0, 0, 1 };
+    volatile uint32_t num_executed = 0;
+    uint32_t executed_nodes[ARRAY_SIZE(priorities)] = { 0 };
+    OrderArg args[ARRAY_SIZE(priorities)];
+    CommandTree::TreeConstructorNode tree_nodes[ARRAY_SIZE(priorities)];
+    for (uint32_t i = 0; i < ARRAY_SIZE(tree_nodes); ++i) {
+      OrderArg arg = { i, &num_executed, executed_nodes };
+      args[i] = arg;
+      if (i < 2) {
+        tree_nodes[i].Initialize(OrderRoutine, &args[i]);
+      } else {
+        tree_nodes[i].InitializeWithDependency(OrderRoutine, &args[i],
+                                               dependencies[i]);
+      }
+      tree_nodes[i].SetPriority(priorities[i]);
+    }
+    command_tree.ConstructTree(ARRAY_SIZE(tree_nodes), tree_nodes);
+
+    bool timed_out = false;
+    const uintptr_t ret = command_tree.ExecuteCommands(5000, &timed_out);
+    ASSERT_FALSE(timed_out) << "Execution has timed out.";
+    ASSERT_EQ(ret, 0) << "Execution did not return 0.";
+
+    const uint32_t expected_nodes[] = { 0, 1, 4, 2, 3 };
+    ASSERT_EQ(ARRAY_SIZE(expected_nodes), num_executed);
+    for (uint32_t i = 0; i < ARRAY_SIZE(expected_nodes); ++i) {
+      EXPECT_EQ(expected_nodes[i], executed_nodes[i])
+          << "Inline dispatch: " << inline_dispatch;
+    }
+  }
+}
+
 }} // namespace ycommon { namespace containers {
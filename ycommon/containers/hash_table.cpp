@@ -1,6 +1,14 @@
 #include "ycommon/containers/hash_table.h"
 
-#include <string>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+  #include <emmintrin.h>
+  #define HASH_TABLE_SSE2
+#endif
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
 
 #include "ycommon/utils/assert.h"
 #include "ycommon/utils/hash.h"
@@ -9,10 +17,68 @@
 #define REMOVED_VALUE static_cast<uint64_t>(-1)
 #define MAX_TRIES 10
 
+// Control bytes of full entries hold the low 7 bits of the hash key, the
+// high bit is only set for empty and removed entries.
+#define CONTROL_EMPTY static_cast<uint8_t>(0x80)
+#define CONTROL_REMOVED static_cast<uint8_t>(0xFE)
+#define CONTROL_HASH_BITS 7
+#define CONTROL_HASH_MASK ((1 << CONTROL_HASH_BITS) - 1)
+
 namespace ycommon { namespace containers {
 
+namespace {
+  inline uint8_t ControlHash(uint64_t hash_key) {
+    return static_cast<uint8_t>(hash_key & CONTROL_HASH_MASK);
+  }
+
+  // Bit N is set if control byte N of the group equals the control value.
+  inline uint32_t MatchGroup(const uint8_t* group, uint8_t control) {
+#ifdef HASH_TABLE_SSE2
+    const __m128i group_bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    const __m128i match = _mm_cmpeq_epi8(
+        group_bytes, _mm_set1_epi8(static_cast<char>(control)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(match));
+#else
+    uint32_t matches = 0;
+    for (uint32_t i = 0; i < HASH_TABLE_GROUP_SIZE; ++i) {
+      if (group[i] == control)
+        matches |= 1u << i;
+    }
+    return matches;
+#endif
+  }
+
+  // Bit N is set if entry N of the group is empty or removed.
+  inline uint32_t MatchGroupFree(const uint8_t* group) {
+#ifdef HASH_TABLE_SSE2
+    const __m128i group_bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(group_bytes));
+#else
+    uint32_t matches = 0;
+    for (uint32_t i = 0; i < HASH_TABLE_GROUP_SIZE; ++i) {
+      if (group[i] & CONTROL_EMPTY)
+        matches |= 1u << i;
+    }
+    return matches;
+#endif
+  }
+
+  inline uint32_t LowestBitIndex(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+  }
+}
+
 HashTable::HashTable()
     : mBuffer(NULL),
+      mControlBytes(NULL),
       mCurrentEntries(0),
       mNumEntries(0),
       mMaxValueSize(0) {
@@ -21,6 +87,7 @@ HashTable::HashTable()
 HashTable::HashTable(void* buffer, size_t buffer_size,
                      size_t num_entries, size_t max_value_size)
     : mBuffer(NULL),
+      mControlBytes(NULL),
       mCurrentEntries(0),
       mNumEntries(0),
       mMaxValueSize(0) {
@@ -41,8 +108,8 @@ void HashTable::Init(void* buffer, size_t buffer_size,
           static_cast<uint32_t>(MAX_TRIES),
           static_cast<uint32_t>(num_entries));
 
-  const size_t entry_size = sizeof(uint64_t) + max_value_size;
-  const size_t total_table_size = entry_size * num_entries;
+  const size_t total_table_size = GetAllocationSize(num_entries,
+                                                   max_value_size);
 
   YASSERT(total_table_size <= buffer_size,
           "Hash Table requires %u bytes, supplied %u bytes.",
@@ -50,15 +117,23 @@ void HashTable::Init(void* buffer, size_t buffer_size,
           static_cast<uint32_t>(buffer_size));
 
   mBuffer = buffer;
+  mControlBytes = NULL;
   mCurrentEntries = 0;
   mNumEntries = num_entries;
   mMaxValueSize = max_value_size;
 
+  // Control bytes follow the key and value tables.
+  if (UsesGroupProbing(num_entries)) {
+    const size_t entry_size = sizeof(uint64_t) + max_value_size;
+    mControlBytes = static_cast<uint8_t*>(buffer) + entry_size * num_entries;
+  }
+
   Clear();
 }
 
 void HashTable::Reset() {
   mBuffer = NULL;
+  mControlBytes = NULL;
   mCurrentEntries = 0;
   mNumEntries = 0;
   mMaxValueSize = 0;
@@ -66,7 +141,10 @@ void HashTable::Reset() {
 
 void HashTable::Clear() {
   mCurrentEntries = 0;
-  memset(mBuffer, EMPTY_VALUE, sizeof(uint64_t) * mNumEntries);
+  if (mControlBytes)
+    memset(mControlBytes, CONTROL_EMPTY, mNumEntries);
+  else
+    memset(mBuffer, EMPTY_VALUE, sizeof(uint64_t) * mNumEntries);
 }
 
 void* HashTable::Insert(const void* key, size_t key_size,
@@ -85,16 +163,26 @@ void* HashTable::Insert(uint64_t hash_key,
                static_cast<uint32_t>(mMaxValueSize),
                static_cast<uint32_t>(value_size));
 
+  if (mControlBytes)
+    return InsertGroup(hash_key, value, value_size);
+
   const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
   uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
   uint8_t* hash_value_table = static_cast<uint8_t*>(mBuffer) + key_table_size;
 
+  // Existing keys may sit past a removed entry, replace those first.
+  int64_t index = FindIndex(hash_key);
+  if (index != -1) {
+    void* hash_data = hash_value_table + (index * mMaxValueSize);
+    memcpy(hash_data, value, value_size);
+    return hash_data;
+  }
+
   for (uint64_t i = 0; i < MAX_TRIES; ++i) {
     const uint64_t try_index = (hash_key + i) % mNumEntries;
     const uint64_t hash_table_value = hash_table[try_index];
 
-    if (hash_table_value == hash_key ||
-        hash_table_value == REMOVED_VALUE ||
+    if (hash_table_value == REMOVED_VALUE ||
         hash_table_value == EMPTY_VALUE) {
       hash_table[try_index] = hash_key;
       void* hash_data = hash_value_table + (try_index * mMaxValueSize);
@@ -108,49 +196,71 @@ void* HashTable::Insert(uint64_t hash_key,
   return nullptr;
 }
 
+void* HashTable::InsertGroup(uint64_t hash_key,
+                             const void* value, size_t value_size) {
+  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
+  uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
+  uint8_t* hash_value_table = static_cast<uint8_t*>(mBuffer) + key_table_size;
+
+  int64_t index = FindGroupIndex(hash_key);
+  if (index == -1) {
+    // Take the first free entry along the same probe sequence as lookups.
+    const size_t group_mask = mNumEntries / HASH_TABLE_GROUP_SIZE - 1;
+    size_t group = static_cast<size_t>(hash_key >> CONTROL_HASH_BITS) &
+                   group_mask;
+    for (size_t step = 1; step <= group_mask + 1; ++step) {
+      const size_t group_start = group * HASH_TABLE_GROUP_SIZE;
+      const uint32_t free_entries =
+          MatchGroupFree(mControlBytes + group_start);
+      if (free_entries) {
+        index = group_start + LowestBitIndex(free_entries);
+        break;
+      }
+      group = (group + step) & group_mask;
+    }
+
+    if (index == -1) {
+      YFATAL("Hash Table is too full, no free entries remaining!");
+      return nullptr;
+    }
+
+    mControlBytes[index] = ControlHash(hash_key);
+    hash_table[index] = hash_key;
+    ++mCurrentEntries;
+  }
+
+  void* hash_data = hash_value_table + (index * mMaxValueSize);
+  memcpy(hash_data, value, value_size);
+  return hash_data;
+}
+
 bool HashTable::Remove(const void* key, size_t key_size) {
   const uint64_t hash_key = ycommon::utils::Hash::Hash64(key, key_size);
   return Remove(hash_key);
 }
 
 bool HashTable::Remove(uint64_t hash_key) {
-  uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
-  for (uint64_t i = 0; i < MAX_TRIES; ++i) {
-    const uint64_t try_index = (hash_key + i) % mNumEntries;
-    const uint64_t hash_table_value = hash_table[try_index];
+  const int64_t index = FindIndex(hash_key);
+  if (index == -1)
+    return false;
 
-    if (hash_table_value == hash_key) {
-      hash_table[try_index] = REMOVED_VALUE;
-      --mCurrentEntries;
-      return true;
-    } else if (hash_table_value == EMPTY_VALUE) {
-      return false;
-    }
-  }
-  return false;
+  RemoveIndex(static_cast<size_t>(index));
+  return true;
 }
 
 bool HashTable::Remove(const void* hash_table_value) {
-  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  const uint8_t* hash_value_table =
-      static_cast<const uint8_t*>(mBuffer) + key_table_size;
-  const uint8_t* hash_value_end =
-      hash_value_table + (mMaxValueSize * mNumEntries);
-  const uint8_t* value_ptr = static_cast<const uint8_t*>(hash_table_value);
-  YASSERT(value_ptr >= hash_value_table &&
-          value_ptr < hash_value_end,
-          "Cannot remove hash table value that is out of range.");
-  YASSERT((value_ptr - hash_value_table) % mMaxValueSize == 0,
-          "Invalid hash table value pointer.");
-
   uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
-  const uint64_t index = (value_ptr - hash_value_table) / mMaxValueSize;
+  const size_t index = GetValueIndex(hash_table_value);
 
-  if (hash_table[index] == REMOVED_VALUE || hash_table[index] == EMPTY_VALUE)
+  if (mControlBytes) {
+    if (mControlBytes[index] & CONTROL_EMPTY)
+      return false;
+  } else if (hash_table[index] == REMOVED_VALUE ||
+             hash_table[index] == EMPTY_VALUE) {
     return false;
+  }
 
-  hash_table[index] = REMOVED_VALUE;
-  --mCurrentEntries;
+  RemoveIndex(index);
   return true;
 }
 
@@ -160,23 +270,14 @@ const void* const HashTable::GetValue(const void* key,
 }
 
 const void* const HashTable::GetValue(uint64_t hash_key) const {
+  const int64_t index = FindIndex(hash_key);
+  if (index == -1)
+    return NULL;
+
   const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
   const uint8_t* hash_value_table =
       static_cast<const uint8_t*>(mBuffer) + key_table_size;
-
-  for (uint64_t i = 0; i < MAX_TRIES; ++i) {
-    const uint64_t try_index = (hash_key + i) % mNumEntries;
-    const uint64_t hash_table_value = hash_table[try_index];
-
-    if (hash_table_value == hash_key) {
-      return hash_value_table + (try_index * mMaxValueSize);
-    } else if (hash_table_value == EMPTY_VALUE) {
-      return NULL;
-    }
-  }
-
-  return NULL;
+  return hash_value_table + (index * mMaxValueSize);
 }
 
 void* HashTable::GetValue(const void* key, size_t key_size) {
@@ -184,22 +285,122 @@ void* HashTable::GetValue(const void* key, size_t key_size) {
 }
 
 void* HashTable::GetValue(uint64_t hash_key) {
+  const int64_t index = FindIndex(hash_key);
+  if (index == -1)
+    return NULL;
+
   const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
-  uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
   uint8_t* hash_value_table = static_cast<uint8_t*>(mBuffer) + key_table_size;
+  return hash_value_table + (index * mMaxValueSize);
+}
 
+size_t HashTable::GetValueIndex(const void* hash_table_value) const {
+  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
+  const uint8_t* hash_value_table =
+      static_cast<const uint8_t*>(mBuffer) + key_table_size;
+  const uint8_t* hash_value_end =
+      hash_value_table + (mMaxValueSize * mNumEntries);
+  const uint8_t* value_ptr = static_cast<const uint8_t*>(hash_table_value);
+  YASSERT(value_ptr >= hash_value_table &&
+          value_ptr < hash_value_end,
+          "Hash table value is out of range.");
+  YASSERT((value_ptr - hash_value_table) % mMaxValueSize == 0,
+          "Invalid hash table value pointer.");
+  return (value_ptr - hash_value_table) / mMaxValueSize;
+}
+
+const void* const HashTable::GetValueAt(size_t index) const {
+  YASSERT(index < mNumEntries, "Hash table index out of range: %u",
+          static_cast<uint32_t>(index));
+  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
+  const uint8_t* hash_value_table =
+      static_cast<const uint8_t*>(mBuffer) + key_table_size;
+  return hash_value_table + (index * mMaxValueSize);
+}
+
+void* HashTable::GetValueAt(size_t index) {
+  YASSERT(index < mNumEntries, "Hash table index out of range: %u",
+          static_cast<uint32_t>(index));
+  const size_t key_table_size = sizeof(uint64_t) * mNumEntries;
+  uint8_t* hash_value_table = static_cast<uint8_t*>(mBuffer) + key_table_size;
+  return hash_value_table + (index * mMaxValueSize);
+}
+
+void HashTable::Prefetch(uint64_t hash_key) const {
+  const uint64_t* hash_table = static_cast<const uint64_t*>(mBuffer);
+  if (mControlBytes) {
+    const size_t group_mask = mNumEntries / HASH_TABLE_GROUP_SIZE - 1;
+    const size_t group = static_cast<size_t>(hash_key >> CONTROL_HASH_BITS) &
+                         group_mask;
+    PREFETCH(mControlBytes + group * HASH_TABLE_GROUP_SIZE);
+    PREFETCH(hash_table + group * HASH_TABLE_GROUP_SIZE);
+  } else {
+    PREFETCH(hash_table + (hash_key % mNumEntries));
+  }
+}
+
+int64_t HashTable::FindIndex(uint64_t hash_key) const {
+  if (mControlBytes)
+    return FindGroupIndex(hash_key);
+
+  const uint64_t* hash_table = static_cast<const uint64_t*>(mBuffer);
   for (uint64_t i = 0; i < MAX_TRIES; ++i) {
     const uint64_t try_index = (hash_key + i) % mNumEntries;
     const uint64_t hash_table_value = hash_table[try_index];
 
     if (hash_table_value == hash_key) {
-      return hash_value_table + (try_index * mMaxValueSize);
+      return static_cast<int64_t>(try_index);
     } else if (hash_table_value == EMPTY_VALUE) {
-      return NULL;
+      return -1;
     }
   }
 
-  return NULL;
+  return -1;
+}
+
+int64_t HashTable::FindGroupIndex(uint64_t hash_key) const {
+  const uint64_t* hash_table = static_cast<const uint64_t*>(mBuffer);
+  const uint8_t control_hash = ControlHash(hash_key);
+
+  // Triangular probing over the groups visits each group exactly once.
+  const size_t group_mask = mNumEntries / HASH_TABLE_GROUP_SIZE - 1;
+  size_t group = static_cast<size_t>(hash_key >> CONTROL_HASH_BITS) &
+                 group_mask;
+  for (size_t step = 1; step <= group_mask + 1; ++step) {
+    const size_t group_start = group * HASH_TABLE_GROUP_SIZE;
+    const uint8_t* group_control = mControlBytes + group_start;
+
+    uint32_t matches = MatchGroup(group_control, control_hash);
+    while (matches) {
+      const size_t index = group_start + LowestBitIndex(matches);
+      if (hash_table[index] == hash_key)
+        return static_cast<int64_t>(index);
+      matches &= matches - 1;
+    }
+
+    // Inserts never probe past a group with an empty entry.
+    if (MatchGroup(group_control, CONTROL_EMPTY))
+      return -1;
+
+    group = (group + step) & group_mask;
+  }
+
+  return -1;
+}
+
+void HashTable::RemoveIndex(size_t index) {
+  if (mControlBytes) {
+    // Entries in a group which still has an empty entry can never be part of
+    // a longer probe sequence, so they can go straight back to empty.
+    const size_t group_start = ROUND_DOWN(index, HASH_TABLE_GROUP_SIZE);
+    const bool group_has_empty =
+        0 != MatchGroup(mControlBytes + group_start, CONTROL_EMPTY);
+    mControlBytes[index] = group_has_empty ? CONTROL_EMPTY : CONTROL_REMOVED;
+  } else {
+    uint64_t* hash_table = static_cast<uint64_t*>(mBuffer);
+    hash_table[index] = REMOVED_VALUE;
+  }
+  --mCurrentEntries;
 }
 
 }} // namespace ycommon { namespace containers {
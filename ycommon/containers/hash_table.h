@@ -1,6 +1,7 @@
 #ifndef YCOMMON_CONTAINERS_HASH_TABLE_H
 #define YCOMMON_CONTAINERS_HASH_TABLE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "ycommon/headers/macros.h"
@@ -8,14 +9,24 @@
 /*******
 * HashTable inserts/retrieves hash values.
 *   - buffer size: (max_value_size + sizeof(uint64_t)) * num_entries.
+*   - Power of 2 entry counts of at least HASH_TABLE_GROUP_SIZE use group
+*     probing: each entry gets an extra control byte holding 7 bits of its
+*     hash, and lookups compare a whole group of control bytes at once
+*     before touching the key table.
 ********/
+#define HASH_TABLE_GROUP_SIZE 16
 
 namespace ycommon { namespace containers {
 
 class HashTable {
  public:
   static size_t GetAllocationSize(size_t num_entries, size_t max_value_size) {
-    return (max_value_size + sizeof(uint64_t)) * num_entries;
+    const size_t control_size = UsesGroupProbing(num_entries) ? num_entries : 0;
+    return (max_value_size + sizeof(uint64_t)) * num_entries + control_size;
+  }
+
+  static bool UsesGroupProbing(size_t num_entries) {
+    return num_entries >= HASH_TABLE_GROUP_SIZE && IS_POWER_OF_2(num_entries);
   }
 
   HashTable();
@@ -44,12 +55,26 @@ class HashTable {
   void* GetValue(const void* key, size_t key_size);
   void* GetValue(uint64_t hash_key);
 
+  // Starts loading the first entries a lookup of hash_key would probe.
+  void Prefetch(uint64_t hash_key) const;
+
+  // Values never move once inserted, their entry index can be stored in
+  // place of a pointer.
+  size_t GetValueIndex(const void* hash_table_value) const;
+  const void* const GetValueAt(size_t index) const;
+  void* GetValueAt(size_t index);
+
   int32_t GetCurrentSize() const { return mCurrentEntries; }
 
  private:
-  bool RemoveHelper(uint32_t index);
+  // Returns the entry index holding the hash key, or -1 if not found.
+  int64_t FindIndex(uint64_t hash_key) const;
+  int64_t FindGroupIndex(uint64_t hash_key) const;
+  void* InsertGroup(uint64_t hash_key, const void* value, size_t value_size);
+  void RemoveIndex(size_t index);
 
   void* mBuffer;
+  uint8_t* mControlBytes;
   int32_t mCurrentEntries;
   size_t mNumEntries;
   size_t mMaxValueSize;
@@ -95,6 +120,13 @@ class TypedHashTable : public HashTable {
   T* GetValue(uint64_t hash_key) {
     return static_cast<T*>(HashTable::GetValue(hash_key));
   }
+
+  const T* const GetValueAt(size_t index) const {
+    return static_cast<const T* const>(HashTable::GetValueAt(index));
+  }
+  T* GetValueAt(size_t index) {
+    return static_cast<T*>(HashTable::GetValueAt(index));
+  }
 };
 
 template <typename T1, typename T2>
@@ -104,41 +136,41 @@ class FullTypedHashTable : public TypedHashTable<T2> {
     return HashTable::GetAllocationSize(num_entries, sizeof(T2));
   }
 
-  FullTypedHashTable() : TypedHashTable() {}
+  FullTypedHashTable() : TypedHashTable<T2>() {}
   FullTypedHashTable(void* buffer, size_t buffer_size, size_t num_entries)
-      : TypedHashTable(buffer, buffer_size, num_entries) {}
+      : TypedHashTable<T2>(buffer, buffer_size, num_entries) {}
   ~FullTypedHashTable() {}
 
   T2* Insert(const T1& key, const T2& value, uint64_t* hash_key = nullptr) {
-    return TypedHashTable::Insert(&key, sizeof(key), value, hash_key);
+    return TypedHashTable<T2>::Insert(&key, sizeof(key), value, hash_key);
   }
 
   T2* Insert(uint64_t hash_key, const T2& value) {
-    return TypedHashTable::Insert(hash_key, value);
+    return TypedHashTable<T2>::Insert(hash_key, value);
   }
 
   const T2* const GetValue(const T1& key) const {
-    return TypedHashTable::GetValue(&key, sizeof(key));
+    return TypedHashTable<T2>::GetValue(&key, sizeof(key));
   }
 
   T2* GetValue(uint64_t hash_key) const {
-    return TypedHashTable::GetValue(hash_key);
+    return TypedHashTable<T2>::GetValue(hash_key);
   }
 
   T2* GetValue(T1& key) {
-    return TypedHashTable::GetValue(&key, sizeof(key));
+    return TypedHashTable<T2>::GetValue(&key, sizeof(key));
   }
 
   T2* GetValue(uint64_t hash_key) {
-    return TypedHashTable::GetValue(hash_key);
+    return TypedHashTable<T2>::GetValue(hash_key);
   }
 
   bool Remove(const T1& key) {
-    return TypedHashTable::Remove(&key, sizeof(key));
+    return TypedHashTable<T2>::Remove(&key, sizeof(key));
   }
 
   bool Remove(const T2* value) {
-    return TypedHashTable::Remove(value);
+    return TypedHashTable<T2>::Remove(value);
   }
 };
 
@@ -150,16 +182,17 @@ class ContainedHashTable : public TypedHashTable<T> {
   }
 
   ContainedHashTable()
-      : TypedHashTable(mBuffer, sizeof(mBuffer), entries) {}
+      : TypedHashTable<T>(mBuffer, sizeof(mBuffer), entries) {}
   ~ContainedHashTable() {}
 
   void Reset() {
-    Init(mBuffer, sizeof(mBuffer), entries, sizeof(T));
+    this->Init(mBuffer, sizeof(mBuffer), entries, sizeof(T));
   }
 
  private:
+  // Extra byte per entry for the control bytes of group probing tables.
   ALIGN_FRONT(8)
-  uint8_t mBuffer[(sizeof(uint64_t)+sizeof(T))*entries] ALIGN_BACK(8);
+  uint8_t mBuffer[(sizeof(uint64_t)+sizeof(T)+1)*entries] ALIGN_BACK(8);
 };
 
 template <typename T1, typename T2, size_t entries>
@@ -170,16 +203,17 @@ class ContainedFullHashTable : public FullTypedHashTable<T1, T2> {
   }
 
   ContainedFullHashTable()
-      : FullTypedHashTable(mBuffer, sizeof(mBuffer), entries) {}
+      : FullTypedHashTable<T1, T2>(mBuffer, sizeof(mBuffer), entries) {}
   ~ContainedFullHashTable() {}
 
   void Reset() {
-    Init(mBuffer, sizeof(mBuffer), entries);
+    this->Init(mBuffer, sizeof(mBuffer), entries);
   }
 
  private:
+  // Extra byte per entry for the control bytes of group probing tables.
   ALIGN_FRONT(8)
-  uint8_t mBuffer[(sizeof(uint64_t)+sizeof(T2))*entries] ALIGN_BACK(8);
+  uint8_t mBuffer[(sizeof(uint64_t)+sizeof(T2)+1)*entries] ALIGN_BACK(8);
 };
 
 }} // namespace ycommon { namespace containers {
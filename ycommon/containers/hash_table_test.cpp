@@ -121,4 +121,111 @@ HASH_TABLE_TEST(MultipleValuesTest);
 HASH_TABLE_TEST(GetEmptyValueTest);
 HASH_TABLE_TEST(AllocationSizeTest);
 
+TEST_F(HashTableTest, ReplaceValueTest) {
+  ContainedFullHashTable<int, int, 100> hash_table;
+
+  int key = 1;
+  hash_table.Insert(key, 123);
+  hash_table.Insert(key, 456);
+  EXPECT_EQ(1, hash_table.GetCurrentSize());
+  EXPECT_EQ(456, *hash_table.GetValue(key));
+}
+
+TEST_F(HashTableTest, PrefetchTest) {
+  ContainedFullHashTable<int, int, 10> linear_table;
+  ContainedFullHashTable<int, int, 16> group_table;
+  int key = 1;
+  uint64_t hash_key = 0;
+  linear_table.Insert(key, 10);
+  group_table.Insert(key, 20, &hash_key);
+
+  // Prefetching is only a hint, lookups are unchanged.
+  linear_table.Prefetch(hash_key);
+  group_table.Prefetch(hash_key);
+  group_table.Prefetch(hash_key + 1);
+  EXPECT_EQ(10, *linear_table.GetValue(key));
+  EXPECT_EQ(20, *group_table.GetValue(hash_key));
+}
+
+TEST_F(HashTableTest, ValueIndexTest) {
+  ContainedFullHashTable<int, int, 100> hash_table;
+
+  int key = 1;
+  int* value = hash_table.Insert(key, 123);
+  const size_t index = hash_table.GetValueIndex(value);
+  EXPECT_LT(index, static_cast<size_t>(100));
+  EXPECT_EQ(value, hash_table.GetValueAt(index));
+
+  // Replacing a value keeps its index.
+  hash_table.Insert(key, 456);
+  EXPECT_EQ(index, hash_table.GetValueIndex(hash_table.GetValue(key)));
+  EXPECT_EQ(456, *hash_table.GetValueAt(index));
+}
+
+TEST_F(HashTableTest, GroupProbingAllocationSizeTest) {
+  EXPECT_FALSE(HashTable::UsesGroupProbing(HASH_TABLE_GROUP_SIZE / 2));
+  EXPECT_FALSE(HashTable::UsesGroupProbing(HASH_TABLE_GROUP_SIZE * 3));
+  EXPECT_TRUE(HashTable::UsesGroupProbing(HASH_TABLE_GROUP_SIZE * 4));
+
+  // Group probing tables need one control byte per entry.
+  EXPECT_EQ(HashTable::GetAllocationSize(100, sizeof(int)),
+            (sizeof(uint64_t) + sizeof(int)) * 100);
+  EXPECT_EQ(HashTable::GetAllocationSize(128, sizeof(int)),
+            (sizeof(uint64_t) + sizeof(int) + 1) * 128);
+}
+
+TEST_F(HashTableTest, GroupProbingFullTableTest) {
+  ContainedFullHashTable<int, int, 64> hash_table;
+
+  // Every group is probed, so the table can be filled completely.
+  for (int i = 0; i < 64; ++i) {
+    hash_table.Insert(i, i);
+  }
+  EXPECT_EQ(64, hash_table.GetCurrentSize());
+
+  for (int i = 0; i < 64; ++i) {
+    ASSERT_NE(nullptr, hash_table.GetValue(i));
+    EXPECT_EQ(i, *hash_table.GetValue(i));
+  }
+  int missing_key = 64;
+  EXPECT_EQ(nullptr, hash_table.GetValue(missing_key));
+}
+
+TEST_F(HashTableTest, GroupProbingRemovalTest) {
+  ContainedFullHashTable<int, int, 64> hash_table;
+
+  for (int i = 0; i < 64; ++i) {
+    hash_table.Insert(i, i);
+  }
+
+  for (int i = 0; i < 64; i += 2) {
+    EXPECT_TRUE(hash_table.Remove(i));
+  }
+  EXPECT_EQ(32, hash_table.GetCurrentSize());
+
+  // Removed entries must not hide keys which were probed past them.
+  for (int i = 0; i < 64; ++i) {
+    if (i % 2) {
+      ASSERT_NE(nullptr, hash_table.GetValue(i));
+      EXPECT_EQ(i, *hash_table.GetValue(i));
+    } else {
+      EXPECT_EQ(nullptr, hash_table.GetValue(i));
+      EXPECT_FALSE(hash_table.Remove(i));
+    }
+  }
+
+  for (int i = 0; i < 64; i += 2) {
+    hash_table.Insert(i, i + 100);
+  }
+  EXPECT_EQ(64, hash_table.GetCurrentSize());
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(i % 2 ? i : i + 100, *hash_table.GetValue(i));
+  }
+
+  hash_table.Clear();
+  EXPECT_EQ(0, hash_table.GetCurrentSize());
+  int cleared_key = 1;
+  EXPECT_EQ(nullptr, hash_table.GetValue(cleared_key));
+}
+
 }} // namespace ycommon { namespace containers {
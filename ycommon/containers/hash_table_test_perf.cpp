@@ -0,0 +1,118 @@
+#include "ycommon/containers/hash_table.h"
+
+#include <gtest/gtest.h>
+
+#include "ycommon/platform/timer.h"
+
+#define NUM_ITERATIONS 20
+
+namespace ycommon { namespace containers {
+
+class HashTablePerfTest : public ::testing::Test {
+ public:
+  HashTablePerfTest()
+    : mKeys(nullptr),
+      mMissingKeys(nullptr) {}
+
+  // Times inserts, hits and misses on a table of the given size.
+  void TimeTable(size_t num_entries, size_t num_keys,
+                 float* insert_time, float* hit_time, float* miss_time) {
+    const size_t buffer_size =
+        TypedHashTable<uint64_t>::GetAllocationSize(num_entries);
+    uint8_t* buffer = new uint8_t[buffer_size];
+    TypedHashTable<uint64_t> hash_table(buffer, buffer_size, num_entries);
+
+    uint64_t found = 0;
+    platform::Timer timer;
+    timer.Start();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      hash_table.Clear();
+      for (size_t n = 0; n < num_keys; ++n) {
+        hash_table.Insert(mKeys[n], mKeys[n]);
+      }
+    }
+    timer.Pulse();
+    *insert_time = timer.GetDiffTimeMicroFloat();
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      for (size_t n = 0; n < num_keys; ++n) {
+        found += *hash_table.GetValue(mKeys[n]);
+      }
+    }
+    timer.Pulse();
+    *hit_time = timer.GetDiffTimeMicroFloat();
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      for (size_t n = 0; n < num_keys; ++n) {
+        found += (hash_table.GetValue(mMissingKeys[n]) != nullptr);
+      }
+    }
+    timer.Pulse();
+    *miss_time = timer.GetDiffTimeMicroFloat();
+
+    // Keep the lookups from being optimized out.
+    EXPECT_NE(0u, found);
+    EXPECT_EQ(static_cast<int32_t>(num_keys), hash_table.GetCurrentSize());
+
+    delete [] buffer;
+  }
+
+  // Compares a linear probing table against a group probing table of
+  // nearly the same size, both filled to the same load.
+  void RunBenchmark(size_t num_entries, size_t num_keys) {
+    ASSERT_TRUE(HashTable::UsesGroupProbing(num_entries));
+
+    mKeys = new uint64_t[num_keys];
+    mMissingKeys = new uint64_t[num_keys];
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < num_keys * 2; ++i) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      if (i % 2)
+        mMissingKeys[i / 2] = state;
+      else
+        mKeys[i / 2] = state;
+    }
+
+    float linear_insert, linear_hit, linear_miss;
+    TimeTable(num_entries - 1, num_keys,
+              &linear_insert, &linear_hit, &linear_miss);
+
+    float group_insert, group_hit, group_miss;
+    TimeTable(num_entries, num_keys,
+              &group_insert, &group_hit, &group_miss);
+
+    const float num_ops = static_cast<float>(NUM_ITERATIONS * num_keys);
+    printf("[ HASHTABLE] %6u keys in %6u entries (ns/op):\n"
+           "[ HASHTABLE]   linear: insert %6.2f, hit %6.2f, miss %6.2f\n"
+           "[ HASHTABLE]   group:  insert %6.2f, hit %6.2f, miss %6.2f\n",
+           static_cast<uint32_t>(num_keys),
+           static_cast<uint32_t>(num_entries),
+           linear_insert * 1000.0f / num_ops,
+           linear_hit * 1000.0f / num_ops,
+           linear_miss * 1000.0f / num_ops,
+           group_insert * 1000.0f / num_ops,
+           group_hit * 1000.0f / num_ops,
+           group_miss * 1000.0f / num_ops);
+  }
+
+  void TearDown() override {
+    delete [] mMissingKeys;
+    delete [] mKeys;
+  }
+
+  uint64_t* mKeys;
+  uint64_t* mMissingKeys;
+};
+
+TEST_F(HashTablePerfTest, Lookups1K) {
+  RunBenchmark(4096, 1024);
+}
+
+TEST_F(HashTablePerfTest, Lookups16K) {
+  RunBenchmark(65536, 16384);
+}
+
+}} // namespace ycommon { namespace containers {
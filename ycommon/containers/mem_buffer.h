@@ -1,6 +1,8 @@
 #ifndef YCOMMON_CONTAINERS_MEM_BUFFER_H
 #define YCOMMON_CONTAINERS_MEM_BUFFER_H
 
+#include <stddef.h>
+
 /*******
 * MemBuffer manages a simple buffer of memory, long lived allocations are
 *   allocated from the front while scratch pad memory is allocated from the end.
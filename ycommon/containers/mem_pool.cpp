@@ -1,7 +1,7 @@
 #include "ycommon/containers/mem_pool.h"
 
 #include <algorithm>
-#include <string>
+#include <string.h>
 
 #include "ycommon/utils/assert.h"
 
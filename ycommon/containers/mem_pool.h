@@ -1,6 +1,7 @@
 #ifndef YCOMMON_CONTAINERS_MEM_POOL_H
 #define YCOMMON_CONTAINERS_MEM_POOL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /*******
@@ -89,11 +90,11 @@ class ContainedMemPool : public TypedMemPool<T> {
     return sizeof(T) * items;
   }
 
-  ContainedMemPool() : TypedMemPool(mData, sizeof(mData), items) {}
+  ContainedMemPool() : TypedMemPool<T>(mData, sizeof(mData), items) {}
   ~ContainedMemPool() {}
 
   void Init() {
-    TypedMemPool::Init(mData, sizeof(mData), items);
+    TypedMemPool<T>::Init(mData, sizeof(mData), items);
   }
 
  private:
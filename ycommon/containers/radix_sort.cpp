@@ -0,0 +1,232 @@
+#include "ycommon/containers/radix_sort.h"
+
+#include <string.h>
+
+#include "ycommon/containers/thread_pool.h"
+#include "ycommon/utils/assert.h"
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define MAX_DIGITS ((128 + RADIX_BITS - 1) / RADIX_BITS)
+
+// Splitting the passes is only worth it for large numbers of keys.
+#define MIN_KEYS_PER_JOB 4096
+#define MAX_SORT_JOBS 16
+
+namespace ycommon { namespace containers {
+
+namespace {
+  struct RadixDigit {
+    uint32_t mWord;
+    uint32_t mShift;
+    uint32_t mMask;
+  };
+
+  // Digits start at each masked bit which is not covered by a previous digit.
+  uint32_t GetRadixDigits(uint64_t key_mask, uint32_t word,
+                          RadixDigit* digits) {
+    uint32_t num_digits = 0;
+    uint32_t bit = 0;
+    while (bit < 64) {
+      if ((key_mask >> bit) & 1) {
+        digits[num_digits].mWord = word;
+        digits[num_digits].mShift = bit;
+        digits[num_digits].mMask =
+            static_cast<uint32_t>(key_mask >> bit) & (RADIX_SIZE - 1);
+        ++num_digits;
+        bit += RADIX_BITS;
+      } else {
+        ++bit;
+      }
+    }
+    return num_digits;
+  }
+
+  inline uint32_t GetDigit(uint64_t key, const RadixDigit& digit) {
+    return static_cast<uint32_t>(key >> digit.mShift) & digit.mMask;
+  }
+
+  inline uint32_t GetDigit(const RadixKey128& key, const RadixDigit& digit) {
+    const uint64_t word = digit.mWord ? key.mHigh : key.mLow;
+    return static_cast<uint32_t>(word >> digit.mShift) & digit.mMask;
+  }
+
+  template <typename Key>
+  Key* SortDigits(const RadixDigit* digits, uint32_t num_digits,
+                  Key* keys, Key* scratch, size_t num_keys) {
+    // Key counts do not change between passes, count every digit at once.
+    uint32_t histograms[MAX_DIGITS][RADIX_SIZE];
+    memset(histograms, 0, sizeof(histograms[0]) * num_digits);
+    for (size_t i = 0; i < num_keys; ++i) {
+      const Key& key = keys[i];
+      for (uint32_t d = 0; d < num_digits; ++d) {
+        ++histograms[d][GetDigit(key, digits[d])];
+      }
+    }
+
+    Key* source = keys;
+    Key* dest = scratch;
+    for (uint32_t d = 0; d < num_digits; ++d) {
+      const RadixDigit digit = digits[d];
+      uint32_t* offsets = histograms[d];
+
+      // Every key shares this digit, the pass would not move anything.
+      if (offsets[GetDigit(source[0], digit)] == num_keys)
+        continue;
+
+      uint32_t offset = 0;
+      for (uint32_t n = 0; n < RADIX_SIZE; ++n) {
+        const uint32_t count = offsets[n];
+        offsets[n] = offset;
+        offset += count;
+      }
+
+      for (size_t i = 0; i < num_keys; ++i) {
+        const Key& key = source[i];
+        dest[offsets[GetDigit(key, digit)]++] = key;
+      }
+
+      Key* temp = source;
+      source = dest;
+      dest = temp;
+    }
+    return source;
+  }
+
+  template <typename Key>
+  struct SortJob {
+    const Key* mSource;
+    Key* mDest;
+    size_t mBegin;
+    size_t mEnd;
+    RadixDigit mDigit;
+    uint32_t mCounts[RADIX_SIZE];
+  };
+
+  template <typename Key>
+  uintptr_t HistogramRoutine(void* arg) {
+    SortJob<Key>* job = static_cast<SortJob<Key>*>(arg);
+    const Key* source = job->mSource;
+    const RadixDigit digit = job->mDigit;
+    uint32_t* counts = job->mCounts;
+
+    memset(counts, 0, sizeof(job->mCounts));
+    const size_t end = job->mEnd;
+    for (size_t i = job->mBegin; i < end; ++i) {
+      ++counts[GetDigit(source[i], digit)];
+    }
+    return 0;
+  }
+
+  template <typename Key>
+  uintptr_t ScatterRoutine(void* arg) {
+    SortJob<Key>* job = static_cast<SortJob<Key>*>(arg);
+    const Key* source = job->mSource;
+    Key* dest = job->mDest;
+    const RadixDigit digit = job->mDigit;
+    uint32_t* offsets = job->mCounts;
+
+    const size_t end = job->mEnd;
+    for (size_t i = job->mBegin; i < end; ++i) {
+      const Key& key = source[i];
+      dest[offsets[GetDigit(key, digit)]++] = key;
+    }
+    return 0;
+  }
+
+  template <typename Key>
+  Key* ParallelSortDigits(ThreadPool* thread_pool, size_t num_jobs,
+                          const RadixDigit* digits, uint32_t num_digits,
+                          Key* keys, Key* scratch, size_t num_keys) {
+    SortJob<Key> jobs[MAX_SORT_JOBS];
+    const size_t keys_per_job = (num_keys + num_jobs - 1) / num_jobs;
+    for (size_t j = 0; j < num_jobs; ++j) {
+      const size_t begin = j * keys_per_job;
+      const size_t end = begin + keys_per_job;
+      jobs[j].mBegin = begin;
+      jobs[j].mEnd = end < num_keys ? end : num_keys;
+    }
+
+    Key* source = keys;
+    Key* dest = scratch;
+    for (uint32_t d = 0; d < num_digits; ++d) {
+      for (size_t j = 0; j < num_jobs; ++j) {
+        jobs[j].mSource = source;
+        jobs[j].mDest = dest;
+        jobs[j].mDigit = digits[d];
+      }
+      thread_pool->RunAndWait(HistogramRoutine<Key>, jobs, sizeof(jobs[0]),
+                              num_jobs);
+
+      // Offsets are ordered by digit then by job so the sort stays stable.
+      bool skip_digit = false;
+      uint32_t offset = 0;
+      for (uint32_t n = 0; n < RADIX_SIZE && !skip_digit; ++n) {
+        uint32_t digit_total = 0;
+        for (size_t j = 0; j < num_jobs; ++j) {
+          const uint32_t count = jobs[j].mCounts[n];
+          jobs[j].mCounts[n] = offset;
+          offset += count;
+          digit_total += count;
+        }
+        skip_digit = (digit_total == num_keys);
+      }
+      if (skip_digit)
+        continue;
+
+      thread_pool->RunAndWait(ScatterRoutine<Key>, jobs, sizeof(jobs[0]),
+                              num_jobs);
+
+      Key* temp = source;
+      source = dest;
+      dest = temp;
+    }
+    return source;
+  }
+
+  template <typename Key>
+  Key* SortKeys(const RadixDigit* digits, uint32_t num_digits,
+                Key* keys, Key* scratch, size_t num_keys,
+                ThreadPool* thread_pool) {
+    YASSERT(num_keys <= static_cast<uint32_t>(-1),
+            "Radix sort supports at most %u keys.",
+            static_cast<uint32_t>(-1));
+    if (num_keys < 2 || num_digits == 0)
+      return keys;
+
+    size_t num_jobs = 1;
+    if (thread_pool && thread_pool->Running()) {
+      num_jobs = thread_pool->GetNumThreads() + 1;
+      if (num_jobs > MAX_SORT_JOBS)
+        num_jobs = MAX_SORT_JOBS;
+      if (num_jobs > num_keys / MIN_KEYS_PER_JOB)
+        num_jobs = num_keys / MIN_KEYS_PER_JOB;
+    }
+
+    if (num_jobs > 1) {
+      return ParallelSortDigits(thread_pool, num_jobs, digits, num_digits,
+                                keys, scratch, num_keys);
+    }
+    return SortDigits(digits, num_digits, keys, scratch, num_keys);
+  }
+}
+
+uint64_t* RadixSort::Sort(uint64_t* keys, uint64_t* scratch, size_t num_keys,
+                          uint64_t key_mask, ThreadPool* thread_pool) {
+  RadixDigit digits[MAX_DIGITS];
+  const uint32_t num_digits = GetRadixDigits(key_mask, 0, digits);
+  return SortKeys(digits, num_digits, keys, scratch, num_keys, thread_pool);
+}
+
+RadixKey128* RadixSort::Sort(RadixKey128* keys, RadixKey128* scratch,
+                             size_t num_keys,
+                             uint64_t high_mask, uint64_t low_mask,
+                             ThreadPool* thread_pool) {
+  // Least significant digits first, the low word is sorted before the high.
+  RadixDigit digits[MAX_DIGITS];
+  uint32_t num_digits = GetRadixDigits(low_mask, 0, digits);
+  num_digits += GetRadixDigits(high_mask, 1, digits + num_digits);
+  return SortKeys(digits, num_digits, keys, scratch, num_keys, thread_pool);
+}
+
+}} // namespace ycommon { namespace containers {
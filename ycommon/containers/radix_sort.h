@@ -0,0 +1,38 @@
+#ifndef YCOMMON_CONTAINERS_RADIX_SORT_H
+#define YCOMMON_CONTAINERS_RADIX_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******
+* Least significant digit radix sort for 64 bit and 128 bit keys.
+*  - Only the bits set in the key mask are sorted on, other bits are carried.
+*  - Digits where every key has the same value are skipped.
+*  - Stable, the scratch buffer must be able to hold num_keys keys.
+*  - When a running thread pool is supplied, large sorts split each digit
+*    pass across the pool threads.
+********/
+namespace ycommon { namespace containers {
+
+class ThreadPool;
+
+// Wide keys are ordered by the high word, then the low word.
+struct RadixKey128 {
+  uint64_t mLow;
+  uint64_t mHigh;
+};
+
+namespace RadixSort {
+  // Returns the buffer holding the sorted keys, either keys or scratch.
+  uint64_t* Sort(uint64_t* keys, uint64_t* scratch, size_t num_keys,
+                 uint64_t key_mask = static_cast<uint64_t>(-1),
+                 ThreadPool* thread_pool = nullptr);
+  RadixKey128* Sort(RadixKey128* keys, RadixKey128* scratch, size_t num_keys,
+                    uint64_t high_mask = static_cast<uint64_t>(-1),
+                    uint64_t low_mask = static_cast<uint64_t>(-1),
+                    ThreadPool* thread_pool = nullptr);
+}
+
+}} // namespace ycommon { namespace containers {
+
+#endif // YCOMMON_CONTAINERS_RADIX_SORT_H
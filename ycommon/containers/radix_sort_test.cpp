@@ -0,0 +1,190 @@
+#include "ycommon/containers/radix_sort.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+#include "ycommon/containers/thread_pool.h"
+#include "ycommon/headers/macros.h"
+
+namespace ycommon { namespace containers {
+
+static uint64_t NextRandom(uint64_t* state) {
+  // xorshift64, deterministic so failures are reproducible.
+  uint64_t value = *state;
+  value ^= value << 13;
+  value ^= value >> 7;
+  value ^= value << 17;
+  *state = value;
+  return value;
+}
+
+static void FillRandom(uint64_t* keys, size_t num_keys, uint64_t mask) {
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys[i] = NextRandom(&state) & mask;
+  }
+}
+
+static void FillRandom(RadixKey128* keys, size_t num_keys,
+                       uint64_t high_mask, uint64_t low_mask) {
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys[i].mHigh = NextRandom(&state) & high_mask;
+    keys[i].mLow = NextRandom(&state) & low_mask;
+  }
+}
+
+static bool WideKeyLess(const RadixKey128& a, const RadixKey128& b) {
+  return a.mHigh < b.mHigh || (a.mHigh == b.mHigh && a.mLow < b.mLow);
+}
+
+TEST(RadixSortTest, EmptySortTest) {
+  uint64_t keys[1] = { 5 };
+  uint64_t scratch[1] = { 0 };
+
+  EXPECT_EQ(keys, RadixSort::Sort(keys, scratch, 0));
+  EXPECT_EQ(keys, RadixSort::Sort(keys, scratch, 1));
+  EXPECT_EQ(5, keys[0]);
+}
+
+TEST(RadixSortTest, BasicSortTest) {
+  uint64_t keys[] = { 5, 0xFF00000000000000ull, 3, 0x100, 3, 0 };
+  uint64_t expected[ARRAY_SIZE(keys)];
+  uint64_t scratch[ARRAY_SIZE(keys)];
+  memcpy(expected, keys, sizeof(keys));
+  std::sort(expected, expected + ARRAY_SIZE(expected));
+
+  const uint64_t* sorted = RadixSort::Sort(keys, scratch, ARRAY_SIZE(keys));
+  for (size_t i = 0; i < ARRAY_SIZE(keys); ++i) {
+    EXPECT_EQ(expected[i], sorted[i]);
+  }
+}
+
+TEST(RadixSortTest, MatchesStdSortTest) {
+  uint64_t keys[2000];
+  uint64_t expected[ARRAY_SIZE(keys)];
+  uint64_t scratch[ARRAY_SIZE(keys)];
+  FillRandom(keys, ARRAY_SIZE(keys), static_cast<uint64_t>(-1));
+  memcpy(expected, keys, sizeof(keys));
+  std::sort(expected, expected + ARRAY_SIZE(expected));
+
+  const uint64_t* sorted = RadixSort::Sort(keys, scratch, ARRAY_SIZE(keys));
+  for (size_t i = 0; i < ARRAY_SIZE(keys); ++i) {
+    ASSERT_EQ(expected[i], sorted[i]);
+  }
+}
+
+TEST(RadixSortTest, MaskedSortIsStableTest) {
+  // Only the high byte is sorted on, the low byte records original order.
+  uint64_t keys[] = {
+    0x0200000000000000ull | 0,
+    0x0100000000000000ull | 1,
+    0x0200000000000000ull | 2,
+    0x0100000000000000ull | 3,
+    0x0000000000000000ull | 4,
+  };
+  uint64_t scratch[ARRAY_SIZE(keys)];
+
+  const uint64_t* sorted = RadixSort::Sort(keys, scratch, ARRAY_SIZE(keys),
+                                           0xFF00000000000000ull);
+  EXPECT_EQ(0x0000000000000000ull | 4, sorted[0]);
+  EXPECT_EQ(0x0100000000000000ull | 1, sorted[1]);
+  EXPECT_EQ(0x0100000000000000ull | 3, sorted[2]);
+  EXPECT_EQ(0x0200000000000000ull | 0, sorted[3]);
+  EXPECT_EQ(0x0200000000000000ull | 2, sorted[4]);
+}
+
+TEST(RadixSortTest, SharedDigitsSkippedTest) {
+  // Every key shares all of its digits, nothing should be moved.
+  uint64_t keys[] = { 0x1234, 0x1234, 0x1234 };
+  uint64_t scratch[ARRAY_SIZE(keys)] = { 0 };
+
+  EXPECT_EQ(keys, RadixSort::Sort(keys, scratch, ARRAY_SIZE(keys)));
+}
+
+TEST(RadixSortTest, ParallelSortTest) {
+  const size_t num_keys = 50000;
+  uint64_t* keys = new uint64_t[num_keys];
+  uint64_t* expected = new uint64_t[num_keys];
+  uint64_t* scratch = new uint64_t[num_keys];
+  const uint64_t key_mask = 0xFFFFFF0000000000ull | 0xFFFF;
+  FillRandom(keys, num_keys, key_mask);
+  memcpy(expected, keys, sizeof(keys[0]) * num_keys);
+  std::sort(expected, expected + num_keys);
+
+  ContainedThreadPool<3, 16> thread_pool;
+  ASSERT_TRUE(thread_pool.Start());
+  const uint64_t* sorted = RadixSort::Sort(keys, scratch, num_keys,
+                                           key_mask, &thread_pool);
+  EXPECT_TRUE(thread_pool.Stop(500));
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    ASSERT_EQ(expected[i], sorted[i]);
+  }
+
+  delete [] scratch;
+  delete [] expected;
+  delete [] keys;
+}
+
+TEST(RadixSortTest, WideSortTest) {
+  RadixKey128 keys[2000];
+  RadixKey128 expected[ARRAY_SIZE(keys)];
+  RadixKey128 scratch[ARRAY_SIZE(keys)];
+  FillRandom(keys, ARRAY_SIZE(keys), 0xFF, static_cast<uint64_t>(-1));
+  memcpy(expected, keys, sizeof(keys));
+  std::sort(expected, expected + ARRAY_SIZE(expected), WideKeyLess);
+
+  const RadixKey128* sorted = RadixSort::Sort(keys, scratch,
+                                              ARRAY_SIZE(keys));
+  for (size_t i = 0; i < ARRAY_SIZE(keys); ++i) {
+    ASSERT_EQ(expected[i].mHigh, sorted[i].mHigh);
+    ASSERT_EQ(expected[i].mLow, sorted[i].mLow);
+  }
+}
+
+TEST(RadixSortTest, WideMaskedSortIsStableTest) {
+  // Only the high word is sorted on, the low word records original order.
+  RadixKey128 keys[] = {
+    { 0, 2 }, { 1, 1 }, { 2, 2 }, { 3, 1 }, { 4, 0 },
+  };
+  RadixKey128 scratch[ARRAY_SIZE(keys)];
+
+  const RadixKey128* sorted = RadixSort::Sort(keys, scratch,
+                                              ARRAY_SIZE(keys),
+                                              static_cast<uint64_t>(-1), 0);
+  const uint64_t expected_order[] = { 4, 1, 3, 0, 2 };
+  for (size_t i = 0; i < ARRAY_SIZE(keys); ++i) {
+    EXPECT_EQ(expected_order[i], sorted[i].mLow);
+  }
+}
+
+TEST(RadixSortTest, WideParallelSortTest) {
+  const size_t num_keys = 50000;
+  RadixKey128* keys = new RadixKey128[num_keys];
+  RadixKey128* expected = new RadixKey128[num_keys];
+  RadixKey128* scratch = new RadixKey128[num_keys];
+  const uint64_t high_mask = 0xFFFF000000000000ull;
+  const uint64_t low_mask = 0xFFFF;
+  FillRandom(keys, num_keys, high_mask, low_mask);
+  memcpy(expected, keys, sizeof(keys[0]) * num_keys);
+  std::sort(expected, expected + num_keys, WideKeyLess);
+
+  ContainedThreadPool<3, 16> thread_pool;
+  ASSERT_TRUE(thread_pool.Start());
+  const RadixKey128* sorted = RadixSort::Sort(keys, scratch, num_keys,
+                                              high_mask, low_mask,
+                                              &thread_pool);
+  EXPECT_TRUE(thread_pool.Stop(500));
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    ASSERT_EQ(expected[i].mHigh, sorted[i].mHigh);
+    ASSERT_EQ(expected[i].mLow, sorted[i].mLow);
+  }
+
+  delete [] scratch;
+  delete [] expected;
+  delete [] keys;
+}
+
+}} // namespace ycommon { namespace containers {
@@ -0,0 +1,113 @@
+#include "ycommon/containers/radix_sort.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+#include "ycommon/containers/thread_pool.h"
+#include "ycommon/platform/timer.h"
+
+#define NUM_SORT_THREADS 3
+#define NUM_ITERATIONS 20
+
+// Render key like layout: 24 field bits on top and the key index at the bottom.
+#define FIELD_BITS 24
+#define FIELD_MASK (~static_cast<uint64_t>(0) << (64 - FIELD_BITS))
+
+namespace ycommon { namespace containers {
+
+class RadixSortPerfTest : public ::testing::Test {
+ public:
+  RadixSortPerfTest()
+    : mKeys(nullptr),
+      mSource(nullptr),
+      mScratch(nullptr) {}
+
+  void RunBenchmark(size_t num_keys) {
+    mKeys = new uint64_t[num_keys];
+    mSource = new uint64_t[num_keys];
+    mScratch = new uint64_t[num_keys];
+
+    uint64_t index_mask = 0;
+    while (index_mask < num_keys - 1)
+      index_mask = (index_mask << 1) | 1;
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < num_keys; ++i) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      mSource[i] = (state & FIELD_MASK) | static_cast<uint64_t>(i);
+    }
+
+    const size_t thread_pool_size = ThreadPool::GetAllocationSize(
+        NUM_SORT_THREADS, 2 * NUM_SORT_THREADS);
+    uint8_t* thread_pool_buffer = new uint8_t[thread_pool_size];
+    ThreadPool thread_pool(NUM_SORT_THREADS, thread_pool_buffer,
+                           thread_pool_size);
+    ASSERT_TRUE(thread_pool.Start());
+
+    platform::Timer timer;
+    timer.Start();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      memcpy(mKeys, mSource, sizeof(mKeys[0]) * num_keys);
+      std::sort(mKeys, mKeys + num_keys);
+    }
+    timer.Pulse();
+    const float std_sort_time = timer.GetDiffTimeMicroFloat();
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      memcpy(mKeys, mSource, sizeof(mKeys[0]) * num_keys);
+      RadixSort::Sort(mKeys, mScratch, num_keys, FIELD_MASK | index_mask);
+    }
+    timer.Pulse();
+    const float radix_time = timer.GetDiffTimeMicroFloat();
+
+    const uint64_t* sorted = nullptr;
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      memcpy(mKeys, mSource, sizeof(mKeys[0]) * num_keys);
+      sorted = RadixSort::Sort(mKeys, mScratch, num_keys,
+                               FIELD_MASK | index_mask, &thread_pool);
+    }
+    timer.Pulse();
+    const float parallel_time = timer.GetDiffTimeMicroFloat();
+    EXPECT_TRUE(thread_pool.Stop(500));
+
+    for (size_t i = 1; i < num_keys; ++i) {
+      ASSERT_LT(sorted[i - 1], sorted[i]);
+    }
+
+    printf("[ RADIXSORT] %7u keys: std::sort %9.1fus, radix %9.1fus, "
+           "parallel radix (%u threads) %9.1fus\n",
+           static_cast<uint32_t>(num_keys),
+           std_sort_time / NUM_ITERATIONS,
+           radix_time / NUM_ITERATIONS,
+           NUM_SORT_THREADS + 1,
+           parallel_time / NUM_ITERATIONS);
+
+    delete [] thread_pool_buffer;
+  }
+
+  void TearDown() override {
+    delete [] mScratch;
+    delete [] mSource;
+    delete [] mKeys;
+  }
+
+  uint64_t* mKeys;
+  uint64_t* mSource;
+  uint64_t* mScratch;
+};
+
+TEST_F(RadixSortPerfTest, SortKeys1K) {
+  RunBenchmark(1000);
+}
+
+TEST_F(RadixSortPerfTest, SortKeys10K) {
+  RunBenchmark(10000);
+}
+
+TEST_F(RadixSortPerfTest, SortKeys100K) {
+  RunBenchmark(100000);
+}
+
+}} // namespace ycommon { namespace containers {
@@ -1,21 +1,148 @@
 #include "ycommon/containers/thread_pool.h"
 
 #include "ycommon/headers/atomics.h"
+#include "ycommon/headers/macros.h"
+#include "ycommon/platform/profiler.h"
 #include "ycommon/platform/timer.h"
 #include "ycommon/utils/assert.h"
 
+#define RUN_AND_WAIT_SLOT_BITS 4
+#define NUM_RUN_AND_WAIT_SLOTS (1 << RUN_AND_WAIT_SLOT_BITS)
+#define RUN_AND_WAIT_REFS_MASK 0xFFFFFFFFull
+
 namespace ycommon { namespace containers {
 
+namespace {
+  // WorkerData of the pool thread running on this thread, if any.
+  THREAD_LOCAL void* gCurrentWorker = NULL;
+
+  uint32_t NextRandom(uint32_t& seed) {
+    // Xorshift, only used to spread out the steal victims.
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+
+  // RunAndWait() state lives in global slots instead of on the caller's
+  // stack, since queued helpers can start after the caller has returned.
+  // Helpers join the slot's current generation, the caller bumps the
+  // generation once every argument ran so late helpers return at once. The
+  // slot is freed when the caller and every joined helper have left.
+  struct RunAndWaitData {
+    RunAndWaitData()
+      : mThreadRoutine(NULL),
+        mArgs(NULL),
+        mArgStride(0),
+        mNumArgs(0),
+        mNextArg(0),
+        mArgsFinished(0),
+        mInUse(0),
+        mState(0),
+        mFinishedSemaphore(0, 1) {}
+
+    // Returns true if this runner finished the last argument.
+    bool RunArgs() {
+      bool finished_last = false;
+      for (;;) {
+        const uint32_t arg_index = AtomicAdd32(&mNextArg, 1);
+        if (arg_index >= mNumArgs)
+          break;
+        mThreadRoutine(mArgs + arg_index * mArgStride);
+        if (AtomicAdd32(&mArgsFinished, 1) == mNumArgs - 1)
+          finished_last = true;
+      }
+      return finished_last;
+    }
+
+    // Drops a reference, the last one frees the slot.
+    void Leave(uint64_t delta) {
+      const uint64_t prev_state = AtomicAdd64(&mState, delta);
+      if ((prev_state & RUN_AND_WAIT_REFS_MASK) == 1) {
+        ReleaseFence();
+        mInUse = 0;
+      }
+    }
+
+    platform::ThreadRoutine mThreadRoutine;
+    uint8_t* mArgs;
+    size_t mArgStride;
+    uint32_t mNumArgs;
+    volatile uint32_t mNextArg;
+    volatile uint32_t mArgsFinished;
+    volatile uint32_t mInUse;
+
+    // Generation in the high 32 bits, references in the low 32 bits.
+    volatile uint64_t mState;
+    platform::Semaphore mFinishedSemaphore;
+  };
+  RunAndWaitData gRunAndWaitSlots[NUM_RUN_AND_WAIT_SLOTS];
+
+  // Helpers are enqueued with the slot index and its generation.
+  uintptr_t GetRunAndWaitKey(uint64_t state, uint32_t slot) {
+    return static_cast<uintptr_t>((state >> 32) << RUN_AND_WAIT_SLOT_BITS) |
+           slot;
+  }
+
+  uintptr_t RunAndWaitRoutine(void* arg) {
+    const uintptr_t key = reinterpret_cast<uintptr_t>(arg);
+    const uint32_t slot =
+        static_cast<uint32_t>(key & (NUM_RUN_AND_WAIT_SLOTS - 1));
+    RunAndWaitData& run_data = gRunAndWaitSlots[slot];
+
+    // Only join while the caller is still running the same generation.
+    for (;;) {
+      const uint64_t state = run_data.mState;
+      if (GetRunAndWaitKey(state, slot) != key)
+        return 0;
+      if (AtomicCmpSet64(&run_data.mState, state, state + 1))
+        break;
+    }
+
+    if (run_data.RunArgs())
+      run_data.mFinishedSemaphore.Release();
+    run_data.Leave(static_cast<uint64_t>(-1));
+    return 0;
+  }
+}
+
 void ThreadPool::ThreadData::Initialize(size_t num_threads, void* buffer,
-                                       size_t buffer_size) {
+                                       size_t buffer_size,
+                                       WorkerData* workers,
+                                       bool work_stealing) {
   mRunState = kRunState_Stopped;
   mSemaphore.Initialize(static_cast<int>(num_threads),
                         static_cast<int>(num_threads));
   mParentSemaphore.Initialize(0, 1);
-  mRunQueue.Initialize(static_cast<ThreadPool::RunArgs*>(buffer),
-                       buffer_size,
-                       buffer_size / sizeof(ThreadPool::RunArgs));
+  mRunQueue.Initialize(buffer, buffer_size,
+                       buffer_size /
+                       AtomicMPMCQueue::GetSlotSize(sizeof(ThreadPool::RunArgs)));
   mThreadsRunning = 0;
+  mWorkers = workers;
+  mNumWorkers = num_threads;
+
+  // Stealing needs worker deques and another worker to steal from.
+  mWorkStealing = work_stealing && num_threads > 1;
+}
+
+bool ThreadPool::ThreadData::GetNextRun(WorkerData* worker,
+                                        RunArgs& run_args) {
+  // Own deque first (newest routine), then the shared queue.
+  if (worker->mDeque.Pop(run_args) || mRunQueue.Dequeue(run_args))
+    return true;
+
+  if (!mWorkStealing)
+    return false;
+
+  // Steal the oldest routine from other threads, starting at a random one.
+  const uint32_t num_workers = static_cast<uint32_t>(mNumWorkers);
+  const uint32_t start = NextRandom(worker->mRandomSeed) % num_workers;
+  for (uint32_t i = 0; i < num_workers; ++i) {
+    const uint32_t victim = (start + i) % num_workers;
+    if (victim != worker->mIndex && mWorkers[victim].mDeque.Steal(run_args))
+      return true;
+  }
+  return false;
 }
 
 ThreadPool::ThreadPool()
@@ -23,10 +150,11 @@ ThreadPool::ThreadPool()
       mNumThreads(0) {
 }
 
-ThreadPool::ThreadPool(size_t num_threads, void* buffer, size_t buffer_size)
+ThreadPool::ThreadPool(size_t num_threads, void* buffer, size_t buffer_size,
+                       size_t worker_queue_size)
     : mThreads(NULL),
       mNumThreads(0) {
-  Initialize(num_threads, buffer, buffer_size);
+  Initialize(num_threads, buffer, buffer_size, worker_queue_size);
 }
 
 ThreadPool::~ThreadPool() {
@@ -36,24 +164,43 @@ ThreadPool::~ThreadPool() {
   for (size_t i = 0; i < num_threads; ++i) {
     // Explicitly call destructor for placement new.
     mThreads[i].~Thread();
+    mThreadData.mWorkers[i].~WorkerData();
   }
 }
 
-void ThreadPool::Initialize(size_t num_threads,
-                            void* buffer, size_t buffer_size) {
+void ThreadPool::Initialize(size_t num_threads, void* buffer,
+                            size_t buffer_size, size_t worker_queue_size) {
   const size_t thread_size = sizeof(platform::Thread) * num_threads;
-  YASSERT(buffer_size > thread_size,
+  const size_t deque_size =
+      TypedWorkStealingDeque<RunArgs>::GetAllocationSize(worker_queue_size);
+  const size_t worker_size = (sizeof(WorkerData) + deque_size) * num_threads;
+  YASSERT(buffer_size > thread_size + worker_size,
           "Buffer size is not big enough to contain ThreadPool");
 
-  YASSERT(((buffer_size - thread_size) /
-            sizeof(ThreadPool::RunArgs)) > 0,
+  YASSERT(((buffer_size - thread_size - worker_size) /
+            AtomicMPMCQueue::GetSlotSize(sizeof(ThreadPool::RunArgs))) > 0,
           "Number of run arguments must be greater than 0");
 
-  mThreads = new (buffer) platform::Thread[num_threads];
+  uint8_t* buffer_iter = static_cast<uint8_t*>(buffer);
+  mThreads = new (buffer_iter) platform::Thread[num_threads];
+  buffer_iter += thread_size;
+
+  WorkerData* workers = reinterpret_cast<WorkerData*>(buffer_iter);
+  buffer_iter += sizeof(WorkerData) * num_threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    WorkerData* worker = new (&workers[i]) WorkerData;
+    worker->mThreadData = &mThreadData;
+    worker->mIndex = static_cast<uint32_t>(i);
+    worker->mRandomSeed = static_cast<uint32_t>(i) * 2654435761u + 1;
+    worker->mDeque.Initialize(reinterpret_cast<RunArgs*>(buffer_iter),
+                              deque_size, worker_queue_size);
+    buffer_iter += deque_size;
+  }
+
   mNumThreads = num_threads;
-  mThreadData.Initialize(num_threads,
-                         static_cast<uint8_t*>(buffer) + thread_size,
-                         buffer_size - thread_size);
+  mThreadData.Initialize(num_threads, buffer_iter,
+                         buffer_size - thread_size - worker_size, workers,
+                         worker_queue_size > 0);
 }
 
 bool ThreadPool::EnqueueRun(platform::ThreadRoutine thread_routine,
@@ -62,7 +209,12 @@ bool ThreadPool::EnqueueRun(platform::ThreadRoutine thread_routine,
     thread_routine,
     thread_args,
   };
-  if (mThreadData.mRunQueue.Enqueue(run_args)) {
+
+  // Routines enqueued from one of our own threads stay local to it.
+  WorkerData* worker = static_cast<WorkerData*>(gCurrentWorker);
+  const bool local = worker && worker->mThreadData == &mThreadData &&
+                     worker->mDeque.Push(run_args);
+  if (local || mThreadData.mRunQueue.Enqueue(run_args)) {
     if (mThreadData.mRunState == ThreadData::kRunState_Running) {
       mThreadData.mSemaphore.Release();
     }
@@ -72,6 +224,58 @@ bool ThreadPool::EnqueueRun(platform::ThreadRoutine thread_routine,
   return false;
 }
 
+uint32_t ThreadPool::GetCurrentThreadIndex() {
+  const WorkerData* worker = static_cast<const WorkerData*>(gCurrentWorker);
+  return worker ? worker->mIndex : INVALID_THREAD_INDEX;
+}
+
+void ThreadPool::RunAndWait(platform::ThreadRoutine thread_routine,
+                            void* args, size_t arg_stride, size_t num_args) {
+  RunAndWaitData* run_data = NULL;
+  uint32_t slot = 0;
+  if (Running() && num_args > 1) {
+    for (; slot < NUM_RUN_AND_WAIT_SLOTS; ++slot) {
+      if (AtomicCmpSet32(&gRunAndWaitSlots[slot].mInUse, 0, 1)) {
+        run_data = &gRunAndWaitSlots[slot];
+        break;
+      }
+    }
+  }
+
+  // Without helpers or a free slot the calling thread runs every argument.
+  if (run_data == NULL) {
+    uint8_t* arg_iter = static_cast<uint8_t*>(args);
+    for (size_t i = 0; i < num_args; ++i) {
+      thread_routine(arg_iter + i * arg_stride);
+    }
+    return;
+  }
+
+  run_data->mThreadRoutine = thread_routine;
+  run_data->mArgs = static_cast<uint8_t*>(args);
+  run_data->mArgStride = arg_stride;
+  run_data->mNumArgs = static_cast<uint32_t>(num_args);
+  run_data->mNextArg = 0;
+  run_data->mArgsFinished = 0;
+
+  // The calling thread holds a reference until every argument has run.
+  const uint64_t state = AtomicAdd64(&run_data->mState, 1) + 1;
+  void* key = reinterpret_cast<void*>(GetRunAndWaitKey(state, slot));
+  const size_t num_helpers = (num_args - 1) < mNumThreads ?
+                             (num_args - 1) : mNumThreads;
+  for (size_t i = 0; i < num_helpers; ++i) {
+    if (!EnqueueRun(RunAndWaitRoutine, key))
+      break;
+  }
+
+  // Only a helper which finished the last argument releases the semaphore.
+  if (!run_data->RunArgs())
+    run_data->mFinishedSemaphore.Wait();
+
+  // Close the generation and drop the calling thread's reference at once.
+  run_data->Leave((static_cast<uint64_t>(1) << 32) - 1);
+}
+
 bool ThreadPool::Start() {
   const ThreadData::RunState prev_run_state = mThreadData.mRunState;
   if (prev_run_state == ThreadData::kRunState_Running) {
@@ -84,7 +288,8 @@ bool ThreadPool::Start() {
   const size_t num_threads = mNumThreads;
   for (size_t i = 0; i < num_threads; ++i) {
     if (prev_run_state == ThreadData::kRunState_Stopped) {
-      mThreads[i].Initialize(ThreadPool::ThreadPoolThread, &mThreadData);
+      mThreads[i].Initialize(ThreadPool::ThreadPoolThread,
+                             &mThreadData.mWorkers[i]);
       mThreads[i].Run();
     } else {
       mThreadData.mSemaphore.Release();
@@ -106,8 +311,12 @@ bool ThreadPool::Stop(size_t milliseconds) {
   mThreadData.mRunState = ThreadData::kRunState_Stopped;
   MemoryBarrier();
 
+  // Released one at a time, a release which would pass the maximum count
+  // does nothing and queued runs can leave wake ups pending.
   const size_t num_threads = mNumThreads;
-  mThreadData.mSemaphore.Release(static_cast<int>(num_threads));
+  for (size_t i = 0; i < num_threads; ++i) {
+    mThreadData.mSemaphore.Release();
+  }
 
   return Join(milliseconds);
 }
@@ -164,7 +373,9 @@ bool ThreadPool::Join(size_t milliseconds) {
 }
 
 uintptr_t ThreadPool::ThreadPoolThread(void* arg) {
-  ThreadData* thread_data = static_cast<ThreadData*>(arg);
+  WorkerData* worker = static_cast<WorkerData*>(arg);
+  ThreadData* thread_data = worker->mThreadData;
+  gCurrentWorker = worker;
 
   RunArgs run_arg;
   for (;;) {
@@ -174,9 +385,12 @@ uintptr_t ThreadPool::ThreadPoolThread(void* arg) {
     if (run_state == ThreadData::kRunState_Stopped) {
       break;
     } else if (run_state == ThreadData::kRunState_Running &&
-               thread_data->mRunQueue.Dequeue(run_arg)) {
+               thread_data->GetNextRun(worker, run_arg)) {
       AtomicAdd32(&thread_data->mThreadsRunning, 1);
-      run_arg.thread_routine(run_arg.thread_args);
+      {
+        YPROFILE_ZONE("ThreadPool Job");
+        run_arg.thread_routine(run_arg.thread_args);
+      }
       AtomicAdd32(&thread_data->mThreadsRunning, static_cast<uint32_t>(-1));
       thread_data->mParentSemaphore.Release();
       continue;
@@ -185,6 +399,8 @@ uintptr_t ThreadPool::ThreadPoolThread(void* arg) {
     // Idle, Stopped, or nothing enqueued
     thread_data->mSemaphore.Wait();
   }
+
+  gCurrentWorker = NULL;
   return 0;
 }
 
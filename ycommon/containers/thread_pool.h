@@ -1,9 +1,11 @@
 #ifndef YCOMMON_CONTAINERS_THREAD_POOL_H
 #define YCOMMON_CONTAINERS_THREAD_POOL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
-#include "ycommon/containers/atomic_queue.h"
+#include "ycommon/containers/atomic_mpmc_queue.h"
+#include "ycommon/containers/work_stealing_deque.h"
 #include "ycommon/platform/semaphore.h"
 #include "ycommon/platform/thread.h"
 
@@ -11,10 +13,18 @@
 * ThreadPool handles a number of threads and allows someone to
 *   enqueue thread routines.
 *
+*   - Routines may enqueue more routines from within the pool threads.
+*   - With a WORKER_QUEUE_SIZE, every thread also owns a work stealing deque.
+*     Routines enqueued from within a pool thread go to its own deque and
+*     idle threads steal from random other threads.
 *   - Space Requirements: sizeof(platform::Thread) * NUM_THREADS +
-*                         sizeof(YThread::RunArgs) * QUEUE_SIZE
+*                         AtomicMPMCQueue slots of RunArgs * QUEUE_SIZE +
+*                         (sizeof(WorkerData) +
+*                          sizeof(RunArgs) * WORKER_QUEUE_SIZE) * NUM_THREADS
 ************************/
 
+#define INVALID_THREAD_INDEX static_cast<uint32_t>(-1)
+
 namespace ycommon { namespace containers {
 
 class ThreadPool {
@@ -24,13 +34,33 @@ class ThreadPool {
     void* thread_args;
   };
 
+  static size_t GetAllocationSize(size_t num_threads, size_t queue_size,
+                                  size_t worker_queue_size = 0) {
+    return sizeof(platform::Thread) * num_threads +
+           TypedAtomicMPMCQueue<RunArgs>::GetAllocationSize(queue_size) +
+           (sizeof(WorkerData) +
+            TypedWorkStealingDeque<RunArgs>::GetAllocationSize(
+                worker_queue_size)) * num_threads;
+  }
+
   ThreadPool();
-  ThreadPool(size_t num_threads, void* buffer, size_t buffer_size);
+  ThreadPool(size_t num_threads, void* buffer, size_t buffer_size,
+             size_t worker_queue_size = 0);
   ~ThreadPool();
 
-  void Initialize(size_t num_threads, void* buffer, size_t buffer_size);
+  // A worker_queue_size of 0 disables work stealing.
+  void Initialize(size_t num_threads, void* buffer, size_t buffer_size,
+                  size_t worker_queue_size = 0);
   bool EnqueueRun(platform::ThreadRoutine thread_routine, void* thread_args);
 
+  // Runs thread_routine once for each of the num_args arguments (spaced
+  // arg_stride bytes apart) and waits for all of them to finish. The calling
+  // thread runs arguments as well, so this also works when the pool is not
+  // running or when every pool thread is busy. Helpers which only start
+  // after every argument ran return at once.
+  void RunAndWait(platform::ThreadRoutine thread_routine,
+                  void* args, size_t arg_stride, size_t num_args);
+
   bool Start();
   bool Pause();
   bool Stop(size_t milliseconds = -1);
@@ -47,23 +77,48 @@ class ThreadPool {
     return mThreadData.mRunState == ThreadData::kRunState_Paused;
   }
 
+  size_t GetNumThreads() const {
+    return mNumThreads;
+  }
+
   size_t GetQueueSize() const {
     return mThreadData.mRunQueue.Size();
   }
 
+  size_t GetWorkerQueueSize() const {
+    return mNumThreads ? mThreadData.mWorkers[0].mDeque.Size() : 0;
+  }
+
+  // Index of the pool thread running the caller, INVALID_THREAD_INDEX when
+  // the caller is not a pool thread.
+  static uint32_t GetCurrentThreadIndex();
+
  protected:
   static uintptr_t ThreadPoolThread(void* arg);
 
  protected:
+  struct ThreadData;
+  struct WorkerData {
+    ThreadData* mThreadData;
+    uint32_t mIndex;
+    uint32_t mRandomSeed;
+    TypedWorkStealingDeque<RunArgs> mDeque;
+  };
+
   platform::Thread* mThreads;
   size_t mNumThreads;
 
   struct ThreadData {
     ThreadData()
       : mRunState(kRunState_Invalid),
-        mThreadsRunning(0) {}
+        mThreadsRunning(0),
+        mWorkers(NULL),
+        mNumWorkers(0),
+        mWorkStealing(false) {}
 
-    void Initialize(size_t num_threads, void* buffer, size_t buffer_size);
+    void Initialize(size_t num_threads, void* buffer, size_t buffer_size,
+                    WorkerData* workers, bool work_stealing);
+    bool GetNextRun(WorkerData* worker, RunArgs& run_args);
 
     volatile enum RunState {
       kRunState_Invalid,
@@ -75,20 +130,29 @@ class ThreadPool {
 
     platform::Semaphore mSemaphore;
     platform::Semaphore mParentSemaphore;
-    TypedAtomicQueue<RunArgs> mRunQueue;
+    TypedAtomicMPMCQueue<RunArgs> mRunQueue;
     volatile uint32_t mThreadsRunning;
+    WorkerData* mWorkers;
+    size_t mNumWorkers;
+    bool mWorkStealing;
   } mThreadData;
 };
 
-template <size_t NUM_THREADS, size_t QUEUE_SIZE>
+template <size_t NUM_THREADS, size_t QUEUE_SIZE, size_t WORKER_QUEUE_SIZE = 0>
 class ContainedThreadPool : public ThreadPool {
  public:
-  ContainedThreadPool() : ThreadPool(NUM_THREADS, mBuffer, sizeof(mBuffer)) {}
+  ContainedThreadPool()
+      : ThreadPool(NUM_THREADS, mBuffer, sizeof(mBuffer), WORKER_QUEUE_SIZE) {}
   ~ContainedThreadPool() {}
 
  private:
+  ALIGN_FRONT(8)
   uint8_t mBuffer[sizeof(platform::Thread) * NUM_THREADS +
-                  sizeof(ThreadPool::RunArgs) * QUEUE_SIZE];
+                  (ROUND_UP(sizeof(ThreadPool::RunArgs), sizeof(uint64_t)) +
+                   sizeof(uint64_t)) * QUEUE_SIZE +
+                  (sizeof(ThreadPool::WorkerData) +
+                   sizeof(ThreadPool::RunArgs) * WORKER_QUEUE_SIZE) *
+                  NUM_THREADS] ALIGN_BACK(8);
 };
 
 }} // namespace ycommon { namespace containers {
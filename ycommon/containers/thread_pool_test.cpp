@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include "ycommon/headers/atomics.h"
+#include "ycommon/headers/macros.h"
 #include "ycommon/platform/semaphore.h"
 #include "ycommon/platform/timer.h"
 
@@ -42,18 +43,59 @@ static uintptr_t ReleaseWaitSemaphoreRoutine(void* arg) {
   return 0;
 }
 
+struct SpawnArg {
+  ThreadPool* thread_pool;
+  volatile uint32_t* num;
+  volatile uint32_t* num_left;
+  platform::Semaphore* semaphore;
+};
+
+static uintptr_t SpawnIncrementRoutine(void* arg) {
+  SpawnArg* arg_data = static_cast<SpawnArg*>(arg);
+  AtomicAdd32(arg_data->num, 1);
+
+  // Each spawned routine enqueues the next one from within the pool.
+  if (AtomicAdd32(arg_data->num_left, static_cast<uint32_t>(-1)) > 1) {
+    while (!arg_data->thread_pool->EnqueueRun(SpawnIncrementRoutine, arg)) {}
+  } else {
+    arg_data->semaphore->Release();
+  }
+  return 0;
+}
+
 static uintptr_t WaitSemaphoreRoutine(void* arg) {
   platform::Semaphore* semaphore = static_cast<platform::Semaphore*>(arg);
   semaphore->Wait();
   return 0;
 }
 
+struct RunAndWaitArg {
+  ThreadPool* thread_pool;
+  IncrementArg* args;
+  size_t num_args;
+  platform::Semaphore* semaphore;
+};
+
+static uintptr_t RunAndWaitRoutine(void* arg) {
+  RunAndWaitArg* arg_data = static_cast<RunAndWaitArg*>(arg);
+  arg_data->thread_pool->RunAndWait(IncrementRoutine, arg_data->args,
+                                    sizeof(arg_data->args[0]),
+                                    arg_data->num_args);
+  arg_data->semaphore->Release();
+  return 0;
+}
+
 TEST(BasicThreadPoolTest, ConstructorTest) {
   char buffer[512];
   ThreadPool pool(2, buffer, sizeof(buffer));
 
   ContainedThreadPool<2, 10> contained_pool;
   ASSERT_EQ(contained_pool.GetQueueSize(), 10);
+  ASSERT_EQ(contained_pool.GetWorkerQueueSize(), 0);
+
+  ContainedThreadPool<2, 10, 16> stealing_pool;
+  ASSERT_EQ(stealing_pool.GetQueueSize(), 10);
+  ASSERT_EQ(stealing_pool.GetWorkerQueueSize(), 16);
 }
 
 TEST(BasicThreadPoolTest, IncrementRoutineTest) {
@@ -130,6 +172,50 @@ TEST(BasicThreadPoolTest, EnqueueMultiple) {
   EXPECT_EQ(10, num);
 }
 
+TEST(BasicThreadPoolTest, SpawnRunsTest) {
+  volatile uint32_t num = 0;
+  volatile uint32_t num_left = 100;
+  platform::Semaphore semaphore(0, 1);
+  ContainedThreadPool<2, 10> thread_pool;
+  SpawnArg arg_data = { &thread_pool, &num, &num_left, &semaphore };
+
+  thread_pool.Start();
+  ASSERT_TRUE(thread_pool.EnqueueRun(SpawnIncrementRoutine, &arg_data));
+  ASSERT_TRUE(semaphore.Wait(500));
+  ASSERT_TRUE(thread_pool.Stop(50));
+  EXPECT_EQ(100, num);
+}
+
+TEST(BasicThreadPoolTest, WorkStealingSpawnRunsTest) {
+  volatile uint32_t num = 0;
+  volatile uint32_t num_left = 100;
+  platform::Semaphore semaphore(0, 1);
+  ContainedThreadPool<2, 10, 4> thread_pool;
+  SpawnArg arg_data = { &thread_pool, &num, &num_left, &semaphore };
+
+  thread_pool.Start();
+  ASSERT_TRUE(thread_pool.EnqueueRun(SpawnIncrementRoutine, &arg_data));
+  ASSERT_TRUE(semaphore.Wait(500));
+  ASSERT_TRUE(thread_pool.Stop(50));
+  EXPECT_EQ(100, num);
+}
+
+TEST(BasicThreadPoolTest, WorkStealingEnqueueMultiple) {
+  volatile uint32_t num = 0;
+  platform::Semaphore semaphore(0, 1);
+  IncrementArg arg_data = { &num };
+  ContainedThreadPool<4, 20, 8> thread_pool;
+
+  thread_pool.Start();
+  for (int i = 0; i < 10; ++i) {
+    thread_pool.EnqueueRun(IncrementRoutine, &arg_data);
+  }
+  ASSERT_TRUE(thread_pool.EnqueueRun(ReleaseSemaphoreRoutine, &semaphore));
+  ASSERT_TRUE(semaphore.Wait(50));
+  ASSERT_TRUE(thread_pool.Stop(50));
+  EXPECT_EQ(10, num);
+}
+
 TEST(BasicThreadPoolTest, StartStopTest) {
   volatile uint32_t num = 0;
   platform::Semaphore semaphore(0, 1);
@@ -249,4 +335,42 @@ TEST(BasicThreadPoolTest, StopJoinTest) {
   EXPECT_TRUE(thread_pool.Join(50));
 }
 
+TEST(BasicThreadPoolTest, RunAndWaitTest) {
+  volatile uint32_t num = 0;
+  IncrementArg args[16];
+  for (size_t i = 0; i < ARRAY_SIZE(args); ++i) {
+    args[i].num = &num;
+  }
+  ContainedThreadPool<2, 10> thread_pool;
+
+  ASSERT_TRUE(thread_pool.Start());
+  for (int i = 0; i < 10; ++i) {
+    thread_pool.RunAndWait(IncrementRoutine, args, sizeof(args[0]),
+                           ARRAY_SIZE(args));
+  }
+  EXPECT_EQ(10 * ARRAY_SIZE(args), num);
+  ASSERT_TRUE(thread_pool.Stop(50));
+}
+
+TEST(BasicThreadPoolTest, RunAndWaitFromPoolThreadTest) {
+  volatile uint32_t num = 0;
+  IncrementArg args[8];
+  for (size_t i = 0; i < ARRAY_SIZE(args); ++i) {
+    args[i].num = &num;
+  }
+  platform::Semaphore semaphore(0, 1);
+  ContainedThreadPool<1, 10, 16> thread_pool;
+  RunAndWaitArg arg_data = { &thread_pool, args, ARRAY_SIZE(args),
+                             &semaphore };
+
+  // The helpers land behind the caller on the only pool thread, the caller
+  // runs every argument and the helpers return once they start.
+  ASSERT_TRUE(thread_pool.Start());
+  ASSERT_TRUE(thread_pool.EnqueueRun(RunAndWaitRoutine, &arg_data));
+  ASSERT_TRUE(semaphore.Wait(1000));
+  EXPECT_EQ(ARRAY_SIZE(args), num);
+  ASSERT_TRUE(thread_pool.Stop(50));
+  EXPECT_EQ(ARRAY_SIZE(args), num);
+}
+
 }} // namespace ycommon { namespace containers {
@@ -0,0 +1,136 @@
+#include "ycommon/containers/thread_pool.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/platform/semaphore.h"
+#include "ycommon/platform/timer.h"
+
+// Every job spawns 2 more jobs until the tree is TREE_DEPTH deep.
+#define TREE_DEPTH 15
+#define NUM_JOBS ((1 << (TREE_DEPTH + 1)) - 1)
+#define JOB_WORK 64
+#define NUM_ITERATIONS 5
+
+namespace ycommon { namespace containers {
+
+struct SpawnTreeData;
+
+struct SpawnTreeJob {
+  SpawnTreeData* tree_data;
+  uint32_t index;
+};
+
+struct SpawnTreeData {
+  ThreadPool* thread_pool;
+  SpawnTreeJob* jobs;
+  volatile uint32_t jobs_left;
+  volatile uint32_t work_result;
+  platform::Semaphore finished_semaphore;
+
+  SpawnTreeData() : finished_semaphore(0, 1) {}
+};
+
+static uintptr_t SpawnTreeRoutine(void* arg) {
+  SpawnTreeJob* job = static_cast<SpawnTreeJob*>(arg);
+  SpawnTreeData* tree_data = job->tree_data;
+
+  // Small amount of busy work to stand in for a fine grained job.
+  uint32_t work = job->index;
+  for (int i = 0; i < JOB_WORK; ++i) {
+    work = work * 1664525u + 1013904223u;
+  }
+  tree_data->work_result ^= work;
+
+  const uint32_t first_child = job->index * 2 + 1;
+  for (uint32_t child = first_child;
+       child < first_child + 2 && child < NUM_JOBS; ++child) {
+    SpawnTreeJob* child_job = &tree_data->jobs[child];
+    if (!tree_data->thread_pool->EnqueueRun(SpawnTreeRoutine, child_job))
+      SpawnTreeRoutine(child_job);
+  }
+
+  if (AtomicAdd32(&tree_data->jobs_left, static_cast<uint32_t>(-1)) == 1)
+    tree_data->finished_semaphore.Release();
+  return 0;
+}
+
+class ThreadPoolPerfTest : public ::testing::Test {
+ public:
+  // Returns the average microseconds to run the whole job tree.
+  float RunTree(size_t num_threads, size_t worker_queue_size) {
+    const size_t queue_size = 256;
+    const size_t buffer_size = ThreadPool::GetAllocationSize(
+        num_threads, queue_size, worker_queue_size);
+    uint64_t* buffer = new uint64_t[(buffer_size + 7) / 8];
+    SpawnTreeJob* jobs = new SpawnTreeJob[NUM_JOBS];
+
+    platform::Timer timer;
+    {
+      ThreadPool thread_pool(num_threads, buffer, buffer_size,
+                             worker_queue_size);
+      SpawnTreeData tree_data;
+      tree_data.thread_pool = &thread_pool;
+      tree_data.jobs = jobs;
+      for (uint32_t i = 0; i < NUM_JOBS; ++i) {
+        jobs[i].tree_data = &tree_data;
+        jobs[i].index = i;
+      }
+
+      EXPECT_TRUE(thread_pool.Start());
+      timer.Start();
+      for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        tree_data.jobs_left = NUM_JOBS;
+        MemoryBarrier();
+        EXPECT_TRUE(thread_pool.EnqueueRun(SpawnTreeRoutine, &jobs[0]));
+        tree_data.finished_semaphore.Wait();
+      }
+      timer.Pulse();
+      EXPECT_TRUE(thread_pool.Stop());
+    }
+
+    delete [] jobs;
+    delete [] buffer;
+    return timer.GetPulsedTimeMicroFloat() / NUM_ITERATIONS;
+  }
+
+  void RunBenchmark(size_t num_threads) {
+    const float shared_time = RunTree(num_threads, 0);
+    const float stealing_time = RunTree(num_threads, 1024);
+    printf("[THREADPOOL] %2u threads, %u jobs: shared queue %9.1fus, "
+           "work stealing %9.1fus\n",
+           static_cast<uint32_t>(num_threads), NUM_JOBS,
+           shared_time, stealing_time);
+  }
+};
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs1) {
+  RunBenchmark(1);
+}
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs2) {
+  RunBenchmark(2);
+}
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs4) {
+  RunBenchmark(4);
+}
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs8) {
+  RunBenchmark(8);
+}
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs16) {
+  RunBenchmark(16);
+}
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs32) {
+  RunBenchmark(32);
+}
+
+TEST_F(ThreadPoolPerfTest, FineGrainedJobs64) {
+  RunBenchmark(64);
+}
+
+}} // namespace ycommon { namespace containers {
@@ -1,6 +1,6 @@
 #include "unordered_array.h"
 
-#include <string>
+#include <string.h>
 
 #include "ycommon/utils/assert.h"
 
@@ -1,7 +1,9 @@
 #ifndef YCOMMON_CONTAINERS_UNORDERED_ARRAY_H
 #define YCOMMON_CONTAINERS_UNORDERED_ARRAY_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 /*******
 * Array where index is not kept constant useful for keeping track of
@@ -70,7 +72,8 @@ class TypedUnorderedArray : public UnorderedArray {
 
   uint32_t PushBack(const T* data) {
     const uint32_t index = Allocate();
-    memcpy(GetData(index), data, sizeof(data));
+    if (index != static_cast<uint32_t>(-1))
+      memcpy(GetData(index), data, sizeof(T));
     return index;
   }
 
@@ -96,12 +99,13 @@ class ContainedUnorderedArray : public TypedUnorderedArray<T> {
     return sizeof(T) * items;
   }
 
-  ContainedUnorderedArray() : TypedUnorderedArray(mData, sizeof(mData), items) {
+  ContainedUnorderedArray()
+      : TypedUnorderedArray<T>(mData, sizeof(mData), items) {
   }
   ~ContainedUnorderedArray() {}
 
   void Init() {
-    TypedUnorderedArray::Init(mData, sizeof(mData), items);
+    TypedUnorderedArray<T>::Init(mData, sizeof(mData), items);
   }
 
  private:
@@ -116,6 +116,19 @@ class BaseUnorderedArrayTest : public ::testing::Test {
     EXPECT_EQ(insertion_data2, array[1]);
   }
 
+  void DoFullArray() {
+    ContainedArray array;
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_EQ(i, array.PushBack(100+i));
+    }
+
+    EXPECT_EQ(static_cast<uint32_t>(-1), array.PushBack(200));
+    EXPECT_EQ(10, array.GetCount());
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_EQ(100+i, array[i]);
+    }
+  }
+
   void DoReuse() {
     ContainedArray array;
 
@@ -162,6 +175,7 @@ MEMPOOL_TEST(GetCountTest)
 MEMPOOL_TEST(CallbackTest)
 MEMPOOL_TEST(TypedArrayFunctions)
 MEMPOOL_TEST(ContainedArrayFunctions)
+MEMPOOL_TEST(FullArray)
 MEMPOOL_TEST(Reuse)
 
 }} // namespace ycommon { namespace containers {
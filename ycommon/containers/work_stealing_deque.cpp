@@ -0,0 +1,113 @@
+#include "ycommon/containers/work_stealing_deque.h"
+
+#include <string.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/utils/assert.h"
+
+namespace ycommon { namespace containers {
+
+WorkStealingDeque::WorkStealingDeque()
+    : mBuffer(NULL),
+      mItemSize(0),
+      mNumItems(0),
+      mTop(0),
+      mBottom(0) {
+}
+
+WorkStealingDeque::WorkStealingDeque(void* buffer, size_t buffer_size,
+                                     size_t item_size, size_t num_items)
+    : mBuffer(NULL),
+      mItemSize(0),
+      mNumItems(0),
+      mTop(0),
+      mBottom(0) {
+  Initialize(buffer, buffer_size, item_size, num_items);
+}
+
+WorkStealingDeque::~WorkStealingDeque() {
+}
+
+void WorkStealingDeque::Initialize(void* buffer, size_t buffer_size,
+                                   size_t item_size, size_t num_items) {
+  YASSERT(buffer_size >= (item_size * num_items),
+          "Work Stealing Deque %u[%u] requires at least %u bytes, "
+          "supplied %u bytes.",
+          static_cast<uint32_t>(item_size), static_cast<uint32_t>(num_items),
+          static_cast<uint32_t>(item_size * num_items),
+          static_cast<uint32_t>(buffer_size));
+
+  mBuffer = static_cast<uint8_t*>(buffer);
+  mItemSize = item_size;
+  mNumItems = num_items;
+  mTop = 0;
+  mBottom = 0;
+  MemoryBarrier();
+}
+
+bool WorkStealingDeque::Push(const void* data_item) {
+  const int64_t bottom = mBottom;
+  const int64_t top = mTop;
+  AcquireFence();
+
+  // Slots are only reused once the top has moved past them.
+  if (bottom - top >= static_cast<int64_t>(mNumItems))
+    return false;
+
+  memcpy(GetItem(bottom), data_item, mItemSize);
+
+  // Item must be visible to thieves before the bottom is moved past it.
+  ReleaseFence();
+  mBottom = bottom + 1;
+  return true;
+}
+
+bool WorkStealingDeque::Pop(void* data_item) {
+  const int64_t bottom = mBottom - 1;
+  mBottom = bottom;
+
+  // Thieves must see the reserved bottom before the top is read.
+  MemoryBarrier();
+  const int64_t top = mTop;
+
+  if (top > bottom) {
+    // Empty, restore the bottom.
+    mBottom = top;
+    return false;
+  }
+
+  memcpy(data_item, GetItem(bottom), mItemSize);
+  if (top < bottom)
+    return true;
+
+  // Last item, race any thieves for it through the top.
+  const bool won = AtomicCmpSet64(&mTop, top, top + 1);
+  mBottom = top + 1;
+  return won;
+}
+
+bool WorkStealingDeque::Steal(void* data_item) {
+  const int64_t top = mTop;
+  MemoryBarrier();
+  const int64_t bottom = mBottom;
+  AcquireFence();
+
+  if (top >= bottom)
+    return false;
+
+  // The slot cannot be reused while the top still points to it, so the copy
+  // is only valid if claiming the top succeeds.
+  memcpy(data_item, GetItem(top), mItemSize);
+  return AtomicCmpSet64(&mTop, top, top + 1);
+}
+
+size_t WorkStealingDeque::CurrentSize() const {
+  const int64_t top = mTop;
+  const int64_t bottom = mBottom;
+  MemoryBarrier();
+
+  // Only a snapshot, both ends may be moving concurrently.
+  return (bottom > top) ? static_cast<size_t>(bottom - top) : 0;
+}
+
+}} // namespace ycommon { namespace containers {
@@ -0,0 +1,97 @@
+#ifndef YCOMMON_CONTAINERS_WORK_STEALING_DEQUE_H
+#define YCOMMON_CONTAINERS_WORK_STEALING_DEQUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ycommon/headers/macros.h"
+
+/*******
+* Bounded Chase-Lev work stealing deque with fixed size elements.
+*  - Single owner (Only the owning thread can Push and Pop, from the bottom)
+*  - Multiple thieves (Any number of threads can Steal, from the top)
+*  - Space Requirements: item_size * num_items
+********/
+namespace ycommon { namespace containers {
+
+class WorkStealingDeque {
+ public:
+  static size_t GetAllocationSize(size_t item_size, size_t num_items) {
+    return item_size * num_items;
+  }
+
+  WorkStealingDeque();
+  WorkStealingDeque(void* buffer, size_t buffer_size,
+                    size_t item_size, size_t num_items);
+  ~WorkStealingDeque();
+
+  void Initialize(void* buffer, size_t buffer_size,
+                  size_t item_size, size_t num_items);
+
+  // Owner thread only.
+  bool Push(const void* data_item);
+  bool Pop(void* data_item);
+
+  // Any thread, fails if empty or if it lost a race for the top item.
+  bool Steal(void* data_item);
+
+  size_t CurrentSize() const;
+  size_t ItemSize() const { return mItemSize; }
+  size_t Size() const { return mNumItems; }
+
+ private:
+  uint8_t* GetItem(int64_t position) const {
+    return mBuffer +
+           static_cast<size_t>(static_cast<uint64_t>(position) % mNumItems) *
+           mItemSize;
+  }
+
+  uint8_t* mBuffer;
+  size_t mItemSize;
+  size_t mNumItems;
+  volatile int64_t mTop;
+  volatile int64_t mBottom;
+};
+
+template<typename T>
+class TypedWorkStealingDeque : public WorkStealingDeque {
+ public:
+  static size_t GetAllocationSize(size_t num_items) {
+    return WorkStealingDeque::GetAllocationSize(sizeof(T), num_items);
+  }
+
+  TypedWorkStealingDeque() : WorkStealingDeque() {}
+  TypedWorkStealingDeque(T* buffer, size_t buffer_size, size_t num_items)
+      : WorkStealingDeque(buffer, buffer_size, sizeof(T), num_items) {}
+
+  void Initialize(T* buffer, size_t buffer_size, size_t num_items) {
+    WorkStealingDeque::Initialize(buffer, buffer_size, sizeof(T), num_items);
+  }
+
+  bool Push(const T& data_item) {
+    return WorkStealingDeque::Push(static_cast<const void*>(&data_item));
+  }
+
+  bool Pop(T& data_item) {
+    return WorkStealingDeque::Pop(static_cast<void*>(&data_item));
+  }
+
+  bool Steal(T& data_item) {
+    return WorkStealingDeque::Steal(static_cast<void*>(&data_item));
+  }
+};
+
+template<typename T, size_t items>
+class ContainedWorkStealingDeque : public TypedWorkStealingDeque<T> {
+ public:
+  ContainedWorkStealingDeque()
+      : TypedWorkStealingDeque<T>(mBuffer, sizeof(mBuffer), items) {}
+  ~ContainedWorkStealingDeque() {}
+
+ private:
+  T mBuffer[items];
+};
+
+}} // namespace ycommon { namespace containers {
+
+#endif // YCOMMON_CONTAINERS_WORK_STEALING_DEQUE_H
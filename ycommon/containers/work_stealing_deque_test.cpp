@@ -0,0 +1,98 @@
+#include "ycommon/containers/work_stealing_deque.h"
+
+#include <gtest/gtest.h>
+
+#include "ycommon/headers/macros.h"
+
+namespace ycommon { namespace containers {
+
+TEST(BasicWorkStealingDequeTest, ConstructorTest) {
+  int deque_data[1];
+  WorkStealingDeque deque(deque_data, sizeof(deque_data), sizeof(int), 1);
+
+  TypedWorkStealingDeque<int> typed_deque(deque_data, sizeof(deque_data),
+                                          ARRAY_SIZE(deque_data));
+
+  ContainedWorkStealingDeque<int, 1> contained_deque;
+}
+
+TEST(BasicWorkStealingDequeTest, SizeTest) {
+  int deque_data[4];
+  TypedWorkStealingDeque<int> deque(deque_data, sizeof(deque_data),
+                                    ARRAY_SIZE(deque_data));
+  EXPECT_EQ(sizeof(int), deque.ItemSize());
+  EXPECT_EQ(ARRAY_SIZE(deque_data), deque.Size());
+  EXPECT_EQ(0, deque.CurrentSize());
+
+  ASSERT_TRUE(deque.Push(1));
+  ASSERT_TRUE(deque.Push(2));
+  EXPECT_EQ(2, deque.CurrentSize());
+}
+
+TEST(BasicWorkStealingDequeTest, PopTest) {
+  ContainedWorkStealingDeque<int, 4> deque;
+
+  ASSERT_TRUE(deque.Push(1));
+  ASSERT_TRUE(deque.Push(2));
+
+  // Owner pops the newest item first.
+  int data = 0;
+  ASSERT_TRUE(deque.Pop(data));
+  EXPECT_EQ(2, data);
+  ASSERT_TRUE(deque.Pop(data));
+  EXPECT_EQ(1, data);
+  ASSERT_FALSE(deque.Pop(data));
+}
+
+TEST(BasicWorkStealingDequeTest, StealTest) {
+  ContainedWorkStealingDeque<int, 4> deque;
+
+  ASSERT_TRUE(deque.Push(1));
+  ASSERT_TRUE(deque.Push(2));
+
+  // Thieves take the oldest item first.
+  int data = 0;
+  ASSERT_TRUE(deque.Steal(data));
+  EXPECT_EQ(1, data);
+  ASSERT_TRUE(deque.Pop(data));
+  EXPECT_EQ(2, data);
+  ASSERT_FALSE(deque.Steal(data));
+  ASSERT_FALSE(deque.Pop(data));
+}
+
+TEST(BasicWorkStealingDequeTest, FullPushTest) {
+  ContainedWorkStealingDeque<int, 2> deque;
+
+  ASSERT_TRUE(deque.Push(1));
+  ASSERT_TRUE(deque.Push(2));
+  ASSERT_FALSE(deque.Push(3));
+
+  int data = 0;
+  ASSERT_TRUE(deque.Steal(data));
+  ASSERT_TRUE(deque.Push(3));
+}
+
+TEST(BasicWorkStealingDequeTest, EmptyDequeTest) {
+  int data = 0;
+  TypedWorkStealingDeque<int> deque(NULL, 0, 0);
+  ASSERT_FALSE(deque.Push(data));
+  ASSERT_FALSE(deque.Pop(data));
+  ASSERT_FALSE(deque.Steal(data));
+}
+
+TEST(BasicWorkStealingDequeTest, ReuseTest) {
+  ContainedWorkStealingDeque<int, 3> deque;
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(deque.Push(i));
+    ASSERT_TRUE(deque.Push(i + 100));
+
+    int data = -1;
+    ASSERT_TRUE(deque.Steal(data));
+    EXPECT_EQ(i, data);
+    ASSERT_TRUE(deque.Pop(data));
+    EXPECT_EQ(i + 100, data);
+  }
+}
+
+}} // namespace ycommon { namespace containers {
@@ -0,0 +1,99 @@
+#include "ycommon/containers/work_stealing_deque.h"
+
+#include <gtest/gtest.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/platform/thread.h"
+
+#define NUM_THIEVES 4
+#define NUM_VALUES 20000
+
+namespace ycommon { namespace containers {
+
+struct StealArg {
+  TypedWorkStealingDeque<uint32_t>* deque;
+  volatile uint32_t* taken_counts;
+  volatile uint32_t* keep_going;
+};
+
+void TakeValue(StealArg* arg_data, uint32_t value) {
+  AtomicAdd32(&arg_data->taken_counts[value], 1);
+}
+
+uintptr_t StealRoutine(void* arg) {
+  StealArg* arg_data = static_cast<StealArg*>(arg);
+
+  // Drain once more after keep_going is cleared.
+  uint32_t keep_going = 1;
+  uint32_t value = 0;
+  while (keep_going) {
+    keep_going = *arg_data->keep_going;
+    MemoryBarrier();
+    while (arg_data->deque->CurrentSize()) {
+      if (arg_data->deque->Steal(value))
+        TakeValue(arg_data, value);
+    }
+  }
+  return 0;
+}
+
+/************
+* Test Definitions
+*************/
+template <uint32_t DEQUE_SIZE>
+class ThreadedStealTest : public ::testing::Test {
+ public:
+  void RunTest(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      volatile uint32_t taken_counts[NUM_VALUES] = { 0 };
+      volatile uint32_t keep_going = 1;
+      StealArg arg_data = { &mDeque, taken_counts, &keep_going };
+
+      ycommon::platform::Thread thieves[NUM_THIEVES];
+      for (int n = 0; n < NUM_THIEVES; ++n) {
+        thieves[n].Initialize(StealRoutine, &arg_data);
+        thieves[n].Run();
+      }
+
+      // Owner pushes every value and pops some of them back.
+      uint32_t value = 0;
+      for (uint32_t n = 0; n < NUM_VALUES; ++n) {
+        while (!mDeque.Push(n)) {
+          if (mDeque.Pop(value))
+            TakeValue(&arg_data, value);
+        }
+        if ((n % 3) == 0 && mDeque.Pop(value))
+          TakeValue(&arg_data, value);
+      }
+      while (mDeque.Pop(value)) {
+        TakeValue(&arg_data, value);
+      }
+
+      keep_going = 0;
+      for (int n = 0; n < NUM_THIEVES; ++n) {
+        thieves[n].Join();
+      }
+
+      // Every value must be taken exactly once.
+      for (uint32_t n = 0; n < NUM_VALUES; ++n) {
+        ASSERT_EQ(1, taken_counts[n]);
+      }
+      ASSERT_EQ(0, mDeque.CurrentSize());
+    }
+  }
+
+  ContainedWorkStealingDeque<uint32_t, DEQUE_SIZE> mDeque;
+};
+
+class SmallStealTest : public ThreadedStealTest<4> {};
+class LargeStealTest : public ThreadedStealTest<1024> {};
+
+TEST_F(SmallStealTest, SmallTests) {
+  RunTest(20);
+}
+
+TEST_F(LargeStealTest, LargeTests) {
+  RunTest(20);
+}
+
+}} // namespace ycommon { namespace containers {
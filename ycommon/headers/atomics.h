@@ -8,6 +8,9 @@ inline void MemoryBarrier();
 inline void AcquireFence();
 inline void ReleaseFence();
 
+/* Hints to the processor that the thread is spin waiting. */
+inline void CpuPause();
+
 /* Sets and returns previous value. */
 inline int32_t AtomicSet32(volatile int32_t* dest, int32_t value);
 inline int64_t AtomicSet64(volatile int64_t* dest, int64_t value);
@@ -109,7 +112,9 @@ inline uint64_t AtomicXor64(volatile uint64_t* result, uint64_t value) {
 } // namespace ycommon {
 
 #ifdef WIN
-  #include "Atomics_Win.inl"
+  #include "atomics_win.inl"
+#elif defined(LINUX)
+  #include "atomics_linux.inl"
 #endif
 
 #endif // YCOMMON_HEADERS_ATOMICS_H
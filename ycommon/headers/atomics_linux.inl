@@ -0,0 +1,84 @@
+namespace ycommon {
+
+/* Memory Barrier. */
+inline void MemoryBarrier() {
+  __sync_synchronize();
+}
+
+inline void AcquireFence() {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+inline void ReleaseFence() {
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+inline void CpuPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/* Sets and returns previous value. */
+inline int32_t AtomicSet32(volatile int32_t* dest, int32_t value) {
+  return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+}
+
+inline int64_t AtomicSet64(volatile int64_t* dest, int64_t value) {
+  return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+}
+
+inline void* AtomicSetPtr(void* volatile* dest, void* value) {
+  return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+}
+
+/* Compares dest with expected and sets to value if they match. */
+inline bool AtomicCmpSet32(volatile int32_t* dest, int32_t expected,
+                           int32_t value) {
+  return __sync_bool_compare_and_swap(dest, expected, value);
+}
+inline bool AtomicCmpSet64(volatile int64_t* dest, int64_t expected,
+                           int64_t value) {
+  return __sync_bool_compare_and_swap(dest, expected, value);
+}
+inline bool AtomicCmpSetPtr(void* volatile* dest, void* expected,
+                            void* value) {
+  return __sync_bool_compare_and_swap(dest, expected, value);
+}
+
+/* Numeric Operations, returns the previous value of the destination. */
+inline int32_t AtomicAdd32(volatile int32_t* sum, int32_t value) {
+  return __sync_fetch_and_add(sum, value);
+}
+
+inline int64_t AtomicAdd64(volatile int64_t* sum, int64_t value) {
+  return __sync_fetch_and_add(sum, value);
+}
+
+inline int32_t AtomicAnd32(volatile int32_t* result, int32_t value) {
+  return __sync_fetch_and_and(result, value);
+}
+
+inline int64_t AtomicAnd64(volatile int64_t* result, int64_t value) {
+  return __sync_fetch_and_and(result, value);
+}
+
+inline int32_t AtomicOr32(volatile int32_t* result, int32_t value) {
+  return __sync_fetch_and_or(result, value);
+}
+
+inline int64_t AtomicOr64(volatile int64_t* result, int64_t value) {
+  return __sync_fetch_and_or(result, value);
+}
+
+inline int32_t AtomicXor32(volatile int32_t* result, int32_t value) {
+  return __sync_fetch_and_xor(result, value);
+}
+
+inline int64_t AtomicXor64(volatile int64_t* result, int64_t value) {
+  return __sync_fetch_and_xor(result, value);
+}
+
+} //namespace ycommon {
@@ -16,6 +16,10 @@ inline void ReleaseFence() {
   ::MemoryBarrier();
 }
 
+inline void CpuPause() {
+  YieldProcessor();
+}
+
 /* Sets and returns previous value. */
 inline int32_t AtomicSet32(volatile int32_t* dest, int32_t value) {
   return InterlockedExchange(reinterpret_cast<volatile long*>(dest), value);
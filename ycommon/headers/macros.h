@@ -1,6 +1,7 @@
 #ifndef YCOMMON_HEADERS_MACROS_H
 #define YCOMMON_HEADERS_MACROS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /***********
@@ -31,4 +32,24 @@ namespace array_size_helper {
   #define ALIGN_BACK(x) __attribute__ ((aligned (x)))
 #endif
 
+/***********
+* THREAD_LOCAL for plain data with static storage, for each compiler.
+************/
+#ifdef _MSC_VER
+  #define THREAD_LOCAL __declspec(thread)
+#else
+  #define THREAD_LOCAL __thread
+#endif
+
+/***********
+* PREFETCH(x) hints that the cache line holding x will soon be read.
+************/
+#ifdef _MSC_VER
+  #include <xmmintrin.h>
+  #define PREFETCH(x) \
+      _mm_prefetch(reinterpret_cast<const char*>(x), _MM_HINT_T0)
+#else
+  #define PREFETCH(x) __builtin_prefetch(x)
+#endif
+
 #endif // YCOMMON_HEADERS_MACROS_H
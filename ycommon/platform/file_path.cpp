@@ -1,7 +1,7 @@
 #include "ycommon/platform/file_path.h"
 
 #include <stdint.h>
-#include <string>
+#include <string.h>
 
 #ifdef WIN
   #define IS_PATH_SEP(PATH_CHAR) (PATH_CHAR == '/' || PATH_CHAR == '\\')
@@ -1,6 +1,8 @@
 #ifndef YCOMMON_PLATFORM_FILE_PATH_H
 #define YCOMMON_PLATFORM_FILE_PATH_H
 
+#include <stddef.h>
+
 namespace ycommon { namespace platform {
 
 namespace FilePath {
@@ -0,0 +1,44 @@
+#include "ycommon/platform/file_path.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace ycommon { namespace platform {
+
+bool FilePath::IsAbsPath(const char* path) {
+  return path[0] == '/';
+}
+
+bool FilePath::IsFile(const char* filepath) {
+  struct stat file_stat;
+  return (stat(filepath, &file_stat) == 0) && S_ISREG(file_stat.st_mode);
+}
+
+bool FilePath::IsDir(const char* dirpath) {
+  struct stat file_stat;
+  return (stat(dirpath, &file_stat) == 0) && S_ISDIR(file_stat.st_mode);
+}
+
+bool FilePath::Exists(const char* path) {
+  struct stat file_stat;
+  return stat(path, &file_stat) == 0;
+}
+
+bool FilePath::GetCurrentWorkingDirectory(char* dir, size_t dir_size,
+                                          size_t* dest_len) {
+  if (getcwd(dir, dir_size) == NULL)
+    return false;
+
+  if (dest_len)
+    *dest_len = strlen(dir);
+  return true;
+}
+
+bool FilePath::CreateDir(const char* dirpath) {
+  return mkdir(dirpath, 0755) == 0;
+}
+
+}} // namespace ycommon { namespace platform {
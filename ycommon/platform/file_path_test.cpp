@@ -14,8 +14,8 @@ TEST(JoinPathsTest, BasicJoinTest) {
   char dest[4] = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_TRUE(file_path::JoinPaths("a", 1, "b", 1,
-                                   dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::JoinPaths("a", 1, "b", 1,
+                                  dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a" PATH_SEP "b", dest);
   EXPECT_EQ(3, dest_len);
 }
@@ -24,26 +24,26 @@ TEST(JoinPathsTest, JoinFailTest) {
   char dest[3] = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_FALSE(file_path::JoinPaths("a", 1, "b", 1,
-                                    dest, sizeof(dest), &dest_len));
+  ASSERT_FALSE(FilePath::JoinPaths("a", 1, "b", 1,
+                                   dest, sizeof(dest), &dest_len));
 }
 
 TEST(JoinPathsTest, JoinVariantPathTest) {
   char dest[64]  = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_TRUE(file_path::JoinPaths("a", 1, PATH_SEP "b", 2,
-                                  dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::JoinPaths("a", 1, PATH_SEP "b", 2,
+                                 dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(PATH_SEP "b", dest);
   EXPECT_EQ(2, dest_len);
 
-  ASSERT_TRUE(file_path::JoinPaths(PATH_SEP "a", 2, "b", 1,
-                                  dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::JoinPaths(PATH_SEP "a", 2, "b", 1,
+                                 dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(PATH_SEP "a" PATH_SEP "b", dest);
   EXPECT_EQ(4, dest_len);
 
-  ASSERT_TRUE(file_path::JoinPaths("a" PATH_SEP, 2, "b", 1,
-                                  dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::JoinPaths("a" PATH_SEP, 2, "b", 1,
+                                 dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a" PATH_SEP "b", dest);
   EXPECT_EQ(3, dest_len);
 }
@@ -53,8 +53,8 @@ TEST(NormPathTest, BasicNormPathTest) {
   size_t dest_len = 0;
 
   const char test1[] = "a" PATH_SEP "b";
-  ASSERT_TRUE(file_path::NormPath(test1, sizeof(test1)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test1, sizeof(test1)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a" PATH_SEP "b", dest);
   EXPECT_EQ(3, dest_len);
 }
@@ -64,8 +64,8 @@ TEST(NormPathTest, FailedNormPathTest) {
   size_t dest_len = 0;
 
   const char test1[] = "a" PATH_SEP "b";
-  ASSERT_FALSE(file_path::NormPath(test1, sizeof(test1)-1,
-                                  dest, sizeof(dest), &dest_len));
+  ASSERT_FALSE(FilePath::NormPath(test1, sizeof(test1)-1,
+                                 dest, sizeof(dest), &dest_len));
 }
 
 #ifdef WIN
@@ -73,13 +73,13 @@ TEST(NormPathTest, AltPathSepTest) {
   char dest[64]  = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_TRUE(file_path::NormPath("a\\b", 3,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath("a\\b", 3,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a\\b", dest);
   EXPECT_EQ(3, dest_len);
 
-  ASSERT_TRUE(file_path::NormPath("a/b", 3,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath("a/b", 3,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a\\b", dest);
   EXPECT_EQ(3, dest_len);
 }
@@ -90,14 +90,14 @@ TEST(NormPathTest, ParentDirTest) {
   size_t dest_len = 0;
 
   const char test1[] = "a" PATH_SEP "..";
-  ASSERT_TRUE(file_path::NormPath(test1, sizeof(test1)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test1, sizeof(test1)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("", dest);
   EXPECT_EQ(0, dest_len);
 
   const char test2[] = "a" PATH_SEP ".." PATH_SEP;
-  ASSERT_TRUE(file_path::NormPath(test2, sizeof(test2)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test2, sizeof(test2)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("", dest);
   EXPECT_EQ(0, dest_len);
 }
@@ -107,32 +107,32 @@ TEST(NormPathTest, InvalidParentDirTest) {
   size_t dest_len = 0;
 
   const char test1[] = ".." PATH_SEP "a";
-  ASSERT_TRUE(file_path::NormPath(test1, sizeof(test1)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test1, sizeof(test1)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(test1, dest);
   EXPECT_EQ(strlen(test1), dest_len);
 
   const char test2[] = "a" PATH_SEP "..test";
-  ASSERT_TRUE(file_path::NormPath(test2, sizeof(test2)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test2, sizeof(test2)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(test2, dest);
   EXPECT_EQ(strlen(test2), dest_len);
 
   const char test3[] = "a..b";
-  ASSERT_TRUE(file_path::NormPath(test3, sizeof(test3)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test3, sizeof(test3)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(test3, dest);
   EXPECT_EQ(strlen(test3), dest_len);
 
   const char test4[] = ".." PATH_SEP ".." PATH_SEP "a";
-  ASSERT_TRUE(file_path::NormPath(test4, sizeof(test4)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test4, sizeof(test4)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(test4, dest);
   EXPECT_EQ(strlen(test4), dest_len);
 
   const char test5[] = ".." PATH_SEP "a" PATH_SEP ".." PATH_SEP "..";
-  ASSERT_TRUE(file_path::NormPath(test5, sizeof(test5)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test5, sizeof(test5)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ(".." PATH_SEP "..", dest);
   EXPECT_EQ(strlen(".." PATH_SEP ".."), dest_len);
 }
@@ -142,20 +142,20 @@ TEST(NormPathTest, CurrentDirTest) {
   size_t dest_len = 0;
 
   const char test1[] = "a" PATH_SEP "." PATH_SEP;
-  ASSERT_TRUE(file_path::NormPath(test1, sizeof(test1)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test1, sizeof(test1)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a", dest);
   EXPECT_EQ(strlen("a"), dest_len);
 
   const char test2[] = "." PATH_SEP "a";
-  ASSERT_TRUE(file_path::NormPath(test2, sizeof(test2)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test2, sizeof(test2)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a", dest);
   EXPECT_EQ(strlen("a"), dest_len);
 
   const char test3[] = "." PATH_SEP "a" PATH_SEP;
-  ASSERT_TRUE(file_path::NormPath(test3, sizeof(test3)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test3, sizeof(test3)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a", dest);
   EXPECT_EQ(strlen("a"), dest_len);
 }
@@ -165,14 +165,14 @@ TEST(NormPathTest, InvalidCurrentDirTest) {
   size_t dest_len = 0;
 
   const char test1[] = "a" PATH_SEP ".test";
-  ASSERT_TRUE(file_path::NormPath(test1, sizeof(test1)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test1, sizeof(test1)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a" PATH_SEP ".test", dest);
   EXPECT_EQ(strlen("a" PATH_SEP ".test"), dest_len);
 
   const char test2[] = "a.b";
-  ASSERT_TRUE(file_path::NormPath(test2, sizeof(test2)-1,
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::NormPath(test2, sizeof(test2)-1,
+                                dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("a.b", dest);
   EXPECT_EQ(strlen("a.b"), dest_len);
 }
@@ -181,8 +181,8 @@ TEST(AbsPathTest, BasicAbsPathTest) {
   char dest[4]  = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_TRUE(file_path::AbsPath("b", strlen("b"),
-                                dest, sizeof(dest), &dest_len,
+  ASSERT_TRUE(FilePath::AbsPath("b", strlen("b"),
+                               dest, sizeof(dest), &dest_len,
                                 "a", strlen("a")));
   EXPECT_STREQ("a" PATH_SEP "b", dest);
   EXPECT_EQ(strlen("a" PATH_SEP "b"), dest_len);
@@ -192,8 +192,8 @@ TEST(AbsPathTest, FailedAbsPathTest) {
   char dest[3]  = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_FALSE(file_path::AbsPath("b", strlen("b"),
-                                 dest, sizeof(dest), &dest_len,
+  ASSERT_FALSE(FilePath::AbsPath("b", strlen("b"),
+                                dest, sizeof(dest), &dest_len,
                                  "a", strlen("a")));
 }
 
@@ -203,8 +203,8 @@ TEST(AbsPathTest, DoubleAbsPathTest) {
 
   const char* path = "/a";
   const char* work_dir = "/b";
-  ASSERT_TRUE(file_path::AbsPath(path, strlen(path),
-                                dest, sizeof(dest), &dest_len,
+  ASSERT_TRUE(FilePath::AbsPath(path, strlen(path),
+                               dest, sizeof(dest), &dest_len,
                                 work_dir, strlen(work_dir)));
 
   const char* expected = PATH_SEP "a";
@@ -219,8 +219,8 @@ TEST(AbsPathTest, AbsWinPathTest) {
 
   const char* path = "a";
   const char* work_dir = "c:\\b";
-  ASSERT_TRUE(file_path::AbsPath(path, strlen(path),
-                                dest, sizeof(dest), &dest_len,
+  ASSERT_TRUE(FilePath::AbsPath(path, strlen(path),
+                               dest, sizeof(dest), &dest_len,
                                 work_dir, strlen(work_dir)));
 
   const char* expected = "c:\\b\\a";
@@ -234,8 +234,8 @@ TEST(AbsPathTest, DoubleAbsWinPathTest) {
 
   const char* path = "c:\\a";
   const char* work_dir = "c:\\b";
-  ASSERT_TRUE(file_path::AbsPath(path, strlen(path),
-                                dest, sizeof(dest), &dest_len,
+  ASSERT_TRUE(FilePath::AbsPath(path, strlen(path),
+                               dest, sizeof(dest), &dest_len,
                                 work_dir, strlen(work_dir)));
 
   const char* expected = "c:\\a";
@@ -248,8 +248,8 @@ TEST(AbsPathTest, RelativePathTest) {
   char dest[4]  = { '\0' };
   size_t dest_len = 0;
 
-  ASSERT_TRUE(file_path::AbsPath("..", strlen(".."),
-                                dest, sizeof(dest), &dest_len,
+  ASSERT_TRUE(FilePath::AbsPath("..", strlen(".."),
+                               dest, sizeof(dest), &dest_len,
                                 "a", strlen("a")));
   EXPECT_STREQ("", dest);
   EXPECT_EQ(strlen(""), dest_len);
@@ -261,8 +261,8 @@ TEST(RelPathTest, BasicTest) {
 
   const char* path = "abc" PATH_SEP "b";
   const char* dir = "abc";
-  ASSERT_TRUE(file_path::RelPath(path, strlen(path),
-                                dir, strlen(dir),
+  ASSERT_TRUE(FilePath::RelPath(path, strlen(path),
+                               dir, strlen(dir),
                                 dest, sizeof(dest), &dest_len));
   EXPECT_STREQ("b", dest);
   EXPECT_EQ(strlen("b"), dest_len);
@@ -273,8 +273,8 @@ TEST(RelPathTest, PathSepEndTest) {
   size_t dest2_len = 0;
   const char* path2 = "abc" PATH_SEP "b" PATH_SEP;
   const char* dir2 = "abc" PATH_SEP;
-  ASSERT_TRUE(file_path::RelPath(path2, strlen(path2),
-                                dir2, strlen(dir2),
+  ASSERT_TRUE(FilePath::RelPath(path2, strlen(path2),
+                               dir2, strlen(dir2),
                                 dest2, sizeof(dest2), &dest2_len));
   EXPECT_STREQ("b", dest2);
   EXPECT_EQ(strlen("b"), dest2_len);
@@ -286,8 +286,8 @@ TEST(RelPathTest, FailedRelTest) {
 
   const char* path = "a" PATH_SEP "abc";
   const char* dir = "a";
-  ASSERT_FALSE(file_path::RelPath(path, strlen(path),
-                                 dir, strlen(dir),
+  ASSERT_FALSE(FilePath::RelPath(path, strlen(path),
+                                dir, strlen(dir),
                                  dest, sizeof(dest), &dest_len));
 }
 
@@ -297,8 +297,8 @@ TEST(RelPathTest, CompleteMatchTest) {
 
   const char* path = "abc" PATH_SEP "def";
   const char* dir = "abc" PATH_SEP "def";
-  ASSERT_TRUE(file_path::RelPath(path, strlen(path),
-                                dir, strlen(dir),
+  ASSERT_TRUE(FilePath::RelPath(path, strlen(path),
+                               dir, strlen(dir),
                                 dest, sizeof(dest), &dest_len));
 
   const char* expected = "";
@@ -306,23 +306,23 @@ TEST(RelPathTest, CompleteMatchTest) {
   EXPECT_EQ(strlen(expected), dest_len);
 
   const char* dir2 = "abc" PATH_SEP "def" PATH_SEP;
-  ASSERT_TRUE(file_path::RelPath(path, strlen(path),
-                                dir2, strlen(dir2),
+  ASSERT_TRUE(FilePath::RelPath(path, strlen(path),
+                               dir2, strlen(dir2),
                                 dest, sizeof(dest), &dest_len));
 
   EXPECT_STREQ(expected, dest);
   EXPECT_EQ(strlen(expected), dest_len);
 
   const char* path2 = "abc" PATH_SEP "def" PATH_SEP;
-  ASSERT_TRUE(file_path::RelPath(path2, strlen(path2),
-                                dir, strlen(dir),
+  ASSERT_TRUE(FilePath::RelPath(path2, strlen(path2),
+                               dir, strlen(dir),
                                 dest, sizeof(dest), &dest_len));
 
   EXPECT_STREQ(expected, dest);
   EXPECT_EQ(strlen(expected), dest_len);
 
-  ASSERT_TRUE(file_path::RelPath(path2, strlen(path2),
-                                dir2, strlen(dir2),
+  ASSERT_TRUE(FilePath::RelPath(path2, strlen(path2),
+                               dir2, strlen(dir2),
                                 dest, sizeof(dest), &dest_len));
 
   EXPECT_STREQ(expected, dest);
@@ -335,8 +335,8 @@ TEST(RelPathTest, NoMatchTest) {
 
   const char* path = "abc" PATH_SEP "def";
   const char* dir = "abcd" PATH_SEP "ghi";
-  ASSERT_TRUE(file_path::RelPath(path, strlen(path),
-                                dir, strlen(dir),
+  ASSERT_TRUE(FilePath::RelPath(path, strlen(path),
+                               dir, strlen(dir),
                                 dest, sizeof(dest), &dest_len));
 
   const char* expected = ".." PATH_SEP ".." PATH_SEP "abc" PATH_SEP "def";
@@ -350,8 +350,8 @@ TEST(RelPathTest, PartialMatchTest) {
 
   const char* path = "abc" PATH_SEP "def";
   const char* dir = "abc" PATH_SEP "jkl";
-  ASSERT_TRUE(file_path::RelPath(path, strlen(path),
-                                dir, strlen(dir),
+  ASSERT_TRUE(FilePath::RelPath(path, strlen(path),
+                               dir, strlen(dir),
                                 dest, sizeof(dest), &dest_len));
 
   const char* expected = ".." PATH_SEP "def";
@@ -364,8 +364,8 @@ TEST(DirPathTest, BasicTest) {
   size_t dest_len = 0;
 
   const char* path = "abc" PATH_SEP "def";
-  ASSERT_TRUE(file_path::DirPath(path, strlen(path),
-                                dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::DirPath(path, strlen(path),
+                               dest, sizeof(dest), &dest_len));
 
   const char* expected = "abc";
   EXPECT_STREQ(expected, dest);
@@ -377,8 +377,8 @@ TEST(DirPathTest, BasicFailTest) {
   size_t dest_len = 0;
 
   const char* path = "abc" PATH_SEP "def";
-  ASSERT_FALSE(file_path::DirPath(path, strlen(path),
-                                 dest, sizeof(dest), &dest_len));
+  ASSERT_FALSE(FilePath::DirPath(path, strlen(path),
+                                dest, sizeof(dest), &dest_len));
 }
 
 TEST(DirPathTest, RootTest) {
@@ -386,8 +386,8 @@ TEST(DirPathTest, RootTest) {
   size_t dest_len = 0;
 
   const char* path = PATH_SEP "abc";
-  ASSERT_TRUE(file_path::DirPath(path, strlen(path),
-                                dest, sizeof(dest), &dest_len));
+  ASSERT_TRUE(FilePath::DirPath(path, strlen(path),
+                               dest, sizeof(dest), &dest_len));
 
   const char* expected = PATH_SEP;
   EXPECT_STREQ(expected, dest);
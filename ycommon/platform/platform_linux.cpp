@@ -0,0 +1,25 @@
+#include "ycommon/platform/platform.h"
+
+#include <stddef.h>
+
+namespace ycommon { namespace platform {
+
+namespace {
+  OnCloseFunc gOnCloseFunc = NULL;
+}
+
+// Linux targets are headless, there is no window or message pump to service.
+void Platform::Init(const PlatformHandle& platform_handle,
+                    const OnCloseFunc on_close_func) {
+  static_cast<void>(platform_handle);
+  gOnCloseFunc = on_close_func;
+}
+
+void Platform::Release() {
+  gOnCloseFunc = NULL;
+}
+
+void Platform::Update() {
+}
+
+}} // namespace ycommon { namespace platform {
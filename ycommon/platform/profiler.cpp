@@ -0,0 +1,206 @@
+#include "ycommon/platform/profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/headers/macros.h"
+#include "ycommon/utils/assert.h"
+
+namespace ycommon { namespace platform {
+
+namespace {
+  struct ZoneEvent {
+    const char* mName;
+    uint64_t mBegin;
+    uint64_t mEnd;
+  };
+
+  // Only the owning thread writes its ring, mWriteCount is published after
+  // the event it counts is written.
+  struct ThreadRing {
+    ZoneEvent* mEvents;
+    volatile uint32_t mWriteCount;
+  };
+
+  volatile bool gInitialized = false;
+  uint32_t gGeneration = 0;
+  uint32_t gEventsPerThread = 0;
+  uint64_t gStartTimestamp = 0;
+  volatile uint32_t gNumThreads = 0;
+  ThreadRing gThreadRings[MAX_PROFILER_THREADS];
+
+  // Rings claimed in an earlier initialization are claimed again.
+  THREAD_LOCAL ThreadRing* gThreadRing = NULL;
+  THREAD_LOCAL uint32_t gThreadGeneration = 0;
+
+  ThreadRing* GetThreadRing() {
+    if (gThreadGeneration != gGeneration) {
+      gThreadGeneration = gGeneration;
+      const uint32_t index = AtomicAdd32(&gNumThreads, 1);
+      gThreadRing = (index < MAX_PROFILER_THREADS) ?
+                    &gThreadRings[index] : NULL;
+    }
+    return gThreadRing;
+  }
+
+  uint32_t GetNumRingZones(const ThreadRing& ring) {
+    const uint32_t write_count = ring.mWriteCount;
+    return write_count < gEventsPerThread ? write_count : gEventsPerThread;
+  }
+
+  // Appends to a buffer or a file, a buffer keeps counting the length once
+  // it is full so the needed size is still known.
+  struct TraceWriter {
+    char* mDest;
+    size_t mDestSize;
+    size_t mLength;
+    FILE* mFile;
+
+    void Write(const char* data, size_t data_len) {
+      if (mFile) {
+        fwrite(data, 1, data_len, mFile);
+      } else if (mLength + data_len < mDestSize) {
+        memcpy(mDest + mLength, data, data_len);
+      }
+      mLength += data_len;
+    }
+  };
+
+  void WriteChromeTrace(TraceWriter& writer) {
+    const double frequency =
+        static_cast<double>(Profiler::GetTimestampFrequency());
+    const double micro_per_count = 1000.0 * 1000.0 / frequency;
+    const uint32_t num_threads = gNumThreads < MAX_PROFILER_THREADS ?
+                                 gNumThreads : MAX_PROFILER_THREADS;
+    const uint32_t event_mask = gEventsPerThread - 1;
+
+    const char header[] = "{\"traceEvents\":[";
+    writer.Write(header, sizeof(header) - 1);
+
+    bool first_event = true;
+    char event_buffer[256];
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      const ThreadRing& ring = gThreadRings[i];
+      const uint32_t write_count = ring.mWriteCount;
+      AcquireFence();
+      const uint32_t num_zones = GetNumRingZones(ring);
+      for (uint32_t n = write_count - num_zones; n != write_count; ++n) {
+        const ZoneEvent& event = ring.mEvents[n & event_mask];
+        const double begin = static_cast<double>(
+            event.mBegin - gStartTimestamp) * micro_per_count;
+        const double duration = static_cast<double>(
+            event.mEnd - event.mBegin) * micro_per_count;
+        const int event_len = snprintf(
+            event_buffer, sizeof(event_buffer),
+            "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            first_event ? "" : ",", event.mName, i, begin, duration);
+        YASSERT(event_len > 0 &&
+                static_cast<size_t>(event_len) < sizeof(event_buffer),
+                "Zone name too long for the trace: %s", event.mName);
+        writer.Write(event_buffer, static_cast<size_t>(event_len));
+        first_event = false;
+      }
+    }
+
+    const char footer[] = "\n],\"displayTimeUnit\":\"ns\"}\n";
+    writer.Write(footer, sizeof(footer) - 1);
+  }
+}
+
+size_t Profiler::GetAllocationSize(uint32_t events_per_thread) {
+  return sizeof(ZoneEvent) * events_per_thread * MAX_PROFILER_THREADS;
+}
+
+void Profiler::Initialize(void* buffer, size_t buffer_size,
+                          uint32_t events_per_thread) {
+  YASSERT(!gInitialized, "Profiler cannot be initialized twice.");
+  YASSERT(events_per_thread && IS_POWER_OF_2(events_per_thread),
+          "Events per thread must be a power of 2: %u", events_per_thread);
+  YASSERT(buffer_size >= GetAllocationSize(events_per_thread),
+          "Buffer size not large enough for the profiler: (%d < %d)",
+          static_cast<int>(buffer_size),
+          static_cast<int>(GetAllocationSize(events_per_thread)));
+
+  ZoneEvent* events = static_cast<ZoneEvent*>(buffer);
+  for (uint32_t i = 0; i < MAX_PROFILER_THREADS; ++i) {
+    gThreadRings[i].mEvents = events + i * events_per_thread;
+    gThreadRings[i].mWriteCount = 0;
+  }
+  gEventsPerThread = events_per_thread;
+  gNumThreads = 0;
+  ++gGeneration;
+  gStartTimestamp = GetTimestamp();
+
+  ReleaseFence();
+  gInitialized = true;
+}
+
+void Profiler::Terminate() {
+  gInitialized = false;
+  MemoryBarrier();
+  memset(gThreadRings, 0, sizeof(gThreadRings));
+  gEventsPerThread = 0;
+  gNumThreads = 0;
+}
+
+bool Profiler::IsInitialized() {
+  return gInitialized;
+}
+
+void Profiler::RecordZone(const char* name, uint64_t begin, uint64_t end) {
+  if (!gInitialized)
+    return;
+
+  // Threads past MAX_PROFILER_THREADS are not recorded.
+  ThreadRing* ring = GetThreadRing();
+  if (ring == NULL)
+    return;
+
+  const uint32_t write_count = ring->mWriteCount;
+  ZoneEvent& event = ring->mEvents[write_count & (gEventsPerThread - 1)];
+  event.mName = name;
+  event.mBegin = begin;
+  event.mEnd = end;
+  ReleaseFence();
+  ring->mWriteCount = write_count + 1;
+}
+
+uint32_t Profiler::GetNumZones() {
+  const uint32_t num_threads = gNumThreads < MAX_PROFILER_THREADS ?
+                               gNumThreads : MAX_PROFILER_THREADS;
+  uint32_t num_zones = 0;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    num_zones += GetNumRingZones(gThreadRings[i]);
+  }
+  return num_zones;
+}
+
+bool Profiler::DumpChromeTrace(char* dest, size_t dest_size,
+                               size_t* dest_len) {
+  YASSERT(gInitialized, "Profiler has not been initialized.");
+  TraceWriter writer = { dest, dest_size, 0, NULL };
+  WriteChromeTrace(writer);
+  if (dest_len)
+    *dest_len = writer.mLength;
+  if (writer.mLength >= dest_size)
+    return false;
+
+  dest[writer.mLength] = '\0';
+  return true;
+}
+
+bool Profiler::DumpChromeTraceFile(const char* file_path) {
+  YASSERT(gInitialized, "Profiler has not been initialized.");
+  FILE* file = fopen(file_path, "wb");
+  if (file == NULL)
+    return false;
+
+  TraceWriter writer = { NULL, 0, 0, file };
+  WriteChromeTrace(writer);
+  const bool succeeded = (ferror(file) == 0);
+  return (fclose(file) == 0) && succeeded;
+}
+
+}} // namespace ycommon { namespace platform {
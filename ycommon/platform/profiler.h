@@ -0,0 +1,84 @@
+#ifndef YCOMMON_PLATFORM_PROFILER_H
+#define YCOMMON_PLATFORM_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_PROFILER_THREADS 32
+
+/*******
+* Scoped CPU zone profiler.
+*  - YPROFILE_ZONE(name) times the rest of its scope, zones are compiled out
+*    in PLATINUM and cost a single check while the profiler is not
+*    initialized.
+*  - Every thread claims its own ring of events on its first zone, so
+*    recording is lock free. Full rings overwrite their oldest zones.
+*  - Zone names are not copied, they must live until the trace is dumped
+*    and should not need escaping in JSON (string literals).
+*  - The trace dump is Chrome trace event JSON (chrome://tracing), zones
+*    recorded while dumping may be torn.
+*  - Space Requirements: see GetAllocationSize().
+********/
+
+namespace ycommon { namespace platform {
+
+namespace Profiler {
+  size_t GetAllocationSize(uint32_t events_per_thread);
+
+  // events_per_thread must be a power of 2. Initialize() and Terminate()
+  // must not run while zones are being recorded.
+  void Initialize(void* buffer, size_t buffer_size,
+                  uint32_t events_per_thread);
+  void Terminate();
+  bool IsInitialized();
+
+  // Monotonic timestamps, in GetTimestampFrequency() counts per second.
+  uint64_t GetTimestamp();
+  uint64_t GetTimestampFrequency();
+
+  void RecordZone(const char* name, uint64_t begin, uint64_t end);
+
+  // Returns the number of zones currently held by all the thread rings.
+  uint32_t GetNumZones();
+
+  // Writes the recorded zones as a null terminated Chrome trace, returns
+  // false if dest_size is too small.
+  bool DumpChromeTrace(char* dest, size_t dest_size,
+                       size_t* dest_len = nullptr);
+  bool DumpChromeTraceFile(const char* file_path);
+}
+
+class ProfileZone {
+ public:
+  explicit ProfileZone(const char* name)
+      : mName(name),
+        mBegin(Profiler::IsInitialized() ? Profiler::GetTimestamp() : 0) {
+  }
+
+  ~ProfileZone() {
+    if (mBegin)
+      Profiler::RecordZone(mName, mBegin, Profiler::GetTimestamp());
+  }
+
+ private:
+  const char* mName;
+  uint64_t mBegin;
+};
+
+}} // namespace ycommon { namespace platform {
+
+/*******
+* Profiler Macros
+********/
+#define YPROFILE_CONCAT_INNER(a, b) a##b
+#define YPROFILE_CONCAT(a, b) YPROFILE_CONCAT_INNER(a, b)
+
+#ifndef PLATINUM
+# define YPROFILE_ZONE(name) \
+  ycommon::platform::ProfileZone YPROFILE_CONCAT(__profile_zone, __LINE__)( \
+      name)
+#else
+# define YPROFILE_ZONE(name) do {} while(0)
+#endif // PLATINUM
+
+#endif // YCOMMON_PLATFORM_PROFILER_H
@@ -0,0 +1,19 @@
+#include "ycommon/platform/profiler.h"
+
+#include <time.h>
+
+namespace ycommon { namespace platform {
+
+// Timestamps are in nanoseconds from CLOCK_MONOTONIC.
+uint64_t Profiler::GetTimestamp() {
+  struct timespec current_time;
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return static_cast<uint64_t>(current_time.tv_sec) * 1000 * 1000 * 1000 +
+         static_cast<uint64_t>(current_time.tv_nsec);
+}
+
+uint64_t Profiler::GetTimestampFrequency() {
+  return static_cast<uint64_t>(1000) * 1000 * 1000;
+}
+
+}} // namespace ycommon { namespace platform {
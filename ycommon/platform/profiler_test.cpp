@@ -0,0 +1,120 @@
+#include "ycommon/platform/profiler.h"
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "ycommon/headers/macros.h"
+#include "ycommon/platform/thread.h"
+
+#define TEST_EVENTS_PER_THREAD 4
+
+namespace ycommon { namespace platform {
+
+class ProfilerTest : public ::testing::Test {
+ protected:
+  ProfilerTest()
+    : mBuffer(nullptr) {
+  }
+
+  ~ProfilerTest() override {
+    delete [] mBuffer;
+  }
+
+  void SetUp() override {
+    const size_t buffer_size =
+        Profiler::GetAllocationSize(TEST_EVENTS_PER_THREAD);
+    mBuffer = new uint8_t[buffer_size];
+    Profiler::Initialize(mBuffer, buffer_size, TEST_EVENTS_PER_THREAD);
+  }
+
+  void TearDown() override {
+    Profiler::Terminate();
+    delete [] mBuffer;
+    mBuffer = nullptr;
+  }
+
+  uint8_t* mBuffer;
+};
+
+uintptr_t ProfiledRoutine(void* arg) {
+  YPROFILE_ZONE(static_cast<const char*>(arg));
+  return 0;
+}
+
+TEST_F(ProfilerTest, ScopedZonesTest) {
+  {
+    YPROFILE_ZONE("outer_zone");
+    YPROFILE_ZONE("inner_zone");
+  }
+  EXPECT_EQ(2u, Profiler::GetNumZones());
+
+  char trace[1024];
+  size_t trace_len = 0;
+  ASSERT_TRUE(Profiler::DumpChromeTrace(trace, sizeof(trace), &trace_len));
+  EXPECT_EQ(strlen(trace), trace_len);
+  EXPECT_EQ(0, strncmp(trace, "{\"traceEvents\":[", 16));
+  EXPECT_NE(nullptr, strstr(trace, "\"name\":\"outer_zone\",\"ph\":\"X\""));
+  EXPECT_NE(nullptr, strstr(trace, "\"name\":\"inner_zone\",\"ph\":\"X\""));
+}
+
+TEST_F(ProfilerTest, TerminatedZonesTest) {
+  Profiler::Terminate();
+  EXPECT_FALSE(Profiler::IsInitialized());
+  {
+    YPROFILE_ZONE("terminated_zone");
+  }
+
+  Profiler::Initialize(mBuffer,
+                       Profiler::GetAllocationSize(TEST_EVENTS_PER_THREAD),
+                       TEST_EVENTS_PER_THREAD);
+  EXPECT_EQ(0u, Profiler::GetNumZones());
+}
+
+TEST_F(ProfilerTest, RingOverwriteTest) {
+  const char* names[] = {
+    "zone_0", "zone_1", "zone_2", "zone_3", "zone_4", "zone_5"
+  };
+  const uint64_t timestamp = Profiler::GetTimestamp();
+  for (size_t i = 0; i < ARRAY_SIZE(names); ++i) {
+    Profiler::RecordZone(names[i], timestamp + i, timestamp + i + 1);
+  }
+  EXPECT_EQ(static_cast<uint32_t>(TEST_EVENTS_PER_THREAD),
+            Profiler::GetNumZones());
+
+  // Only the newest zones are kept.
+  char trace[1024];
+  ASSERT_TRUE(Profiler::DumpChromeTrace(trace, sizeof(trace)));
+  EXPECT_EQ(nullptr, strstr(trace, "zone_0"));
+  EXPECT_EQ(nullptr, strstr(trace, "zone_1"));
+  EXPECT_NE(nullptr, strstr(trace, "zone_2"));
+  EXPECT_NE(nullptr, strstr(trace, "zone_5"));
+}
+
+TEST_F(ProfilerTest, ThreadRingsTest) {
+  char thread_zone[] = "thread_zone";
+  Thread thread(ProfiledRoutine, thread_zone);
+  ASSERT_EQ(kStatusCode_OK, thread.Run());
+  ASSERT_TRUE(thread.Join());
+
+  char main_zone[] = "main_zone";
+  ProfiledRoutine(main_zone);
+
+  // Each thread records into its own ring.
+  char trace[1024];
+  ASSERT_TRUE(Profiler::DumpChromeTrace(trace, sizeof(trace)));
+  EXPECT_NE(nullptr, strstr(trace, "\"tid\":0"));
+  EXPECT_NE(nullptr, strstr(trace, "\"tid\":1"));
+  EXPECT_EQ(2u, Profiler::GetNumZones());
+}
+
+TEST_F(ProfilerTest, DumpTooSmallTest) {
+  const uint64_t timestamp = Profiler::GetTimestamp();
+  Profiler::RecordZone("small_zone", timestamp, timestamp + 1);
+
+  char trace[16];
+  size_t trace_len = 0;
+  EXPECT_FALSE(Profiler::DumpChromeTrace(trace, sizeof(trace), &trace_len));
+  EXPECT_LT(sizeof(trace), trace_len);
+}
+
+}} // namespace ycommon { namespace platform {
@@ -0,0 +1,19 @@
+#include "ycommon/platform/profiler.h"
+
+#include <Windows.h>
+
+namespace ycommon { namespace platform {
+
+uint64_t Profiler::GetTimestamp() {
+  LARGE_INTEGER current_count;
+  QueryPerformanceCounter(&current_count);
+  return static_cast<uint64_t>(current_count.QuadPart);
+}
+
+uint64_t Profiler::GetTimestampFrequency() {
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  return static_cast<uint64_t>(frequency.QuadPart);
+}
+
+}} // namespace ycommon { namespace platform {
@@ -1,5 +1,8 @@
 #ifndef YCOMMON_PLATFORM_SEMAPHORE_H
 #define YCOMMON_PLATFORM_SEMAPHORE_H
+
+#include <stddef.h>
+
 namespace ycommon { namespace platform {
 
 class Semaphore {
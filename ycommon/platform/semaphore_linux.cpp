@@ -0,0 +1,131 @@
+#include "ycommon/platform/semaphore.h"
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/utils/assert.h"
+
+namespace ycommon { namespace platform {
+
+/*******
+* The count lives in user space, Wait() and Release() only enter the kernel
+* when a thread actually has to sleep or there are sleeping threads to wake.
+********/
+struct LinuxPimpl {
+  volatile int32_t count;
+  int32_t maximum_count;
+  volatile int32_t num_waiters;
+};
+
+static int FutexWait(volatile int32_t* address, int32_t expected,
+                     const struct timespec* timeout) {
+  return static_cast<int>(syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE,
+                                  expected, timeout, NULL, 0));
+}
+
+static int FutexWake(volatile int32_t* address, int32_t count) {
+  return static_cast<int>(syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE,
+                                  count, NULL, NULL, 0));
+}
+
+static int64_t GetMonotonicNano() {
+  struct timespec current_time;
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return static_cast<int64_t>(current_time.tv_sec) * 1000 * 1000 * 1000 +
+         static_cast<int64_t>(current_time.tv_nsec);
+}
+
+Semaphore::Semaphore() {
+  static_assert(sizeof(LinuxPimpl) < sizeof(mPimpl),
+                "Linux Semaphore Pimpl larger than Semaphore Pimpl!");
+
+  memset(mPimpl, 0, sizeof(mPimpl));
+}
+
+Semaphore::Semaphore(int initial_count, int maximum_count) {
+  memset(mPimpl, 0, sizeof(mPimpl));
+  Initialize(initial_count, maximum_count);
+}
+
+Semaphore::~Semaphore() {
+}
+
+void Semaphore::Initialize(int initial_count, int maximum_count) {
+  static_assert(sizeof(LinuxPimpl) < sizeof(mPimpl),
+                "Linux Semaphore Pimpl larger than Semaphore Pimpl!");
+
+  YASSERT(initial_count >= 0 && initial_count <= maximum_count,
+          "Invalid Semaphore initial count: %d (maximum %d)",
+          initial_count, maximum_count);
+
+  memset(mPimpl, 0, sizeof(mPimpl));
+  LinuxPimpl* linux_data = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  linux_data->count = static_cast<int32_t>(initial_count);
+  linux_data->maximum_count = static_cast<int32_t>(maximum_count);
+  linux_data->num_waiters = 0;
+}
+
+bool Semaphore::Wait(size_t milliseconds) {
+  LinuxPimpl* linux_data = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  const bool infinite = (milliseconds == static_cast<size_t>(-1));
+  const int64_t end_time = infinite ? 0 :
+      GetMonotonicNano() + static_cast<int64_t>(milliseconds) * 1000 * 1000;
+
+  for (;;) {
+    // Fast path, take a count without entering the kernel.
+    int32_t count = linux_data->count;
+    while (count > 0) {
+      if (AtomicCmpSet32(&linux_data->count, count, count - 1))
+        return true;
+      count = linux_data->count;
+    }
+
+    struct timespec timeout;
+    struct timespec* timeout_ptr = NULL;
+    if (!infinite) {
+      const int64_t remaining = end_time - GetMonotonicNano();
+      if (remaining <= 0)
+        return false;
+
+      timeout.tv_sec = static_cast<time_t>(remaining / (1000 * 1000 * 1000));
+      timeout.tv_nsec = static_cast<long>(remaining % (1000 * 1000 * 1000));
+      timeout_ptr = &timeout;
+    }
+
+    // The kernel rechecks the count so a release in between is not lost.
+    AtomicAdd32(&linux_data->num_waiters, 1);
+    FutexWait(&linux_data->count, 0, timeout_ptr);
+    AtomicAdd32(&linux_data->num_waiters, -1);
+  }
+}
+
+bool Semaphore::Release(int count) {
+  LinuxPimpl* linux_data = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  const int32_t release_count = static_cast<int32_t>(count);
+  for (;;) {
+    const int32_t cur_count = linux_data->count;
+
+    // Matches windows semantics, releasing past the maximum does nothing.
+    if (release_count <= 0 ||
+        cur_count > linux_data->maximum_count - release_count) {
+      return false;
+    }
+
+    if (AtomicCmpSet32(&linux_data->count, cur_count,
+                       cur_count + release_count)) {
+      break;
+    }
+  }
+
+  if (linux_data->num_waiters)
+    FutexWake(&linux_data->count, release_count);
+  return true;
+}
+
+}} // namespace ycommon { namespace platform {
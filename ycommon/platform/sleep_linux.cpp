@@ -0,0 +1,51 @@
+#include "ycommon/platform/sleep.h"
+
+#include <errno.h>
+#include <time.h>
+
+namespace ycommon { namespace platform {
+
+static int64_t GetMonotonicNano() {
+  struct timespec current_time;
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return static_cast<int64_t>(current_time.tv_sec) * 1000 * 1000 * 1000 +
+         static_cast<int64_t>(current_time.tv_nsec);
+}
+
+static void NanoSleep(int64_t nanoseconds) {
+  struct timespec sleep_time;
+  sleep_time.tv_sec = static_cast<time_t>(nanoseconds / (1000 * 1000 * 1000));
+  sleep_time.tv_nsec = static_cast<long>(nanoseconds % (1000 * 1000 * 1000));
+  while (nanosleep(&sleep_time, &sleep_time) == -1 && errno == EINTR) {
+  }
+}
+
+void Sleep::MicroSleep(int64_t microseconds) {
+  // Spin like the windows version, scheduler wake ups are too coarse.
+  const int64_t start = GetMonotonicNano();
+  const int64_t sleep_nano = microseconds * 1000;
+  while ((GetMonotonicNano() - start) < sleep_nano) {
+  }
+}
+
+void Sleep::MilliSleep(int64_t milliseconds) {
+  NanoSleep(milliseconds * 1000 * 1000);
+}
+
+void Sleep::Sleep(int64_t seconds) {
+  NanoSleep(seconds * 1000 * 1000 * 1000);
+}
+
+void Sleep::MicroSleepFloat(float microseconds) {
+  return MicroSleep(static_cast<int64_t>(microseconds + 0.5f));
+}
+
+void Sleep::MilliSleepFloat(float milliseconds) {
+  return MicroSleep(static_cast<int64_t>(milliseconds * 1000.0f));
+}
+
+void Sleep::SleepFloat(float seconds) {
+  return MilliSleep(static_cast<int64_t>(seconds * 1000.0f));
+}
+
+}} // namespace ycommon { namespace platform {
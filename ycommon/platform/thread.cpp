@@ -0,0 +1,37 @@
+#include "ycommon/platform/thread.h"
+
+#include "ycommon/headers/macros.h"
+
+#define MAX_EXIT_ROUTINES 8
+
+namespace ycommon { namespace platform {
+
+namespace {
+  struct ExitRoutine {
+    ThreadRoutine mRoutine;
+    void* mArg;
+  };
+
+  THREAD_LOCAL ExitRoutine gExitRoutines[MAX_EXIT_ROUTINES];
+  THREAD_LOCAL uint32_t gNumExitRoutines = 0;
+}
+
+bool Thread::AddExitRoutine(ThreadRoutine exit_func, void* exit_arg) {
+  if (gNumExitRoutines >= MAX_EXIT_ROUTINES)
+    return false;
+
+  gExitRoutines[gNumExitRoutines].mRoutine = exit_func;
+  gExitRoutines[gNumExitRoutines].mArg = exit_arg;
+  ++gNumExitRoutines;
+  return true;
+}
+
+void Thread::RunExitRoutines() {
+  while (gNumExitRoutines > 0) {
+    --gNumExitRoutines;
+    gExitRoutines[gNumExitRoutines].mRoutine(
+        gExitRoutines[gNumExitRoutines].mArg);
+  }
+}
+
+}} // namespace ycommon { namespace platform {
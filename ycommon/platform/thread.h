@@ -1,6 +1,8 @@
 #ifndef YCOMMON_PLATFORM_THREAD_H
 #define YCOMMON_PLATFORM_THREAD_H
 
+#include <stdint.h>
+#include <string.h>
 #include <string>
 
 #include "ycommon/headers/status_codes.h"
@@ -31,8 +33,18 @@ class Thread {
     return mName;
   }
 
+  // Restricts the thread to the processors in the mask, must be called after
+  // Initialize() and before Run().
+  bool SetAffinityMask(uint64_t cpu_mask);
+
   bool IsRunning() const;
 
+  // Registers a routine for the calling thread to run once its thread
+  // function returns, in reverse order of registration. Threads which were
+  // not started through Thread must call RunExitRoutines() themselves.
+  static bool AddExitRoutine(ThreadRoutine exit_func, void* exit_arg);
+  static void RunExitRoutines();
+
   // Returned undefined behavior if it is still running.
   uintptr_t ReturnValue() const;
 
@@ -0,0 +1,195 @@
+#include "ycommon/platform/thread.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/utils/assert.h"
+
+namespace ycommon { namespace platform {
+
+struct LinuxPimpl {
+  bool valid;
+  bool started;
+  bool joined;
+  volatile int32_t finished;
+  pthread_t thread_handle;
+
+  ThreadRoutine thread_routine;
+  void* thread_arg;
+  const char* thread_name;
+  uintptr_t ret_code;
+  uint64_t affinity_mask;
+};
+
+// System Linux Thread functions
+static void* ThreadBeginProc(void* param) {
+  LinuxPimpl* thread_pimpl = static_cast<LinuxPimpl*>(param);
+
+#ifndef GOLD
+  if (thread_pimpl->thread_name[0] != '\0') {
+    // Linux thread names are limited to 16 characters including the null.
+    char thread_name[16];
+    strncpy(thread_name, thread_pimpl->thread_name, sizeof(thread_name) - 1);
+    thread_name[sizeof(thread_name) - 1] = '\0';
+    pthread_setname_np(pthread_self(), thread_name);
+  }
+#endif // GOLD
+
+  const uintptr_t ret = thread_pimpl->thread_routine(thread_pimpl->thread_arg);
+  Thread::RunExitRoutines();
+  thread_pimpl->ret_code = ret;
+
+  ReleaseFence();
+  AtomicSet32(&thread_pimpl->finished, 1);
+  return NULL;
+}
+
+Thread::Thread() {
+  static_assert(sizeof(LinuxPimpl) < sizeof(mPimpl),
+                "Linux Thread Pimpl larger than Thread Pimpl!");
+
+  memset(mName, 0, sizeof(mName));
+  memset(mPimpl, 0, sizeof(mPimpl));
+}
+
+Thread::Thread(ThreadRoutine thread_func, void* thread_arg,
+               const char* name) {
+  memset(mName, 0, sizeof(mName));
+  memset(mPimpl, 0, sizeof(mPimpl));
+
+  Initialize(thread_func, thread_arg);
+  if (name)
+    SetName(name);
+}
+
+Thread::~Thread() {
+  LinuxPimpl* thread_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  // The thread writes back into the pimpl until it finishes, it must be
+  // joined or finished before the Thread is destroyed.
+  YASSERT(!IsRunning(), "Thread destroyed while still running.");
+  if (thread_pimpl->started && !thread_pimpl->joined) {
+    if (thread_pimpl->finished)
+      pthread_join(thread_pimpl->thread_handle, NULL);
+    else
+      pthread_detach(thread_pimpl->thread_handle);
+  }
+}
+
+bool Thread::Initialize(ThreadRoutine thread_func, void* thread_arg) {
+  LinuxPimpl* thread_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  if (thread_pimpl->valid) {
+    if (IsRunning()) {
+      return false;
+    }
+
+    // No longer running, reclaim the finished thread and restart.
+    if (thread_pimpl->started && !thread_pimpl->joined)
+      pthread_join(thread_pimpl->thread_handle, NULL);
+
+    memset(mName, 0, sizeof(mName));
+    memset(mPimpl, 0, sizeof(mPimpl));
+  }
+
+  // Linux threads cannot be created suspended, creation is deferred to Run().
+  thread_pimpl->thread_routine = thread_func;
+  thread_pimpl->thread_arg = thread_arg;
+  thread_pimpl->thread_name = mName;
+  thread_pimpl->ret_code = 0;
+  thread_pimpl->valid = true;
+  return true;
+}
+
+YStatusCode Thread::Run() {
+  LinuxPimpl* thread_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  if (!thread_pimpl->valid)
+    return kStatusCode_InvalidArguments;
+  else if (thread_pimpl->started)
+    return kStatusCode_AlreadyRunning;
+
+  pthread_attr_t attr;
+  if (0 != pthread_attr_init(&attr))
+    return kStatusCode_SystemError;
+
+  if (thread_pimpl->affinity_mask) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int i = 0; i < 64; ++i) {
+      if (thread_pimpl->affinity_mask & (static_cast<uint64_t>(1) << i))
+        CPU_SET(i, &cpu_set);
+    }
+    pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+  }
+
+  thread_pimpl->finished = 0;
+  const int ret = pthread_create(&thread_pimpl->thread_handle, &attr,
+                                 ThreadBeginProc, thread_pimpl);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    return kStatusCode_SystemError;
+
+  thread_pimpl->started = true;
+  return kStatusCode_OK;
+}
+
+bool Thread::Join(size_t milliseconds) {
+  LinuxPimpl* thread_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  if (!thread_pimpl->started)
+    return false;
+  else if (thread_pimpl->joined)
+    return true;
+
+  int ret = 0;
+  if (milliseconds == static_cast<size_t>(-1)) {
+    ret = pthread_join(thread_pimpl->thread_handle, NULL);
+  } else {
+    // Timed joins are measured against the realtime clock.
+    struct timespec abs_time;
+    clock_gettime(CLOCK_REALTIME, &abs_time);
+    abs_time.tv_sec += static_cast<time_t>(milliseconds / 1000);
+    abs_time.tv_nsec += static_cast<long>((milliseconds % 1000) * 1000000);
+    if (abs_time.tv_nsec >= 1000000000) {
+      abs_time.tv_sec += 1;
+      abs_time.tv_nsec -= 1000000000;
+    }
+    ret = pthread_timedjoin_np(thread_pimpl->thread_handle, NULL, &abs_time);
+  }
+
+  if (ret != 0)
+    return false;
+
+  thread_pimpl->joined = true;
+  return true;
+}
+
+bool Thread::SetAffinityMask(uint64_t cpu_mask) {
+  LinuxPimpl* thread_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  if (!thread_pimpl->valid || thread_pimpl->started)
+    return false;
+
+  // Applied when the thread is created in Run().
+  thread_pimpl->affinity_mask = cpu_mask;
+  return true;
+}
+
+bool Thread::IsRunning() const {
+  const LinuxPimpl* thread_pimpl =
+    reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  return thread_pimpl->started && !thread_pimpl->finished;
+}
+
+uintptr_t Thread::ReturnValue() const {
+  const LinuxPimpl* thread_pimpl =
+    reinterpret_cast<const LinuxPimpl*>(mPimpl);
+
+  if (!thread_pimpl->started || !thread_pimpl->finished)
+    return static_cast<uintptr_t>(-1);
+
+  AcquireFence();
+  return thread_pimpl->ret_code;
+}
+
+}} // namespace ycommon { namespace platform {
@@ -57,6 +57,16 @@ uintptr_t IncrementRoutine(void* arg) {
   return 0;
 }
 
+/* Registers the increment routine to run when the thread exits. */
+uintptr_t AddExitRoutinesRoutine(void* arg) {
+  if (!Thread::AddExitRoutine(IncrementRoutine, arg) ||
+      !Thread::AddExitRoutine(IncrementRoutine, arg))
+    return static_cast<uintptr_t>(-1);
+
+  IncrementArg* arg_data = static_cast<IncrementArg*>(arg);
+  return arg_data->num;
+}
+
 /************
 * Test definitions
 *************/
@@ -148,6 +158,32 @@ TEST(BasicThreadTest, ReturnValueTest) {
   ASSERT_EQ(test_value, test_thread.ReturnValue());
 }
 
+TEST(BasicThreadTest, AffinityMaskTest) {
+  Thread test_thread;
+  ASSERT_FALSE(test_thread.SetAffinityMask(1));
+
+  uintptr_t test_value = 123;
+  test_thread.Initialize(NopRoutine, reinterpret_cast<void*>(test_value));
+  ASSERT_TRUE(test_thread.SetAffinityMask(1));
+  ASSERT_EQ(kStatusCode_OK, test_thread.Run());
+
+  // Affinity can only be changed before the thread is running.
+  ASSERT_FALSE(test_thread.SetAffinityMask(1));
+  ASSERT_TRUE(test_thread.Join(5000));
+  ASSERT_EQ(test_value, test_thread.ReturnValue());
+}
+
+TEST(BasicThreadTest, ExitRoutineTest) {
+  IncrementArg increment_arg;
+  Thread test_thread(AddExitRoutinesRoutine, &increment_arg);
+  ASSERT_EQ(kStatusCode_OK, test_thread.Run());
+  ASSERT_TRUE(test_thread.Join(5000));
+
+  // Exit routines only run after the thread function returned.
+  EXPECT_EQ(0u, test_thread.ReturnValue());
+  EXPECT_EQ(2u, increment_arg.num);
+}
+
 TEST(BasicThreadTest, ThreadsRunTest) {
   IncrementArg arg;
   Thread test_thread(IncrementRoutine, &arg);
@@ -54,6 +54,7 @@ static DWORD __stdcall ThreadBeginProc(LPVOID lpParam)
 #endif // GOLD
 
   const uintptr_t ret = thread_pimpl->thread_routine(thread_pimpl->thread_arg);
+  Thread::RunExitRoutines();
   thread_pimpl->ret_code = ret;
 
   ExitThread(0);
@@ -148,6 +149,15 @@ bool Thread::Join(size_t milliseconds) {
   return (WAIT_OBJECT_0 == ret);
 }
 
+bool Thread::SetAffinityMask(uint64_t cpu_mask) {
+  WindowsPimpl* thread_pimpl = reinterpret_cast<WindowsPimpl*>(mPimpl);
+  if (!thread_pimpl->valid || thread_pimpl->started)
+    return false;
+
+  return 0 != SetThreadAffinityMask(thread_pimpl->thread_handle,
+                                    static_cast<DWORD_PTR>(cpu_mask));
+}
+
 bool Thread::IsRunning() const {
   const WindowsPimpl* thread_pimpl =
     reinterpret_cast<const WindowsPimpl*>(mPimpl);
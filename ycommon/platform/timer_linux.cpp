@@ -0,0 +1,139 @@
+#include "ycommon/platform/timer.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "ycommon/utils/assert.h"
+
+namespace ycommon { namespace platform {
+
+// All counts are in nanoseconds from CLOCK_MONOTONIC.
+struct LinuxPimpl {
+  int64_t start_count;
+  int64_t last_pulsed_count;
+  int64_t pulsed_count;
+};
+
+#define NANO_PER_MICRO static_cast<int64_t>(1000)
+#define NANO_PER_MILLI static_cast<int64_t>(1000 * 1000)
+#define NANO_PER_SECOND static_cast<int64_t>(1000 * 1000 * 1000)
+
+static int64_t GetCurrentCount() {
+  struct timespec current_time;
+  const int ret_value = clock_gettime(CLOCK_MONOTONIC, &current_time);
+  YASSERT(ret_value == 0, "Could not query monotonic clock.");
+
+  return static_cast<int64_t>(current_time.tv_sec) * NANO_PER_SECOND +
+         static_cast<int64_t>(current_time.tv_nsec);
+}
+
+static int64_t RoundedDivide(int64_t diff, int64_t divisor) {
+  return (diff + (divisor / 2)) / divisor;
+}
+
+Timer::Timer() {
+  static_assert(sizeof(LinuxPimpl) <= sizeof(mPimpl),
+                "Linux Timer Pimpl larger than Timer Pimpl!");
+
+  memset(mPimpl, 0, sizeof(mPimpl));
+}
+
+Timer::~Timer() {
+}
+
+void Timer::Start() {
+  const int64_t current_count = GetCurrentCount();
+
+  LinuxPimpl* linux_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  linux_pimpl->start_count = current_count;
+  linux_pimpl->last_pulsed_count = current_count;
+  linux_pimpl->pulsed_count = current_count;
+}
+
+void Timer::Pulse() {
+  const int64_t current_count = GetCurrentCount();
+
+  LinuxPimpl* linux_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  linux_pimpl->last_pulsed_count = linux_pimpl->pulsed_count;
+  linux_pimpl->pulsed_count = current_count;
+}
+
+void Timer::Stop() {
+  LinuxPimpl* linux_pimpl = reinterpret_cast<LinuxPimpl*>(mPimpl);
+  linux_pimpl->start_count = 0;
+  linux_pimpl->last_pulsed_count = 0;
+  linux_pimpl->pulsed_count = 0;
+}
+
+// Get the pulsed time from start time.
+int64_t Timer::GetPulsedTimeMicro() const {
+  const LinuxPimpl* linux_pimpl = reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  const int64_t diff = linux_pimpl->pulsed_count - linux_pimpl->start_count;
+  return RoundedDivide(diff, NANO_PER_MICRO);
+}
+
+int64_t Timer::GetPulsedTimeMilli() const {
+  const LinuxPimpl* linux_pimpl = reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  const int64_t diff = linux_pimpl->pulsed_count - linux_pimpl->start_count;
+  return RoundedDivide(diff, NANO_PER_MILLI);
+}
+
+int64_t Timer::GetPulsedTimeSeconds() const {
+  const LinuxPimpl* linux_pimpl = reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  const int64_t diff = linux_pimpl->pulsed_count - linux_pimpl->start_count;
+  return RoundedDivide(diff, NANO_PER_SECOND);
+}
+
+float Timer::GetPulsedTimeMicroFloat() const {
+  const int64_t micro_time = GetPulsedTimeMicro();
+  return static_cast<float>(micro_time);
+}
+
+float Timer::GetPulsedTimeMilliFloat() const {
+  const int64_t micro_time = GetPulsedTimeMicro();
+  return static_cast<float>(micro_time) / 1000.0f;
+}
+
+float Timer::GetPulsedTimeSecondsFloat() const {
+  const int64_t micro_time = GetPulsedTimeMicro();
+  return static_cast<float>(micro_time) / (1000.0f * 1000.0f);
+}
+
+// Get the pulsed time from the previous pulsed time.
+int64_t Timer::GetDiffTimeMicro() const {
+  const LinuxPimpl* linux_pimpl = reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  const int64_t diff = linux_pimpl->pulsed_count -
+                       linux_pimpl->last_pulsed_count;
+  return RoundedDivide(diff, NANO_PER_MICRO);
+}
+
+int64_t Timer::GetDiffTimeMilli() const {
+  const LinuxPimpl* linux_pimpl = reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  const int64_t diff = linux_pimpl->pulsed_count -
+                       linux_pimpl->last_pulsed_count;
+  return RoundedDivide(diff, NANO_PER_MILLI);
+}
+
+int64_t Timer::GetDiffTimeSeconds() const {
+  const LinuxPimpl* linux_pimpl = reinterpret_cast<const LinuxPimpl*>(mPimpl);
+  const int64_t diff = linux_pimpl->pulsed_count -
+                       linux_pimpl->last_pulsed_count;
+  return RoundedDivide(diff, NANO_PER_SECOND);
+}
+
+float Timer::GetDiffTimeMicroFloat() const {
+  const int64_t micro_time = GetDiffTimeMicro();
+  return static_cast<float>(micro_time);
+}
+
+float Timer::GetDiffTimeMilliFloat() const {
+  const int64_t micro_time = GetDiffTimeMicro();
+  return static_cast<float>(micro_time) / 1000.0f;
+}
+
+float Timer::GetDiffTimeSecondsFloat() const {
+  const int64_t micro_time = GetDiffTimeMicro();
+  return static_cast<float>(micro_time) / (1000.0f * 1000.0f);
+}
+
+}} // namespace ycommon { namespace platform {
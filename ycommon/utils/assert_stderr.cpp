@@ -0,0 +1,25 @@
+#include "ycommon/utils/assert.h"
+
+#include <cstdio>
+#include <stdlib.h>
+
+namespace ycommon { namespace utils {
+
+// Used where there is no window to show a message box, such as on servers.
+void Assert::Initialize(const platform::PlatformHandle&) {
+}
+
+void Assert::Terminate() {
+}
+
+void Assert::Assert(const char* file, uint32_t line, const char* message) {
+  fprintf(stderr, "Assertion: [%s:%u] %s\n", file, line, message);
+  fflush(stderr);
+  abort();
+}
+
+void Assert::Warn(const char* file, uint32_t line, const char* message) {
+  fprintf(stderr, "Warning: [%s:%u] %s\n", file, line, message);
+}
+
+}} // namespace ycommon { namespace utils {
@@ -1,6 +1,7 @@
 #ifndef YCOMMON_UTILS_HASH_H
 #define YCOMMON_UTILS_HASH_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace ycommon { namespace utils {
@@ -9,7 +9,8 @@ namespace {
   size_t gMaxStringSize = 0;
 }
 
-size_t GetAllocationSize(size_t max_string_size, size_t table_size) {
+size_t StringTable::GetAllocationSize(size_t max_string_size,
+                                     size_t table_size) {
   return ycommon::containers::AtomicHashTable::GetAllocationSize(
       table_size, max_string_size);
 }
@@ -22,6 +23,13 @@ void StringTable::Initialize(size_t max_string_size, size_t table_size,
   gMaxStringSize = max_string_size;
 }
 
+void StringTable::SetGrowthAllocator(
+    ycommon::containers::AtomicHashTable::AllocateFunc allocate_func,
+    ycommon::containers::AtomicHashTable::ReleaseFunc release_func,
+    void* allocator_arg) {
+  gHashTable.SetGrowthAllocator(allocate_func, release_func, allocator_arg);
+}
+
 void StringTable::Terminate() {
   gHashTable.Reset();
   gMaxStringSize = 0;
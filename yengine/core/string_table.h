@@ -4,10 +4,15 @@
 /***********
 * The String Table is a thread-safe shared global string table which contains
 * all the strings in the program.
+*   - With a growth allocator the table can start small and grow as strings
+*     are added, looked up strings stay valid until Terminate().
 ************/
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "ycommon/containers/atomic_hash_table.h"
+
 namespace yengine { namespace core {
 
 namespace StringTable {
@@ -16,6 +21,12 @@ namespace StringTable {
                   void* buffer, size_t buffer_size);
   void Terminate();
 
+  // Optional, lets the table grow past table_size instead of failing.
+  void SetGrowthAllocator(
+      ycommon::containers::AtomicHashTable::AllocateFunc allocate_func,
+      ycommon::containers::AtomicHashTable::ReleaseFunc release_func,
+      void* allocator_arg);
+
   uint64_t AddString(const char* string, size_t string_size);
   const char* StringLookup(uint64_t string_hash);
 }
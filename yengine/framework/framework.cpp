@@ -3,6 +3,8 @@
 #include "ycommon/containers/command_tree.h"
 #include "ycommon/platform/platform.h"
 #include "ycommon/utils/assert.h"
+#include "yengine/render_device/render_device.h"
+#include "yengine/renderer/renderer.h"
 
 namespace yengine { namespace framework {
 
@@ -14,10 +16,14 @@ static uintptr_t PlatformUpdateRoutine(void*) {
 }
 
 static uintptr_t PrepareRenderRoutine(void*) {
+  renderer::Renderer::PrepareDraw();
   return 0;
 }
 
 static uintptr_t RenderRoutine(void*) {
+  // Nothing is presented until the first frame has been prepared.
+  if (renderer::Renderer::ExecuteDraws())
+    render_device::RenderDevice::Present();
   return 0;
 }
 
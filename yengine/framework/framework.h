@@ -25,9 +25,8 @@ public:
   // commands but before actual render call. Best called at the end of the
   // previous frame.
   static ycommon::platform::ThreadRoutine GetPrepareRenderRoutine();
-  // Render call, called after Prepare Render to draw any commands prepared.
-  // Should probably be called at the beginning of a frame to draw the previous
-  // frame.
+  // Render call, draws and presents the frame prepared by the previous Prepare
+  // Render. Can run in parallel with the Prepare Render of the current frame.
   static ycommon::platform::ThreadRoutine GetRenderRoutine();
 
   // [Thread-Safe] Prepares command tree to be swapped at beginning of a frame.
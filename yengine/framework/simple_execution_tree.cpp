@@ -6,7 +6,7 @@
 namespace yengine { namespace framework {
 
 SimpleExecutionTree::SimpleExecutionTree(void* buffer, size_t buffer_size)
-  : ycommon::containers::CommandTree(1, buffer, buffer_size) {
+  : ycommon::containers::CommandTree(1, buffer, buffer_size, MAX_NODES) {
 }
 
 void SimpleExecutionTree::Setup(ycommon::platform::ThreadRoutine* routines,
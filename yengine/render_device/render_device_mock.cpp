@@ -1,5 +1,6 @@
 #include "yengine/render_device/render_device_mock.h"
 
+#include <string.h>
 #include <gmock/gmock.h>
 
 #include "ycommon/platform/platform_handle.h"
@@ -302,6 +303,16 @@ namespace {
   };
 
   MockRenderDevice* gMockRenderDevice = nullptr;
+
+  // Vertex declarations are usually copied before being created.
+  MATCHER_P2(VertexElementsEq, elements, num_elements, "") {
+    return num_elements == 0 ||
+           memcmp(arg, elements, num_elements * sizeof(elements[0])) == 0;
+  }
+
+  MATCHER_P2(BufferDataEq, buffer, buffer_size, "") {
+    return memcmp(arg, buffer, buffer_size) == 0;
+  }
   ycommon::platform::PlatformHandle gPlatformHandle;
   uint32_t gRenderWidth = 0;
   uint32_t gRenderHeight = 0;
@@ -772,8 +783,9 @@ void RenderDeviceMock::ExpectCreateRenderTarget(RenderTargetID ret,
 void RenderDeviceMock::ExpectCreateVertexDeclaration(
     VertexDeclID ret, const VertexDeclElement* elements,
     uint32_t num_elements) {
-  EXPECT_CALL(*gMockRenderDevice, CreateVertexDeclaration(elements,
-                                                          num_elements))
+  EXPECT_CALL(*gMockRenderDevice,
+              CreateVertexDeclaration(VertexElementsEq(elements, num_elements),
+                                      num_elements))
       .Times(1)
       .WillOnce(Return(ret));
 }
@@ -844,15 +856,15 @@ void RenderDeviceMock::ExpectCreateConstantBuffer(ConstantBufferID ret,
       .WillOnce(Return(ret));
 }
 
-void RenderDeviceMock::ExpectBeginRecord() {
+void RenderDeviceMock::ExpectBeginRecord(int times) {
   EXPECT_CALL(*gMockRenderDevice, BeginRecord())
-      .Times(1);
+      .Times(times);
 }
 
-void RenderDeviceMock::ExpectEndRecord(CommandListID ret) {
+void RenderDeviceMock::ExpectEndRecord(CommandListID ret, int times) {
   EXPECT_CALL(*gMockRenderDevice, EndRecord())
-      .Times(1)
-      .WillOnce(Return(ret));
+      .Times(times)
+      .WillRepeatedly(Return(ret));
 }
 
 void RenderDeviceMock::ExpectSetViewPort(ViewPortID viewport,
@@ -893,6 +905,18 @@ void RenderDeviceMock::ExpectFillVertexBuffer(VertexBufferID vertex_buffer,
       .Times(1);
 }
 
+void RenderDeviceMock::ExpectFillVertexBufferData(VertexBufferID vertex_buffer,
+                                                  uint32_t count,
+                                                  const void* buffer,
+                                                  uint32_t buffer_size,
+                                                  uint32_t index_offset) {
+  EXPECT_CALL(*gMockRenderDevice,
+              FillVertexBuffer(vertex_buffer, count,
+                               BufferDataEq(buffer, buffer_size),
+                               buffer_size, index_offset))
+      .Times(1);
+}
+
 void RenderDeviceMock::ExpectFillVertexBufferInterleaved(
     VertexBufferID vertex_buffer, uint32_t count,
     uint32_t num_interleaves, const uint32_t* stride_sizes,
@@ -1024,42 +1048,46 @@ void RenderDeviceMock::ExpectReleaseConstantBuffer(
       .Times(1);
 }
 
-void RenderDeviceMock::ExpectReleaseCommandList(CommandListID command_list) {
+void RenderDeviceMock::ExpectReleaseCommandList(CommandListID command_list,
+                                                int times) {
   EXPECT_CALL(*gMockRenderDevice, ReleaseCommandList(command_list))
-      .Times(1);
+      .Times(times);
 }
 
-void RenderDeviceMock::ExpectActivateViewPort(ViewPortID viewport) {
+void RenderDeviceMock::ExpectActivateViewPort(ViewPortID viewport,
+                                              int times) {
   EXPECT_CALL(*gMockRenderDevice, ActivateViewPort(viewport))
-      .Times(1);
+      .Times(times);
 }
 
 void RenderDeviceMock::ExpectActivateRenderBlendState(
-    RenderBlendStateID blend_state) {
+    RenderBlendStateID blend_state, int times) {
   EXPECT_CALL(*gMockRenderDevice, ActivateRenderBlendState(blend_state))
-      .Times(1);
+      .Times(times);
 }
 
 void RenderDeviceMock::ExpectActivateRenderTarget(
-    int target, RenderTargetID render_target) {
+    int target, RenderTargetID render_target, int times) {
   EXPECT_CALL(*gMockRenderDevice, ActivateRenderTarget(target, render_target))
-      .Times(1);
+      .Times(times);
 }
 
 void RenderDeviceMock::ExpectActivateVertexDeclaration(
-    VertexDeclID vertex_decl) {
+    VertexDeclID vertex_decl, int times) {
   EXPECT_CALL(*gMockRenderDevice, ActivateVertexDeclaration(vertex_decl))
-      .Times(1);
+      .Times(times);
 }
 
-void RenderDeviceMock::ExpectActivateVertexShader(VertexShaderID shader) {
+void RenderDeviceMock::ExpectActivateVertexShader(VertexShaderID shader,
+                                                  int times) {
   EXPECT_CALL(*gMockRenderDevice, ActivateVertexShader(shader))
-      .Times(1);
+      .Times(times);
 }
 
-void RenderDeviceMock::ExpectActivatePixelShader(PixelShaderID shader) {
+void RenderDeviceMock::ExpectActivatePixelShader(PixelShaderID shader,
+                                                 int times) {
   EXPECT_CALL(*gMockRenderDevice, ActivatePixelShader(shader))
-      .Times(1);
+      .Times(times);
 }
 
 void RenderDeviceMock::ExpectActivateVertexSamplerState(
@@ -1153,8 +1181,9 @@ void RenderDeviceMock::ExpectDrawIndexedInstanced(uint32_t start_index,
       .Times(1);
 }
 
-void RenderDeviceMock::ExpectExecuteCommandList(CommandListID commands) {
-  EXPECT_CALL(*gMockRenderDevice, ExecuteCommandList(commands)).Times(1);
+void RenderDeviceMock::ExpectExecuteCommandList(CommandListID commands,
+                                                int times) {
+  EXPECT_CALL(*gMockRenderDevice, ExecuteCommandList(commands)).Times(times);
 }
 
 void RenderDeviceMock::ExpectPresent() {
@@ -48,8 +48,9 @@ namespace RenderDeviceMock {
                                   uint32_t buffer_size = 0);
 
   // Command List
-  void ExpectBeginRecord();
-  void ExpectEndRecord(CommandListID ret);
+  // Parallel recording expects a record per command list.
+  void ExpectBeginRecord(int times = 1);
+  void ExpectEndRecord(CommandListID ret, int times = 1);
 
   // Modifiers
   void ExpectSetViewPort(ViewPortID viewport,
@@ -67,6 +68,11 @@ namespace RenderDeviceMock {
   void ExpectFillVertexBuffer(VertexBufferID vertex_buffer, uint32_t count,
                              const void* buffer, uint32_t buffer_size,
                              uint32_t index_offset = 0);
+  // Matches the buffer contents instead of the pointer, for data which is
+  // copied before it is filled.
+  void ExpectFillVertexBufferData(VertexBufferID vertex_buffer, uint32_t count,
+                                  const void* buffer, uint32_t buffer_size,
+                                  uint32_t index_offset = 0);
   void ExpectFillVertexBufferInterleaved(VertexBufferID vertex_buffer,
                                          uint32_t count,
                                          uint32_t num_interleaves,
@@ -108,15 +114,18 @@ namespace RenderDeviceMock {
   void ExpectReleaseVertexBuffer(VertexBufferID vertex_buffer);
   void ExpectReleaseIndexBuffer(IndexBufferID index_buffer);
   void ExpectReleaseConstantBuffer(ConstantBufferID constant_buffer);
-  void ExpectReleaseCommandList(CommandListID command_list);
+  void ExpectReleaseCommandList(CommandListID command_list, int times = 1);
 
   // Activations
-  void ExpectActivateViewPort(ViewPortID viewport);
-  void ExpectActivateRenderBlendState(RenderBlendStateID blend_state);
-  void ExpectActivateRenderTarget(int target, RenderTargetID render_target);
-  void ExpectActivateVertexDeclaration(VertexDeclID vertex_decl);
-  void ExpectActivateVertexShader(VertexShaderID shader);
-  void ExpectActivatePixelShader(PixelShaderID shader);
+  void ExpectActivateViewPort(ViewPortID viewport, int times = 1);
+  void ExpectActivateRenderBlendState(RenderBlendStateID blend_state,
+                                      int times = 1);
+  void ExpectActivateRenderTarget(int target, RenderTargetID render_target,
+                                  int times = 1);
+  void ExpectActivateVertexDeclaration(VertexDeclID vertex_decl,
+                                       int times = 1);
+  void ExpectActivateVertexShader(VertexShaderID shader, int times = 1);
+  void ExpectActivatePixelShader(PixelShaderID shader, int times = 1);
   void ExpectActivateVertexStream(uint32_t stream,
                                   VertexBufferID vertex_buffer);
   void ExpectActivateIndexStream(IndexBufferID index_buffer);
@@ -145,7 +154,7 @@ namespace RenderDeviceMock {
                                   uint32_t vertex_offset = 0);
 
   // Render
-  void ExpectExecuteCommandList(CommandListID commands);
+  void ExpectExecuteCommandList(CommandListID commands, int times = 1);
   void ExpectPresent();
 }
 
@@ -0,0 +1,1538 @@
+#include "yengine/render_device/render_device.h"
+#include "yengine/render_device/render_device_null.h"
+
+#include <string.h>
+
+#include "ycommon/containers/atomic_mem_pool.h"
+#include "ycommon/headers/atomics.h"
+#include "ycommon/headers/macros.h"
+#include "ycommon/utils/assert.h"
+#include "yengine/render_device/render_blend_state.h"
+#include "yengine/render_device/sampler_state.h"
+#include "yengine/render_device/vertex_decl_element.h"
+
+#define NULL_RENDER_TARGET static_cast<RenderTargetID>(-1)
+#define INVALID_COMMAND_LIST static_cast<CommandListID>(-1)
+#define INVALID_COMMAND_CHUNK static_cast<uint32_t>(-1)
+#define MAX_VIEWPORTS 8
+#define MAX_RENDER_BLEND_STATES 12
+#define MAX_SAMPLER_STATES 24
+#define MAX_ELEMENTS_PER_VERTEX 24
+#define MAX_STREAM_SOURCES 2
+#define MAX_RENDER_TARGETS 4
+#define MAX_VERTEX_SAMPLERS 4
+#define MAX_PIXEL_SAMPLERS 16
+#define MAX_NUM_SURFACES 12
+#define MAX_NUM_VERT_DECLS 32
+#define MAX_NUM_SHADERS 256
+#define MAX_NUM_TEXTURES 512
+#define MAX_NUM_VERT_BUFFS 512
+#define MAX_NUM_INDEX_BUFFS 512
+#define MAX_NUM_CONST_BUFFS 512
+
+// Recorded commands are stored in fixed size chunks shared by command lists.
+#define MAX_COMMAND_LISTS 64
+#define MAX_COMMAND_CHUNKS 512
+#define COMMANDS_PER_CHUNK 128
+#define MAX_COMMAND_ARGS 5
+
+namespace yengine { namespace render_device {
+
+/*************
+* Helper Classes
+**************/
+template <typename T, typename T_ID, size_t size>
+class DataArray : public ycommon::containers::ContainedAtomicMemPool<T, size> {
+ public:
+  bool used[size];
+
+  void Init() {
+    memset(used, 0, sizeof(used));
+    ycommon::containers::ContainedAtomicMemPool<T, size>::Init();
+    memset(this->GetBuffer(), 0, sizeof(T) * size);
+  }
+
+  void Release() {
+    const uint32_t count = this->GetNumIndexesUsed();
+    for (uint32_t i = 0; i < count; ++i) {
+      if (used[i]) {
+        used[i] = false;
+        (*this)[i].Release();
+      }
+    }
+  }
+
+  bool IsValid(T_ID id) {
+    return id < size && used[id];
+  }
+
+  T_ID AllocateID() {
+    uint32_t index = this->Allocate();
+    if (index != static_cast<uint32_t>(-1)) {
+      used[index] = true;
+      (*this)[index].Init();
+    }
+    return static_cast<T_ID>(index);
+  }
+
+  bool ReleaseID(T_ID id) {
+    if (!IsValid(id))
+      return false;
+
+    used[id] = false;
+    (*this)[id].Release();
+    this->Remove(static_cast<uint32_t>(id));
+    return true;
+  }
+};
+
+/*************
+* Global Variables
+**************/
+namespace {
+  enum CommandType {
+    kCommandType_ActivateViewPort,
+    kCommandType_ActivateRenderBlendState,
+    kCommandType_ActivateRenderTarget,
+    kCommandType_ActivateVertexDeclaration,
+    kCommandType_ActivateVertexShader,
+    kCommandType_ActivatePixelShader,
+    kCommandType_ActivateVertexStream,
+    kCommandType_ActivateIndexStream,
+    kCommandType_ActivateVertexConstantBuffer,
+    kCommandType_ActivatePixelConstantBuffer,
+    kCommandType_ActivateVertexSamplerState,
+    kCommandType_ActivatePixelSamplerState,
+    kCommandType_ActivateVertexTexture,
+    kCommandType_ActivatePixelTexture,
+    kCommandType_ActivateDrawPrimitive,
+    kCommandType_Draw,
+    kCommandType_DrawIndexed,
+
+    NUM_COMMAND_TYPES
+  };
+
+  struct Command {
+    uint32_t type;
+    uint32_t args[MAX_COMMAND_ARGS];
+  };
+
+  struct CommandChunk {
+    Command commands[COMMANDS_PER_CHUNK];
+    uint32_t num_commands;
+    uint32_t next_chunk;
+  };
+  ycommon::containers::ContainedAtomicMemPool<CommandChunk,
+                                              MAX_COMMAND_CHUNKS>
+      gCommandChunks;
+
+  // Command List Data
+  struct CommandListData {
+    uint32_t first_chunk;
+    uint32_t last_chunk;
+
+    void Init() {
+      first_chunk = INVALID_COMMAND_CHUNK;
+      last_chunk = INVALID_COMMAND_CHUNK;
+    }
+
+    void Release() {
+      uint32_t chunk = first_chunk;
+      while (chunk != INVALID_COMMAND_CHUNK) {
+        const uint32_t next_chunk = gCommandChunks[chunk].next_chunk;
+        gCommandChunks.Remove(chunk);
+        chunk = next_chunk;
+      }
+      Init();
+    }
+  };
+  DataArray<CommandListData, CommandListID, MAX_COMMAND_LISTS> gCommandLists;
+
+  // Each thread records into its own command list.
+  THREAD_LOCAL CommandListID gRecordingList = INVALID_COMMAND_LIST;
+
+  void* gMemory = NULL;
+  int64_t gMemorySize = 0;
+  volatile int64_t gUsedMemory = 0;
+  uint32_t gWidth = 0;
+  uint32_t gHeight = 0;
+
+  // Viewport Data
+  struct ViewPortData {
+    uint32_t top, left, width, height;
+    float min_z, max_z;
+
+    void Init() {
+      top = 0;
+      left = 0;
+      width = 0;
+      height = 0;
+      min_z = 0.0f;
+      max_z = 1.0f;
+    }
+
+    void Release() {}
+
+    void SetData(uint32_t _top, uint32_t _left,
+                 uint32_t _width, uint32_t _height,
+                 float _min_z, float _max_z) {
+      top = _top;
+      left = _left;
+      width = _width;
+      height = _height;
+      min_z = _min_z;
+      max_z = _max_z;
+    }
+  };
+  DataArray<ViewPortData, ViewPortID, MAX_VIEWPORTS> gViewPorts;
+
+  // Render Blend State
+  struct InternalRenderBlendState {
+    RenderBlendState state_data;
+    void Init() {}
+    void Release() {}
+  };
+  DataArray<InternalRenderBlendState,
+            RenderBlendStateID,
+            MAX_RENDER_BLEND_STATES> gRenderBlendStates;
+
+  // Sampler State
+  struct InternalSamplerState {
+    SamplerState state_data;
+    void Init() {}
+    void Release() {}
+  };
+  DataArray<InternalSamplerState,
+            SamplerStateID,
+            MAX_SAMPLER_STATES> gSamplerStates;
+
+  // Resources keep their memory when released, device memory is never freed
+  // so a new resource in the same slot reuses it when it fits.
+  void* AllocateMemory(size_t size);
+  void* ReserveMemory(void*& data, size_t& capacity, size_t size) {
+    if (size > capacity) {
+      data = AllocateMemory(size);
+      capacity = size;
+    }
+    return data;
+  }
+
+  // Texture Data
+  struct TextureData {
+    void* texture_data;
+    size_t texture_capacity;
+    UsageType usage;
+    PixelFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mips;
+
+    void Init() {
+      usage = kUsageType_Invalid;
+      format = NUM_PIXEL_FORMATS;
+      width = 0;
+      height = 0;
+      mips = 0;
+    }
+    void Release() {
+      Init();
+    }
+  };
+  DataArray<TextureData, TextureID, MAX_NUM_TEXTURES> gTextures;
+
+  // Surface Data
+  struct SurfaceData {
+    TextureID texture_id;
+    uint32_t width;
+    uint32_t height;
+    void Init() {
+      texture_id = static_cast<TextureID>(-1);
+      width = 0;
+      height = 0;
+    }
+    void Release() {
+      if (texture_id != static_cast<TextureID>(-1)) {
+        gTextures.ReleaseID(texture_id);
+      }
+      Init();
+    }
+  };
+  DataArray<SurfaceData, RenderTargetID, MAX_NUM_SURFACES> gSurfaces;
+
+  // Vertex Declaration Data
+  struct VertexDeclData {
+    uint32_t num_streams;
+    uint8_t stream_divisors[MAX_STREAM_SOURCES];
+    void Init() {
+      num_streams = 0;
+      memset(stream_divisors, 0, sizeof(stream_divisors));
+    }
+    void Release() {
+      Init();
+    }
+  };
+  DataArray<VertexDeclData, VertexDeclID, MAX_NUM_VERT_DECLS> gVertDecls;
+
+  // Shader Data, shaders are opaque blobs which are never run.
+  struct ShaderData {
+    size_t shader_size;
+    void Init() {
+      shader_size = 0;
+    }
+    void Release() {
+      Init();
+    }
+  };
+  DataArray<ShaderData, VertexShaderID, MAX_NUM_SHADERS> gVertShaders;
+  DataArray<ShaderData, PixelShaderID, MAX_NUM_SHADERS> gPixelShaders;
+
+  // Vertex Buffer Data
+  struct VertBuffData {
+    void* buffer_data;
+    size_t buffer_capacity;
+    UsageType usage;
+    uint32_t stride;
+    uint32_t total_count;
+    uint32_t count;
+
+    void Init() {
+      usage = kUsageType_Invalid;
+      stride = 0;
+      total_count = 0;
+      count = 0;
+    }
+    void Release() {
+      Init();
+    }
+  };
+  DataArray<VertBuffData, VertexBufferID, MAX_NUM_VERT_BUFFS> gVertexBuffers;
+
+  // Index Buffer Data
+  struct IndexBuffData {
+    void* buffer_data;
+    size_t buffer_capacity;
+    UsageType usage;
+    uint32_t total_count;
+    uint32_t count;
+
+    void Init() {
+      usage = kUsageType_Invalid;
+      total_count = 0;
+      count = 0;
+    }
+    void Release() {
+      Init();
+    }
+  };
+  DataArray<IndexBuffData, IndexBufferID, MAX_NUM_INDEX_BUFFS> gIndexBuffers;
+
+  // Constant Buffer Data
+  struct ConstBuffData {
+    void* buffer_data;
+    size_t buffer_capacity;
+    UsageType usage;
+    size_t size;
+
+    void Init() {
+      usage = kUsageType_Invalid;
+      size = 0;
+    }
+    void Release() {
+      Init();
+    }
+  };
+  DataArray<ConstBuffData, ConstantBufferID, MAX_NUM_CONST_BUFFS> gConstBuffers;
+
+  // Device state set by executed commands.
+  struct DeviceState {
+    ViewPortID viewport;
+    RenderBlendStateID blend_state;
+    RenderTargetID render_targets[MAX_RENDER_TARGETS];
+    VertexDeclID vertex_decl;
+    VertexShaderID vertex_shader;
+    PixelShaderID pixel_shader;
+    VertexBufferID streams[MAX_STREAM_SOURCES];
+    IndexBufferID index_buffer;
+    DrawPrimitive draw_primitive;
+  };
+  DeviceState gDeviceState;
+
+  RenderTargetID gBackBufferRenderTarget = 0;
+  RenderDeviceNull::FrameStats gFrameStats;
+  RenderDeviceNull::FrameStats gPresentedFrameStats;
+  uint32_t gNumPresentedFrames = 0;
+
+  void* AllocateMemory(size_t size) {
+    const int64_t memory_location = ycommon::AtomicAdd64(
+        &gUsedMemory, static_cast<int64_t>(size));
+    YASSERT(memory_location + static_cast<int64_t>(size) <= gMemorySize,
+            "Render Device has run out of memory! Maximum size: %u",
+            static_cast<uint32_t>(gMemorySize));
+
+    return static_cast<uint8_t*>(gMemory) + memory_location;
+  }
+
+  uint32_t GetTextureSize(const TextureData& texture_data, uint32_t mips) {
+    uint32_t width = texture_data.width;
+    uint32_t height = texture_data.height;
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < mips; ++i) {
+      size += width * height * kPixelFormatSize[texture_data.format];
+      width = (width <= 1) ? 1 : (width >> 1);
+      height = (height <= 1) ? 1 : (height >> 1);
+    }
+    return size;
+  }
+
+  uint32_t GetNumPrimitives(DrawPrimitive draw_primitive,
+                            uint32_t num_points) {
+    const uint32_t multiple = kPrimitiveMultiple[draw_primitive];
+    const uint32_t minimum = kPrimitiveMinimum[draw_primitive];
+    YASSERT(num_points >= minimum,
+            "Not enough points supplied (%u) for draw primitive %d.",
+            num_points, static_cast<int>(draw_primitive));
+    YASSERT(num_points % multiple == 0,
+            "Number of points (%u) is not a multiple of %u.",
+            num_points, multiple);
+
+    if (num_points < minimum)
+      return 0;
+    return (multiple > 1) ? (num_points / multiple) :
+                            (num_points - (minimum - 1));
+  }
+
+  void ExecuteDraw(const Command& command) {
+    const uint32_t start = command.args[0];
+    const uint32_t num_points = command.args[1];
+    const uint32_t num_instances = command.args[3];
+
+    YASSERT(gDeviceState.draw_primitive != NUM_DRAW_PRIMITIVES,
+            "Draw Primitive not activated.");
+    YASSERT(gVertDecls.IsValid(gDeviceState.vertex_decl),
+            "Vertex Declaration not activated.");
+    YASSERT(gVertShaders.IsValid(gDeviceState.vertex_shader),
+            "Vertex Shader not activated.");
+    YASSERT(gPixelShaders.IsValid(gDeviceState.pixel_shader),
+            "Pixel Shader not activated.");
+    if (!gVertDecls.IsValid(gDeviceState.vertex_decl) ||
+        gDeviceState.draw_primitive == NUM_DRAW_PRIMITIVES)
+      return;
+
+    const VertexDeclData& vertex_decl_data =
+        gVertDecls[gDeviceState.vertex_decl];
+    for (uint32_t i = 0; i < vertex_decl_data.num_streams; ++i) {
+      YASSERT(gVertexBuffers.IsValid(gDeviceState.streams[i]),
+              "Vertex Stream %u not activated.", i);
+    }
+    if (!gVertexBuffers.IsValid(gDeviceState.streams[0]))
+      return;
+
+    const uint32_t vertex_count =
+        gVertexBuffers[gDeviceState.streams[0]].count;
+    uint32_t num_vertexes = num_points;
+    if (command.type == kCommandType_DrawIndexed) {
+      YASSERT(gIndexBuffers.IsValid(gDeviceState.index_buffer),
+              "Index Stream not activated.");
+      if (!gIndexBuffers.IsValid(gDeviceState.index_buffer))
+        return;
+
+      const uint32_t index_count =
+          gIndexBuffers[gDeviceState.index_buffer].count;
+      YASSERT(start + num_points <= index_count,
+              "Drawing indexes [%u, %u) out of %u filled indexes.",
+              start, start + num_points, index_count);
+      const uint32_t vertex_offset = command.args[4];
+      YASSERT(vertex_offset < vertex_count,
+              "Vertex offset %u out of %u filled vertexes.",
+              vertex_offset, vertex_count);
+      num_vertexes = vertex_count - vertex_offset;
+    } else {
+      YASSERT(start + num_points <= vertex_count,
+              "Drawing vertexes [%u, %u) out of %u filled vertexes.",
+              start, start + num_points, vertex_count);
+    }
+
+    gFrameStats.mNumDrawCalls++;
+    gFrameStats.mNumInstances += num_instances;
+    gFrameStats.mNumVertexes += static_cast<uint64_t>(num_vertexes) *
+                                num_instances;
+    gFrameStats.mNumPrimitives += static_cast<uint64_t>(
+        GetNumPrimitives(gDeviceState.draw_primitive, num_points)) *
+        num_instances;
+  }
+
+  void ExecuteCommand(const Command& command) {
+    gFrameStats.mNumCommands++;
+    if (command.type < kCommandType_Draw)
+      gFrameStats.mNumActivations++;
+
+    switch (command.type) {
+      case kCommandType_ActivateViewPort:
+        gDeviceState.viewport = static_cast<ViewPortID>(command.args[0]);
+        break;
+      case kCommandType_ActivateRenderBlendState:
+        gDeviceState.blend_state =
+            static_cast<RenderBlendStateID>(command.args[0]);
+        break;
+      case kCommandType_ActivateRenderTarget:
+        gDeviceState.render_targets[command.args[0]] =
+            static_cast<RenderTargetID>(command.args[1]);
+        break;
+      case kCommandType_ActivateVertexDeclaration:
+        gDeviceState.vertex_decl = static_cast<VertexDeclID>(command.args[0]);
+        break;
+      case kCommandType_ActivateVertexShader:
+        gDeviceState.vertex_shader =
+            static_cast<VertexShaderID>(command.args[0]);
+        break;
+      case kCommandType_ActivatePixelShader:
+        gDeviceState.pixel_shader = static_cast<PixelShaderID>(command.args[0]);
+        break;
+      case kCommandType_ActivateVertexStream:
+        gDeviceState.streams[command.args[0]] =
+            static_cast<VertexBufferID>(command.args[1]);
+        break;
+      case kCommandType_ActivateIndexStream:
+        gDeviceState.index_buffer = static_cast<IndexBufferID>(command.args[0]);
+        break;
+      case kCommandType_ActivateVertexConstantBuffer:
+      case kCommandType_ActivatePixelConstantBuffer:
+      case kCommandType_ActivateVertexSamplerState:
+      case kCommandType_ActivatePixelSamplerState:
+      case kCommandType_ActivateVertexTexture:
+      case kCommandType_ActivatePixelTexture:
+        // Bindings are only read by shaders, validated when submitted.
+        break;
+      case kCommandType_ActivateDrawPrimitive:
+        gDeviceState.draw_primitive =
+            static_cast<DrawPrimitive>(command.args[0]);
+        break;
+      case kCommandType_Draw:
+      case kCommandType_DrawIndexed:
+        ExecuteDraw(command);
+        break;
+      default:
+        YFATAL("Invalid Command Type: %u", command.type);
+    }
+  }
+
+  // Commands are executed immediately unless the thread is recording.
+  void SubmitCommand(CommandType type,
+                     uint32_t arg0 = 0, uint32_t arg1 = 0, uint32_t arg2 = 0,
+                     uint32_t arg3 = 0, uint32_t arg4 = 0) {
+    const Command command = { static_cast<uint32_t>(type),
+                              { arg0, arg1, arg2, arg3, arg4 } };
+    if (gRecordingList == INVALID_COMMAND_LIST) {
+      ExecuteCommand(command);
+      return;
+    }
+
+    CommandListData& command_list = gCommandLists[gRecordingList];
+    if (command_list.last_chunk == INVALID_COMMAND_CHUNK ||
+        gCommandChunks[command_list.last_chunk].num_commands ==
+            COMMANDS_PER_CHUNK) {
+      const uint32_t chunk = gCommandChunks.Allocate();
+      YASSERT(chunk != INVALID_COMMAND_CHUNK,
+              "Maximum number of command chunks reached.");
+      gCommandChunks[chunk].num_commands = 0;
+      gCommandChunks[chunk].next_chunk = INVALID_COMMAND_CHUNK;
+
+      if (command_list.last_chunk == INVALID_COMMAND_CHUNK)
+        command_list.first_chunk = chunk;
+      else
+        gCommandChunks[command_list.last_chunk].next_chunk = chunk;
+      command_list.last_chunk = chunk;
+    }
+
+    CommandChunk& command_chunk = gCommandChunks[command_list.last_chunk];
+    command_chunk.commands[command_chunk.num_commands++] = command;
+  }
+}
+
+void RenderDevice::Initialize(const ycommon::platform::PlatformHandle& handle,
+                              uint32_t width, uint32_t height,
+                              void* buffer, size_t buffer_size) {
+  static_cast<void>(handle);
+
+  gMemory = buffer;
+  gMemorySize = static_cast<int64_t>(buffer_size);
+  gUsedMemory = 0;
+  gWidth = width;
+  gHeight = height;
+
+  // Initialize Various Data Handlers
+  gCommandChunks.Init();
+  gCommandLists.Init();
+  gViewPorts.Init();
+  gRenderBlendStates.Init();
+  gSamplerStates.Init();
+  gTextures.Init();
+  gSurfaces.Init();
+  gVertDecls.Init();
+  gVertShaders.Init();
+  gPixelShaders.Init();
+  gVertexBuffers.Init();
+  gIndexBuffers.Init();
+  gConstBuffers.Init();
+
+  // The back buffer has no texture, nothing is ever drawn into it.
+  gBackBufferRenderTarget = gSurfaces.AllocateID();
+  gSurfaces[gBackBufferRenderTarget].width = width;
+  gSurfaces[gBackBufferRenderTarget].height = height;
+
+  memset(&gDeviceState, -1, sizeof(gDeviceState));
+  gDeviceState.draw_primitive = NUM_DRAW_PRIMITIVES;
+  memset(&gFrameStats, 0, sizeof(gFrameStats));
+  memset(&gPresentedFrameStats, 0, sizeof(gPresentedFrameStats));
+  gNumPresentedFrames = 0;
+}
+
+void RenderDevice::Terminate() {
+  gCommandLists.Release();
+  gConstBuffers.Release();
+  gIndexBuffers.Release();
+  gVertexBuffers.Release();
+  gPixelShaders.Release();
+  gVertShaders.Release();
+  gVertDecls.Release();
+  gSurfaces.Release();
+  gTextures.Release();
+  gSamplerStates.Release();
+  gRenderBlendStates.Release();
+  gViewPorts.Release();
+
+  gRecordingList = INVALID_COMMAND_LIST;
+  gMemory = NULL;
+  gMemorySize = 0;
+  gUsedMemory = 0;
+}
+
+// System Values
+RenderTargetID RenderDevice::GetNullRenderTarget() {
+  return NULL_RENDER_TARGET;
+}
+
+RenderTargetID RenderDevice::GetBackBufferRenderTarget() {
+  return gBackBufferRenderTarget;
+}
+
+TextureID RenderDevice::GetRenderTargetTexture(RenderTargetID render_target) {
+  YASSERT(gSurfaces.IsValid(render_target),
+          "Getting Texture for Invalid Render Target: %d",
+          static_cast<int>(render_target));
+  return gSurfaces[render_target].texture_id;
+}
+
+// Creates
+ViewPortID RenderDevice::CreateViewPort(uint32_t top, uint32_t left,
+                                        uint32_t width, uint32_t height,
+                                        float min_z, float max_z) {
+  const ViewPortID viewport_id = gViewPorts.AllocateID();
+  YASSERT(viewport_id != static_cast<ViewPortID>(-1),
+          "Maximum number of viewports reached.");
+
+  gViewPorts[viewport_id].SetData(top, left, width, height, min_z, max_z);
+  return viewport_id;
+}
+
+RenderBlendStateID RenderDevice::CreateRenderBlendState(
+    const RenderBlendState& state) {
+  YASSERT(state.source >= 0 && state.source < NUM_RENDER_BLENDS,
+          "Invalid Render Blend source: %d", static_cast<int>(state.source));
+  YASSERT(state.dest >= 0 && state.dest < NUM_RENDER_BLENDS,
+          "Invalid Render Blend dest: %d", static_cast<int>(state.dest));
+  YASSERT(state.blend_op >= 0 && state.blend_op < NUM_RENDER_BLEND_OPS,
+          "Invalid Render Blend op: %d", static_cast<int>(state.blend_op));
+  YASSERT(state.alpha_source >= 0 && state.alpha_source < NUM_RENDER_BLENDS,
+          "Invalid Alpha Render Blend source: %d",
+          static_cast<int>(state.alpha_source));
+  YASSERT(state.alpha_dest >= 0 && state.alpha_dest < NUM_RENDER_BLENDS,
+          "Invalid Alpha Render Blend dest: %d",
+          static_cast<int>(state.alpha_dest));
+  YASSERT(state.alpha_blend_op >= 0 &&
+          state.alpha_blend_op < NUM_RENDER_BLEND_OPS,
+          "Invalid Alpha Render Blend op: %d",
+          static_cast<int>(state.alpha_blend_op));
+
+  const RenderBlendStateID state_id = gRenderBlendStates.AllocateID();
+  YASSERT(state_id != static_cast<RenderBlendStateID>(-1),
+          "Maximum number of render blend states reached.");
+
+  gRenderBlendStates[state_id].state_data = state;
+  return state_id;
+}
+
+RenderTargetID RenderDevice::CreateRenderTarget(uint32_t width, uint32_t height,
+                                                PixelFormat format) {
+  YASSERT(format >= 0 && format < NUM_PIXEL_FORMATS,
+          "Invalid Pixel Format: %d", static_cast<int>(format));
+
+  const TextureID texture_id = gTextures.AllocateID();
+  YASSERT(texture_id != static_cast<TextureID>(-1),
+          "Maximum number of textures reached.");
+
+  const RenderTargetID surface_id = gSurfaces.AllocateID();
+  YASSERT(surface_id != static_cast<RenderTargetID>(-1),
+          "Maximum number of surfaces reached.");
+
+  TextureData& texture_data = gTextures[texture_id];
+  texture_data.usage = kUsageType_System;
+  texture_data.format = format;
+  texture_data.width = width;
+  texture_data.height = height;
+  texture_data.mips = 1;
+  ReserveMemory(texture_data.texture_data, texture_data.texture_capacity,
+                GetTextureSize(texture_data, 1));
+
+  SurfaceData& surface_data = gSurfaces[surface_id];
+  surface_data.texture_id = texture_id;
+  surface_data.width = width;
+  surface_data.height = height;
+  return surface_id;
+}
+
+VertexDeclID RenderDevice::CreateVertexDeclaration(
+    const VertexDeclElement* elements, uint32_t num_elements) {
+  YASSERT(num_elements <= MAX_ELEMENTS_PER_VERTEX,
+          "Maximum number of elements per vertex declaration is %u, %u given.",
+          static_cast<uint32_t>(MAX_ELEMENTS_PER_VERTEX),
+          static_cast<uint32_t>(num_elements));
+
+  const VertexDeclID vert_decl_id = gVertDecls.AllocateID();
+  YASSERT(vert_decl_id != static_cast<VertexDeclID>(-1),
+          "Maximum number of vertex declarations reached.");
+
+  VertexDeclData& vertex_decl_data = gVertDecls[vert_decl_id];
+  uint8_t max_streams = 0;
+  bool stream_divisor_set[MAX_STREAM_SOURCES] = { false };
+
+  for (uint32_t i = 0; i < num_elements; ++i) {
+    const VertexDeclElement& decl_element = elements[i];
+    YASSERT(decl_element.mStreamNum < MAX_STREAM_SOURCES,
+            "Maximum stream source is %u, %u supplied as vertex element.",
+            static_cast<uint32_t>(MAX_STREAM_SOURCES),
+            static_cast<uint32_t>(decl_element.mStreamNum));
+    if (decl_element.mStreamNum >= MAX_STREAM_SOURCES)
+      continue;
+
+    if (decl_element.mStreamNum > max_streams)
+      max_streams = decl_element.mStreamNum;
+
+    if (stream_divisor_set[decl_element.mStreamNum]) {
+      YASSERT(decl_element.mInstanceDivisor ==
+              vertex_decl_data.stream_divisors[decl_element.mStreamNum],
+              "Instance divisor must all match.");
+    } else {
+      stream_divisor_set[decl_element.mStreamNum] = true;
+      vertex_decl_data.stream_divisors[decl_element.mStreamNum] =
+          decl_element.mInstanceDivisor;
+    }
+  }
+
+  vertex_decl_data.num_streams = max_streams + 1;
+  return vert_decl_id;
+}
+
+VertexShaderID RenderDevice::CreateVertexShader(const void* shader_data,
+                                                size_t shader_size) {
+  static_cast<void>(shader_data);
+  YASSERT(shader_size != 0, "Cannot create empty vertex shader.");
+  const VertexShaderID shader_id = gVertShaders.AllocateID();
+  YASSERT(shader_id != static_cast<VertexShaderID>(-1),
+          "Maximum number of Vertex Shaders reached.");
+
+  gVertShaders[shader_id].shader_size = shader_size;
+  return shader_id;
+}
+
+PixelShaderID RenderDevice::CreatePixelShader(const void* shader_data,
+                                              size_t shader_size) {
+  static_cast<void>(shader_data);
+  YASSERT(shader_size != 0, "Cannot create empty pixel shader.");
+  const PixelShaderID shader_id = gPixelShaders.AllocateID();
+  YASSERT(shader_id != static_cast<PixelShaderID>(-1),
+          "Maximum number of Pixel Shaders reached.");
+
+  gPixelShaders[shader_id].shader_size = shader_size;
+  return shader_id;
+}
+
+SamplerStateID RenderDevice::CreateSamplerState(const SamplerState& state) {
+  YASSERT(state.filter >= 0 && state.filter < NUM_SAMPLER_FILTERS,
+          "Invalid Sampler Filter: %d", static_cast<int>(state.filter));
+  YASSERT(state.address_mode_u >= 0 &&
+          state.address_mode_u < NUM_SAMPLER_ADDRESS_MODES,
+          "Invalid Sampler Address Mode U: %d",
+          static_cast<int>(state.address_mode_u));
+  YASSERT(state.address_mode_v >= 0 &&
+          state.address_mode_v < NUM_SAMPLER_ADDRESS_MODES,
+          "Invalid Sampler Address Mode V: %d",
+          static_cast<int>(state.address_mode_v));
+  YASSERT(state.address_mode_w >= 0 &&
+          state.address_mode_w < NUM_SAMPLER_ADDRESS_MODES,
+          "Invalid Sampler Address Mode W: %d",
+          static_cast<int>(state.address_mode_w));
+
+  const SamplerStateID state_id = gSamplerStates.AllocateID();
+  YASSERT(state_id != static_cast<SamplerStateID>(-1),
+          "Maximum number of sampler states reached.");
+
+  gSamplerStates[state_id].state_data = state;
+  return state_id;
+}
+
+TextureID RenderDevice::CreateTexture(UsageType type, uint32_t width,
+                                      uint32_t height, uint32_t mips,
+                                      PixelFormat format,
+                                      const void* buffer,
+                                      uint32_t buffer_size) {
+  YASSERT(format >= 0 && format < NUM_PIXEL_FORMATS,
+          "Invalid Pixel Format: %d", static_cast<int>(format));
+  YASSERT(IS_POWER_OF_2(width),
+          "Texture width must be power of 2: %u", width);
+  YASSERT(IS_POWER_OF_2(height),
+          "Texture height must be power of 2: %u", height);
+
+  const TextureID texture_id = gTextures.AllocateID();
+  YASSERT(texture_id != static_cast<TextureID>(-1),
+          "Maximum number of textures reached.");
+
+  TextureData& texture_data = gTextures[texture_id];
+  texture_data.format = format;
+  texture_data.width = width;
+  texture_data.height = height;
+  texture_data.mips = mips;
+  ReserveMemory(texture_data.texture_data, texture_data.texture_capacity,
+                GetTextureSize(texture_data, mips));
+
+  switch (type) {
+    case kUsageType_Immutable:
+      YASSERT(buffer && buffer_size > 0,
+              "Immutable texture must be initialized upon creation.");
+
+      texture_data.usage = kUsageType_Static;
+      FillTexture(texture_id, buffer, buffer_size);
+      texture_data.usage = kUsageType_Immutable;
+      break;
+
+    case kUsageType_Static:
+    case kUsageType_Dynamic:
+      texture_data.usage = type;
+      if (buffer_size > 0)
+        FillTexture(texture_id, buffer, buffer_size);
+      break;
+
+    default:
+      YFATAL("Invalid Usage Type used in Texture Creation: %d",
+             static_cast<int>(type));
+  }
+
+  return texture_id;
+}
+
+VertexBufferID RenderDevice::CreateVertexBuffer(UsageType type, uint32_t stride,
+                                                uint32_t count,
+                                                const void* buffer,
+                                                uint32_t buffer_size) {
+  const VertexBufferID vert_id = gVertexBuffers.AllocateID();
+  YASSERT(vert_id != static_cast<VertexBufferID>(-1),
+          "Maximum number of vertex buffers reached.");
+
+  VertBuffData& vertex_buffer_data = gVertexBuffers[vert_id];
+  ReserveMemory(vertex_buffer_data.buffer_data,
+                vertex_buffer_data.buffer_capacity, stride * count);
+  vertex_buffer_data.stride = stride;
+  vertex_buffer_data.total_count = count;
+  vertex_buffer_data.count = 0;
+
+  switch (type) {
+    case kUsageType_Immutable:
+      YASSERT(buffer && buffer_size > 0,
+              "Immutable vertex buffer must be initialized upon creation.");
+
+      vertex_buffer_data.usage = kUsageType_Static;
+      FillVertexBuffer(vert_id, count, buffer, buffer_size);
+      vertex_buffer_data.usage = kUsageType_Immutable;
+      break;
+
+    case kUsageType_Static:
+    case kUsageType_Dynamic:
+      vertex_buffer_data.usage = type;
+      if (buffer_size > 0)
+        FillVertexBuffer(vert_id, count, buffer, buffer_size);
+      break;
+
+    default:
+      YFATAL("Invalid Usage Type used in Vertex Buffer Creation: %d",
+             static_cast<int>(type));
+  }
+
+  return vert_id;
+}
+
+IndexBufferID RenderDevice::CreateIndexBuffer(UsageType type, uint32_t count,
+                                              const void* buffer,
+                                              uint32_t buffer_size) {
+  const IndexBufferID indx_id = gIndexBuffers.AllocateID();
+  YASSERT(indx_id != static_cast<IndexBufferID>(-1),
+          "Maximum number of index buffers reached.");
+
+  IndexBuffData& index_buffer_data = gIndexBuffers[indx_id];
+  ReserveMemory(index_buffer_data.buffer_data,
+                index_buffer_data.buffer_capacity, count * sizeof(uint16_t));
+  index_buffer_data.total_count = count;
+  index_buffer_data.count = 0;
+
+  switch (type) {
+    case kUsageType_Immutable:
+      YASSERT(buffer && buffer_size > 0,
+              "Immutable index buffer must be initialized upon creation.");
+
+      index_buffer_data.usage = kUsageType_Static;
+      FillIndexBuffer(indx_id, count, buffer, buffer_size);
+      index_buffer_data.usage = kUsageType_Immutable;
+      break;
+
+    case kUsageType_Static:
+    case kUsageType_Dynamic:
+      index_buffer_data.usage = type;
+      if (buffer_size > 0)
+        FillIndexBuffer(indx_id, count, buffer, buffer_size);
+      break;
+
+    default:
+      YFATAL("Invalid Usage Type used in Index Buffer Creation: %d",
+             static_cast<int>(type));
+  }
+
+  return indx_id;
+}
+
+ConstantBufferID RenderDevice::CreateConstantBuffer(UsageType type,
+                                                    uint32_t size,
+                                                    const void* buffer,
+                                                    uint32_t buffer_size) {
+  YASSERT(size % (sizeof(float) * 4) == 0,
+          "Constant buffer size must be a multiple of %u bytes: %u",
+          static_cast<uint32_t>(sizeof(float) * 4),
+          static_cast<uint32_t>(size));
+  const ConstantBufferID buff_id = gConstBuffers.AllocateID();
+  YASSERT(buff_id != static_cast<ConstantBufferID>(-1),
+          "Maximum number of constant buffers reached.");
+
+  ConstBuffData& const_buffer_data = gConstBuffers[buff_id];
+  void* allocated_data = ReserveMemory(const_buffer_data.buffer_data,
+                                       const_buffer_data.buffer_capacity,
+                                       size);
+  memset(allocated_data, 0, size);
+  const_buffer_data.size = size;
+
+  switch (type) {
+    case kUsageType_Immutable:
+      YASSERT(buffer && buffer_size > 0,
+              "Immutable constant buffer must be initialized upon creation.");
+
+      const_buffer_data.usage = kUsageType_Static;
+      FillConstantBuffer(buff_id, buffer, buffer_size);
+      const_buffer_data.usage = kUsageType_Immutable;
+      break;
+
+    case kUsageType_Static:
+    case kUsageType_Dynamic:
+      const_buffer_data.usage = type;
+      if (buffer_size > 0)
+        FillConstantBuffer(buff_id, buffer, buffer_size);
+      break;
+
+    default:
+      YFATAL("Invalid Usage Type used in constant Buffer Creation: %d",
+             static_cast<int>(type));
+  }
+
+  return buff_id;
+}
+
+// Command List
+void RenderDevice::BeginRecord() {
+  YASSERT(gRecordingList == INVALID_COMMAND_LIST,
+          "Command list %d is already being recorded.",
+          static_cast<int>(gRecordingList));
+
+  gRecordingList = gCommandLists.AllocateID();
+  YASSERT(gRecordingList != INVALID_COMMAND_LIST,
+          "Maximum number of command lists reached.");
+}
+
+CommandListID RenderDevice::EndRecord() {
+  YASSERT(gRecordingList != INVALID_COMMAND_LIST,
+          "No command list is being recorded.");
+
+  const CommandListID command_list = gRecordingList;
+  gRecordingList = INVALID_COMMAND_LIST;
+  return command_list;
+}
+
+// Modifiers
+void RenderDevice::SetViewPort(ViewPortID viewport,
+                               uint32_t top, uint32_t left,
+                               uint32_t width, uint32_t height,
+                               float min_z, float max_z) {
+  YASSERT(gViewPorts.IsValid(viewport),
+          "Setting Invalid View Port ID: %d.", static_cast<int>(viewport));
+  gViewPorts[viewport].SetData(top, left, width, height, min_z, max_z);
+}
+
+void RenderDevice::FillTexture(TextureID texture, const void* buffer,
+                               uint32_t size) {
+  YASSERT(gTextures.IsValid(texture),
+          "Filling Invalid Texture ID: %d.", static_cast<int>(texture));
+
+  TextureData& texture_data = gTextures[texture];
+  const uint32_t texture_size = GetTextureSize(texture_data, texture_data.mips);
+  YASSERT(texture_size == size,
+          "Texture fill buffer size (%u) did not match texture (%ux%ux%u).",
+          size, texture_data.width, texture_data.height, texture_data.mips);
+
+  uint32_t used_size = 0;
+  for (uint32_t i = 0; i < texture_data.mips; ++i) {
+    const uint32_t mip_size = GetTextureSize(texture_data, i + 1) - used_size;
+    FillTextureMip(texture, i,
+                   static_cast<const uint8_t*>(buffer) + used_size,
+                   mip_size);
+    used_size += mip_size;
+  }
+}
+
+void RenderDevice::FillTextureMip(TextureID texture, uint32_t mip,
+                                  const void* buffer, uint32_t size) {
+  YASSERT(gTextures.IsValid(texture),
+          "Filling Invalid Texture ID: %d.", static_cast<int>(texture));
+
+  TextureData& texture_data = gTextures[texture];
+  YASSERT(texture_data.usage == kUsageType_Static ||
+          texture_data.usage == kUsageType_Dynamic,
+          "Cannot fill texture with usage type: %d.",
+          static_cast<int>(texture_data.usage));
+  YASSERT(mip < texture_data.mips,
+          "Invalid texture mip (%u) for texture with %u mips.",
+          mip, texture_data.mips);
+
+  const uint32_t mip_offset = GetTextureSize(texture_data, mip);
+  const uint32_t mip_size = GetTextureSize(texture_data, mip + 1) - mip_offset;
+  YASSERT(size == mip_size,
+          "Invalid texture fill size (%u) for mip (%u) for texture %ux%u.",
+          size, mip, texture_data.width, texture_data.height);
+
+  memcpy(static_cast<uint8_t*>(texture_data.texture_data) + mip_offset,
+         buffer, mip_size);
+}
+
+void RenderDevice::ResetVertexBuffer(VertexBufferID vertex_buffer) {
+  YASSERT(gVertexBuffers.IsValid(vertex_buffer),
+          "Resetting Invalid Vertex Buffer ID: %d.",
+          static_cast<int>(vertex_buffer));
+
+  gVertexBuffers[vertex_buffer].count = 0;
+}
+
+void RenderDevice::FillVertexBuffer(VertexBufferID vertex_buffer,
+                                    uint32_t count,
+                                    const void* buffer, uint32_t buffer_size,
+                                    uint32_t index_offset) {
+  YASSERT(gVertexBuffers.IsValid(vertex_buffer),
+          "Filling Invalid Vertex Buffer ID: %d.",
+          static_cast<int>(vertex_buffer));
+
+  VertBuffData& vertex_buffer_data = gVertexBuffers[vertex_buffer];
+  FillVertexBufferInterleaved(vertex_buffer, count, 1,
+                              &vertex_buffer_data.stride,
+                              &buffer, &buffer_size,
+                              index_offset);
+}
+
+void RenderDevice::FillVertexBufferInterleaved(
+    VertexBufferID vertex_buffer, uint32_t count, uint32_t num_interleaves,
+    const uint32_t* stride_sizes, const void* const* buffers,
+    const uint32_t* buffer_sizes, uint32_t index_offset) {
+  YASSERT(gVertexBuffers.IsValid(vertex_buffer),
+          "Filling Invalid Vertex Buffer ID: %d.",
+          static_cast<int>(vertex_buffer));
+
+  VertBuffData& vertex_buffer_data = gVertexBuffers[vertex_buffer];
+  YASSERT(vertex_buffer_data.usage == kUsageType_Static ||
+          vertex_buffer_data.usage == kUsageType_Dynamic,
+          "Cannot fill vertex buffer with usage type: %d.",
+          static_cast<int>(vertex_buffer_data.usage));
+
+  const uint32_t index_end = index_offset + count;
+  YASSERT(index_end <= vertex_buffer_data.total_count,
+          "Could not fill vertex buffer ID %d, maximum count exceeded.",
+          static_cast<int>(vertex_buffer));
+  if (index_end > vertex_buffer_data.total_count)
+    return;
+
+  vertex_buffer_data.count = index_end > vertex_buffer_data.count ?
+                             index_end :
+                             vertex_buffer_data.count;
+
+  uint32_t total_stride = 0;
+  uint32_t total_buffer_size = 0;
+  for (uint32_t i = 0; i < num_interleaves; ++i) {
+    total_stride += stride_sizes[i];
+    total_buffer_size += buffer_sizes[i];
+  }
+  YASSERT(total_stride == vertex_buffer_data.stride,
+          "Total stride count (%u) does not match initialization stride (%u).",
+          total_stride, vertex_buffer_data.stride);
+
+  const uint32_t stride = vertex_buffer_data.stride;
+  const uint32_t fill_size = count * stride;
+  YASSERT(fill_size == total_buffer_size,
+          "Vertex Fill size (%u) did not match buffer size (%u).",
+          fill_size, total_buffer_size);
+  if (fill_size != total_buffer_size || total_stride != stride)
+    return;
+
+  uint8_t* data_ptr = static_cast<uint8_t*>(vertex_buffer_data.buffer_data) +
+                      index_offset * stride;
+  if (num_interleaves == 1) {
+    memcpy(data_ptr, *buffers, total_buffer_size);
+  } else {
+    for (uint32_t i = 0; i < count; ++i) {
+      for (uint32_t n = 0; n < num_interleaves; ++n) {
+        const uint32_t buffer_stride = stride_sizes[n];
+        const uint8_t* buffer =
+            static_cast<const uint8_t*>(buffers[n]) + buffer_stride * i;
+        memcpy(data_ptr, buffer, buffer_stride);
+        data_ptr += buffer_stride;
+      }
+    }
+  }
+}
+
+void RenderDevice::ResetIndexBuffer(IndexBufferID index_buffer) {
+  YASSERT(gIndexBuffers.IsValid(index_buffer),
+          "Resetting Invalid Index Buffer ID: %d.",
+          static_cast<int>(index_buffer));
+
+  gIndexBuffers[index_buffer].count = 0;
+}
+
+// Appended indexes are offset by the starting offset when one is given.
+void RenderDevice::AppendIndexBuffer(IndexBufferID index_buffer,
+                                     uint32_t count,
+                                     const void* buffer, uint32_t buffer_size,
+                                     const uint32_t* starting_offset) {
+  YASSERT(gIndexBuffers.IsValid(index_buffer),
+          "Appending Invalid Index Buffer ID: %d.",
+          static_cast<int>(index_buffer));
+
+  const uint32_t vertex_offset = starting_offset ? *starting_offset : 0;
+  YASSERT(vertex_offset <= UINT16_MAX,
+          "Index starting offset (%u) exceeds 16 bit indexes.",
+          vertex_offset);
+  FillIndexBuffer(index_buffer, count, buffer, buffer_size,
+                  static_cast<uint16_t>(vertex_offset),
+                  gIndexBuffers[index_buffer].count);
+}
+
+void RenderDevice::FillIndexBuffer(IndexBufferID index_buffer, uint32_t count,
+                                   const void* buffer, uint32_t buffer_size,
+                                   uint16_t vertex_offset,
+                                   uint32_t index_offset) {
+  YASSERT(gIndexBuffers.IsValid(index_buffer),
+          "Filling Invalid Index Buffer ID: %d.",
+          static_cast<int>(index_buffer));
+
+  IndexBuffData& index_buffer_data = gIndexBuffers[index_buffer];
+  YASSERT(index_buffer_data.usage == kUsageType_Static ||
+          index_buffer_data.usage == kUsageType_Dynamic,
+          "Cannot fill index buffer with usage type: %d.",
+          static_cast<int>(index_buffer_data.usage));
+
+  const uint32_t index_end = index_offset + count;
+  YASSERT(index_end <= index_buffer_data.total_count,
+          "Could not fill index buffer ID %d, maximum count exceeded.",
+          static_cast<int>(index_buffer));
+
+  const uint32_t fill_size = count * sizeof(uint16_t);
+  YASSERT(fill_size == buffer_size,
+          "Index Fill size (%u) did not match buffer size (%u).",
+          fill_size, buffer_size);
+  if (index_end > index_buffer_data.total_count || fill_size != buffer_size)
+    return;
+
+  index_buffer_data.count = index_end > index_buffer_data.count ?
+                            index_end :
+                            index_buffer_data.count;
+
+  uint16_t* data_ptr =
+      static_cast<uint16_t*>(index_buffer_data.buffer_data) + index_offset;
+  if (vertex_offset == 0) {
+    memcpy(data_ptr, buffer, buffer_size);
+  } else {
+    const uint16_t* buffer_ptr = static_cast<const uint16_t*>(buffer);
+    for (uint32_t i = 0; i < count; ++i) {
+      data_ptr[i] = static_cast<uint16_t>(buffer_ptr[i] + vertex_offset);
+    }
+  }
+}
+
+void RenderDevice::FillConstantBuffer(ConstantBufferID constant_buffer,
+                                      const void* buffer, uint32_t size) {
+  YASSERT(gConstBuffers.IsValid(constant_buffer),
+          "Filling Invalid Constant Buffer ID: %d.",
+          static_cast<int>(constant_buffer));
+
+  ConstBuffData& const_buffer_data = gConstBuffers[constant_buffer];
+  YASSERT(const_buffer_data.usage == kUsageType_Static ||
+          const_buffer_data.usage == kUsageType_Dynamic,
+          "Cannot fill constant buffer with usage type: %d.",
+          static_cast<int>(const_buffer_data.usage));
+  YASSERT(const_buffer_data.size == size,
+          "Cannot fill constant buffer of size %u with size %u.",
+          static_cast<uint32_t>(const_buffer_data.size), size);
+  if (const_buffer_data.size != size)
+    return;
+
+  memcpy(const_buffer_data.buffer_data, buffer, size);
+}
+
+// Accessors
+void RenderDevice::GetFrameBufferDimensions(uint32_t& width, uint32_t& height) {
+  width = gWidth;
+  height = gHeight;
+}
+
+void RenderDevice::GetViewPort(ViewPortID viewport,
+                               uint32_t& top, uint32_t& left,
+                               uint32_t& width, uint32_t& height,
+                               float& min_z, float& max_z) {
+  YASSERT(gViewPorts.IsValid(viewport),
+          "Getting Invalid View Port ID: %d.", static_cast<int>(viewport));
+
+  const ViewPortData& viewport_data = gViewPorts[viewport];
+  top = viewport_data.top;
+  left = viewport_data.left;
+  width = viewport_data.width;
+  height = viewport_data.height;
+  min_z = viewport_data.min_z;
+  max_z = viewport_data.max_z;
+}
+
+uint32_t RenderDevice::GetVertexBufferCount(VertexBufferID vertex_buffer) {
+  YASSERT(gVertexBuffers.IsValid(vertex_buffer),
+          "Accessing Invalid Vertex Buffer ID: %d.",
+          static_cast<int>(vertex_buffer));
+
+  return gVertexBuffers[vertex_buffer].count;
+}
+
+uint32_t RenderDevice::GetIndexBufferCount(IndexBufferID index_buffer) {
+  YASSERT(gIndexBuffers.IsValid(index_buffer),
+          "Accessing Invalid Index Buffer ID: %d.",
+          static_cast<int>(index_buffer));
+
+  return gIndexBuffers[index_buffer].count;
+}
+
+// Releases
+void RenderDevice::ReleaseViewPort(ViewPortID viewport) {
+  YASSERT(gViewPorts.IsValid(viewport),
+          "Releasing Invalid View Port ID: %d.", static_cast<int>(viewport));
+  gViewPorts.ReleaseID(viewport);
+}
+
+void RenderDevice::ReleaseRenderBlendState(RenderBlendStateID state) {
+  YASSERT(gRenderBlendStates.IsValid(state),
+          "Releasing Invalid Render Blend State ID: %d",
+          static_cast<int>(state));
+  gRenderBlendStates.ReleaseID(state);
+}
+
+void RenderDevice::ReleaseRenderTarget(RenderTargetID render_target) {
+  YASSERT(gSurfaces.IsValid(render_target),
+          "Releasing Invalid Render Target ID: %d",
+          static_cast<int>(render_target));
+  YASSERT(render_target != GetBackBufferRenderTarget(),
+          "Cannot release back buffer render target!");
+  gSurfaces.ReleaseID(render_target);
+}
+
+void RenderDevice::ReleaseVertexDeclaration(VertexDeclID vertex_decl) {
+  YASSERT(gVertDecls.IsValid(vertex_decl),
+          "Releasing Invalid Vertex Declaration ID: %d",
+          static_cast<int>(vertex_decl));
+  gVertDecls.ReleaseID(vertex_decl);
+}
+
+void RenderDevice::ReleaseVertexShader(VertexShaderID shader) {
+  YASSERT(gVertShaders.IsValid(shader),
+          "Releasing Invalid Vertex Shader ID: %d",
+          static_cast<int>(shader));
+  gVertShaders.ReleaseID(shader);
+}
+
+void RenderDevice::ReleasePixelShader(PixelShaderID shader) {
+  YASSERT(gPixelShaders.IsValid(shader),
+          "Releasing Invalid Pixel Shader ID: %d",
+          static_cast<int>(shader));
+  gPixelShaders.ReleaseID(shader);
+}
+
+void RenderDevice::ReleaseSamplerState(SamplerStateID state) {
+  YASSERT(gSamplerStates.IsValid(state),
+          "Releasing Invalid Sampler State ID: %d",
+          static_cast<int>(state));
+  gSamplerStates.ReleaseID(state);
+}
+
+void RenderDevice::ReleaseTexture(TextureID texture) {
+  YASSERT(gTextures.IsValid(texture),
+          "Releasing Invalid Texture ID: %d", static_cast<int>(texture));
+  YASSERT(gTextures[texture].usage != kUsageType_System,
+          "Cannot release system texture: %d",
+          static_cast<int>(texture));
+  gTextures.ReleaseID(texture);
+}
+
+void RenderDevice::ReleaseVertexBuffer(VertexBufferID vertex_buffer) {
+  YASSERT(gVertexBuffers.IsValid(vertex_buffer),
+          "Releasing Invalid Vertex Buffer ID: %d",
+          static_cast<int>(vertex_buffer));
+  YASSERT(gVertexBuffers[vertex_buffer].usage != kUsageType_System,
+          "Cannot release system vertex buffer ID: %d",
+          static_cast<int>(vertex_buffer));
+  gVertexBuffers.ReleaseID(vertex_buffer);
+}
+
+void RenderDevice::ReleaseIndexBuffer(IndexBufferID index_buffer) {
+  YASSERT(gIndexBuffers.IsValid(index_buffer),
+          "Releasing Invalid Index Buffer ID: %d",
+          static_cast<int>(index_buffer));
+  YASSERT(gIndexBuffers[index_buffer].usage != kUsageType_System,
+          "Cannot release system index buffer ID: %d",
+          static_cast<int>(index_buffer));
+  gIndexBuffers.ReleaseID(index_buffer);
+}
+
+void RenderDevice::ReleaseConstantBuffer(ConstantBufferID constant_buffer) {
+  YASSERT(gConstBuffers.IsValid(constant_buffer),
+          "Releasing Invalid Constant Buffer ID: %d",
+          static_cast<int>(constant_buffer));
+  YASSERT(gConstBuffers[constant_buffer].usage != kUsageType_System,
+          "Cannot release system constant buffer ID: %d",
+          static_cast<int>(constant_buffer));
+  gConstBuffers.ReleaseID(constant_buffer);
+}
+
+void RenderDevice::ReleaseCommandList(CommandListID command_list) {
+  YASSERT(gCommandLists.IsValid(command_list),
+          "Releasing Invalid Command List ID: %d",
+          static_cast<int>(command_list));
+  YASSERT(command_list != gRecordingList,
+          "Cannot release command list being recorded: %d",
+          static_cast<int>(command_list));
+  gCommandLists.ReleaseID(command_list);
+}
+
+// Activations
+void RenderDevice::ActivateViewPort(ViewPortID viewport) {
+  YASSERT(gViewPorts.IsValid(viewport),
+          "Activating Invalid View Port ID: %d.", static_cast<int>(viewport));
+  SubmitCommand(kCommandType_ActivateViewPort, viewport);
+}
+
+void RenderDevice::ActivateRenderBlendState(RenderBlendStateID blend_state) {
+  YASSERT(gRenderBlendStates.IsValid(blend_state),
+          "Activating Invalid Blend State ID: %d",
+          static_cast<int>(blend_state));
+  SubmitCommand(kCommandType_ActivateRenderBlendState, blend_state);
+}
+
+void RenderDevice::ActivateRenderTarget(int target,
+                                        RenderTargetID render_target) {
+  YASSERT(target >= 0 && target < MAX_RENDER_TARGETS,
+          "Invalid Render Target index: %d", target);
+  YASSERT(render_target == GetNullRenderTarget() ||
+          gSurfaces.IsValid(render_target),
+          "Activating Invalid Render Target ID: %d",
+          static_cast<int>(render_target));
+  if (target < 0 || target >= MAX_RENDER_TARGETS)
+    return;
+
+  SubmitCommand(kCommandType_ActivateRenderTarget,
+                static_cast<uint32_t>(target), render_target);
+}
+
+void RenderDevice::ActivateVertexDeclaration(VertexDeclID vertex_decl) {
+  YASSERT(gVertDecls.IsValid(vertex_decl),
+          "Activating Invalid Vertex Declaration ID: %d",
+          static_cast<int>(vertex_decl));
+  SubmitCommand(kCommandType_ActivateVertexDeclaration, vertex_decl);
+}
+
+void RenderDevice::ActivateVertexShader(VertexShaderID shader) {
+  YASSERT(gVertShaders.IsValid(shader),
+          "Activating Invalid Vertex Shader ID: %d", static_cast<int>(shader));
+  SubmitCommand(kCommandType_ActivateVertexShader, shader);
+}
+
+void RenderDevice::ActivatePixelShader(PixelShaderID shader) {
+  YASSERT(gPixelShaders.IsValid(shader),
+          "Activating Invalid Pixel Shader ID: %d", static_cast<int>(shader));
+  SubmitCommand(kCommandType_ActivatePixelShader, shader);
+}
+
+void RenderDevice::ActivateVertexStream(uint32_t stream,
+                                        VertexBufferID vertex_buffer) {
+  YASSERT(stream < MAX_STREAM_SOURCES,
+          "Activating Invalid Vertex Stream: %u.", stream);
+  YASSERT(gVertexBuffers.IsValid(vertex_buffer),
+          "Activating Invalid Vertex Buffer ID: %d",
+          static_cast<int>(vertex_buffer));
+  if (stream >= MAX_STREAM_SOURCES)
+    return;
+
+  SubmitCommand(kCommandType_ActivateVertexStream, stream, vertex_buffer);
+}
+
+void RenderDevice::ActivateIndexStream(IndexBufferID index_buffer) {
+  YASSERT(gIndexBuffers.IsValid(index_buffer),
+          "Activating Invalid Index Buffer ID: %d",
+          static_cast<int>(index_buffer));
+  SubmitCommand(kCommandType_ActivateIndexStream, index_buffer);
+}
+
+void RenderDevice::ActivateVertexConstantBuffer(
+    int start_reg, ConstantBufferID constant_buffer) {
+  YASSERT(gConstBuffers.IsValid(constant_buffer),
+          "Activating Invalid Constant Buffer ID: %d",
+          static_cast<int>(constant_buffer));
+  SubmitCommand(kCommandType_ActivateVertexConstantBuffer,
+                static_cast<uint32_t>(start_reg), constant_buffer);
+}
+
+void RenderDevice::ActivatePixelConstantBuffer(
+    int start_reg, ConstantBufferID constant_buffer) {
+  YASSERT(gConstBuffers.IsValid(constant_buffer),
+          "Activating Invalid Constant Buffer ID: %d",
+          static_cast<int>(constant_buffer));
+  SubmitCommand(kCommandType_ActivatePixelConstantBuffer,
+                static_cast<uint32_t>(start_reg), constant_buffer);
+}
+
+void RenderDevice::ActivateVertexSamplerState(int sampler,
+                                              SamplerStateID sampler_state) {
+  YASSERT(gSamplerStates.IsValid(sampler_state),
+          "Activating Invalid Sampler State ID: %d",
+          static_cast<int>(sampler_state));
+  YASSERT(sampler >= 0 && sampler < MAX_VERTEX_SAMPLERS,
+          "Invalid Vertex Sampler: %d", sampler);
+  SubmitCommand(kCommandType_ActivateVertexSamplerState,
+                static_cast<uint32_t>(sampler), sampler_state);
+}
+
+void RenderDevice::ActivatePixelSamplerState(int sampler,
+                                             SamplerStateID sampler_state) {
+  YASSERT(gSamplerStates.IsValid(sampler_state),
+          "Activating Invalid Sampler State ID: %d",
+          static_cast<int>(sampler_state));
+  YASSERT(sampler >= 0 && sampler < MAX_PIXEL_SAMPLERS,
+          "Invalid Pixel Sampler: %d", sampler);
+  SubmitCommand(kCommandType_ActivatePixelSamplerState,
+                static_cast<uint32_t>(sampler), sampler_state);
+}
+
+void RenderDevice::ActivateVertexTexture(int sampler, TextureID texture) {
+  YASSERT(gTextures.IsValid(texture),
+          "Activating Invalid Texture ID: %d", static_cast<int>(texture));
+  YASSERT(sampler >= 0 && sampler < MAX_VERTEX_SAMPLERS,
+          "Invalid Vertex Sampler: %d", sampler);
+  SubmitCommand(kCommandType_ActivateVertexTexture,
+                static_cast<uint32_t>(sampler), texture);
+}
+
+void RenderDevice::ActivatePixelTexture(int sampler, TextureID texture) {
+  YASSERT(gTextures.IsValid(texture),
+          "Activating Invalid Texture ID: %d", static_cast<int>(texture));
+  YASSERT(sampler >= 0 && sampler < MAX_PIXEL_SAMPLERS,
+          "Invalid Pixel Sampler: %d", sampler);
+  SubmitCommand(kCommandType_ActivatePixelTexture,
+                static_cast<uint32_t>(sampler), texture);
+}
+
+void RenderDevice::ActivateDrawPrimitive(DrawPrimitive draw_primitive) {
+  YASSERT(draw_primitive >= 0 && draw_primitive < NUM_DRAW_PRIMITIVES,
+          "Invalid Draw Primitive: %d", static_cast<int>(draw_primitive));
+  if (draw_primitive < 0 || draw_primitive >= NUM_DRAW_PRIMITIVES)
+    return;
+
+  SubmitCommand(kCommandType_ActivateDrawPrimitive,
+                static_cast<uint32_t>(draw_primitive));
+}
+
+// Draw
+void RenderDevice::Draw(uint32_t start_vertex, uint32_t num_verts) {
+  SubmitCommand(kCommandType_Draw, start_vertex, num_verts, 0, 1);
+}
+
+void RenderDevice::DrawInstanced(uint32_t start_vertex,
+                                 uint32_t verts_per_instance,
+                                 uint32_t start_instance,
+                                 uint32_t num_instances) {
+  SubmitCommand(kCommandType_Draw, start_vertex, verts_per_instance,
+                start_instance, num_instances);
+}
+
+void RenderDevice::DrawIndexed(uint32_t start_index, uint32_t num_indexes,
+                               uint32_t vertex_offset) {
+  SubmitCommand(kCommandType_DrawIndexed, start_index, num_indexes, 0, 1,
+                vertex_offset);
+}
+
+void RenderDevice::DrawIndexedInstanced(uint32_t start_index,
+                                        uint32_t index_per_instance,
+                                        uint32_t start_instance,
+                                        uint32_t num_instances,
+                                        uint32_t vertex_offset) {
+  SubmitCommand(kCommandType_DrawIndexed, start_index, index_per_instance,
+                start_instance, num_instances, vertex_offset);
+}
+
+// Render
+void RenderDevice::ExecuteCommandList(CommandListID commands) {
+  YASSERT(gCommandLists.IsValid(commands),
+          "Executing Invalid Command List ID: %d",
+          static_cast<int>(commands));
+  YASSERT(commands != gRecordingList,
+          "Cannot execute command list being recorded: %d",
+          static_cast<int>(commands));
+
+  gFrameStats.mNumCommandLists++;
+  uint32_t chunk = gCommandLists[commands].first_chunk;
+  while (chunk != INVALID_COMMAND_CHUNK) {
+    const CommandChunk& command_chunk = gCommandChunks[chunk];
+    for (uint32_t i = 0; i < command_chunk.num_commands; ++i) {
+      ExecuteCommand(command_chunk.commands[i]);
+    }
+    chunk = command_chunk.next_chunk;
+  }
+}
+
+void RenderDevice::Present() {
+  gPresentedFrameStats = gFrameStats;
+  memset(&gFrameStats, 0, sizeof(gFrameStats));
+  gNumPresentedFrames++;
+}
+
+// Null Device Stats
+const RenderDeviceNull::FrameStats& RenderDeviceNull::GetFrameStats() {
+  return gPresentedFrameStats;
+}
+
+uint32_t RenderDeviceNull::GetNumPresentedFrames() {
+  return gNumPresentedFrames;
+}
+
+}} // namespace yengine { namespace render_device {
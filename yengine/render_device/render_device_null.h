@@ -0,0 +1,35 @@
+#ifndef YENGINE_RENDER_DEVICE_RENDER_DEVICE_NULL_H
+#define YENGINE_RENDER_DEVICE_RENDER_DEVICE_NULL_H
+
+#include <stdint.h>
+
+/*******
+* Headless Render Device
+*  - Implements RenderDevice with CPU resource tables and no graphics API so
+*    the renderer can run on machines without a GPU (build with gfx="null").
+*  - Activations and draws are recorded into command lists and validated
+*    against the device state when executed, nothing is rasterized.
+*  - Executed work is counted per frame, Present() ends the frame.
+********/
+
+namespace yengine { namespace render_device {
+
+namespace RenderDeviceNull {
+  struct FrameStats {
+    uint32_t mNumCommandLists;
+    uint32_t mNumCommands;
+    uint32_t mNumActivations;
+    uint32_t mNumDrawCalls;
+    uint32_t mNumInstances;
+    uint64_t mNumVertexes;
+    uint64_t mNumPrimitives;
+  };
+
+  // Stats of the last presented frame.
+  const FrameStats& GetFrameStats();
+  uint32_t GetNumPresentedFrames();
+}
+
+}} // namespace yengine { namespace render_device {
+
+#endif // YENGINE_RENDER_DEVICE_RENDER_DEVICE_NULL_H
@@ -0,0 +1,199 @@
+#include "yengine/render_device/render_device_null.h"
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "ycommon/headers/test_helpers.h"
+#include "ycommon/platform/platform_handle.h"
+#include "yengine/render_device/render_device.h"
+#include "yengine/render_device/vertex_decl_element.h"
+
+#define NULL_DEVICE_WIDTH 128
+#define NULL_DEVICE_HEIGHT 64
+
+namespace yengine { namespace render_device {
+
+namespace {
+  // Activates a triangle list over |num_vertexes| 2D positions.
+  VertexBufferID SetupDrawState(uint32_t num_vertexes) {
+    const VertexDeclElement element = {
+      0, 0, 1, kVertexElementType_Float2, kVertexElementUsage_Position
+    };
+    const uint8_t shader_data[] = { 1, 2, 3, 4 };
+    float vertexes[64] = { 0.0f };
+    const uint32_t stride = sizeof(float) * 2;
+
+    const VertexBufferID vertex_buffer = RenderDevice::CreateVertexBuffer(
+        kUsageType_Static, stride, num_vertexes, vertexes,
+        stride * num_vertexes);
+    RenderDevice::ActivateVertexDeclaration(
+        RenderDevice::CreateVertexDeclaration(&element, 1));
+    RenderDevice::ActivateVertexShader(
+        RenderDevice::CreateVertexShader(shader_data, sizeof(shader_data)));
+    RenderDevice::ActivatePixelShader(
+        RenderDevice::CreatePixelShader(shader_data, sizeof(shader_data)));
+    RenderDevice::ActivateVertexStream(0, vertex_buffer);
+    RenderDevice::ActivateDrawPrimitive(kDrawPrimitive_TriangleList);
+    return vertex_buffer;
+  }
+}
+
+class RenderDeviceNullTest : public ::testing::Test {
+ protected:
+  RenderDeviceNullTest()
+    : mBuffer(nullptr) {
+    memset(&mHandle, 0, sizeof(mHandle));
+  }
+
+  ~RenderDeviceNullTest() override {
+    delete [] mBuffer;
+  }
+
+  void SetUp() override {
+    const size_t buffer_size = 1024 * 64;
+    mBuffer = new uint8_t[buffer_size];
+    RenderDevice::Initialize(mHandle, NULL_DEVICE_WIDTH, NULL_DEVICE_HEIGHT,
+                             mBuffer, buffer_size);
+  }
+
+  void TearDown() override {
+    RenderDevice::Terminate();
+    delete [] mBuffer;
+    mBuffer = nullptr;
+  }
+
+  uint8_t* mBuffer;
+  ycommon::platform::PlatformHandle mHandle;
+};
+
+TEST_F(RenderDeviceNullTest, FrameBufferDimensionsTest) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  RenderDevice::GetFrameBufferDimensions(width, height);
+  EXPECT_EQ(NULL_DEVICE_WIDTH, width);
+  EXPECT_EQ(NULL_DEVICE_HEIGHT, height);
+}
+
+TEST_F(RenderDeviceNullTest, ViewPortTest) {
+  const ViewPortID viewport = RenderDevice::CreateViewPort(1, 2, 3, 4,
+                                                           0.1f, 0.9f);
+  RenderDevice::SetViewPort(viewport, 5, 6, 7, 8, 0.2f, 0.8f);
+
+  uint32_t top, left, width, height;
+  float min_z, max_z;
+  RenderDevice::GetViewPort(viewport, top, left, width, height, min_z, max_z);
+  EXPECT_EQ(5u, top);
+  EXPECT_EQ(6u, left);
+  EXPECT_EQ(7u, width);
+  EXPECT_EQ(8u, height);
+  EXPECT_EQ(0.2f, min_z);
+  EXPECT_EQ(0.8f, max_z);
+
+  RenderDevice::ReleaseViewPort(viewport);
+}
+
+TEST_F(RenderDeviceNullTest, BufferCountTest) {
+  const uint16_t indexes[] = { 0, 1, 2, 2, 1, 3 };
+  const IndexBufferID index_buffer =
+      RenderDevice::CreateIndexBuffer(kUsageType_Dynamic, 12);
+  EXPECT_EQ(0u, RenderDevice::GetIndexBufferCount(index_buffer));
+
+  RenderDevice::FillIndexBuffer(index_buffer, 6, indexes, sizeof(indexes));
+  EXPECT_EQ(6u, RenderDevice::GetIndexBufferCount(index_buffer));
+
+  const uint32_t vertex_offset = 4;
+  RenderDevice::AppendIndexBuffer(index_buffer, 6, indexes, sizeof(indexes),
+                                  &vertex_offset);
+  EXPECT_EQ(12u, RenderDevice::GetIndexBufferCount(index_buffer));
+
+  RenderDevice::ResetIndexBuffer(index_buffer);
+  EXPECT_EQ(0u, RenderDevice::GetIndexBufferCount(index_buffer));
+
+  const float positions[] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  const float tex_coords[] = { 5.0f, 6.0f };
+  const uint32_t stride_sizes[] = { sizeof(float) * 2, sizeof(float) };
+  const void* buffers[] = { positions, tex_coords };
+  const uint32_t buffer_sizes[] = { sizeof(positions), sizeof(tex_coords) };
+  const VertexBufferID vertex_buffer = RenderDevice::CreateVertexBuffer(
+      kUsageType_Dynamic, sizeof(float) * 3, 4);
+  RenderDevice::FillVertexBufferInterleaved(vertex_buffer, 2, 2, stride_sizes,
+                                            buffers, buffer_sizes, 1);
+  EXPECT_EQ(3u, RenderDevice::GetVertexBufferCount(vertex_buffer));
+
+  RenderDevice::ReleaseVertexBuffer(vertex_buffer);
+  RenderDevice::ReleaseIndexBuffer(index_buffer);
+}
+
+TEST_F(RenderDeviceNullTest, ImmediateDrawTest) {
+  SetupDrawState(6);
+  RenderDevice::Draw(0, 6);
+  RenderDevice::DrawInstanced(0, 3, 0, 4);
+  RenderDevice::Present();
+
+  const RenderDeviceNull::FrameStats& stats = RenderDeviceNull::GetFrameStats();
+  EXPECT_EQ(1u, RenderDeviceNull::GetNumPresentedFrames());
+  EXPECT_EQ(0u, stats.mNumCommandLists);
+  EXPECT_EQ(5u, stats.mNumActivations);
+  EXPECT_EQ(2u, stats.mNumDrawCalls);
+  EXPECT_EQ(5u, stats.mNumInstances);
+  EXPECT_EQ(18u, stats.mNumVertexes);
+  EXPECT_EQ(6u, stats.mNumPrimitives);
+}
+
+TEST_F(RenderDeviceNullTest, IndexedDrawTest) {
+  SetupDrawState(4);
+  const uint16_t indexes[] = { 0, 1, 2, 3 };
+  RenderDevice::ActivateIndexStream(RenderDevice::CreateIndexBuffer(
+      kUsageType_Immutable, 4, indexes, sizeof(indexes)));
+  RenderDevice::ActivateDrawPrimitive(kDrawPrimitive_TriangleStrip);
+  RenderDevice::DrawIndexed(0, 4);
+  RenderDevice::Present();
+
+  const RenderDeviceNull::FrameStats& stats = RenderDeviceNull::GetFrameStats();
+  EXPECT_EQ(1u, stats.mNumDrawCalls);
+  EXPECT_EQ(2u, stats.mNumPrimitives);
+}
+
+TEST_F(RenderDeviceNullTest, CommandListTest) {
+  RenderDevice::BeginRecord();
+  SetupDrawState(3);
+  RenderDevice::Draw(0, 3);
+  const CommandListID command_list = RenderDevice::EndRecord();
+
+  // Nothing is executed until the command list is.
+  RenderDevice::Present();
+  EXPECT_EQ(0u, RenderDeviceNull::GetFrameStats().mNumCommands);
+
+  RenderDevice::ExecuteCommandList(command_list);
+  RenderDevice::ExecuteCommandList(command_list);
+  RenderDevice::ReleaseCommandList(command_list);
+  RenderDevice::Present();
+
+  const RenderDeviceNull::FrameStats& stats = RenderDeviceNull::GetFrameStats();
+  EXPECT_EQ(2u, RenderDeviceNull::GetNumPresentedFrames());
+  EXPECT_EQ(2u, stats.mNumCommandLists);
+  EXPECT_EQ(12u, stats.mNumCommands);
+  EXPECT_EQ(2u, stats.mNumDrawCalls);
+  EXPECT_EQ(2u, stats.mNumPrimitives);
+}
+
+TEST_FAILURE_F(RenderDeviceNullTest, DrawUnfilledVertexesFails,
+               "out of 3 filled vertexes") {
+  SetupDrawState(3);
+  RenderDevice::Draw(3, 3);
+}
+
+TEST_FAILURE_F(RenderDeviceNullTest, DrawNoIndexStreamFails,
+               "Index Stream not activated") {
+  SetupDrawState(3);
+  RenderDevice::DrawIndexed(0, 3);
+}
+
+TEST_FAILURE_F(RenderDeviceNullTest, RecordTwiceFails,
+               "already being recorded") {
+  RenderDevice::BeginRecord();
+  RenderDevice::BeginRecord();
+  RenderDevice::ReleaseCommandList(RenderDevice::EndRecord());
+}
+
+}} // namespace yengine { namespace render_device {
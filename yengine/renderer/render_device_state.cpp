@@ -6,36 +6,46 @@ namespace yengine { namespace renderer {
 
 void RenderDeviceState::Reset() {
   memset(this, -1, sizeof(*this));
+  memset(mNumActivations, 0, sizeof(mNumActivations));
+  memset(mNumFiltered, 0, sizeof(mNumFiltered));
 }
 
 void RenderDeviceState::ActivateViewPort(render_device::ViewPortID id) {
-  if (mSetViewPort != id) {
+  const bool activate = (mSetViewPort != id);
+  if (activate) {
     render_device::RenderDevice::ActivateViewPort(id);
     mSetViewPort = id;
   }
+  CountActivation(kDeviceStateType_ViewPort, activate);
 }
 
 void RenderDeviceState::ActivateBlendState(
     render_device::RenderBlendStateID id) {
-  if (mSetBlendStateID != id) {
+  const bool activate = (mSetBlendStateID != id);
+  if (activate) {
     render_device::RenderDevice::ActivateRenderBlendState(id);
     mSetBlendStateID = id;
   }
+  CountActivation(kDeviceStateType_BlendState, activate);
 }
 
 void RenderDeviceState::ActivateRenderTarget(uint8_t target,
                                              render_device::RenderTargetID id) {
-  if (mSetRenderTargetIDs[target] != id) {
+  const bool activate = (mSetRenderTargetIDs[target] != id);
+  if (activate) {
     render_device::RenderDevice::ActivateRenderTarget(target, id);
     mSetRenderTargetIDs[target] = id;
   }
+  CountActivation(kDeviceStateType_RenderTarget, activate);
 }
 
 void RenderDeviceState::ActivateVertexDecl(render_device::VertexDeclID id) {
-  if (mSetVertexDecl != id) {
+  const bool activate = (mSetVertexDecl != id);
+  if (activate) {
     render_device::RenderDevice::ActivateVertexDeclaration(id);
     mSetVertexDecl = id;
   }
+  CountActivation(kDeviceStateType_VertexDecl, activate);
 }
 
 void RenderDeviceState::ActivateVertexFloatArg(
@@ -48,6 +58,7 @@ void RenderDeviceState::ActivateVertexFloatArg(
     }
   }
 
+  CountActivation(kDeviceStateType_VertexFloatArg, update);
   if (update)
     render_device::RenderDevice::ActivateVertexConstantBuffer(reg, id);
 }
@@ -62,68 +73,85 @@ void RenderDeviceState::ActivatePixelFloatArg(
     }
   }
 
+  CountActivation(kDeviceStateType_PixelFloatArg, update);
   if (update)
     render_device::RenderDevice::ActivatePixelConstantBuffer(reg, id);
 }
 
 void RenderDeviceState::ActivateVertexSamplerState(
     uint8_t sampler, render_device::SamplerStateID id) {
-  if (mSetVertexSamplerState[sampler] != id) {
+  const bool activate = (mSetVertexSamplerState[sampler] != id);
+  if (activate) {
     render_device::RenderDevice::ActivateVertexSamplerState(sampler, id);
     mSetVertexSamplerState[sampler] = id;
   }
+  CountActivation(kDeviceStateType_VertexSamplerState, activate);
 }
 
 void RenderDeviceState::ActivatePixelSamplerState(
     uint8_t sampler, render_device::SamplerStateID id) {
-  if (mSetPixelSamplerState[sampler] != id) {
+  const bool activate = (mSetPixelSamplerState[sampler] != id);
+  if (activate) {
     render_device::RenderDevice::ActivatePixelSamplerState(sampler, id);
     mSetPixelSamplerState[sampler] = id;
   }
+  CountActivation(kDeviceStateType_PixelSamplerState, activate);
 }
 
 void RenderDeviceState::ActivateVertexTexture(
     uint8_t sampler, render_device::TextureID id) {
-  if (mSetVertexTextureArg[sampler] != id) {
+  const bool activate = (mSetVertexTextureArg[sampler] != id);
+  if (activate) {
     render_device::RenderDevice::ActivateVertexTexture(sampler, id);
     mSetVertexTextureArg[sampler] = id;
   }
+  CountActivation(kDeviceStateType_VertexTexture, activate);
 }
 
 void RenderDeviceState::ActivatePixelTexture(
     uint8_t sampler, render_device::TextureID id) {
-  if (mSetPixelTextureArg[sampler] != id) {
+  const bool activate = (mSetPixelTextureArg[sampler] != id);
+  if (activate) {
     render_device::RenderDevice::ActivatePixelTexture(sampler, id);
     mSetPixelTextureArg[sampler] = id;
   }
+  CountActivation(kDeviceStateType_PixelTexture, activate);
 }
 
 void RenderDeviceState::ActivateVertexShader(render_device::VertexShaderID id) {
-  if (mSetVertexShader != id) {
+  const bool activate = (mSetVertexShader != id);
+  if (activate) {
     render_device::RenderDevice::ActivateVertexShader(id);
     mSetVertexShader = id;
   }
+  CountActivation(kDeviceStateType_VertexShader, activate);
 }
 
 void RenderDeviceState::ActivatePixelShader(render_device::PixelShaderID id) {
-  if (mSetPixelShader != id) {
+  const bool activate = (mSetPixelShader != id);
+  if (activate) {
     render_device::RenderDevice::ActivatePixelShader(id);
     mSetPixelShader = id;
   }
+  CountActivation(kDeviceStateType_PixelShader, activate);
 }
 
 void RenderDeviceState::ActivateIndexStream(render_device::IndexBufferID id) {
-  if (mSetIndexStream != id) {
+  const bool activate = (mSetIndexStream != id);
+  if (activate) {
     render_device::RenderDevice::ActivateIndexStream(id);
     mSetIndexStream = id;
   }
+  CountActivation(kDeviceStateType_IndexStream, activate);
 }
 
 void RenderDeviceState::ActivateVertexStream(render_device::VertexBufferID id) {
-  if (mSetVertexStream != id) {
+  const bool activate = (mSetVertexStream != id);
+  if (activate) {
     render_device::RenderDevice::ActivateVertexStream(0, id);
     mSetVertexStream = id;
   }
+  CountActivation(kDeviceStateType_VertexStream, activate);
 }
 
 }} // namespace yengine { namespace renderer {
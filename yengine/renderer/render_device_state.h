@@ -2,11 +2,14 @@
 #define YENGINE_RENDERER_RENDER_DEVICE_STATE_H
 
 #include "yengine/render_device/render_device.h"
+#include "yengine/renderer/renderer_common.h"
 
 /************************
 * Device state caching to help render devices which do not check if the same
 * state is set multiple times, this class does no error checking so it assumes
 * all maxes and ids are valid.
+* Activations sent to the device and redundant ones filtered out are counted
+* per state type until the next Reset().
 *************************/
 
 namespace yengine { namespace renderer {
@@ -44,7 +47,18 @@ struct RenderDeviceState {
   void ActivateIndexStream(render_device::IndexBufferID id);
   void ActivateVertexStream(render_device::VertexBufferID id);
 
+  uint32_t GetNumActivations(DeviceStateType type) const {
+    return mNumActivations[type];
+  }
+  uint32_t GetNumFiltered(DeviceStateType type) const {
+    return mNumFiltered[type];
+  }
+
  private:
+  inline void CountActivation(DeviceStateType type, bool activated) {
+    ++(activated ? mNumActivations : mNumFiltered)[type];
+  }
+
   render_device::ViewPortID mSetViewPort;
   render_device::RenderBlendStateID mSetBlendStateID;
   render_device::RenderTargetID mSetRenderTargetIDs[MAX_NUM_RENDER_TARGETS];
@@ -59,6 +73,9 @@ struct RenderDeviceState {
   render_device::PixelShaderID mSetPixelShader;
   render_device::IndexBufferID mSetIndexStream;
   render_device::VertexBufferID mSetVertexStream;
+
+  uint32_t mNumActivations[NUM_DEVICE_STATE_TYPES];
+  uint32_t mNumFiltered[NUM_DEVICE_STATE_TYPES];
 };
 
 }} // namespace yengine { namespace renderer {
@@ -41,7 +41,7 @@ void RenderTarget::SetRenderTarget(render_device::PixelFormat format,
   mDirty = true;
 }
 
-void RenderTarget::Activate(RenderDeviceState& device_state, uint8_t target) {
+void RenderTarget::Update() {
   if (mDirty) {
     uint32_t frame_width, frame_height;
     render_device::RenderDevice::GetFrameBufferDimensions(frame_width,
@@ -59,7 +59,10 @@ void RenderTarget::Activate(RenderDeviceState& device_state, uint8_t target) {
         render_device::RenderDevice::CreateRenderTarget(w, h, mFormat);
     mDirty = false;
   }
+}
 
+void RenderTarget::Activate(RenderDeviceState& device_state, uint8_t target) {
+  Update();
   device_state.ActivateRenderTarget(target,
                                     mRenderTargetIDs[mActiveRenderTargetIndex]);
 }
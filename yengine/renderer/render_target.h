@@ -18,6 +18,9 @@ class RenderTarget {
   void SetRenderTarget(render_device::PixelFormat format,
                        DimensionType width_type, float width,
                        DimensionType height_type, float height);
+  // Creates the device render target when dirty, Activate() calls this as
+  // well.
+  void Update();
   void Activate(RenderDeviceState& device_state, uint8_t target);
 
  private:
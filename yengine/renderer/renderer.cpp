@@ -4,11 +4,15 @@
 #include <inttypes.h>
 
 #include "ycommon/headers/atomics.h"
+#include "ycommon/headers/macros.h"
 #include "ycommon/containers/hash_table.h"
 #include "ycommon/containers/mem_buffer.h"
 #include "ycommon/containers/mem_pool.h"
+#include "ycommon/containers/radix_sort.h"
 #include "ycommon/containers/ref_pointer.h"
+#include "ycommon/containers/thread_pool.h"
 #include "ycommon/containers/unordered_array.h"
+#include "ycommon/platform/profiler.h"
 #include "ycommon/utils/hash.h"
 #include "yengine/core/string_table.h"
 #include "yengine/render_device/draw_primitive.h"
@@ -21,6 +25,7 @@
 #include "yengine/renderer/render_state_cache.h"
 #include "yengine/renderer/render_target.h"
 #include "yengine/renderer/shader_data.h"
+#include "yengine/renderer/upload_ring.h"
 #include "yengine/renderer/vertex_buffer.h"
 #include "yengine/renderer/view_port.h"
 
@@ -44,6 +49,7 @@
 #define TEXARGS_SIZE 1024
 #define GLOBALTEXARGS_SIZE 128
 #define RENDEROBJECTS_SIZE 256
+#define SHADER_VARIANTS_SIZE 1024
 
 // Mem Pool Sizes
 #define VERTEX_BUFFERS_SIZE 512
@@ -68,9 +74,44 @@
 #define MAX_ACTIVE_VERTEX_DECLS 64
 #define MAX_ACTIVE_SHADERS 512
 #define MAX_ACTIVE_RENDERKEYS 1024
+#define MAX_ACTIVE_RENDERKEY_ARGS (MAX_ACTIVE_RENDERKEYS * 8)
+
+// Render object handles hold the slot index in the low bits and the slot
+// generation in the high bits.
+#define RENDER_OBJECT_INDEX_BITS 16
+#define RENDER_OBJECT_INDEX_MASK ((1 << RENDER_OBJECT_INDEX_BITS) - 1)
+
+// Per thread render key buckets, each can hold every enqueued render key.
+#define MAX_ENQUEUE_BUCKETS 4
+
+// Wide render keys take two words, key buffers are sized for them.
+#define MAX_RENDER_KEY_WORDS 2
+
+// Render object activation is split across the thread pool in jobs.
+#define MIN_OBJECTS_PER_ACTIVATION_JOB 16
+#define MAX_ACTIVATION_JOBS 16
+
+// Batched enqueues reserve keys once per batch, lookups prefetch ahead.
+#define ENQUEUE_BATCH_SIZE 256
+#define ENQUEUE_PREFETCH_DISTANCE 8
+
+// Sorted keys are recorded into command lists across the thread pool.
+#define MIN_KEYS_PER_RECORD_JOB 16
+#define MAX_RECORD_JOBS 16
+
+// Sorted render keys are visited out of order, keys are loaded ahead.
+#define RENDER_KEY_PREFETCH_DISTANCE 4
+
+// Dynamic vertex (bytes per stride) and index data uploaded per frame.
+#define UPLOAD_RING_VERTEX_SIZE (1024 * 1024)
+#define UPLOAD_RING_INDEX_COUNT (64 * 1024)
+
+// Frames in flight, one is prepared while the previous one executes.
+#define NUM_PIPELINED_FRAMES 2
 
 #define INVALID_BLEND_STATE static_cast<render_device::RenderBlendStateID>(-1)
 #define INVALID_VERTEX_DECL static_cast<render_device::VertexDeclID>(-1)
+#define INVALID_ENQUEUE_BUCKET static_cast<uint32_t>(-1)
 #define INVALID_INDEX_BUFFER static_cast<render_device::IndexBufferID>(-1)
 #define INVALID_VERTEX_BUFFER static_cast<render_device::VertexBufferID>(-1)
 #define INVALID_INDEX static_cast<uint32_t>(-1)
@@ -85,8 +126,33 @@ namespace {
   class VertexDeclInternal;
   struct ShaderDataInternal;
 
-  ycommon::containers::TypedUnorderedArray<RenderObjectInternal*>
-      gRenderObjArray;
+  // Render object slots stay at the same index until the object is released.
+  struct RenderObjectSlot {
+    uint32_t mNextFree; // Overwritten by the memory pool once freed.
+    uint32_t mGeneration;
+    RenderObjectInternal* mObject;
+  };
+  ycommon::containers::TypedMemPool<RenderObjectSlot> gRenderObjArray;
+  static_assert(MAX_ACTIVE_RENDEROBJS <= RENDER_OBJECT_INDEX_MASK,
+                "Render object indexes must fit in a render object handle.");
+
+  RenderObjectHandle MakeRenderObjectHandle(uint32_t generation,
+                                            uint32_t index) {
+    return static_cast<RenderObjectHandle>(
+        (generation << RENDER_OBJECT_INDEX_BITS) | index);
+  }
+
+  RenderObjectInternal* GetRenderObject(RenderObjectHandle handle) {
+    const uint32_t index = handle & RENDER_OBJECT_INDEX_MASK;
+    if (index >= gRenderObjArray.GetNumIndexesUsed())
+      return nullptr;
+
+    const RenderObjectSlot& slot = gRenderObjArray[index];
+    if (slot.mObject == nullptr ||
+        MakeRenderObjectHandle(slot.mGeneration, index) != handle)
+      return nullptr;
+    return slot.mObject;
+  }
   ycommon::containers::TypedUnorderedArray<ViewPortInternal*>
       gViewPortArray;
   ycommon::containers::TypedUnorderedArray<VertexDeclInternal*>
@@ -140,9 +206,12 @@ namespace {
                        const char* shader_variant,
                        uint8_t shader_variant_size,
                        RenderTargetInternal** render_targets,
-                       uint8_t num_render_targets)
+                       uint8_t num_render_targets,
+                       DepthSortType depth_sort)
       : RefCountBase(),
         mBlendStateHash(blend_state_hash),
+        mArrayIndex(INVALID_INDEX),
+        mDepthSort(depth_sort),
         mNumRenderTargets(num_render_targets),
         mShaderVariantSize(shader_variant_size) {
       YASSERT(num_render_targets < ARRAY_SIZE(mRenderTargets),
@@ -156,6 +225,13 @@ namespace {
       memcpy(mShaderVariant, shader_variant, shader_variant_size);
     }
 
+    void Update() {
+      RenderStateCache::GetBlendStateID(mBlendStateHash);
+      for (uint8_t i = 0; i < mNumRenderTargets; ++i) {
+        mRenderTargets[i]->Update();
+      }
+    }
+
     void Activate(RenderDeviceState& device_state) {
       const render_device::RenderBlendStateID blend_state_id =
           RenderStateCache::GetBlendStateID(mBlendStateHash);
@@ -166,13 +242,20 @@ namespace {
       }
     }
 
+    static void ItemSwapCallback(uint32_t old_index, uint32_t new_index,
+                                 void* arg);
+
     RenderTargetInternal* mRenderTargets[MAX_RENDERTARGETS_PER_PASS];
     uint64_t mBlendStateHash;
+    uint32_t mArrayIndex;
+    DepthSortType mDepthSort;
     char mShaderVariant[MAX_SHADER_VARIANT_NAME];
     uint8_t mNumRenderTargets;
     uint8_t mShaderVariantSize;
   };
   ycommon::containers::TypedHashTable<RenderPassInternal> gRenderPasses;
+  ycommon::containers::TypedUnorderedArray<RenderPassInternal*>
+      gRenderPassArray;
 
   class VertexDeclInternal : public VertexDecl, public RefCountBase {
    public:
@@ -295,6 +378,10 @@ namespace {
              num_pixel_shdr_texture_params * sizeof(mPixelShdrTexParams[0]));
     }
 
+    void Update() {
+      mVertexDecl->Update();
+    }
+
     void Activate(RenderDeviceState& device_state) {
       mVertexDecl->Activate(device_state);
       mVertexShader->Activate(device_state);
@@ -331,8 +418,11 @@ namespace {
   struct RenderTypeInternal : public RefCountBase {
     RenderTypeInternal(const char* shader, size_t shader_size)
       : RefCountBase(),
-        mShaderBaseSize(shader_size) {
+        mShaderBaseSize(shader_size),
+        mArrayIndex(INVALID_INDEX),
+        mPassShadersActivation(0) {
       memset(mShaderBase, 0, sizeof(mShaderBase));
+      memset(mPassShaders, 0, sizeof(mPassShaders));
       YASSERT(shader_size < MAX_SHADER_BASE_NAME,
               "Maximum Shader Size %u exceeded: %u",
               static_cast<uint32_t>(MAX_SHADER_BASE_NAME),
@@ -340,10 +430,99 @@ namespace {
       memcpy(mShaderBase, shader, shader_size);
     }
 
+    static void ItemSwapCallback(uint32_t old_index, uint32_t new_index,
+                                 void* arg);
+
     char mShaderBase[MAX_SHADER_BASE_NAME];
     size_t mShaderBaseSize;
+    uint32_t mArrayIndex;
+
+    // Shader data for each active render pass, resolved once per activation.
+    uint32_t mPassShadersActivation;
+    ShaderDataInternal* mPassShaders[MAX_ACTIVE_RENDERPASSES];
   };
   ycommon::containers::TypedHashTable<RenderTypeInternal> gRenderTypes;
+  ycommon::containers::TypedUnorderedArray<RenderTypeInternal*>
+      gRenderTypeArray;
+
+  // Shader data of every registered render type and render pass pair.
+  struct ShaderVariantKey {
+    RenderTypeInternal* mRenderType;
+    RenderPassInternal* mRenderPass;
+  };
+  ycommon::containers::FullTypedHashTable<ShaderVariantKey,
+                                          ShaderDataInternal*>
+      gShaderVariants;
+
+  // Shader data is named "<shader>:<variant>", the separator replaces the
+  // terminating null character of the shader name.
+  size_t GetShaderDataName(const char* shader, size_t shader_size,
+                           const char* variant, size_t variant_size,
+                           char* full_name) {
+    memcpy(full_name, shader, shader_size);
+    full_name[shader_size-1] = ':';
+    memcpy(full_name + shader_size, variant, variant_size);
+    return shader_size + variant_size;
+  }
+
+  void InsertShaderVariant(RenderTypeInternal* render_type,
+                           RenderPassInternal* render_pass,
+                           ShaderDataInternal* shader_data) {
+    ShaderVariantKey key = { render_type, render_pass };
+    ShaderDataInternal** variant = gShaderVariants.Insert(key, shader_data);
+    YASSERT(variant,
+            "Maximum number of shader variants (%u) exceeded.",
+            SHADER_VARIANTS_SIZE);
+  }
+
+  void RemoveShaderVariant(RenderTypeInternal* render_type,
+                           RenderPassInternal* render_pass) {
+    ShaderVariantKey key = { render_type, render_pass };
+    gShaderVariants.Remove(key);
+  }
+
+  // Looks up the shader data of a newly registered render type or pass.
+  void ResolveShaderVariant(RenderTypeInternal* render_type,
+                            RenderPassInternal* render_pass) {
+    char shader_name[MAX_SHADER_BASE_NAME + MAX_SHADER_VARIANT_NAME];
+    const size_t shader_name_size =
+        GetShaderDataName(render_type->mShaderBase,
+                          render_type->mShaderBaseSize,
+                          render_pass->mShaderVariant,
+                          render_pass->mShaderVariantSize,
+                          shader_name);
+    ShaderDataInternal* shader_data = gShaderDatas.GetValue(shader_name,
+                                                            shader_name_size);
+    if (shader_data)
+      InsertShaderVariant(render_type, render_pass, shader_data);
+  }
+
+  // Updates every render type and pass pair which names the shader data,
+  // a null shader data removes the pairs.
+  void UpdateShaderVariants(const char* shader, size_t shader_size,
+                            const char* variant, size_t variant_size,
+                            ShaderDataInternal* shader_data) {
+    const uint32_t num_render_passes = gRenderPassArray.GetCount();
+    const uint32_t num_render_types = gRenderTypeArray.GetCount();
+    for (uint32_t i = 0; i < num_render_passes; ++i) {
+      RenderPassInternal* render_pass = gRenderPassArray[i];
+      if (render_pass->mShaderVariantSize != variant_size ||
+          memcmp(render_pass->mShaderVariant, variant, variant_size) != 0)
+        continue;
+
+      for (uint32_t n = 0; n < num_render_types; ++n) {
+        RenderTypeInternal* render_type = gRenderTypeArray[n];
+        if (render_type->mShaderBaseSize != shader_size ||
+            memcmp(render_type->mShaderBase, shader, shader_size) != 0)
+          continue;
+
+        if (shader_data)
+          InsertShaderVariant(render_type, render_pass, shader_data);
+        else
+          RemoveShaderVariant(render_type, render_pass);
+      }
+    }
+  }
 
   struct VertexFillData {
     VertexFillData(
@@ -525,78 +704,191 @@ namespace {
   };
   ycommon::containers::TypedHashTable<GlobalTexArgInternal> gGlobalTexArgs;
 
+  // Render keys store their arguments as indexes into the argument tables,
+  // packed into one arena in the order vertex floats, vertex textures, pixel
+  // floats then pixel textures.
+  static_assert(FLOATARGS_SIZE <= 0x10000 && TEXARGS_SIZE <= 0x10000,
+                "Shader argument tables must be indexable with 16 bits.");
+  uint16_t* gRenderKeyArgs = nullptr;
+  uint32_t gRenderKeyArgsCount = 0;
+
+  // Only the state compared between sorted keys is stored in the key, the
+  // arguments are only read when the shader or arguments change.
   struct RenderKeyInternal {
     RenderKeyInternal()
-      : mNumVertexShaderFloatArgs(0),
-        mNumVertexShaderTexArgs(0),
-        mNumPixelShaderFloatArgs(0),
-        mNumPixelShaderTexArgs(0),
-        mViewPort(nullptr),
+      : mViewPort(nullptr),
         mRenderPass(nullptr),
         mShaderData(nullptr),
-        mVertexBuffer(nullptr) {}
+        mVertexBuffer(nullptr),
+        mFirstArg(0),
+        mNumVertexShaderFloatArgs(0),
+        mNumVertexShaderTexArgs(0),
+        mNumPixelShaderFloatArgs(0),
+        mNumPixelShaderTexArgs(0) {}
 
     RenderKeyInternal(ViewPortInternal* viewport,
                       RenderPassInternal* render_pass,
                       ShaderDataInternal* shader_data,
                       VertexBufferInternal* vertex_buffer,
+                      uint32_t first_arg,
                       uint8_t num_vertex_shader_float_args,
-                      ShdrFloatArgInternal** vertex_shader_float_args,
                       uint8_t num_vertex_shader_tex_args,
-                      ShdrTexArgInternal** vertex_shader_tex_args,
                       uint8_t num_pixel_shader_float_args,
-                      ShdrFloatArgInternal** pixel_shader_float_args,
-                      uint8_t num_pixel_shader_tex_args,
-                      ShdrTexArgInternal** vertex_pixel_tex_args)
-      : mNumVertexShaderFloatArgs(num_vertex_shader_float_args),
-        mNumVertexShaderTexArgs(num_vertex_shader_tex_args),
-        mNumPixelShaderFloatArgs(num_pixel_shader_float_args),
-        mNumPixelShaderTexArgs(num_pixel_shader_tex_args),
-        mViewPort(viewport),
+                      uint8_t num_pixel_shader_tex_args)
+      : mViewPort(viewport),
         mRenderPass(render_pass),
         mShaderData(shader_data),
-        mVertexBuffer(vertex_buffer) {
-      memcpy(mVertexShaderFloatArgs, vertex_shader_float_args,
-             num_vertex_shader_float_args * sizeof(mVertexShaderFloatArgs[0]));
-      memcpy(mVertexShaderTexArgs, vertex_shader_tex_args,
-             num_vertex_shader_tex_args * sizeof(mVertexShaderTexArgs[0]));
-      memcpy(mPixelShaderFloatArgs, pixel_shader_float_args,
-             num_pixel_shader_float_args * sizeof(mPixelShaderFloatArgs[0]));
-      memcpy(mPixelShaderTexArgs, vertex_pixel_tex_args,
-             num_pixel_shader_tex_args * sizeof(mPixelShaderTexArgs[0]));
-    }
-
-    void ExecuteRenderKey(RenderDeviceState& device_state) const {
-      mViewPort->Activate(device_state);
-      mRenderPass->Activate(device_state);
-      mShaderData->Activate(device_state);
+        mVertexBuffer(vertex_buffer),
+        mFirstArg(first_arg),
+        mNumVertexShaderFloatArgs(num_vertex_shader_float_args),
+        mNumVertexShaderTexArgs(num_vertex_shader_tex_args),
+        mNumPixelShaderFloatArgs(num_pixel_shader_float_args),
+        mNumPixelShaderTexArgs(num_pixel_shader_tex_args) {}
+
+    // State groups already set by the previous key are skipped, returns the
+    // number of skipped activations.
+    uint32_t ExecuteRenderKey(RenderDeviceState& device_state,
+                              const RenderKeyInternal* prev_key) const {
+      uint32_t skipped = 0;
+      if (prev_key && prev_key->mViewPort == mViewPort)
+        ++skipped;
+      else
+        mViewPort->Activate(device_state);
+
+      if (prev_key && prev_key->mRenderPass == mRenderPass)
+        ++skipped;
+      else
+        mRenderPass->Activate(device_state);
+
+      if (prev_key && prev_key->mShaderData == mShaderData) {
+        ++skipped;
+        if (HasSameArgs(*prev_key))
+          return skipped + GetNumArgs();
+      } else {
+        mShaderData->Activate(device_state);
+      }
 
+      const uint16_t* args = GetArgs();
       const uint8_t vertex_float_args = mNumVertexShaderFloatArgs;
       for (uint8_t i = 0; i < vertex_float_args; ++i) {
-        mVertexShaderFloatArgs[i]->ActivateVertexShaderArg(device_state);
+        gShdrFloatArgs.GetValueAt(args[i])->ActivateVertexShaderArg(
+            device_state);
       }
+      args += vertex_float_args;
 
       const uint8_t vertex_textures = mNumVertexShaderTexArgs;
       for (uint8_t i = 0; i < vertex_textures; ++i) {
-        mVertexShaderTexArgs[i]->ActivateVertexShaderTexture(device_state);
+        gShdrTexArgs.GetValueAt(args[i])->ActivateVertexShaderTexture(
+            device_state);
       }
+      args += vertex_textures;
 
       const uint8_t pixel_float_args = mNumPixelShaderFloatArgs;
       for (uint8_t i = 0; i < pixel_float_args; ++i) {
-        mPixelShaderFloatArgs[i]->ActivatePixelShaderArg(device_state);
+        gShdrFloatArgs.GetValueAt(args[i])->ActivatePixelShaderArg(
+            device_state);
+      }
+      args += pixel_float_args;
+
+      const uint8_t pixel_textures = mNumPixelShaderTexArgs;
+      for (uint8_t i = 0; i < pixel_textures; ++i) {
+        gShdrTexArgs.GetValueAt(args[i])->ActivatePixelShaderTexture(
+            device_state);
       }
+      return skipped;
+    }
+
+    // Creates the device resources activation would otherwise create, keys
+    // can then be recorded on several threads at once.
+    void UpdateRenderKey(const RenderKeyInternal* prev_key) const {
+      if (!prev_key || prev_key->mViewPort != mViewPort)
+        mViewPort->Update();
+      if (!prev_key || prev_key->mRenderPass != mRenderPass)
+        mRenderPass->Update();
+      if (!prev_key || prev_key->mShaderData != mShaderData)
+        mShaderData->Update();
+      if (mVertexBuffer)
+        mVertexBuffer->Update();
+
+      const uint16_t* args = GetArgs() + mNumVertexShaderFloatArgs;
+      const uint8_t vertex_textures = mNumVertexShaderTexArgs;
+      for (uint8_t i = 0; i < vertex_textures; ++i) {
+        gShdrTexArgs.GetValueAt(args[i])->Update();
+      }
+      args += vertex_textures + mNumPixelShaderFloatArgs;
 
       const uint8_t pixel_textures = mNumPixelShaderTexArgs;
       for (uint8_t i = 0; i < pixel_textures; ++i) {
-        mPixelShaderTexArgs[i]->ActivatePixelShaderTexture(device_state);
+        gShdrTexArgs.GetValueAt(args[i])->Update();
+      }
+    }
+
+    // Draws the vertex buffer once per instance, buffers which have not been
+    // filled yet are skipped. Returns if a draw was issued.
+    bool DrawRenderKey(RenderDeviceState& device_state,
+                       uint32_t num_instances) const {
+      const uint32_t num_verts =
+          mVertexBuffer ? mVertexBuffer->GetFillCount() : 0;
+      if (num_verts == 0)
+        return false;
+
+      // Dynamic buffers may be filled at an offset of the upload ring.
+      mVertexBuffer->Activate(device_state);
+      const uint32_t first_vertex = mVertexBuffer->GetFirstVertex();
+      if (num_instances == 1) {
+        render_device::RenderDevice::Draw(first_vertex, num_verts);
+      } else {
+        render_device::RenderDevice::DrawInstanced(first_vertex, num_verts,
+                                                   0, num_instances);
       }
+      return true;
+    }
+
+    const uint16_t* GetArgs() const {
+      return gRenderKeyArgs + mFirstArg;
+    }
+
+    void PrefetchArgs() const {
+      PREFETCH(GetArgs());
+    }
+
+    uint32_t GetNumArgs() const {
+      return mNumVertexShaderFloatArgs + mNumVertexShaderTexArgs +
+             mNumPixelShaderFloatArgs + mNumPixelShaderTexArgs;
+    }
+
+    // Viewport, render pass and shader activations plus the arguments.
+    uint32_t GetNumStateChanges() const {
+      return 3 + GetNumArgs();
+    }
 
+    bool HasSameArgs(const RenderKeyInternal& other) const {
+      if (mNumVertexShaderFloatArgs != other.mNumVertexShaderFloatArgs ||
+          mNumVertexShaderTexArgs != other.mNumVertexShaderTexArgs ||
+          mNumPixelShaderFloatArgs != other.mNumPixelShaderFloatArgs ||
+          mNumPixelShaderTexArgs != other.mNumPixelShaderTexArgs)
+        return false;
+      return mFirstArg == other.mFirstArg ||
+             0 == memcmp(GetArgs(), other.GetArgs(),
+                         GetNumArgs() * sizeof(gRenderKeyArgs[0]));
+    }
 
+    // Keys drawing the same vertex buffer with the same state can be merged
+    // into a single instanced draw.
+    bool IsSameDraw(const RenderKeyInternal& other) const {
+      return mVertexBuffer == other.mVertexBuffer &&
+             mShaderData == other.mShaderData &&
+             mViewPort == other.mViewPort &&
+             mRenderPass == other.mRenderPass &&
+             HasSameArgs(other);
     }
 
-    uint64_t GetRenderKey(uint32_t key_num, uint32_t pass_num,
-                          RenderKeyField* fields, size_t num_fields,
-                          uint8_t field_bits_used) {
+    // Narrow keys store the key number in the bits the fields leave over,
+    // wide keys store it in the low word and the fields in the high word.
+    void GetRenderKey(uint32_t key_num, uint32_t pass_num,
+                      RenderKeyField* fields, size_t num_fields,
+                      uint8_t field_bits_used,
+                      uint64_t* key_words, uint8_t num_key_words) {
       uint64_t key = 0;
       uint8_t bits_left = 64;
 
@@ -618,12 +910,18 @@ namespace {
         YDEBUG_CHECK(fields[i].field_type >= 0 &&
                      fields[i].field_type < NUM_RENDER_KEY_FIELD_TYPES,
                      "Invalid Field Type: %d", fields[i].field_type);
-        YDEBUG_CHECK(fields[i].field_bits < bits_left,
+        YDEBUG_CHECK(fields[i].field_bits <= bits_left,
                      "Maximum number of field bits used.");
         const uint8_t field_bits = fields[i].field_bits;
         const uint8_t field_type = static_cast<uint8_t>(fields[i].field_type);
-        YASSERT(field_values[field_type] <
-                (static_cast<uint64_t>(1) << field_bits),
+        const uint64_t field_max = (static_cast<uint64_t>(1) << field_bits) - 1;
+
+        // Enqueues xor the depth in, back to front passes start inverted.
+        if (field_type == kRenderKeyFieldType_Depth &&
+            mRenderPass->mDepthSort == kDepthSortType_BackToFront) {
+          field_values[field_type] = field_max;
+        }
+        YASSERT(field_values[field_type] <= field_max,
                 "Render key field (%d) needs more bits (%u): %" PRIu64,
                 field_type, field_bits, field_values[field_type]);
         key = (key << field_bits) | field_values[field_type];
@@ -632,23 +930,29 @@ namespace {
       YASSERT(bits_left + field_bits_used == 64,
               "Unexpected number of bits used.");
 
+      const uint64_t field_key = (bits_left < 64) ? (key << bits_left) : 0;
+      if (num_key_words == 2) {
+        key_words[0] = key_num;
+        key_words[1] = field_key;
+        return;
+      }
+
       YASSERT(key_num < (static_cast<uint64_t>(1) << bits_left),
               "Bits left over (%u) not enough to store render key: %u",
               bits_left, key_num);
-      return (key << bits_left) | key_num;
+      key_words[0] = field_key | key_num;
     }
 
-    uint8_t mNumVertexShaderFloatArgs, mNumVertexShaderTexArgs;
-    uint8_t mNumPixelShaderFloatArgs, mNumPixelShaderTexArgs;
     ViewPortInternal* mViewPort;
     RenderPassInternal* mRenderPass;
     ShaderDataInternal* mShaderData;
     VertexBufferInternal* mVertexBuffer;
-    ShdrFloatArgInternal* mVertexShaderFloatArgs[MAX_FLOAT_ARGS_PER_OBJ];
-    ShdrTexArgInternal* mVertexShaderTexArgs[MAX_TEXTURE_ARGS_PER_OBJ];
-    ShdrFloatArgInternal* mPixelShaderFloatArgs[MAX_FLOAT_ARGS_PER_OBJ];
-    ShdrTexArgInternal* mPixelShaderTexArgs[MAX_TEXTURE_ARGS_PER_OBJ];
+    uint32_t mFirstArg;
+    uint8_t mNumVertexShaderFloatArgs, mNumVertexShaderTexArgs;
+    uint8_t mNumPixelShaderFloatArgs, mNumPixelShaderTexArgs;
   };
+  static_assert(sizeof(RenderKeyInternal) <= 64,
+                "Render keys should fit in a single cache line.");
   ycommon::containers::TypedUnorderedArray<RenderKeyInternal> gRenderKeys;
 
   struct RenderObjectInternal : public RefCountBase {
@@ -662,10 +966,13 @@ namespace {
       : mNumFloatArgs(num_float_args),
         mNumTextureArgs(num_tex_args),
         mNumRenderKeys(0),
+        mKeysActivation(0),
+        mFirstRenderKey(INVALID_INDEX),
+        mFirstRenderKeyArg(0),
+        mArrayIndex(INVALID_INDEX),
         mViewPort(view_port),
         mRenderType(render_type),
-        mVertexData(vertex_data),
-        mArrayIndex(static_cast<uint32_t>(-1)) {
+        mVertexData(vertex_data) {
       YASSERT(num_float_args < ARRAY_SIZE(mFloatArgs),
               "Maximum number of floats per render object exceeded: %u >= %u",
               num_float_args, ARRAY_SIZE(mFloatArgs));
@@ -681,21 +988,36 @@ namespace {
 
     void IncRef() {
       if (mRefCount == 0) {
-        YASSERT(mArrayIndex == static_cast<uint32_t>(-1), "Unexpected index");
-        mArrayIndex = gRenderObjArray.PushBack(this);
+        YASSERT(mArrayIndex == INVALID_INDEX, "Unexpected index");
+        mArrayIndex = gRenderObjArray.Allocate();
+        YASSERT(mArrayIndex != INVALID_INDEX,
+                "Maximum number of render objects (%u) exceeded.",
+                MAX_ACTIVE_RENDEROBJS);
+        gRenderObjArray[mArrayIndex].mObject = this;
       }
       RefCountBase::IncRef();
     }
 
     bool DecRef() {
       if (RefCountBase::DecRef()) {
-        YASSERT(mArrayIndex != static_cast<uint32_t>(-1), "Empty index");
-        mArrayIndex = static_cast<uint32_t>(-1);
+        YASSERT(mArrayIndex != INVALID_INDEX, "Empty index");
+
+        // Bumping the generation invalidates every handle to the slot.
+        RenderObjectSlot& slot = gRenderObjArray[mArrayIndex];
+        slot.mObject = nullptr;
+        slot.mGeneration++;
+        gRenderObjArray.Remove(mArrayIndex);
+        mArrayIndex = INVALID_INDEX;
         return true;
       }
       return false;
     }
 
+    RenderObjectHandle GetHandle() {
+      return MakeRenderObjectHandle(gRenderObjArray[mArrayIndex].mGeneration,
+                                    mArrayIndex);
+    }
+
     ShdrFloatArgInternal* GetFloatArg(ShdrFloatParamInternal* param) {
       const uint8_t num_float_args = mNumFloatArgs;
       for (uint8_t i = 0; i < num_float_args; ++i) {
@@ -714,39 +1036,638 @@ namespace {
       return nullptr;
     }
 
-    static void ItemSwapCallback(uint32_t old_index, uint32_t new_index,
-                                 void* arg);
-
     uint8_t mNumFloatArgs;
     uint8_t mNumTextureArgs;
     uint8_t mNumRenderKeys;
+    uint32_t mKeysActivation;
+    uint32_t mFirstRenderKey;
+    uint32_t mFirstRenderKeyArg;
     uint32_t mArrayIndex;
     ViewPortInternal* mViewPort;
     RenderTypeInternal* mRenderType;
     VertexDataInternal* mVertexData;
     ShdrFloatArgInternal* mFloatArgs[MAX_FLOAT_ARGS_PER_OBJ];
     ShdrTexArgInternal* mTextureArgs[MAX_TEXTURE_ARGS_PER_OBJ];
-    uint64_t mRenderKeys[MAX_ACTIVE_RENDERPASSES];
+    uint64_t mRenderKeys[MAX_ACTIVE_RENDERPASSES * MAX_RENDER_KEY_WORDS];
   };
   ycommon::containers::TypedHashTable<RenderObjectInternal> gRenderObjects;
 
   size_t gActiveRenderKeyFieldsCount = 0;
   uint8_t gActiveRenderKeyBitsUsed = 0;
+  uint8_t gRenderKeyWords = 1;
   ActivePassesInternal* gActiveRenderPasses = nullptr;
   RenderKeyField gActiveRenderKeyFields[NUM_RENDER_KEY_FIELD_TYPES];
 
-  volatile uint32_t gEnqueuedRenderKeysCount = 0;
+  // Location of the depth field within render keys, no bits if unused.
+  uint8_t gDepthKeyShift = 0;
+  uint8_t gDepthKeyBits = 0;
+
+  // Quantizes a depth in the [0, 1] range into the render key depth field.
+  uint64_t GetDepthKeyBits(float depth) {
+    if (gDepthKeyBits == 0)
+      return 0;
+
+    const uint64_t depth_max = (static_cast<uint64_t>(1) << gDepthKeyBits) - 1;
+    const float clamped_depth = std::min(std::max(depth, 0.0f), 1.0f);
+    const uint64_t depth_value =
+        static_cast<uint64_t>(clamped_depth * depth_max + 0.5f);
+    return std::min(depth_value, depth_max) << gDepthKeyShift;
+  }
+
+  // Every full activation bumps the activation count, render types and
+  // render objects tag the data they resolved with it. Changes which can
+  // affect the keys of any render object mark the active keys as stale.
+  uint32_t gActivationCount = 0;
+  bool gActiveRenderKeysStale = false;
+
   const uint32_t gMaxEnqueuedRenderKeys = MAX_ACTIVE_RENDERKEYS;
-  uint64_t* gEnqueuedRenderKeys = nullptr;
+  uint64_t* gMergedRenderKeys = nullptr;
+
+  // Counters of the last prepared frame, uploads are measured as the
+  // difference of the upload ring totals between prepares.
+  Renderer::FrameStats gFrameStats;
+  uint32_t gPreparedUploads = 0;
+  uint64_t gPreparedUploadSize = 0;
+
+  // Keys enqueued from a registered thread skip the shared atomic counter.
+  struct EnqueueBucket {
+    uint64_t* mKeys;
+    uint64_t* mScratch;
+    volatile uint32_t mCount;
+    volatile uint32_t mNumObjects;
+  };
+  static_assert(MAX_ENQUEUE_BUCKETS <= 32,
+                "Enqueue buckets used must fit in a 32 bit mask.");
+
+  // Enqueued keys and recorded command lists are double buffered so frame N+1
+  // can enqueue and prepare while the command lists of frame N execute.
+  struct FrameData {
+    volatile uint32_t mEnqueuesInFlight;
+    volatile uint32_t mEnqueuedRenderKeysCount;
+    volatile uint32_t mEnqueuedObjectsCount;
+    uint64_t* mEnqueuedRenderKeys;
+    uint64_t* mEnqueuedRenderKeysScratch;
+    EnqueueBucket mEnqueueBuckets[MAX_ENQUEUE_BUCKETS];
+
+    // Command lists recorded by PrepareDraw(), in submission order.
+    render_device::CommandListID mCommandLists[MAX_RECORD_JOBS];
+    uint32_t mNumCommandLists;
+    volatile uint32_t mPrepared;
+  };
+  FrameData gFrames[NUM_PIPELINED_FRAMES];
+
+  // Enqueues go to the enqueue frame, PrepareDraw() swaps it as it begins.
+  // ExecuteDraws() consumes prepared frames in the order they were prepared.
+  volatile uint32_t gEnqueueFrame = 0;
+  uint32_t gExecuteFrame = 0;
+
+  volatile uint32_t gEnqueueBucketsUsed = 0;
+  THREAD_LOCAL uint32_t gThreadEnqueueBucket = INVALID_ENQUEUE_BUCKET;
+
+  // Enqueues hold the frame they write to until their keys are copied,
+  // PrepareDraw() waits for them after it swaps the enqueue frame.
+  FrameData& BeginEnqueue() {
+    for (;;) {
+      const uint32_t frame_index = gEnqueueFrame;
+      FrameData& frame = gFrames[frame_index];
+      ycommon::AtomicAdd32(&frame.mEnqueuesInFlight, 1u);
+      if (gEnqueueFrame == frame_index)
+        return frame;
+
+      // The frame was swapped before PrepareDraw() could see this enqueue.
+      ycommon::AtomicAdd32(&frame.mEnqueuesInFlight,
+                           static_cast<uint32_t>(-1));
+    }
+  }
+
+  void EndEnqueue(FrameData& frame) {
+    ycommon::AtomicAdd32(&frame.mEnqueuesInFlight, static_cast<uint32_t>(-1));
+  }
+
+  // Reserves space for num_keys enqueued keys in the thread's bucket or the
+  // shared queue if the thread has not registered a bucket, num_objects is
+  // only counted for the frame stats.
+  uint64_t* ReserveEnqueuedRenderKeys(FrameData& frame, uint32_t num_keys,
+                                      uint32_t num_objects) {
+    const uint32_t bucket_index = gThreadEnqueueBucket;
+    if (bucket_index != INVALID_ENQUEUE_BUCKET) {
+      EnqueueBucket& bucket = frame.mEnqueueBuckets[bucket_index];
+      const uint32_t index = bucket.mCount;
+      YASSERT(index + num_keys <= gMaxEnqueuedRenderKeys,
+              "Maximum number of enqueued render objects reached: %u",
+              gMaxEnqueuedRenderKeys);
+      bucket.mCount = index + num_keys;
+      bucket.mNumObjects += num_objects;
+      return &bucket.mKeys[index * gRenderKeyWords];
+    }
+
+    const uint32_t index =
+        ycommon::AtomicAdd32(&frame.mEnqueuedRenderKeysCount, num_keys);
+    ycommon::AtomicAdd32(&frame.mEnqueuedObjectsCount, num_objects);
+    YASSERT(index + num_keys <= gMaxEnqueuedRenderKeys,
+            "Maximum number of enqueued render objects reached: %u",
+            gMaxEnqueuedRenderKeys);
+    return &frame.mEnqueuedRenderKeys[index * gRenderKeyWords];
+  }
+
+  // Copies the precomputed keys of an object with its depth patched in, the
+  // depth is in the last word of each key.
+  uint64_t* CopyRenderKeys(uint64_t* keys, const RenderObjectInternal* object,
+                           float depth) {
+    const uint32_t key_words = gRenderKeyWords;
+    const uint32_t num_words = object->mNumRenderKeys * key_words;
+    memcpy(keys, object->mRenderKeys, sizeof(uint64_t) * num_words);
+
+    const uint64_t depth_bits = GetDepthKeyBits(depth);
+    if (depth_bits) {
+      for (uint32_t i = key_words - 1; i < num_words; i += key_words) {
+        keys[i] ^= depth_bits;
+      }
+    }
+    return keys + num_words;
+  }
+
+  // Copies the keys of every object with a single reservation.
+  void EnqueueRenderObjectBatch(RenderObjectInternal** objects,
+                                const float* depths, size_t count) {
+    uint32_t num_keys = 0;
+    uint32_t num_objects = 0;
+    for (size_t i = 0; i < count; ++i) {
+      num_keys += objects[i]->mNumRenderKeys;
+      num_objects += (objects[i]->mNumRenderKeys != 0);
+    }
+
+    if (num_keys) {
+      FrameData& frame = BeginEnqueue();
+      uint64_t* keys = ReserveEnqueuedRenderKeys(frame, num_keys, num_objects);
+      for (size_t i = 0; i < count; ++i) {
+        keys = CopyRenderKeys(keys, objects[i], depths ? depths[i] : 0.0f);
+      }
+      EndEnqueue(frame);
+    }
+  }
+
+  typedef ycommon::containers::RadixKey128 WideRenderKey;
+
+  inline bool RenderKeyLess(uint64_t a, uint64_t b) {
+    return a < b;
+  }
+
+  inline bool RenderKeyLess(const WideRenderKey& a, const WideRenderKey& b) {
+    return a.mHigh < b.mHigh || (a.mHigh == b.mHigh && a.mLow < b.mLow);
+  }
+
+  // The key index is in the low bits of narrow keys and the low word of wide
+  // keys, wide keys use an index mask covering the whole word.
+  inline uint32_t GetRenderKeyIndex(const uint64_t* keys, uint32_t key,
+                                    uint64_t key_index_mask) {
+    return static_cast<uint32_t>(keys[key * gRenderKeyWords] &
+                                 key_index_mask);
+  }
+
+  // Sorts narrow keys on the sort mask, wide keys sort the high word on the
+  // sort mask and the low word on the index sort mask.
+  const uint64_t* SortRenderKeys(uint64_t* keys, uint64_t* scratch,
+                                 uint32_t num_keys, uint64_t sort_mask,
+                                 uint64_t index_sort_mask,
+                                 ycommon::containers::ThreadPool* thread_pool) {
+    if (gRenderKeyWords == 1) {
+      return ycommon::containers::RadixSort::Sort(keys, scratch, num_keys,
+                                                  sort_mask, thread_pool);
+    }
+    return reinterpret_cast<const uint64_t*>(
+        ycommon::containers::RadixSort::Sort(
+            reinterpret_cast<WideRenderKey*>(keys),
+            reinterpret_cast<WideRenderKey*>(scratch),
+            num_keys, sort_mask, index_sort_mask, thread_pool));
+  }
+
+  // A sorted run of render keys, sorted from mKeys using mScratch.
+  struct SortRunJob {
+    uint64_t* mKeys;
+    uint64_t* mScratch;
+    uint32_t mCount;
+    uint64_t mSortMask;
+    uint64_t mIndexSortMask;
+    const uint64_t* mSorted;
+  };
+
+  uintptr_t SortRunRoutine(void* arg) {
+    SortRunJob* job = static_cast<SortRunJob*>(arg);
+    job->mSorted = SortRenderKeys(job->mKeys, job->mScratch, job->mCount,
+                                  job->mSortMask, job->mIndexSortMask,
+                                  nullptr);
+    return 0;
+  }
+
+  // K-way merge of the sorted runs, there are only a handful of runs so the
+  // smallest head is found with a linear scan.
+  template <typename Key>
+  void MergeSortedRuns(SortRunJob* runs, uint32_t num_runs, Key* dest) {
+    const Key* heads[MAX_ENQUEUE_BUCKETS + 1];
+    const Key* ends[MAX_ENQUEUE_BUCKETS + 1];
+    for (uint32_t i = 0; i < num_runs; ++i) {
+      heads[i] = reinterpret_cast<const Key*>(runs[i].mSorted);
+      ends[i] = heads[i] + runs[i].mCount;
+    }
+
+    while (num_runs > 1) {
+      uint32_t min_run = 0;
+      for (uint32_t i = 1; i < num_runs; ++i) {
+        if (RenderKeyLess(*heads[i], *heads[min_run]))
+          min_run = i;
+      }
+      *dest++ = *heads[min_run]++;
+
+      // Exhausted runs are replaced by the last run.
+      if (heads[min_run] == ends[min_run]) {
+        --num_runs;
+        heads[min_run] = heads[num_runs];
+        ends[min_run] = ends[num_runs];
+      }
+    }
+
+    if (num_runs) {
+      memcpy(dest, heads[0], sizeof(heads[0][0]) * (ends[0] - heads[0]));
+    }
+  }
+
+  // Gathers the shader data of each active render pass for a render type.
+  void ResolvePassShaders(RenderTypeInternal* render_type,
+                          ActivePassesInternal* active_passes) {
+    if (render_type->mPassShadersActivation == gActivationCount)
+      return;
+    render_type->mPassShadersActivation = gActivationCount;
+
+    const uint8_t num_passes = active_passes->mNumRenderPasses;
+    for (uint8_t pass_index = 0; pass_index < num_passes; ++pass_index) {
+      ShaderVariantKey key = { render_type,
+                               active_passes->mRenderPasses[pass_index] };
+      ShaderDataInternal** shader_data = gShaderVariants.GetValue(key);
+      render_type->mPassShaders[pass_index] =
+          shader_data ? *shader_data : nullptr;
+    }
+  }
+
+  // Activates everything the render object draws with and reserves a
+  // contiguous range of render keys, returns false if the keys do not fit.
+  bool ActivateRenderObject(RenderObjectInternal* render_obj,
+                            ActivePassesInternal* active_passes) {
+    // Activate Viewport
+    ViewPortInternal* viewport = render_obj->mViewPort;
+    if (viewport->mActivatedArrayIndex == INVALID_INDEX) {
+      viewport->mActivatedArrayIndex = gViewPortArray.PushBack(viewport);
+      YASSERT(viewport->mActivatedArrayIndex != INVALID_INDEX,
+              "Maximum number of activated viewports (%u) exceeded.",
+              MAX_ACTIVE_VIEWPORTS);
+    }
+
+    RenderTypeInternal* render_type = render_obj->mRenderType;
+    ResolvePassShaders(render_type, active_passes);
+
+    uint32_t num_keys = 0;
+    uint32_t num_key_args = 0;
+    const uint8_t num_passes = active_passes->mNumRenderPasses;
+    for (uint8_t pass_index = 0; pass_index < num_passes; ++pass_index) {
+      ShaderDataInternal* shader = render_type->mPassShaders[pass_index];
+      if (shader == nullptr)
+        continue;
+
+      num_key_args += shader->mNumVertexShdrFloatParams +
+                      shader->mNumVertexShdrTexParams +
+                      shader->mNumPixelShdrFloatParams +
+                      shader->mNumPixelShdrTexParams;
+
+      // Activate Shader
+      if (shader->mActivatedArrayIndex == INVALID_INDEX) {
+        shader->mActivatedArrayIndex = gShaderDataArray.PushBack(shader);
+        YASSERT(shader->mActivatedArrayIndex != INVALID_INDEX,
+            "Maximum number of activated shaders (%u) exceeded.",
+            MAX_ACTIVE_SHADERS);
+      }
+
+      // Activate Vertex Declaration
+      VertexDeclInternal* vertex_decl = shader->mVertexDecl;
+      if (vertex_decl->mActivatedArrayIndex == INVALID_INDEX) {
+        vertex_decl->mActivatedArrayIndex =
+            gVertexDeclArray.PushBack(vertex_decl);
+        YASSERT(vertex_decl->mActivatedArrayIndex != INVALID_INDEX,
+            "Maximum number of activated vertex declarations (%u) exceeded.",
+            MAX_ACTIVE_VERTEX_DECLS);
+      }
+
+      // Activate Vertex Buffers for the Vertex Declaration
+      VertexDataInternal* vertex_data = render_obj->mVertexData;
+      if (nullptr == vertex_data->GetVertexBuffer(vertex_decl)) {
+        VertexBufferInternal new_vertex_buffer(vertex_decl);
+        uint32_t buffer_index = gVertexBuffers.Insert(new_vertex_buffer);
+        YASSERT(buffer_index != INVALID_INDEX,
+                "Maximum number of vertex buffers (%u) reached.",
+                VERTEX_BUFFERS_SIZE);
+        VertexBufferInternal* vertex_buffer = &gVertexBuffers[buffer_index];
+        if (!vertex_data->InsertVertexBuffer(vertex_buffer)) {
+          vertex_data->ClearUnusedVertexBuffer();
+          const bool inserted =
+              vertex_data->InsertVertexBuffer(vertex_buffer);
+          YASSERT(inserted,
+                  "Maximum number of vertex buffers (%u) per data exceeded.",
+                  MAX_VERTEX_BUFFERS_PER_DATA);
+        }
+      }
+      ++num_keys;
+    }
+
+    YASSERT(num_keys <= MAX_ACTIVE_RENDERPASSES,
+            "Invalid number of render keys (%u), something went wrong...",
+            num_keys);
+    const uint32_t first_key = gRenderKeys.GetCount();
+    if (first_key + num_keys > gRenderKeys.GetTotalSize())
+      return false;
+    const uint32_t first_key_arg = gRenderKeyArgsCount;
+    if (first_key_arg + num_key_args > MAX_ACTIVE_RENDERKEY_ARGS)
+      return false;
+    for (uint32_t i = 0; i < num_keys; ++i) {
+      gRenderKeys.Allocate();
+    }
+    gRenderKeyArgsCount += num_key_args;
+
+    render_obj->mNumRenderKeys = 0;
+    render_obj->mFirstRenderKey = first_key;
+    render_obj->mFirstRenderKeyArg = first_key_arg;
+    render_obj->mKeysActivation = gActivationCount;
+    return true;
+  }
+
+  struct RenderKeyJob {
+    RenderObjectInternal** mRenderObjects;
+    uint32_t mNumRenderObjects;
+    ActivePassesInternal* mActivePasses;
+  };
+
+  // Fills in the render keys reserved by ActivateRenderObject().
+  uintptr_t GenerateRenderKeysRoutine(void* arg) {
+    RenderKeyJob* job = static_cast<RenderKeyJob*>(arg);
+    ActivePassesInternal* active_passes = job->mActivePasses;
+    const uint8_t num_passes = active_passes->mNumRenderPasses;
+    for (uint32_t i = 0; i < job->mNumRenderObjects; ++i) {
+      RenderObjectInternal* render_obj = job->mRenderObjects[i];
+      RenderTypeInternal* render_type = render_obj->mRenderType;
+      uint32_t key_index = render_obj->mFirstRenderKey;
+      uint32_t arg_index = render_obj->mFirstRenderKeyArg;
+      uint8_t num_keys = 0;
+      for (uint8_t pass_index = 0; pass_index < num_passes; ++pass_index) {
+        ShaderDataInternal* shader = render_type->mPassShaders[pass_index];
+        if (shader == nullptr)
+          continue;
+
+        VertexBufferInternal* vertex_buffer =
+            render_obj->mVertexData->GetVertexBuffer(shader->mVertexDecl);
+
+        // Shader Parameters
+        const uint32_t first_arg = arg_index;
+
+        // Vertex Shader Float Params
+        const uint8_t num_vert_shdr_floats = shader->mNumVertexShdrFloatParams;
+        for (uint8_t m = 0; m < num_vert_shdr_floats; ++m) {
+          ShdrFloatParamInternal* float_param =
+              shader->mVertexShdrFloatParams[m];
+          ShdrFloatArgInternal* float_arg =
+              render_obj->GetFloatArg(float_param);
+          if (!float_arg) {
+            GlobalFloatArgInternal* global_arg =
+                gGlobalFloatArgs.GetValue(float_param->mName,
+                                          float_param->mNameSize);
+            YASSERT(global_arg,
+                    "Vertex shader float parameter not set: %s",
+                    float_param->mName);
+            float_arg = global_arg->mFloatArg;
+          }
+          gRenderKeyArgs[arg_index++] = static_cast<uint16_t>(
+              gShdrFloatArgs.GetValueIndex(float_arg));
+        }
+
+        // Vertex Shader Texture Params
+        const uint8_t num_vert_shdr_texs = shader->mNumVertexShdrTexParams;
+        for (uint8_t m = 0; m < num_vert_shdr_texs; ++m) {
+          ShdrTexParamInternal* tex_param = shader->mVertexShdrTexParams[m];
+          ShdrTexArgInternal* tex_arg = render_obj->GetTexArg(tex_param);
+          if (!tex_arg) {
+            GlobalTexArgInternal* global_arg =
+                gGlobalTexArgs.GetValue(tex_param->mName,
+                                        tex_param->mNameSize);
+            YASSERT(global_arg,
+                    "Vertex shader texture parameter not set: %s",
+                    tex_param->mName);
+            tex_arg = global_arg->mTexArg;
+          }
+          gRenderKeyArgs[arg_index++] = static_cast<uint16_t>(
+              gShdrTexArgs.GetValueIndex(tex_arg));
+        }
+
+        // Pixel Shader Float Params
+        const uint8_t num_pix_shdr_floats = shader->mNumPixelShdrFloatParams;
+        for (uint8_t m = 0; m < num_pix_shdr_floats; ++m) {
+          ShdrFloatParamInternal* float_param =
+              shader->mPixelShdrFloatParams[m];
+          ShdrFloatArgInternal* float_arg =
+              render_obj->GetFloatArg(float_param);
+          if (!float_arg) {
+            GlobalFloatArgInternal* global_arg =
+                gGlobalFloatArgs.GetValue(float_param->mName,
+                                          float_param->mNameSize);
+            YASSERT(global_arg,
+                    "Pixel shader float parameter not set: %s",
+                    float_param->mName);
+            float_arg = global_arg->mFloatArg;
+          }
+          gRenderKeyArgs[arg_index++] = static_cast<uint16_t>(
+              gShdrFloatArgs.GetValueIndex(float_arg));
+        }
+
+        // Pixel Shader Texture Params
+        const uint8_t num_pix_shdr_texs = shader->mNumPixelShdrTexParams;
+        for (uint8_t m = 0; m < num_pix_shdr_texs; ++m) {
+          ShdrTexParamInternal* tex_param = shader->mPixelShdrTexParams[m];
+          ShdrTexArgInternal* tex_arg = render_obj->GetTexArg(tex_param);
+          if (!tex_arg) {
+            GlobalTexArgInternal* global_arg =
+                gGlobalTexArgs.GetValue(tex_param->mName,
+                                        tex_param->mNameSize);
+            YASSERT(global_arg,
+                    "Pixel shader texture parameter not set: %s",
+                    tex_param->mName);
+            tex_arg = global_arg->mTexArg;
+          }
+          gRenderKeyArgs[arg_index++] = static_cast<uint16_t>(
+              gShdrTexArgs.GetValueIndex(tex_arg));
+        }
+
+        // Generate Render Key
+        RenderKeyInternal render_key(render_obj->mViewPort,
+                                     active_passes->mRenderPasses[pass_index],
+                                     shader, vertex_buffer, first_arg,
+                                     num_vert_shdr_floats, num_vert_shdr_texs,
+                                     num_pix_shdr_floats, num_pix_shdr_texs);
+        gRenderKeys[key_index] = render_key;
+        render_key.GetRenderKey(key_index, pass_index,
+                                gActiveRenderKeyFields,
+                                gActiveRenderKeyFieldsCount,
+                                gActiveRenderKeyBitsUsed,
+                                &render_obj->mRenderKeys[num_keys *
+                                                         gRenderKeyWords],
+                                gRenderKeyWords);
+        ++num_keys;
+        ++key_index;
+      }
+      render_obj->mNumRenderKeys = num_keys;
+    }
+    return 0;
+  }
+
+  ycommon::containers::ThreadPool* gThreadPool = nullptr;
+
+  // A range of sorted render keys recorded into its own command list.
+  struct RecordJob {
+    const uint64_t* mKeys;
+    uint64_t mKeyIndexMask;
+    uint32_t mBegin;
+    uint32_t mEnd;
+    uint32_t mSkippedStateChanges;
+    uint32_t mNumDraws;
+    uint32_t mNumInstances;
+    RenderDeviceState mDeviceState;
+    render_device::CommandListID mCommandList;
+  };
+
+  // Loads the render key a few sorted keys ahead and the arguments of the
+  // next key, which was loaded by an earlier call.
+  inline void PrefetchRenderKey(const uint64_t* sorted_keys,
+                                uint32_t key_index, uint32_t end,
+                                uint64_t key_index_mask) {
+    if (key_index + RENDER_KEY_PREFETCH_DISTANCE < end) {
+      PREFETCH(&gRenderKeys[GetRenderKeyIndex(
+          sorted_keys, key_index + RENDER_KEY_PREFETCH_DISTANCE,
+          key_index_mask)]);
+    }
+    if (key_index + 1 < end) {
+      gRenderKeys[GetRenderKeyIndex(sorted_keys, key_index + 1,
+                                    key_index_mask)].PrefetchArgs();
+    }
+  }
+
+  uintptr_t RecordRoutine(void* arg) {
+    YPROFILE_ZONE("Renderer Record");
+    RecordJob* job = static_cast<RecordJob*>(arg);
+    const uint64_t* sorted_keys = job->mKeys;
+    const uint64_t key_index_mask = job->mKeyIndexMask;
+    const uint32_t end = job->mEnd;
+
+    RenderDeviceState& device_state = job->mDeviceState;
+    const RenderKeyInternal* prev_key_obj = nullptr;
+    uint32_t skipped_state_changes = 0;
+    uint32_t num_draws = 0;
+    uint32_t num_drawn_instances = 0;
+
+    render_device::RenderDevice::BeginRecord();
+    uint32_t key_index = job->mBegin;
+    while (key_index < end) {
+      PrefetchRenderKey(sorted_keys, key_index, end, key_index_mask);
+      const RenderKeyInternal* render_key_obj =
+          &gRenderKeys[GetRenderKeyIndex(sorted_keys, key_index,
+                                         key_index_mask)];
+      skipped_state_changes += render_key_obj->ExecuteRenderKey(device_state,
+                                                                prev_key_obj);
+
+      // Sorted keys sharing all their state are drawn as instances.
+      uint32_t num_instances = 1;
+      while (key_index + num_instances < end) {
+        const RenderKeyInternal& next_key_obj =
+            gRenderKeys[GetRenderKeyIndex(sorted_keys,
+                                          key_index + num_instances,
+                                          key_index_mask)];
+        if (!render_key_obj->IsSameDraw(next_key_obj))
+          break;
+        skipped_state_changes += next_key_obj.GetNumStateChanges();
+        ++num_instances;
+      }
+
+      if (render_key_obj->DrawRenderKey(device_state, num_instances)) {
+        ++num_draws;
+        num_drawn_instances += num_instances;
+      }
+      prev_key_obj = render_key_obj;
+      key_index += num_instances;
+    }
+
+    job->mCommandList = render_device::RenderDevice::EndRecord();
+    job->mSkippedStateChanges = skipped_state_changes;
+    job->mNumDraws = num_draws;
+    job->mNumInstances = num_drawn_instances;
+    return 0;
+  }
+
+  // Splits the sorted keys at viewport or render pass changes, each job
+  // starts by setting those anyways. Device resources are created here so
+  // the jobs only record.
+  uint32_t SplitRecordJobs(const uint64_t* sorted_keys, uint32_t num_keys,
+                           uint64_t key_index_mask, RecordJob* jobs) {
+    uint32_t max_jobs = 1;
+    if (gThreadPool && gThreadPool->Running()) {
+      max_jobs = static_cast<uint32_t>(gThreadPool->GetNumThreads()) + 1;
+      if (max_jobs > MAX_RECORD_JOBS)
+        max_jobs = MAX_RECORD_JOBS;
+      if (max_jobs > num_keys / MIN_KEYS_PER_RECORD_JOB)
+        max_jobs = num_keys / MIN_KEYS_PER_RECORD_JOB;
+      if (max_jobs == 0)
+        max_jobs = 1;
+    }
+    const uint32_t keys_per_job = (num_keys + max_jobs - 1) / max_jobs;
+
+    uint32_t num_jobs = 1;
+    jobs[0].mBegin = 0;
+    const RenderKeyInternal* prev_key_obj = nullptr;
+    for (uint32_t i = 0; i < num_keys; ++i) {
+      PrefetchRenderKey(sorted_keys, i, num_keys, key_index_mask);
+      const RenderKeyInternal* render_key_obj =
+          &gRenderKeys[GetRenderKeyIndex(sorted_keys, i, key_index_mask)];
+      render_key_obj->UpdateRenderKey(prev_key_obj);
+
+      if (num_jobs < max_jobs &&
+          i - jobs[num_jobs - 1].mBegin >= keys_per_job &&
+          (prev_key_obj->mViewPort != render_key_obj->mViewPort ||
+           prev_key_obj->mRenderPass != render_key_obj->mRenderPass)) {
+        jobs[num_jobs - 1].mEnd = i;
+        jobs[num_jobs].mBegin = i;
+        ++num_jobs;
+      }
+      prev_key_obj = render_key_obj;
+    }
+    jobs[num_jobs - 1].mEnd = num_keys;
+
+    for (uint32_t i = 0; i < num_jobs; ++i) {
+      jobs[i].mKeys = sorted_keys;
+      jobs[i].mKeyIndexMask = key_index_mask;
+    }
+    return num_jobs;
+  }
+}
+
+void RenderPassInternal::ItemSwapCallback(uint32_t old_index,
+                                          uint32_t new_index,
+                                          void* arg) {
+  YASSERT(arg == &gRenderPassArray, "Sanity check item swap callback failed.");
+  YASSERT(gRenderPassArray[old_index]->mArrayIndex == old_index,
+          "Unexpected index.");
+  gRenderPassArray[old_index]->mArrayIndex = new_index;
 }
 
-void RenderObjectInternal::ItemSwapCallback(uint32_t old_index,
-                                            uint32_t new_index,
-                                            void* arg) {
-  YASSERT(arg == &gRenderObjects, "Sanity check item swap callback failed.");
-  YASSERT(gRenderObjArray[old_index]->mArrayIndex == old_index,
+void RenderTypeInternal::ItemSwapCallback(uint32_t old_index,
+                                          uint32_t new_index,
+                                          void* arg) {
+  YASSERT(arg == &gRenderTypeArray, "Sanity check item swap callback failed.");
+  YASSERT(gRenderTypeArray[old_index]->mArrayIndex == old_index,
           "Unexpected index.");
-  gRenderObjArray[old_index]->mArrayIndex = new_index;
+  gRenderTypeArray[old_index]->mArrayIndex = new_index;
 }
 
 void DeactivateRenderObjects() {
@@ -774,11 +1695,13 @@ void DeactivateRenderObjects() {
   }
   gShaderDataArray.Clear();
 
-  const uint32_t activated_render_objects = gRenderObjArray.GetCount();
-  for (uint32_t i = 0; i < activated_render_objects; ++i) {
-    gRenderObjArray[i]->mNumRenderKeys = 0;
+  const uint32_t render_object_slots = gRenderObjArray.GetNumIndexesUsed();
+  for (uint32_t i = 0; i < render_object_slots; ++i) {
+    if (gRenderObjArray[i].mObject)
+      gRenderObjArray[i].mObject->mNumRenderKeys = 0;
   }
   gRenderKeys.Clear();
+  gRenderKeyArgsCount = 0;
 }
 
 #define INITIALIZE_TABLE(HASHTABLE, TABLESIZE, NAME) \
@@ -822,15 +1745,28 @@ void Renderer::Initialize(void* buffer, size_t buffer_size) {
   YASSERT(state_cache_buffer,
           "Not enough space to allocate render state cache.");
   RenderStateCache::Initialize(state_cache_buffer, state_cache_size);
+  UploadRing::Initialize(UPLOAD_RING_VERTEX_SIZE, UPLOAD_RING_INDEX_COUNT);
 
-  INITIALIZE_ARRAY(gRenderObjArray, MAX_ACTIVE_RENDEROBJS, "Render Object");
+  INITIALIZE_MEMPOOL(gRenderObjArray, MAX_ACTIVE_RENDEROBJS, "Render Object");
+  memset(&gRenderObjArray[0], 0,
+         sizeof(RenderObjectSlot) * MAX_ACTIVE_RENDEROBJS);
   INITIALIZE_ARRAY(gViewPortArray, MAX_ACTIVE_VIEWPORTS, "View Port");
   INITIALIZE_ARRAY(gVertexDeclArray, MAX_ACTIVE_VERTEX_DECLS, "Vertex Decl");
   INITIALIZE_ARRAY(gShaderDataArray, MAX_ACTIVE_SHADERS, "Shader Data");
   INITIALIZE_ARRAY(gRenderKeys, MAX_ACTIVE_RENDERKEYS, "Render Keys");
-
-  gRenderObjArray.SetItemSwappedCallBack(RenderObjectInternal::ItemSwapCallback,
-                                         &gRenderObjArray);
+  const size_t render_key_args_size =
+      sizeof(gRenderKeyArgs[0]) * MAX_ACTIVE_RENDERKEY_ARGS;
+  gRenderKeyArgs = static_cast<uint16_t*>(
+      gMemBuffer.Allocate(render_key_args_size, 128));
+  YASSERT(gRenderKeyArgs, "Not enough space for render key arguments.");
+  gRenderKeyArgsCount = 0;
+  INITIALIZE_ARRAY(gRenderPassArray, RENDERPASSES_SIZE, "Render Pass");
+  INITIALIZE_ARRAY(gRenderTypeArray, RENDER_TYPES_SIZE, "Render Type");
+
+  gRenderPassArray.SetItemSwappedCallBack(RenderPassInternal::ItemSwapCallback,
+                                          &gRenderPassArray);
+  gRenderTypeArray.SetItemSwappedCallBack(RenderTypeInternal::ItemSwapCallback,
+                                          &gRenderTypeArray);
 
   INITIALIZE_MEMPOOL(gVertexBuffers, VERTEX_BUFFERS_SIZE, "Vertex Buffers");
 
@@ -852,29 +1788,71 @@ void Renderer::Initialize(void* buffer, size_t buffer_size) {
   INITIALIZE_TABLE(gGlobalFloatArgs, GLOBALFLOATARGS_SIZE, "Global Float Args");
   INITIALIZE_TABLE(gGlobalTexArgs, GLOBALTEXARGS_SIZE, "Global Texture Args");
   INITIALIZE_TABLE(gRenderObjects, RENDEROBJECTS_SIZE, "Render Objects");
+  INITIALIZE_TABLE(gShaderVariants, SHADER_VARIANTS_SIZE, "Shader Variants");
 
   gActiveRenderPasses = nullptr;
   SetupRenderKey(kDefaultRenderKeyFields, ARRAY_SIZE(kDefaultRenderKeyFields));
 
-  gEnqueuedRenderKeysCount = 0;
-  const size_t enqueued_render_keys_size =
-      sizeof(gEnqueuedRenderKeys[0]) * gMaxEnqueuedRenderKeys;
-  void* render_key_buffer = gMemBuffer.Allocate(enqueued_render_keys_size, 128);
+  // Merged keys followed by the enqueue buffers of each frame, the shared
+  // queue and every bucket hold their keys followed by sort scratch space.
+  // Buffers are sized for wide keys so the key width can change later.
+  const uint32_t max_key_words = gMaxEnqueuedRenderKeys * MAX_RENDER_KEY_WORDS;
+  const size_t frame_keys_size =
+      sizeof(gMergedRenderKeys[0]) * max_key_words *
+      (1 + MAX_ENQUEUE_BUCKETS) * 2;
+  const size_t render_keys_size =
+      sizeof(gMergedRenderKeys[0]) * max_key_words +
+      frame_keys_size * NUM_PIPELINED_FRAMES;
+  void* render_key_buffer = gMemBuffer.Allocate(render_keys_size, 128);
   YASSERT(render_key_buffer,
           "Not enough space for enqueued render key buffer.\n"
           "  Free Space:  %u\n"
           "  Needed Size: %u\n",
           static_cast<uint32_t>(gMemBuffer.FreeSpace()),
-          static_cast<uint32_t>(enqueued_render_keys_size));
-  gEnqueuedRenderKeys = static_cast<uint64_t*>(render_key_buffer);
+          static_cast<uint32_t>(render_keys_size));
+  gMergedRenderKeys = static_cast<uint64_t*>(render_key_buffer);
+  uint64_t* frame_keys = gMergedRenderKeys + max_key_words;
+  for (uint32_t i = 0; i < NUM_PIPELINED_FRAMES; ++i) {
+    FrameData& frame = gFrames[i];
+    frame.mEnqueuedRenderKeysCount = 0;
+    frame.mEnqueuedObjectsCount = 0;
+    frame.mEnqueuedRenderKeys = frame_keys;
+    frame.mEnqueuedRenderKeysScratch = frame_keys + max_key_words;
+    frame_keys += max_key_words * 2;
+    for (uint32_t n = 0; n < MAX_ENQUEUE_BUCKETS; ++n) {
+      frame.mEnqueueBuckets[n].mKeys = frame_keys;
+      frame.mEnqueueBuckets[n].mScratch = frame_keys + max_key_words;
+      frame.mEnqueueBuckets[n].mCount = 0;
+      frame.mEnqueueBuckets[n].mNumObjects = 0;
+      frame_keys += max_key_words * 2;
+    }
+    frame.mNumCommandLists = 0;
+    frame.mPrepared = 0;
+  }
+  gEnqueueFrame = 0;
+  gExecuteFrame = 0;
+  gEnqueueBucketsUsed = 0;
+
+  memset(&gFrameStats, 0, sizeof(gFrameStats));
+  gPreparedUploads = 0;
+  gPreparedUploadSize = 0;
 }
 
 void Renderer::Terminate() {
-  gEnqueuedRenderKeysCount = 0;
-  gEnqueuedRenderKeys = nullptr;
+  gMergedRenderKeys = nullptr;
+  memset(&gFrameStats, 0, sizeof(gFrameStats));
+  gPreparedUploads = 0;
+  gPreparedUploadSize = 0;
+  memset(gFrames, 0, sizeof(gFrames));
+  gEnqueueFrame = 0;
+  gExecuteFrame = 0;
+  gEnqueueBucketsUsed = 0;
+  gThreadEnqueueBucket = INVALID_ENQUEUE_BUCKET;
+  gThreadPool = nullptr;
 
   gActiveRenderPasses = nullptr;
 
+  gShaderVariants.Reset();
   gRenderObjects.Reset();
   gGlobalTexArgs.Reset();
   gGlobalFloatArgs.Reset();
@@ -896,17 +1874,23 @@ void Renderer::Terminate() {
 
   gVertexBuffers.Reset();
 
+  gRenderTypeArray.Reset();
+  gRenderPassArray.Reset();
   gRenderKeys.Reset();
+  gRenderKeyArgs = nullptr;
+  gRenderKeyArgsCount = 0;
   gShaderDataArray.Reset();
   gVertexDeclArray.Reset();
   gViewPortArray.Reset();
   gRenderObjArray.Reset();
 
+  UploadRing::Terminate();
   RenderStateCache::Terminate();
   gMemBuffer.Reset();
 }
 
-void Renderer::SetupRenderKey(const RenderKeyField* fields, size_t num_fields) {
+void Renderer::SetupRenderKey(const RenderKeyField* fields, size_t num_fields,
+                              bool wide_keys) {
   memset(gActiveRenderKeyFields, 0, sizeof(gActiveRenderKeyFields));
   YASSERT(num_fields < ARRAY_SIZE(gActiveRenderKeyFields),
           "Maximum number of fields per render key exceeded: %u >= %u",
@@ -916,13 +1900,30 @@ void Renderer::SetupRenderKey(const RenderKeyField* fields, size_t num_fields) {
   gActiveRenderKeyFieldsCount = num_fields;
 
   uint32_t bits_used = 0;
+  uint32_t depth_bits_end = 0;
+  gDepthKeyBits = 0;
   for (size_t i = 0; i < num_fields; ++i) {
     bits_used += fields[i].field_bits;
+    if (fields[i].field_type == kRenderKeyFieldType_Depth) {
+      YASSERT(gDepthKeyBits == 0, "Render key has multiple depth fields.");
+      gDepthKeyBits = fields[i].field_bits;
+      depth_bits_end = bits_used;
+    }
   }
-  YASSERT(bits_used < 64,
-          "Maximum number of bits used exceeded (64): %u", bits_used);
+  // Narrow keys need at least one bit left over for the key index.
+  const uint32_t max_bits = wide_keys ? 64 : 63;
+  YASSERT(bits_used <= max_bits,
+          "Maximum number of bits used exceeded (%u): %u",
+          max_bits, bits_used);
+  gDepthKeyShift = static_cast<uint8_t>(64 - depth_bits_end);
+  gRenderKeyWords = wide_keys ? 2 : 1;
 
   gActiveRenderKeyBitsUsed = static_cast<uint8_t>(bits_used);
+  gActiveRenderKeysStale = true;
+}
+
+void Renderer::SetThreadPool(ycommon::containers::ThreadPool* thread_pool) {
+  gThreadPool = thread_pool;
 }
 
 void Renderer::RegisterViewPort(const char* name, size_t name_size,
@@ -976,7 +1977,7 @@ void Renderer::RegisterRenderPass(
     const char* shader_variant, size_t variant_size,
     const render_device::RenderBlendState& blend_state,
     const char** render_targets, size_t* target_sizes,
-    size_t num_targets) {
+    size_t num_targets, DepthSortType depth_sort) {
   const uint64_t blend_hash = RenderStateCache::InsertBlendState(blend_state);
 
   const uint64_t name_hash = core::StringTable::AddString(name, name_size);
@@ -1004,8 +2005,18 @@ void Renderer::RegisterRenderPass(
     RenderPassInternal new_render_pass(blend_hash, shader_variant,
                                        static_cast<uint8_t>(variant_size),
                                        targets,
-                                       static_cast<uint8_t>(num_targets));
+                                       static_cast<uint8_t>(num_targets),
+                                       depth_sort);
     render_pass = gRenderPasses.Insert(name_hash, new_render_pass);
+
+    render_pass->mArrayIndex = gRenderPassArray.PushBack(render_pass);
+    YASSERT(render_pass->mArrayIndex != INVALID_INDEX,
+            "Maximum number of render passes (%u) exceeded.",
+            RENDERPASSES_SIZE);
+    const uint32_t num_render_types = gRenderTypeArray.GetCount();
+    for (uint32_t i = 0; i < num_render_types; ++i) {
+      ResolveShaderVariant(gRenderTypeArray[i], render_pass);
+    }
   }
   render_pass->IncRef();
 }
@@ -1068,14 +2079,13 @@ void Renderer::RegisterShaderData(
           variant_name, static_cast<uint32_t>(MAX_SHADER_VARIANT_NAME),
           static_cast<uint32_t>(variant_name_size));
   char full_shader_name[MAX_SHADER_BASE_NAME + MAX_SHADER_VARIANT_NAME];
-  memcpy(full_shader_name, shader_name, shader_name_size);
-  full_shader_name[shader_name_size] = ':';
-  memcpy(&full_shader_name[shader_name_size+1],
-         variant_name, variant_name_size);
-
-  const size_t full_shader_size = shader_name_size + variant_name_size;
+  const size_t full_shader_size = GetShaderDataName(shader_name,
+                                                    shader_name_size,
+                                                    variant_name,
+                                                    variant_name_size,
+                                                    full_shader_name);
   const uint64_t full_shader_hash =
-      core::StringTable::AddString(full_shader_name, full_shader_size);
+      ycommon::utils::Hash::Hash64(full_shader_name, full_shader_size);
 
   ShaderDataInternal* shader_data = gShaderDatas.GetValue(full_shader_hash);
   if (nullptr == shader_data) {
@@ -1184,6 +2194,9 @@ void Renderer::RegisterShaderData(
         pixel_shader, pixel_float_params, num_pixel_float_params,
         pixel_tex_params, num_pixel_tex_params);
     shader_data = gShaderDatas.Insert(full_shader_hash, new_shader_data);
+    UpdateShaderVariants(shader_name, shader_name_size,
+                         variant_name, variant_name_size, shader_data);
+    gActiveRenderKeysStale = true;
   }
   shader_data->IncRef();
 }
@@ -1224,6 +2237,15 @@ void Renderer::RegisterRenderType(const char* name, size_t name_size,
   if (nullptr == render_type) {
     RenderTypeInternal new_render_type(shader, shader_size);
     render_type = gRenderTypes.Insert(name_hash, new_render_type);
+
+    render_type->mArrayIndex = gRenderTypeArray.PushBack(render_type);
+    YASSERT(render_type->mArrayIndex != INVALID_INDEX,
+            "Maximum number of render types (%u) exceeded.",
+            RENDER_TYPES_SIZE);
+    const uint32_t num_render_passes = gRenderPassArray.GetCount();
+    for (uint32_t i = 0; i < num_render_passes; ++i) {
+      ResolveShaderVariant(render_type, gRenderPassArray[i]);
+    }
   }
   render_type->IncRef();
 }
@@ -1234,6 +2256,9 @@ void Renderer::RegisterVertexData(const char* name, size_t name_size) {
   if (nullptr == vertex_data_internal) {
     VertexDataInternal new_vertex_data;
     vertex_data_internal = gVertexDatas.Insert(name_hash, new_vertex_data);
+
+    // The contained array still points into the copied stack object.
+    vertex_data_internal->mVertexBuffers.Init();
   }
   vertex_data_internal->IncRef();
 }
@@ -1286,6 +2311,7 @@ void Renderer::RegisterGlobalArg(const char* param, size_t param_size,
       float_arg->IncRef();
       GlobalFloatArgInternal new_global_arg(float_arg);
       global_arg = gGlobalFloatArgs.Insert(param_hash, new_global_arg);
+      gActiveRenderKeysStale = true;
     }
     YASSERT(global_arg->mFloatArg == float_arg,
             "Global argument (%s) cannot be set to already set parameter (%s).",
@@ -1302,6 +2328,7 @@ void Renderer::RegisterGlobalArg(const char* param, size_t param_size,
       tex_arg->IncRef();
       GlobalTexArgInternal new_global_arg(tex_arg);
       global_arg = gGlobalTexArgs.Insert(param_hash, new_global_arg);
+      gActiveRenderKeysStale = true;
     }
     YASSERT(global_arg->mTexArg == tex_arg,
             "Global argument (%s) cannot be set to already set parameter (%s).",
@@ -1313,7 +2340,7 @@ void Renderer::RegisterGlobalArg(const char* param, size_t param_size,
   YASSERT(false, "Invalid Global Shader Argument name: %s", arg);
 }
 
-void Renderer::RegisterRenderObject(
+RenderObjectHandle Renderer::RegisterRenderObject(
     const char* name, size_t name_size,
     const char* view_port, size_t view_port_size,
     const char* render_type, size_t render_type_size,
@@ -1378,6 +2405,7 @@ void Renderer::RegisterRenderObject(
     render_object = gRenderObjects.Insert(name_hash, new_render_object);
   }
   render_object->IncRef();
+  return render_object->GetHandle();
 }
 
 bool Renderer::ReleaseViewPort(const char* name, size_t name_size) {
@@ -1426,6 +2454,11 @@ bool Renderer::ReleaseRenderPass(const char* name, size_t name_size) {
               name);
     }
 
+    const uint32_t num_render_types = gRenderTypeArray.GetCount();
+    for (uint32_t i = 0; i < num_render_types; ++i) {
+      RemoveShaderVariant(gRenderTypeArray[i], render_pass);
+    }
+    gRenderPassArray.Remove(render_pass->mArrayIndex);
     return gRenderPasses.Remove(name_hash);
   }
   return false;
@@ -1467,14 +2500,13 @@ bool Renderer::ReleaseShaderData(const char* shader_name,
                                  const char* variant_name,
                                  size_t variant_name_size) {
   char full_shader_name[MAX_SHADER_BASE_NAME + MAX_SHADER_VARIANT_NAME];
-  memcpy(full_shader_name, shader_name, shader_name_size);
-  full_shader_name[shader_name_size] = ':';
-  memcpy(&full_shader_name[shader_name_size+1],
-         variant_name, variant_name_size);
-
-  const size_t full_shader_size = shader_name_size + variant_name_size;
+  const size_t full_shader_size = GetShaderDataName(shader_name,
+                                                    shader_name_size,
+                                                    variant_name,
+                                                    variant_name_size,
+                                                    full_shader_name);
   const uint64_t full_shader_hash =
-      core::StringTable::AddString(full_shader_name, full_shader_size);
+      ycommon::utils::Hash::Hash64(full_shader_name, full_shader_size);
 
   ShaderDataInternal* shader_data = gShaderDatas.GetValue(full_shader_hash);
   YASSERT(shader_data, "Releasing an invalid Shader: %s", full_shader_name);
@@ -1506,13 +2538,13 @@ bool Renderer::ReleaseShaderData(const char* shader_name,
               full_shader_name);
     }
 
-    const uint8_t vertex_tex_params = shader_data->mNumVertexShdrFloatParams;
+    const uint8_t vertex_tex_params = shader_data->mNumVertexShdrTexParams;
     for (uint8_t i = 0; i < vertex_tex_params; ++i) {
       bool empty = shader_data->mVertexShdrTexParams[i]->DecRef();
       YASSERT(!empty, "Shader parameter released before shader data: %s",
               full_shader_name);
     }
-    const uint8_t vertex_float_params = shader_data->mNumVertexShdrTexParams;
+    const uint8_t vertex_float_params = shader_data->mNumVertexShdrFloatParams;
     for (uint8_t i = 0; i < vertex_float_params; ++i) {
       bool empty = shader_data->mVertexShdrFloatParams[i]->DecRef();
       YASSERT(!empty, "Shader parameter released before shader data: %s",
@@ -1526,6 +2558,9 @@ bool Renderer::ReleaseShaderData(const char* shader_name,
               full_shader_name);
     }
 
+    UpdateShaderVariants(shader_name, shader_name_size,
+                         variant_name, variant_name_size, nullptr);
+    gActiveRenderKeysStale = true;
     return gShaderDatas.Remove(full_shader_hash);
   }
   return false;
@@ -1552,6 +2587,11 @@ bool Renderer::ReleaseRenderType(const char* name, size_t name_size) {
   RenderTypeInternal* render_type = gRenderTypes.GetValue(name_hash);
   YASSERT(render_type, "Releasing an invalid Render Type Name: %s", name);
   if (render_type->DecRef()) {
+    const uint32_t num_render_passes = gRenderPassArray.GetCount();
+    for (uint32_t i = 0; i < num_render_passes; ++i) {
+      RemoveShaderVariant(render_type, gRenderPassArray[i]);
+    }
+    gRenderTypeArray.Remove(render_type->mArrayIndex);
     return gRenderTypes.Remove(name_hash);
   }
   return false;
@@ -1614,6 +2654,7 @@ bool Renderer::ReleaseGlobalArg(const char* param, size_t param_size) {
       bool empty = float_arg->mFloatArg->DecRef();
       YASSERT(!empty, "Float argument released before global argument: %s",
               param);
+      gActiveRenderKeysStale = true;
       return gGlobalFloatArgs.Remove(param_hash);
     }
     return false;
@@ -1626,6 +2667,7 @@ bool Renderer::ReleaseGlobalArg(const char* param, size_t param_size) {
       bool empty = tex_arg->mTexArg->DecRef();
       YASSERT(!empty, "Float argument released before global argument: %s",
               param);
+      gActiveRenderKeysStale = true;
       return gGlobalTexArgs.Remove(param_hash);
     }
     return false;
@@ -1666,187 +2708,74 @@ bool Renderer::ReleaseRenderObject(const char* name, size_t name_size) {
 }
 
 void Renderer::ActivateRenderPasses(const char* name, size_t name_size) {
-  DeactivateRenderPasses();
-  uint32_t frame_width, frame_height;
-  render_device::RenderDevice::GetFrameBufferDimensions(frame_width,
-                                                        frame_height);
-
   ActivePassesInternal* active_passes = gActivePasses.GetValue(name, name_size);
   YASSERT(active_passes, "Unknown Render Passes Name: %s", name);
-  active_passes->IncRef();
-  gActiveRenderPasses = active_passes;
 
-  // Setup Render Objects
-  const uint32_t num_render_objects = gRenderObjArray.GetCount();
-  for (uint32_t i = 0; i < num_render_objects; ++i) {
-    RenderObjectInternal* render_obj = gRenderObjArray[i];
+  // Reactivating the active passes only builds keys for the render objects
+  // which do not have keys for this activation yet.
+  const bool incremental = (active_passes == gActiveRenderPasses &&
+                            !gActiveRenderKeysStale);
+  if (!incremental) {
+    DeactivateRenderPasses();
+    active_passes->IncRef();
+    gActiveRenderPasses = active_passes;
+    gActiveRenderKeysStale = false;
+    ++gActivationCount;
+  }
 
-    // Activate Viewport
-    ViewPortInternal* viewport = render_obj->mViewPort;
-    if (viewport->mActivatedArrayIndex == INVALID_INDEX) {
-      viewport->mActivatedArrayIndex = gViewPortArray.PushBack(viewport);
-      YASSERT(viewport->mActivatedArrayIndex != INVALID_INDEX,
-              "Maximum number of activated viewports (%u) exceeded.",
-              MAX_ACTIVE_VIEWPORTS);
+  // Activations which modify shared state are done serially up front.
+  RenderObjectInternal* render_objs[MAX_ACTIVE_RENDEROBJS];
+  uint32_t num_render_objs = 0;
+  const uint32_t num_slots = gRenderObjArray.GetNumIndexesUsed();
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    RenderObjectInternal* render_obj = gRenderObjArray[i].mObject;
+    if (render_obj == nullptr ||
+        render_obj->mKeysActivation == gActivationCount)
+      continue;
+
+    if (!ActivateRenderObject(render_obj, active_passes)) {
+      YASSERT(incremental,
+              "Maximum number of render keys (%u) or render key arguments "
+              "(%u) exceeded.",
+              MAX_ACTIVE_RENDERKEYS, MAX_ACTIVE_RENDERKEY_ARGS);
+
+      // Released objects leave their keys behind, rebuild every key.
+      gActiveRenderKeysStale = true;
+      ActivateRenderPasses(name, name_size);
+      return;
     }
+    render_objs[num_render_objs++] = render_obj;
+  }
 
-    // Iterate through active render passes
-    const uint8_t num_passes = active_passes->mNumRenderPasses;
-    RenderTypeInternal* render_type = render_obj->mRenderType;
-    for (uint8_t pass_index = 0; pass_index < num_passes; ++pass_index) {
-      RenderPassInternal* render_pass =
-          active_passes->mRenderPasses[pass_index];
-      char shader_name[MAX_SHADER_BASE_NAME + MAX_SHADER_VARIANT_NAME];
-      memcpy(shader_name, render_type->mShaderBase,
-             render_type->mShaderBaseSize);
-      shader_name[render_type->mShaderBaseSize-1] = ':';
-      memcpy(shader_name + render_type->mShaderBaseSize,
-             render_pass->mShaderVariant,
-             render_pass->mShaderVariantSize);
-
-      ShaderDataInternal* shader = gShaderDatas.GetValue(
-        shader_name,
-        render_type->mShaderBaseSize + render_pass->mShaderVariantSize);
-      if (shader) {
-        // Activate Shader
-        if (shader->mActivatedArrayIndex == INVALID_INDEX) {
-          shader->mActivatedArrayIndex = gShaderDataArray.PushBack(shader);
-          YASSERT(shader->mActivatedArrayIndex != INVALID_INDEX,
-              "Maximum number of activated shaders (%u) exceeded.",
-              MAX_ACTIVE_SHADERS);
-        }
-
-        // Activate Vertex Declaration
-        VertexDeclInternal* vertex_decl = shader->mVertexDecl;
-        if (vertex_decl->mActivatedArrayIndex == INVALID_INDEX) {
-          vertex_decl->mActivatedArrayIndex =
-              gVertexDeclArray.PushBack(vertex_decl);
-          YASSERT(vertex_decl->mActivatedArrayIndex != INVALID_INDEX,
-              "Maximum number of activated vertex declarations (%u) exceeded.",
-              MAX_ACTIVE_VERTEX_DECLS);
-        }
-
-        // Activate Vertex Buffers for the Vertex Declaration
-        VertexDataInternal* vertex_data = render_obj->mVertexData;
-        VertexBufferInternal* vertex_buffer =
-            vertex_data->GetVertexBuffer(vertex_decl);
-        if (nullptr == vertex_buffer) {
-          VertexBufferInternal new_vertex_buffer(vertex_decl);
-          uint32_t buffer_index = gVertexBuffers.Insert(new_vertex_buffer);
-          YASSERT(buffer_index != INVALID_INDEX,
-                  "Maximum number of vertex buffers (%u) reached.",
-                  VERTEX_BUFFERS_SIZE);
-          vertex_buffer = &gVertexBuffers[buffer_index];
-          if (!vertex_data->InsertVertexBuffer(vertex_buffer)) {
-            vertex_data->ClearUnusedVertexBuffer();
-            const bool inserted =
-                vertex_data->InsertVertexBuffer(vertex_buffer);
-            YASSERT(inserted,
-                    "Maximum number of vertex buffers (%u) per data exceeded.",
-                    MAX_VERTEX_BUFFERS_PER_DATA);
-          }
-        }
-
-        // Shader Parameters
-        ShdrFloatArgInternal* vertex_shdr_float_args[MAX_FLOAT_ARGS_PER_OBJ];
-        ShdrTexArgInternal* vertex_shdr_tex_args[MAX_TEXTURE_ARGS_PER_OBJ];
-        ShdrFloatArgInternal* pixel_shdr_float_args[MAX_FLOAT_ARGS_PER_OBJ];
-        ShdrTexArgInternal* pixel_shdr_tex_args[MAX_TEXTURE_ARGS_PER_OBJ];
-
-        // Vertex Shader Float Params
-        const uint8_t num_vert_shdr_floats = shader->mNumVertexShdrFloatParams;
-        for (uint8_t m = 0; m < num_vert_shdr_floats; ++m) {
-          ShdrFloatParamInternal* float_param =
-              shader->mVertexShdrFloatParams[m];
-          ShdrFloatArgInternal* float_arg =
-              render_obj->GetFloatArg(float_param);
-          if (!float_arg) {
-            GlobalFloatArgInternal* global_arg =
-                gGlobalFloatArgs.GetValue(float_param->mName,
-                                          float_param->mNameSize);
-            YASSERT(global_arg,
-                    "Vertex shader float parameter not set: %s",
-                    float_param->mName);
-            float_arg = global_arg->mFloatArg;
-          }
-          vertex_shdr_float_args[m] = float_arg;
-        }
-
-        // Vertex Shader Texture Params
-        const uint8_t num_vert_shdr_texs = shader->mNumVertexShdrTexParams;
-        for (uint8_t m = 0; m < num_vert_shdr_texs; ++m) {
-          ShdrTexParamInternal* tex_param = shader->mVertexShdrTexParams[m];
-          ShdrTexArgInternal* tex_arg = render_obj->GetTexArg(tex_param);
-          if (!tex_arg) {
-            GlobalTexArgInternal* global_arg =
-                gGlobalTexArgs.GetValue(tex_param->mName,
-                                        tex_param->mNameSize);
-            YASSERT(global_arg,
-                    "Vertex shader texture parameter not set: %s",
-                    tex_param->mName);
-            tex_arg = global_arg->mTexArg;
-          }
-          vertex_shdr_tex_args[m] = tex_arg;
-        }
-
-        // Pixel Shader Float Params
-        const uint8_t num_pix_shdr_floats = shader->mNumPixelShdrFloatParams;
-        for (uint8_t m = 0; m < num_pix_shdr_floats; ++m) {
-          ShdrFloatParamInternal* float_param =
-              shader->mPixelShdrFloatParams[m];
-          ShdrFloatArgInternal* float_arg =
-              render_obj->GetFloatArg(float_param);
-          if (!float_arg) {
-            GlobalFloatArgInternal* global_arg =
-                gGlobalFloatArgs.GetValue(float_param->mName,
-                                          float_param->mNameSize);
-            YASSERT(global_arg,
-                    "Pixel shader float parameter not set: %s",
-                    float_param->mName);
-            float_arg = global_arg->mFloatArg;
-          }
-          pixel_shdr_float_args[m] = float_arg;
-        }
-
-        // Pixel Shader Texture Params
-        const uint8_t num_pix_shdr_texs = shader->mNumPixelShdrTexParams;
-        for (uint8_t m = 0; m < num_pix_shdr_texs; ++m) {
-          ShdrTexParamInternal* tex_param = shader->mPixelShdrTexParams[m];
-          ShdrTexArgInternal* tex_arg = render_obj->GetTexArg(tex_param);
-          if (!tex_arg) {
-            GlobalTexArgInternal* global_arg =
-                gGlobalTexArgs.GetValue(tex_param->mName,
-                                        tex_param->mNameSize);
-            YASSERT(global_arg,
-                    "Pixel shader texture parameter not set: %s",
-                    tex_param->mName);
-            tex_arg = global_arg->mTexArg;
-          }
-          pixel_shdr_tex_args[m] = tex_arg;
-        }
+  // Generating the render keys only reads shared state.
+  size_t num_jobs = 1;
+  if (gThreadPool && gThreadPool->Running()) {
+    num_jobs = std::min<size_t>(gThreadPool->GetNumThreads() + 1,
+                                MAX_ACTIVATION_JOBS);
+    num_jobs = std::min<size_t>(num_jobs,
+                                num_render_objs /
+                                MIN_OBJECTS_PER_ACTIVATION_JOB);
+  }
 
-        // Generate Render Key
-        RenderKeyInternal render_key(viewport, render_pass,
-                                     shader, vertex_buffer,
-                                     num_vert_shdr_floats,
-                                     vertex_shdr_float_args,
-                                     num_vert_shdr_texs, vertex_shdr_tex_args,
-                                     num_pix_shdr_floats, pixel_shdr_float_args,
-                                     num_pix_shdr_texs, pixel_shdr_tex_args);
-
-        const uint32_t key_index = gRenderKeys.PushBack(render_key);
-        const uint64_t render_key_num =
-            render_key.GetRenderKey(key_index, pass_index,
-                                    gActiveRenderKeyFields,
-                                    gActiveRenderKeyFieldsCount,
-                                    gActiveRenderKeyBitsUsed);
-        YASSERT(render_obj->mNumRenderKeys >=
-                ARRAY_SIZE(render_obj->mRenderKeys),
-                "Invalid number of render keys (%u), something went wrong...",
-                render_obj->mNumRenderKeys);
-        render_obj->mRenderKeys[render_obj->mNumRenderKeys++] = render_key_num;
-      }
+  if (num_jobs > 1) {
+    RenderKeyJob jobs[MAX_ACTIVATION_JOBS];
+    const uint32_t objs_per_job =
+        static_cast<uint32_t>((num_render_objs + num_jobs - 1) / num_jobs);
+    for (size_t j = 0; j < num_jobs; ++j) {
+      const uint32_t begin = static_cast<uint32_t>(j) * objs_per_job;
+      jobs[j].mRenderObjects = render_objs + begin;
+      jobs[j].mNumRenderObjects = std::min(objs_per_job,
+                                           num_render_objs - begin);
+      jobs[j].mActivePasses = active_passes;
     }
+    gThreadPool->RunAndWait(GenerateRenderKeysRoutine, jobs, sizeof(jobs[0]),
+                            num_jobs);
+  } else {
+    RenderKeyJob job;
+    job.mRenderObjects = render_objs;
+    job.mNumRenderObjects = num_render_objs;
+    job.mActivePasses = active_passes;
+    GenerateRenderKeysRoutine(&job);
   }
 }
 
@@ -1860,47 +2789,281 @@ void Renderer::DeactivateRenderPasses() {
   }
 }
 
-void Renderer::EnqueueRenderObject(uint64_t render_object_hash) {
+bool Renderer::RegisterEnqueueThread() {
+  if (gThreadEnqueueBucket != INVALID_ENQUEUE_BUCKET)
+    return true;
+
+  for (;;) {
+    const uint32_t buckets_used = gEnqueueBucketsUsed;
+    uint32_t bucket_index = 0;
+    while (bucket_index < MAX_ENQUEUE_BUCKETS &&
+           (buckets_used & (1u << bucket_index)))
+      ++bucket_index;
+    if (bucket_index == MAX_ENQUEUE_BUCKETS)
+      return false;
+
+    if (ycommon::AtomicCmpSet32(&gEnqueueBucketsUsed, buckets_used,
+                                buckets_used | (1u << bucket_index))) {
+      gThreadEnqueueBucket = bucket_index;
+      return true;
+    }
+  }
+}
+
+void Renderer::ReleaseEnqueueThread() {
+  const uint32_t bucket_index = gThreadEnqueueBucket;
+  if (bucket_index != INVALID_ENQUEUE_BUCKET) {
+    // Keys left in the bucket are still merged in the next PrepareDraw().
+    ycommon::AtomicAnd32(&gEnqueueBucketsUsed, ~(1u << bucket_index));
+    gThreadEnqueueBucket = INVALID_ENQUEUE_BUCKET;
+  }
+}
+
+void Renderer::EnqueueRenderObject(uint64_t render_object_hash,
+                                   float depth) {
   RenderObjectInternal* object = gRenderObjects.GetValue(render_object_hash);
   YASSERT(object, "Invalid Render Object Hash Given.");
 
   const uint32_t num_keys = object->mNumRenderKeys;
   if (num_keys) {
-    uint32_t index = ycommon::AtomicAdd32(&gEnqueuedRenderKeysCount, num_keys);
-    YASSERT(index + num_keys <= gMaxEnqueuedRenderKeys,
-            "Maximum number of enqueued render objects reached: %u",
-            gMaxEnqueuedRenderKeys);
+    FrameData& frame = BeginEnqueue();
+    CopyRenderKeys(ReserveEnqueuedRenderKeys(frame, num_keys, 1), object,
+                   depth);
+    EndEnqueue(frame);
+  }
+}
+
+void Renderer::EnqueueRenderObjects(const uint64_t* render_object_hashes,
+                                    size_t count, const float* depths) {
+  RenderObjectInternal* objects[ENQUEUE_BATCH_SIZE];
+  for (size_t i = 0; i < count && i < ENQUEUE_PREFETCH_DISTANCE; ++i) {
+    gRenderObjects.Prefetch(render_object_hashes[i]);
+  }
+
+  for (size_t batch_begin = 0; batch_begin < count;
+       batch_begin += ENQUEUE_BATCH_SIZE) {
+    const size_t batch_size = std::min<size_t>(count - batch_begin,
+                                               ENQUEUE_BATCH_SIZE);
+    const uint64_t* hashes = render_object_hashes + batch_begin;
+    for (size_t i = 0; i < batch_size; ++i) {
+      if (batch_begin + i + ENQUEUE_PREFETCH_DISTANCE < count) {
+        gRenderObjects.Prefetch(hashes[i + ENQUEUE_PREFETCH_DISTANCE]);
+      }
 
-    memcpy(&gEnqueuedRenderKeys[index], object->mRenderKeys,
-           sizeof(uint64_t) * num_keys);
+      RenderObjectInternal* object = gRenderObjects.GetValue(hashes[i]);
+      YASSERT(object, "Invalid Render Object Hash Given.");
+      PREFETCH(object->mRenderKeys);
+      objects[i] = object;
+    }
+    EnqueueRenderObjectBatch(objects, depths ? depths + batch_begin : nullptr,
+                             batch_size);
+  }
+}
+
+bool Renderer::IsValidRenderObject(RenderObjectHandle handle) {
+  return GetRenderObject(handle) != nullptr;
+}
+
+void Renderer::EnqueueRenderObjectHandle(RenderObjectHandle handle,
+                                         float depth) {
+  RenderObjectInternal* object = GetRenderObject(handle);
+  YASSERT(object, "Invalid Render Object Handle Given: %u", handle);
+
+  const uint32_t num_keys = object->mNumRenderKeys;
+  if (num_keys) {
+    FrameData& frame = BeginEnqueue();
+    CopyRenderKeys(ReserveEnqueuedRenderKeys(frame, num_keys, 1), object,
+                   depth);
+    EndEnqueue(frame);
+  }
+}
+
+void Renderer::EnqueueRenderObjectHandles(const RenderObjectHandle* handles,
+                                          size_t count, const float* depths) {
+  RenderObjectInternal* objects[ENQUEUE_BATCH_SIZE];
+  for (size_t batch_begin = 0; batch_begin < count;
+       batch_begin += ENQUEUE_BATCH_SIZE) {
+    const size_t batch_size = std::min<size_t>(count - batch_begin,
+                                               ENQUEUE_BATCH_SIZE);
+    for (size_t i = 0; i < batch_size; ++i) {
+      RenderObjectInternal* object = GetRenderObject(handles[batch_begin + i]);
+      YASSERT(object, "Invalid Render Object Handle Given: %u",
+              handles[batch_begin + i]);
+      PREFETCH(object->mRenderKeys);
+      objects[i] = object;
+    }
+    EnqueueRenderObjectBatch(objects, depths ? depths + batch_begin : nullptr,
+                             batch_size);
   }
 }
 
 void Renderer::PrepareDraw() {
-  const uint32_t num_keys = gEnqueuedRenderKeysCount;
+  YPROFILE_ZONE("Renderer::PrepareDraw");
+  // Swap the enqueue buffers first so the next frame can start enqueuing.
+  const uint32_t frame_index = gEnqueueFrame;
+  FrameData& frame = gFrames[frame_index];
+  ycommon::AtomicSet32(&gEnqueueFrame,
+                       (frame_index + 1) % NUM_PIPELINED_FRAMES);
+
+  // Enqueues which began before the swap may still be copying their keys.
+  while (frame.mEnqueuesInFlight)
+    ycommon::CpuPause();
   ycommon::AcquireFence();
-  std::sort(gEnqueuedRenderKeys, gEnqueuedRenderKeys + num_keys);
+  YASSERT(!frame.mPrepared,
+          "Frame was prepared again before its draws were executed.");
+
+  // Wide keys have the whole low word for the index.
+  const bool wide_keys = (gRenderKeyWords == 2);
+  const uint8_t num_index_bits = wide_keys ? 64 :
+                                 64 - gActiveRenderKeyBitsUsed;
+  YDEBUG_CHECK(num_index_bits > 0, "Sanity check failed for number of bits");
+  const uint64_t key_index_mask = (num_index_bits == 64) ?
+      static_cast<uint64_t>(-1) :
+      (static_cast<uint64_t>(1) << num_index_bits) - 1;
+
+  // Only sort on the field bits and the index bits which can be set.
+  const uint32_t num_render_keys = gRenderKeys.GetCount();
+  uint64_t used_index_mask = 0;
+  while (num_render_keys && used_index_mask < num_render_keys - 1)
+    used_index_mask = (used_index_mask << 1) | 1;
+  const uint64_t field_mask = (gActiveRenderKeyBitsUsed == 0) ? 0 :
+      static_cast<uint64_t>(-1) << (64 - gActiveRenderKeyBitsUsed);
+  const uint64_t sort_mask = wide_keys ? field_mask :
+      field_mask | (used_index_mask & key_index_mask);
+  const uint64_t index_sort_mask = wide_keys ? used_index_mask : 0;
+
+  // The shared queue and each bucket are sorted as separate runs.
+  SortRunJob runs[MAX_ENQUEUE_BUCKETS + 1];
+  uint32_t num_runs = 0;
+  uint32_t num_keys = 0;
+  uint32_t num_objects = ycommon::AtomicSet32(&frame.mEnqueuedObjectsCount,
+                                              0u);
+  const uint32_t num_shared_keys =
+      ycommon::AtomicSet32(&frame.mEnqueuedRenderKeysCount, 0u);
+  if (num_shared_keys) {
+    runs[num_runs].mKeys = frame.mEnqueuedRenderKeys;
+    runs[num_runs].mScratch = frame.mEnqueuedRenderKeysScratch;
+    runs[num_runs].mCount = num_shared_keys;
+    num_keys += num_shared_keys;
+    ++num_runs;
+  }
+  for (uint32_t i = 0; i < MAX_ENQUEUE_BUCKETS; ++i) {
+    EnqueueBucket& bucket = frame.mEnqueueBuckets[i];
+    const uint32_t bucket_keys = ycommon::AtomicSet32(&bucket.mCount, 0u);
+    if (bucket_keys) {
+      runs[num_runs].mKeys = bucket.mKeys;
+      runs[num_runs].mScratch = bucket.mScratch;
+      runs[num_runs].mCount = bucket_keys;
+      num_keys += bucket_keys;
+      ++num_runs;
+    }
+    num_objects += ycommon::AtomicSet32(&bucket.mNumObjects, 0u);
+  }
+  YASSERT(num_keys <= gMaxEnqueuedRenderKeys,
+          "Maximum number of enqueued render keys (%u) exceeded: %u",
+          gMaxEnqueuedRenderKeys, num_keys);
+
+  // A single run can split its sort across the pool, otherwise the runs are
+  // sorted in parallel and merged.
+  const uint64_t* sorted_keys = gMergedRenderKeys;
+  {
+    YPROFILE_ZONE("Renderer Sort");
+    if (num_runs == 1) {
+      sorted_keys = SortRenderKeys(runs[0].mKeys, runs[0].mScratch,
+                                   runs[0].mCount, sort_mask, index_sort_mask,
+                                   gThreadPool);
+    } else if (num_runs > 1) {
+      for (uint32_t i = 0; i < num_runs; ++i) {
+        runs[i].mSortMask = sort_mask;
+        runs[i].mIndexSortMask = index_sort_mask;
+      }
+      if (gThreadPool) {
+        gThreadPool->RunAndWait(SortRunRoutine, runs, sizeof(runs[0]),
+                                num_runs);
+      } else {
+        for (uint32_t i = 0; i < num_runs; ++i) {
+          SortRunRoutine(&runs[i]);
+        }
+      }
+      if (wide_keys) {
+        MergeSortedRuns(runs, num_runs,
+                        reinterpret_cast<WideRenderKey*>(gMergedRenderKeys));
+      } else {
+        MergeSortedRuns(runs, num_runs, gMergedRenderKeys);
+      }
+    }
+  }
 
-  RenderDeviceState device_state;
+  RecordJob jobs[MAX_RECORD_JOBS];
+  const uint32_t num_jobs = SplitRecordJobs(sorted_keys, num_keys,
+                                            key_index_mask, jobs);
+  if (num_jobs > 1) {
+    gThreadPool->RunAndWait(RecordRoutine, jobs, sizeof(jobs[0]), num_jobs);
+  } else {
+    RecordRoutine(&jobs[0]);
+  }
 
-  render_device::RenderDevice::BeginRecord();
-  const uint8_t num_index_bits = 64 - gActiveRenderKeyBitsUsed;
-  YDEBUG_CHECK(num_index_bits > 0 && num_index_bits < 32,
-               "Sanity check failed for number of bits");
-  const uint32_t bits_power = static_cast<uint32_t>(1u) << num_index_bits;
-  const uint32_t key_index_mask = bits_power - 1;
-  for (uint32_t i = 0; i < num_keys; ++i) {
-    const uint64_t render_key = gEnqueuedRenderKeys[i];
-    const uint32_t render_index =
-        static_cast<uint32_t>(render_key) & key_index_mask;
-    const RenderKeyInternal* render_key_obj = &gRenderKeys[render_index];
-    render_key_obj->ExecuteRenderKey(device_state);
+  Renderer::FrameStats& stats = gFrameStats;
+  memset(&stats, 0, sizeof(stats));
+  stats.mNumEnqueuedObjects = num_objects;
+  stats.mNumRenderKeys = num_keys;
+  stats.mNumSortRuns = num_runs;
+  stats.mNumCommandLists = num_jobs;
+  for (uint32_t i = 0; i < num_jobs; ++i) {
+    const RecordJob& job = jobs[i];
+    frame.mCommandLists[i] = job.mCommandList;
+    stats.mNumDraws += job.mNumDraws;
+    stats.mNumInstances += job.mNumInstances;
+    stats.mNumSkippedStateChanges += job.mSkippedStateChanges;
+    for (uint32_t n = 0; n < NUM_DEVICE_STATE_TYPES; ++n) {
+      const DeviceStateType type = static_cast<DeviceStateType>(n);
+      stats.mNumStateChanges[n] += job.mDeviceState.GetNumActivations(type);
+      stats.mNumFilteredStateChanges[n] +=
+          job.mDeviceState.GetNumFiltered(type);
+    }
   }
+  frame.mNumCommandLists = num_jobs;
+
+  const uint32_t num_uploads = UploadRing::GetNumAllocations();
+  const uint64_t upload_size = UploadRing::GetAllocatedSize();
+  stats.mNumUploads = num_uploads - gPreparedUploads;
+  stats.mUploadSize = upload_size - gPreparedUploadSize;
+  gPreparedUploads = num_uploads;
+  gPreparedUploadSize = upload_size;
+
+  // Publish the command lists to ExecuteDraws().
+  ycommon::ReleaseFence();
+  frame.mPrepared = 1;
+}
 
-  render_device::RenderDevice::EndRecord();
+uint32_t Renderer::GetNumSkippedStateChanges() {
+  return gFrameStats.mNumSkippedStateChanges;
 }
 
-void Renderer::ExecuteDraws() {
+const Renderer::FrameStats& Renderer::GetFrameStats() {
+  return gFrameStats;
+}
+
+bool Renderer::ExecuteDraws() {
+  YPROFILE_ZONE("Renderer::ExecuteDraws");
+  FrameData& frame = gFrames[gExecuteFrame];
+  if (!frame.mPrepared)
+    return false;
+  ycommon::AcquireFence();
+
+  const uint32_t num_command_lists = frame.mNumCommandLists;
+  for (uint32_t i = 0; i < num_command_lists; ++i) {
+    render_device::RenderDevice::ExecuteCommandList(frame.mCommandLists[i]);
+    render_device::RenderDevice::ReleaseCommandList(frame.mCommandLists[i]);
+  }
+  frame.mNumCommandLists = 0;
+
+  // The frame can be prepared again once its command lists are released.
+  ycommon::ReleaseFence();
+  frame.mPrepared = 0;
+  gExecuteFrame = (gExecuteFrame + 1) % NUM_PIPELINED_FRAMES;
+  UploadRing::EndFrame();
+  return true;
 }
 
 }} // namespace yengine { namespace renderer {
@@ -10,6 +10,10 @@
 using ycommon::containers::ReadRefData;
 using ycommon::containers::TypedReadRefData;
 
+namespace ycommon { namespace containers {
+  class ThreadPool;
+}} // namespace ycommon { namespace containers {
+
 namespace yengine { namespace render_device {
   struct RenderBlendState;
   struct SamplerState;
@@ -22,11 +26,23 @@ struct RenderKeyField;
 typedef uint8_t ShaderID;
 typedef uint8_t RenderTypeID;
 
+// Registered render objects can be enqueued by handle without a lookup.
+typedef uint32_t RenderObjectHandle;
+const RenderObjectHandle kInvalidRenderObjectHandle =
+    static_cast<RenderObjectHandle>(-1);
+
 namespace Renderer {
   void Initialize(void* buffer, size_t buffer_size);
   void Terminate();
 
-  void SetupRenderKey(const RenderKeyField* fields, size_t num_fields);
+  // Narrow render keys pack the fields and the render key index into 64 bits.
+  // Wide keys hold the fields in a high word and the index in a low word so
+  // fields can use every bit without limiting the number of render keys.
+  void SetupRenderKey(const RenderKeyField* fields, size_t num_fields,
+                      bool wide_keys = false);
+
+  // Optional thread pool used to split up the work in PrepareDraw().
+  void SetThreadPool(ycommon::containers::ThreadPool* thread_pool);
 
   // Register renderer options, default values do not overwrite settings.
   void RegisterViewPort(const char* name, size_t name_size,
@@ -44,7 +60,9 @@ namespace Renderer {
                           const char* shader_variant, size_t variant_size,
                           const render_device::RenderBlendState& blend_state,
                           const char** render_targets, size_t* target_sizes,
-                          size_t num_targets);
+                          size_t num_targets,
+                          DepthSortType depth_sort =
+                              kDepthSortType_FrontToBack);
   void RegisterVertexDecl(const char* name, size_t name_size,
                           const render_device::VertexDeclElement* elements,
                           size_t num_elements);
@@ -75,12 +93,14 @@ namespace Renderer {
                          const char* param, size_t param_size);
   void RegisterGlobalArg(const char* param, size_t param_size,
                          const char* arg, size_t arg_size);
-  void RegisterRenderObject(const char* name, size_t name_size,
-                            const char* view_port, size_t view_port_size,
-                            const char* render_type, size_t render_type_size,
-                            const char* vertex_data, size_t vertex_data_size,
-                            size_t num_shader_args,
-                            const char** shader_args, size_t* shader_arg_sizes);
+  // The returned handle stays valid until the render object is released.
+  RenderObjectHandle RegisterRenderObject(
+      const char* name, size_t name_size,
+      const char* view_port, size_t view_port_size,
+      const char* render_type, size_t render_type_size,
+      const char* vertex_data, size_t vertex_data_size,
+      size_t num_shader_args,
+      const char** shader_args, size_t* shader_arg_sizes);
 
   // Release
   bool ReleaseViewPort(const char* name, size_t name_size);
@@ -131,13 +151,58 @@ namespace Renderer {
       ReadRefData shader_arg_data);
 
   // Enqueue Render Command
-  void EnqueueRenderObject(uint64_t render_object_hash);
+  // Threads enqueuing many objects should register for their own bucket so
+  // they do not contend on the shared queue, buckets are merged together in
+  // PrepareDraw(). Returns false once every bucket has been taken, the
+  // thread then keeps using the shared queue. Threads must release their
+  // bucket before the renderer is terminated.
+  bool RegisterEnqueueThread();
+  void ReleaseEnqueueThread();
+  // Depths range from 0 (nearest) to 1 (farthest) and are quantized into the
+  // depth field of the render key, ordered by the depth sort of the pass.
+  void EnqueueRenderObject(uint64_t render_object_hash, float depth = 0.0f);
+  void EnqueueRenderObjects(const uint64_t* render_object_hashes,
+                            size_t count, const float* depths = nullptr);
+
+  // Handles skip the render object lookup, released handles are invalid.
+  bool IsValidRenderObject(RenderObjectHandle handle);
+  void EnqueueRenderObjectHandle(RenderObjectHandle handle,
+                                 float depth = 0.0f);
+  void EnqueueRenderObjectHandles(const RenderObjectHandle* handles,
+                                  size_t count, const float* depths = nullptr);
 
   // Execution Commands (These are meant to run on separate threads)
+  // Frames are pipelined, PrepareDraw() for frame N+1 may run while
+  // ExecuteDraws() submits frame N. PrepareDraw() marks the frame boundary,
+  // enqueues made before it belong to the frame it prepares and later ones to
+  // the next frame, enqueues still copying into the prepared frame are waited
+  // for. A frame must be executed before the frame after next is prepared.
   void PrepareDraw();
 
+  // State activations the last PrepareDraw() skipped because consecutive
+  // keys already shared them.
+  uint32_t GetNumSkippedStateChanges();
+
+  // Counters of the last PrepareDraw(), uploads are the dynamic buffer
+  // allocations made since the PrepareDraw() before it.
+  struct FrameStats {
+    uint32_t mNumEnqueuedObjects;
+    uint32_t mNumRenderKeys;
+    uint32_t mNumSortRuns;
+    uint32_t mNumCommandLists;
+    uint32_t mNumDraws;
+    uint32_t mNumInstances;
+    uint32_t mNumSkippedStateChanges;
+    uint32_t mNumStateChanges[NUM_DEVICE_STATE_TYPES];
+    uint32_t mNumFilteredStateChanges[NUM_DEVICE_STATE_TYPES];
+    uint32_t mNumUploads;
+    uint64_t mUploadSize;
+  };
+  const FrameStats& GetFrameStats();
+
   void ExecuteUploads();
-  void ExecuteDraws();
+  // Submits the oldest prepared frame, returns false if none was prepared.
+  bool ExecuteDraws();
 }
 
 }} // namespace yengine { namespace renderer {
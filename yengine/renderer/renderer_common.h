@@ -10,6 +10,30 @@ enum DimensionType {
   kDimensionType_Percentage, // Use percentage of frame buffer dimensions.
 };
 
+enum DepthSortType {
+  kDepthSortType_FrontToBack, // Nearest first, reduces overdraw.
+  kDepthSortType_BackToFront, // Farthest first, for blended passes.
+};
+
+enum DeviceStateType {
+  kDeviceStateType_ViewPort,
+  kDeviceStateType_BlendState,
+  kDeviceStateType_RenderTarget,
+  kDeviceStateType_VertexDecl,
+  kDeviceStateType_VertexFloatArg,
+  kDeviceStateType_PixelFloatArg,
+  kDeviceStateType_VertexSamplerState,
+  kDeviceStateType_PixelSamplerState,
+  kDeviceStateType_VertexTexture,
+  kDeviceStateType_PixelTexture,
+  kDeviceStateType_VertexShader,
+  kDeviceStateType_PixelShader,
+  kDeviceStateType_IndexStream,
+  kDeviceStateType_VertexStream,
+
+  NUM_DEVICE_STATE_TYPES
+};
+
 uint32_t GetDimensionValue(uint32_t frame_value, DimensionType type,
                            float value);
 
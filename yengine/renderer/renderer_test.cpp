@@ -1,20 +1,37 @@
 #include "yengine/renderer/renderer.h"
 
+#include <stdio.h>
 #include <gtest/gtest.h>
 
 #include "ycommon/containers/mem_buffer.h"
+#include "ycommon/containers/thread_pool.h"
+#include "ycommon/headers/macros.h"
 #include "ycommon/platform/platform_handle.h"
+#include "ycommon/platform/thread.h"
 #include "yengine/core/string_table.h"
 #include "yengine/render_device/render_blend_state.h"
 #include "yengine/render_device/render_device.h"
 #include "yengine/render_device/render_device_mock.h"
 #include "yengine/render_device/sampler_state.h"
+#include "yengine/renderer/render_key_field.h"
 
 namespace yengine { namespace renderer {
 
 namespace {
   const uint32_t gTestWidth = 128;
   const uint32_t gTestHeight = 128;
+
+  // Registers for an enqueue bucket and exits without releasing it.
+  uintptr_t RegisterEnqueueRoutine(void*) {
+    return Renderer::RegisterEnqueueThread() ? 1 : 0;
+  }
+
+  uintptr_t RunRegisterEnqueueThread() {
+    ycommon::platform::Thread thread(RegisterEnqueueRoutine, nullptr);
+    if (thread.Run() != kStatusCode_OK || !thread.Join(5000))
+      return 0;
+    return thread.ReturnValue();
+  }
 };
 
 class RendererTest : public ::testing::Test {
@@ -36,7 +53,7 @@ class RendererTest : public ::testing::Test {
     core::StringTable::Initialize(32, 128, mMemBuffer.Allocate(10240), 10240);
     render_device::RenderDevice::Initialize(mHandle, gTestWidth, gTestHeight,
                                             mMemBuffer.Allocate(10240), 10240);
-    Renderer::Initialize(mMemBuffer.Allocate(1024 * 1024), 1024 * 1024);
+    Renderer::Initialize(mMemBuffer.Allocate(1536 * 1024), 1536 * 1024);
   }
 
   virtual void TearDown() {
@@ -390,4 +407,1074 @@ TEST_F(RendererTest, BasicActivationTest) {
   EXPECT_TRUE(Renderer::ReleaseViewPort(viewport_name, sizeof(viewport_name)));
 }
 
+TEST_F(RendererTest, EnqueueThreadTest) {
+  EXPECT_TRUE(Renderer::RegisterEnqueueThread());
+  EXPECT_TRUE(Renderer::RegisterEnqueueThread());
+
+  // Other threads take the remaining buckets until none are left.
+  const size_t max_threads = 64;
+  size_t registered = 0;
+  while (registered < max_threads && RunRegisterEnqueueThread())
+    ++registered;
+  EXPECT_LT(registered, max_threads);
+  EXPECT_EQ(0u, RunRegisterEnqueueThread());
+
+  Renderer::ReleaseEnqueueThread();
+  EXPECT_EQ(1u, RunRegisterEnqueueThread());
+  EXPECT_FALSE(Renderer::RegisterEnqueueThread());
+
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectEndRecord(0);
+  Renderer::PrepareDraw();
+}
+
+TEST_F(RendererTest, EnqueueRenderObjectsTest) {
+  const char name[] = "render_object_name";
+  const char viewport[] = "test_viewport";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  Renderer::RegisterViewPort(viewport, sizeof(viewport),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+  Renderer::RegisterRenderObject(name, sizeof(name),
+                                 viewport, sizeof(viewport),
+                                 render_type, sizeof(render_type),
+                                 vertex_data, sizeof(vertex_data),
+                                 0, nullptr, nullptr);
+
+  // Enough objects to span more than a single enqueue batch.
+  const uint64_t name_hash = core::StringTable::AddString(name, sizeof(name));
+  uint64_t render_objects[300];
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    render_objects[i] = name_hash;
+  }
+  Renderer::EnqueueRenderObjects(render_objects, ARRAY_SIZE(render_objects));
+  Renderer::EnqueueRenderObjects(render_objects, 0);
+  Renderer::EnqueueRenderObject(name_hash);
+
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectEndRecord(0);
+  Renderer::PrepareDraw();
+
+  EXPECT_TRUE(Renderer::ReleaseRenderObject(name, sizeof(name)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport, sizeof(viewport)));
+}
+
+TEST_F(RendererTest, RenderObjectHandleTest) {
+  const char name[] = "render_object_name";
+  const char name2[] = "render_object_name2";
+  const char viewport[] = "test_viewport";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  Renderer::RegisterViewPort(viewport, sizeof(viewport),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+
+  EXPECT_FALSE(Renderer::IsValidRenderObject(kInvalidRenderObjectHandle));
+
+  const RenderObjectHandle handle =
+      Renderer::RegisterRenderObject(name, sizeof(name),
+                                     viewport, sizeof(viewport),
+                                     render_type, sizeof(render_type),
+                                     vertex_data, sizeof(vertex_data),
+                                     0, nullptr, nullptr);
+  EXPECT_TRUE(Renderer::IsValidRenderObject(handle));
+  EXPECT_EQ(handle,
+            Renderer::RegisterRenderObject(name, sizeof(name),
+                                           viewport, sizeof(viewport),
+                                           render_type, sizeof(render_type),
+                                           vertex_data, sizeof(vertex_data),
+                                           0, nullptr, nullptr));
+
+  const RenderObjectHandle handles[] = { handle, handle, handle };
+  Renderer::EnqueueRenderObjectHandle(handle);
+  Renderer::EnqueueRenderObjectHandles(handles, ARRAY_SIZE(handles));
+
+  EXPECT_FALSE(Renderer::ReleaseRenderObject(name, sizeof(name)));
+  EXPECT_TRUE(Renderer::IsValidRenderObject(handle));
+  EXPECT_TRUE(Renderer::ReleaseRenderObject(name, sizeof(name)));
+  EXPECT_FALSE(Renderer::IsValidRenderObject(handle));
+
+  // A new object reusing the released slot gets a different handle.
+  const RenderObjectHandle handle2 =
+      Renderer::RegisterRenderObject(name2, sizeof(name2),
+                                     viewport, sizeof(viewport),
+                                     render_type, sizeof(render_type),
+                                     vertex_data, sizeof(vertex_data),
+                                     0, nullptr, nullptr);
+  EXPECT_NE(handle, handle2);
+  EXPECT_FALSE(Renderer::IsValidRenderObject(handle));
+  EXPECT_TRUE(Renderer::IsValidRenderObject(handle2));
+
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectEndRecord(0);
+  Renderer::PrepareDraw();
+
+  EXPECT_TRUE(Renderer::ReleaseRenderObject(name2, sizeof(name2)));
+  EXPECT_FALSE(Renderer::IsValidRenderObject(handle2));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport, sizeof(viewport)));
+}
+
+TEST_F(RendererTest, IncrementalActivationTest) {
+  const char viewport[] = "test_viewport";
+  const char render_target[] = "test_render_target";
+  const char render_pass[] = "test_render_pass";
+  const char shader_variant[] = "test_variant";
+  const char passes[] = "test_render_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  Renderer::RegisterViewPort(viewport, sizeof(viewport),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(render_pass, sizeof(render_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1);
+  const char* passes_names[] = { render_pass };
+  size_t passes_sizes[] = { sizeof(render_pass) };
+  Renderer::RegisterRenderPasses(passes, sizeof(passes),
+                                 passes_names, passes_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+
+  // Enough render objects for the activation to be split across the pool.
+  char names[41][32];
+  memset(names, 0, sizeof(names));
+  for (size_t i = 0; i < ARRAY_SIZE(names); ++i) {
+    snprintf(names[i], sizeof(names[i]), "render_object_%u",
+             static_cast<uint32_t>(i));
+  }
+
+  ycommon::containers::ContainedThreadPool<3, 16> thread_pool;
+  ASSERT_TRUE(thread_pool.Start());
+  Renderer::SetThreadPool(&thread_pool);
+
+  for (size_t i = 0; i < ARRAY_SIZE(names) - 1; ++i) {
+    Renderer::RegisterRenderObject(names[i], sizeof(names[i]),
+                                   viewport, sizeof(viewport),
+                                   render_type, sizeof(render_type),
+                                   vertex_data, sizeof(vertex_data),
+                                   0, nullptr, nullptr);
+  }
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+
+  // Reactivating only activates the newly registered render object.
+  const RenderObjectHandle handle =
+      Renderer::RegisterRenderObject(names[40], sizeof(names[40]),
+                                     viewport, sizeof(viewport),
+                                     render_type, sizeof(render_type),
+                                     vertex_data, sizeof(vertex_data),
+                                     0, nullptr, nullptr);
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+  Renderer::EnqueueRenderObjectHandle(handle);
+
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectEndRecord(0);
+  Renderer::PrepareDraw();
+
+  Renderer::DeactivateRenderPasses();
+  Renderer::SetThreadPool(nullptr);
+  EXPECT_TRUE(thread_pool.Stop(500));
+
+  for (size_t i = 0; i < ARRAY_SIZE(names); ++i) {
+    EXPECT_TRUE(Renderer::ReleaseRenderObject(names[i], sizeof(names[i])));
+  }
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(passes, sizeof(passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(render_pass, sizeof(render_pass)));
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport, sizeof(viewport)));
+}
+
+TEST_F(RendererTest, ShaderVariantTest) {
+  const char viewport[] = "test_viewport";
+  const char render_target[] = "test_render_target";
+  const char render_pass[] = "test_render_pass";
+  const char shader_variant[] = "test_variant";
+  const char passes[] = "test_render_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_decl[] = "vertex_decl_name";
+  const char vertex_shader[] = "test vertex shader";
+  const char pixel_shader[] = "test pixel shader";
+  const char vertex_data[] = "test_vertex_data_name";
+  const char render_object[] = "test_render_object";
+
+  Renderer::RegisterViewPort(viewport, sizeof(viewport),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(render_pass, sizeof(render_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1);
+  const char* passes_names[] = { render_pass };
+  size_t passes_sizes[] = { sizeof(render_pass) };
+  Renderer::RegisterRenderPasses(passes, sizeof(passes),
+                                 passes_names, passes_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+  Renderer::RegisterRenderObject(render_object, sizeof(render_object),
+                                 viewport, sizeof(viewport),
+                                 render_type, sizeof(render_type),
+                                 vertex_data, sizeof(vertex_data),
+                                 0, nullptr, nullptr);
+
+  // Shader data registered after the render type and pass is still found.
+  render_device::RenderDeviceMock::ExpectCreateVertexShader(
+      10, vertex_shader, sizeof(vertex_shader));
+  render_device::RenderDeviceMock::ExpectCreatePixelShader(
+      20, pixel_shader, sizeof(pixel_shader));
+  Renderer::RegisterVertexDecl(vertex_decl, sizeof(vertex_decl), nullptr, 0);
+  Renderer::RegisterShaderData(shader, sizeof(shader),
+                               shader_variant, sizeof(shader_variant),
+                               vertex_decl, sizeof(vertex_decl),
+                               0, nullptr, nullptr,
+                               vertex_shader, sizeof(vertex_shader),
+                               0, nullptr, nullptr,
+                               pixel_shader, sizeof(pixel_shader));
+
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+  Renderer::EnqueueRenderObject(
+      core::StringTable::AddString(render_object, sizeof(render_object)));
+
+  // The enqueued render object draws with the resolved shader data.
+  render_device::RenderBlendState blend_state_copy = blend_state;
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectCreateViewPort(1, 1, 2, 3, 4,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1);
+  render_device::RenderDeviceMock::ExpectCreateRenderBlendState(
+      2, blend_state_copy);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectCreateRenderTarget(
+      3, 1, 1, static_cast<render_device::PixelFormat>(1));
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectCreateVertexDeclaration(4, nullptr,
+                                                                 0);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(5);
+  Renderer::PrepareDraw();
+
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(5);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(5);
+  Renderer::ExecuteDraws();
+  Renderer::DeactivateRenderPasses();
+
+  EXPECT_TRUE(Renderer::ReleaseRenderObject(render_object,
+                                            sizeof(render_object)));
+  render_device::RenderDeviceMock::ExpectReleasePixelShader(20);
+  render_device::RenderDeviceMock::ExpectReleaseVertexShader(10);
+  EXPECT_TRUE(Renderer::ReleaseShaderData(shader, sizeof(shader),
+                                          shader_variant,
+                                          sizeof(shader_variant)));
+  render_device::RenderDeviceMock::ExpectReleaseVertexDeclaration(4);
+  EXPECT_TRUE(Renderer::ReleaseVertexDecl(vertex_decl, sizeof(vertex_decl)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(passes, sizeof(passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(render_pass, sizeof(render_pass)));
+  render_device::RenderDeviceMock::ExpectReleaseRenderTarget(3);
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(1);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport, sizeof(viewport)));
+}
+
+TEST_F(RendererTest, SkippedStateChangesTest) {
+  const char viewport[] = "test_viewport";
+  const char render_target[] = "test_render_target";
+  const char render_pass[] = "test_render_pass";
+  const char shader_variant[] = "test_variant";
+  const char passes[] = "test_render_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_decl[] = "vertex_decl_name";
+  const char vertex_shader[] = "test vertex shader";
+  const char pixel_shader[] = "test pixel shader";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  Renderer::RegisterViewPort(viewport, sizeof(viewport),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(render_pass, sizeof(render_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1);
+  const char* passes_names[] = { render_pass };
+  size_t passes_sizes[] = { sizeof(render_pass) };
+  Renderer::RegisterRenderPasses(passes, sizeof(passes),
+                                 passes_names, passes_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+  const char* render_objects[] = {
+    "test_render_object1", "test_render_object2", "test_render_object3"
+  };
+  uint64_t render_object_hashes[ARRAY_SIZE(render_objects)];
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    const size_t name_size = strlen(render_objects[i]) + 1;
+    Renderer::RegisterRenderObject(render_objects[i], name_size,
+                                   viewport, sizeof(viewport),
+                                   render_type, sizeof(render_type),
+                                   vertex_data, sizeof(vertex_data),
+                                   0, nullptr, nullptr);
+    render_object_hashes[i] =
+        core::StringTable::AddString(render_objects[i], name_size);
+  }
+
+  render_device::RenderDeviceMock::ExpectCreateVertexShader(
+      10, vertex_shader, sizeof(vertex_shader));
+  render_device::RenderDeviceMock::ExpectCreatePixelShader(
+      20, pixel_shader, sizeof(pixel_shader));
+  Renderer::RegisterVertexDecl(vertex_decl, sizeof(vertex_decl), nullptr, 0);
+  Renderer::RegisterShaderData(shader, sizeof(shader),
+                               shader_variant, sizeof(shader_variant),
+                               vertex_decl, sizeof(vertex_decl),
+                               0, nullptr, nullptr,
+                               vertex_shader, sizeof(vertex_shader),
+                               0, nullptr, nullptr,
+                               pixel_shader, sizeof(pixel_shader));
+
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+  Renderer::EnqueueRenderObjects(render_object_hashes,
+                                 ARRAY_SIZE(render_object_hashes));
+
+  // State is only activated for the first of the identical keys.
+  render_device::RenderBlendState blend_state_copy = blend_state;
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectCreateViewPort(1, 1, 2, 3, 4,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1);
+  render_device::RenderDeviceMock::ExpectCreateRenderBlendState(
+      2, blend_state_copy);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectCreateRenderTarget(
+      3, 1, 1, static_cast<render_device::PixelFormat>(1));
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectCreateVertexDeclaration(4, nullptr,
+                                                                 0);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(0);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(6u, Renderer::GetNumSkippedStateChanges());
+
+  const Renderer::FrameStats& stats = Renderer::GetFrameStats();
+  EXPECT_EQ(3u, stats.mNumEnqueuedObjects);
+  EXPECT_EQ(3u, stats.mNumRenderKeys);
+  EXPECT_EQ(1u, stats.mNumSortRuns);
+  EXPECT_EQ(1u, stats.mNumCommandLists);
+  EXPECT_EQ(6u, stats.mNumSkippedStateChanges);
+  EXPECT_EQ(1u, stats.mNumStateChanges[kDeviceStateType_ViewPort]);
+  EXPECT_EQ(1u, stats.mNumStateChanges[kDeviceStateType_PixelShader]);
+  EXPECT_EQ(0u, stats.mNumFilteredStateChanges[kDeviceStateType_ViewPort]);
+
+  // Vertex data was never filled so nothing is drawn or uploaded.
+  EXPECT_EQ(0u, stats.mNumDraws);
+  EXPECT_EQ(0u, stats.mNumInstances);
+  EXPECT_EQ(0u, stats.mNumUploads);
+
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(0);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(0);
+  Renderer::ExecuteDraws();
+
+  // Nothing is skipped for a single key.
+  Renderer::EnqueueRenderObject(render_object_hashes[0]);
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(0);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(0u, Renderer::GetNumSkippedStateChanges());
+  EXPECT_EQ(1u, Renderer::GetFrameStats().mNumEnqueuedObjects);
+  EXPECT_EQ(1u, Renderer::GetFrameStats().mNumRenderKeys);
+  Renderer::DeactivateRenderPasses();
+
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    EXPECT_TRUE(Renderer::ReleaseRenderObject(render_objects[i],
+                                              strlen(render_objects[i]) + 1));
+  }
+  render_device::RenderDeviceMock::ExpectReleasePixelShader(20);
+  render_device::RenderDeviceMock::ExpectReleaseVertexShader(10);
+  EXPECT_TRUE(Renderer::ReleaseShaderData(shader, sizeof(shader),
+                                          shader_variant,
+                                          sizeof(shader_variant)));
+  render_device::RenderDeviceMock::ExpectReleaseVertexDeclaration(4);
+  EXPECT_TRUE(Renderer::ReleaseVertexDecl(vertex_decl, sizeof(vertex_decl)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(passes, sizeof(passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(render_pass, sizeof(render_pass)));
+  render_device::RenderDeviceMock::ExpectReleaseRenderTarget(3);
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(1);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport, sizeof(viewport)));
+}
+
+TEST_F(RendererTest, PipelinedFramesTest) {
+  const char viewport[] = "test_viewport";
+  const char render_target[] = "test_render_target";
+  const char render_pass[] = "test_render_pass";
+  const char shader_variant[] = "test_variant";
+  const char passes[] = "test_render_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_decl[] = "vertex_decl_name";
+  const char vertex_shader[] = "test vertex shader";
+  const char pixel_shader[] = "test pixel shader";
+  const char vertex_data[] = "test_vertex_data_name";
+  const char render_object1[] = "test_render_object1";
+  const char render_object2[] = "test_render_object2";
+
+  Renderer::RegisterViewPort(viewport, sizeof(viewport),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(render_pass, sizeof(render_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1);
+  const char* passes_names[] = { render_pass };
+  size_t passes_sizes[] = { sizeof(render_pass) };
+  Renderer::RegisterRenderPasses(passes, sizeof(passes),
+                                 passes_names, passes_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+  const RenderObjectHandle handle1 = Renderer::RegisterRenderObject(
+      render_object1, sizeof(render_object1),
+      viewport, sizeof(viewport),
+      render_type, sizeof(render_type),
+      vertex_data, sizeof(vertex_data),
+      0, nullptr, nullptr);
+  const RenderObjectHandle handle2 = Renderer::RegisterRenderObject(
+      render_object2, sizeof(render_object2),
+      viewport, sizeof(viewport),
+      render_type, sizeof(render_type),
+      vertex_data, sizeof(vertex_data),
+      0, nullptr, nullptr);
+
+  render_device::RenderDeviceMock::ExpectCreateVertexShader(
+      10, vertex_shader, sizeof(vertex_shader));
+  render_device::RenderDeviceMock::ExpectCreatePixelShader(
+      20, pixel_shader, sizeof(pixel_shader));
+  Renderer::RegisterVertexDecl(vertex_decl, sizeof(vertex_decl), nullptr, 0);
+  Renderer::RegisterShaderData(shader, sizeof(shader),
+                               shader_variant, sizeof(shader_variant),
+                               vertex_decl, sizeof(vertex_decl),
+                               0, nullptr, nullptr,
+                               vertex_shader, sizeof(vertex_shader),
+                               0, nullptr, nullptr,
+                               pixel_shader, sizeof(pixel_shader));
+
+  // Nothing has been prepared yet.
+  EXPECT_FALSE(Renderer::ExecuteDraws());
+
+  // First frame draws both objects.
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+  Renderer::EnqueueRenderObjectHandle(handle1);
+  Renderer::EnqueueRenderObjectHandle(handle2);
+
+  render_device::RenderBlendState blend_state_copy = blend_state;
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectCreateViewPort(1, 1, 2, 3, 4,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1);
+  render_device::RenderDeviceMock::ExpectCreateRenderBlendState(
+      2, blend_state_copy);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectCreateRenderTarget(
+      3, 1, 1, static_cast<render_device::PixelFormat>(1));
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectCreateVertexDeclaration(4, nullptr,
+                                                                 0);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(5);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(3u, Renderer::GetNumSkippedStateChanges());
+
+  // Second frame is enqueued and prepared before the first is executed.
+  Renderer::EnqueueRenderObjectHandle(handle1);
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(6);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(0u, Renderer::GetNumSkippedStateChanges());
+  EXPECT_EQ(1u, Renderer::GetFrameStats().mNumEnqueuedObjects);
+  EXPECT_EQ(1u, Renderer::GetFrameStats().mNumRenderKeys);
+
+  // Frames are executed in the order they were prepared.
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(5);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(5);
+  EXPECT_TRUE(Renderer::ExecuteDraws());
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(6);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(6);
+  EXPECT_TRUE(Renderer::ExecuteDraws());
+  EXPECT_FALSE(Renderer::ExecuteDraws());
+  Renderer::DeactivateRenderPasses();
+
+  EXPECT_TRUE(Renderer::ReleaseRenderObject(render_object1,
+                                            sizeof(render_object1)));
+  EXPECT_TRUE(Renderer::ReleaseRenderObject(render_object2,
+                                            sizeof(render_object2)));
+  render_device::RenderDeviceMock::ExpectReleasePixelShader(20);
+  render_device::RenderDeviceMock::ExpectReleaseVertexShader(10);
+  EXPECT_TRUE(Renderer::ReleaseShaderData(shader, sizeof(shader),
+                                          shader_variant,
+                                          sizeof(shader_variant)));
+  render_device::RenderDeviceMock::ExpectReleaseVertexDeclaration(4);
+  EXPECT_TRUE(Renderer::ReleaseVertexDecl(vertex_decl, sizeof(vertex_decl)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(passes, sizeof(passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(render_pass, sizeof(render_pass)));
+  render_device::RenderDeviceMock::ExpectReleaseRenderTarget(3);
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(1);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport, sizeof(viewport)));
+}
+
+TEST_F(RendererTest, ParallelRecordTest) {
+  const char viewport1[] = "test_viewport1";
+  const char viewport2[] = "test_viewport2";
+  const char render_target[] = "test_render_target";
+  const char render_pass[] = "test_render_pass";
+  const char shader_variant[] = "test_variant";
+  const char passes[] = "test_render_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_decl[] = "vertex_decl_name";
+  const char vertex_shader[] = "test vertex shader";
+  const char pixel_shader[] = "test pixel shader";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  Renderer::RegisterViewPort(viewport1, sizeof(viewport1),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterViewPort(viewport2, sizeof(viewport2),
+                             kDimensionType_Absolute, 5.0f,
+                             kDimensionType_Absolute, 6.0f,
+                             kDimensionType_Absolute, 7.0f,
+                             kDimensionType_Absolute, 8.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(render_pass, sizeof(render_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1);
+  const char* passes_names[] = { render_pass };
+  size_t passes_sizes[] = { sizeof(render_pass) };
+  Renderer::RegisterRenderPasses(passes, sizeof(passes),
+                                 passes_names, passes_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+
+  render_device::RenderDeviceMock::ExpectCreateVertexShader(
+      10, vertex_shader, sizeof(vertex_shader));
+  render_device::RenderDeviceMock::ExpectCreatePixelShader(
+      20, pixel_shader, sizeof(pixel_shader));
+  Renderer::RegisterVertexDecl(vertex_decl, sizeof(vertex_decl), nullptr, 0);
+  Renderer::RegisterShaderData(shader, sizeof(shader),
+                               shader_variant, sizeof(shader_variant),
+                               vertex_decl, sizeof(vertex_decl),
+                               0, nullptr, nullptr,
+                               vertex_shader, sizeof(vertex_shader),
+                               0, nullptr, nullptr,
+                               pixel_shader, sizeof(pixel_shader));
+
+  // Half of the render objects are in each viewport.
+  char names[32][32];
+  memset(names, 0, sizeof(names));
+  uint64_t name_hashes[ARRAY_SIZE(names)];
+  for (size_t i = 0; i < ARRAY_SIZE(names); ++i) {
+    snprintf(names[i], sizeof(names[i]), "render_object_%u",
+             static_cast<uint32_t>(i));
+    const bool first_half = i < ARRAY_SIZE(names) / 2;
+    Renderer::RegisterRenderObject(names[i], sizeof(names[i]),
+                                   first_half ? viewport1 : viewport2,
+                                   sizeof(viewport1),
+                                   render_type, sizeof(render_type),
+                                   vertex_data, sizeof(vertex_data),
+                                   0, nullptr, nullptr);
+    name_hashes[i] = core::StringTable::AddString(names[i], sizeof(names[i]));
+  }
+
+  ycommon::containers::ContainedThreadPool<3, 16> thread_pool;
+  ASSERT_TRUE(thread_pool.Start());
+  Renderer::SetThreadPool(&thread_pool);
+
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+  Renderer::EnqueueRenderObjects(name_hashes, ARRAY_SIZE(name_hashes));
+
+  // Each viewport is recorded into its own command list.
+  render_device::RenderBlendState blend_state_copy = blend_state;
+  render_device::RenderDeviceMock::ExpectCreateViewPort(1, 1, 2, 3, 4,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectCreateViewPort(5, 5, 6, 7, 8,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectCreateRenderBlendState(
+      2, blend_state_copy);
+  render_device::RenderDeviceMock::ExpectCreateRenderTarget(
+      3, 1, 1, static_cast<render_device::PixelFormat>(1));
+  render_device::RenderDeviceMock::ExpectCreateVertexDeclaration(4, nullptr,
+                                                                 0);
+  render_device::RenderDeviceMock::ExpectBeginRecord(2);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(5);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2, 2);
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3, 2);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4, 2);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10, 2);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20, 2);
+  render_device::RenderDeviceMock::ExpectEndRecord(7, 2);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(2u * 15u * 3u, Renderer::GetNumSkippedStateChanges());
+
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(7, 2);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(7, 2);
+  Renderer::ExecuteDraws();
+
+  Renderer::DeactivateRenderPasses();
+  Renderer::SetThreadPool(nullptr);
+  EXPECT_TRUE(thread_pool.Stop(500));
+
+  for (size_t i = 0; i < ARRAY_SIZE(names); ++i) {
+    EXPECT_TRUE(Renderer::ReleaseRenderObject(names[i], sizeof(names[i])));
+  }
+  render_device::RenderDeviceMock::ExpectReleasePixelShader(20);
+  render_device::RenderDeviceMock::ExpectReleaseVertexShader(10);
+  EXPECT_TRUE(Renderer::ReleaseShaderData(shader, sizeof(shader),
+                                          shader_variant,
+                                          sizeof(shader_variant)));
+  render_device::RenderDeviceMock::ExpectReleaseVertexDeclaration(4);
+  EXPECT_TRUE(Renderer::ReleaseVertexDecl(vertex_decl, sizeof(vertex_decl)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(passes, sizeof(passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(render_pass, sizeof(render_pass)));
+  render_device::RenderDeviceMock::ExpectReleaseRenderTarget(3);
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(5);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport2, sizeof(viewport2)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(1);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport1, sizeof(viewport1)));
+}
+
+TEST_F(RendererTest, DepthSortTest) {
+  const char viewport1[] = "test_viewport1";
+  const char viewport2[] = "test_viewport2";
+  const char render_target[] = "test_render_target";
+  const char opaque_pass[] = "test_opaque_pass";
+  const char transparent_pass[] = "test_transparent_pass";
+  const char shader_variant[] = "test_variant";
+  const char opaque_passes[] = "test_opaque_passes";
+  const char transparent_passes[] = "test_transparent_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_decl[] = "vertex_decl_name";
+  const char vertex_shader[] = "test vertex shader";
+  const char pixel_shader[] = "test pixel shader";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  // Depth is sorted before the viewport.
+  const RenderKeyField fields[] = {
+    { 2, kRenderKeyFieldType_Depth },
+    { 2, kRenderKeyFieldType_ViewPort },
+    { 4, kRenderKeyFieldType_RenderPass },
+    { 6, kRenderKeyFieldType_VertexDecl },
+    { 6, kRenderKeyFieldType_Shader },
+  };
+  Renderer::SetupRenderKey(fields, ARRAY_SIZE(fields));
+
+  Renderer::RegisterViewPort(viewport1, sizeof(viewport1),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterViewPort(viewport2, sizeof(viewport2),
+                             kDimensionType_Absolute, 5.0f,
+                             kDimensionType_Absolute, 6.0f,
+                             kDimensionType_Absolute, 7.0f,
+                             kDimensionType_Absolute, 8.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(opaque_pass, sizeof(opaque_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1,
+                               kDepthSortType_FrontToBack);
+  Renderer::RegisterRenderPass(transparent_pass, sizeof(transparent_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1,
+                               kDepthSortType_BackToFront);
+  const char* opaque_names[] = { opaque_pass };
+  size_t opaque_sizes[] = { sizeof(opaque_pass) };
+  Renderer::RegisterRenderPasses(opaque_passes, sizeof(opaque_passes),
+                                 opaque_names, opaque_sizes, 1);
+  const char* transparent_names[] = { transparent_pass };
+  size_t transparent_sizes[] = { sizeof(transparent_pass) };
+  Renderer::RegisterRenderPasses(transparent_passes,
+                                 sizeof(transparent_passes),
+                                 transparent_names, transparent_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+
+  // Objects 0 and 2 are in the first viewport, object 1 in the second.
+  const char* render_objects[] = {
+    "test_render_object1", "test_render_object2", "test_render_object3"
+  };
+  RenderObjectHandle handles[ARRAY_SIZE(render_objects)];
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    handles[i] = Renderer::RegisterRenderObject(
+        render_objects[i], strlen(render_objects[i]) + 1,
+        i == 1 ? viewport2 : viewport1, sizeof(viewport1),
+        render_type, sizeof(render_type),
+        vertex_data, sizeof(vertex_data),
+        0, nullptr, nullptr);
+  }
+
+  render_device::RenderDeviceMock::ExpectCreateVertexShader(
+      10, vertex_shader, sizeof(vertex_shader));
+  render_device::RenderDeviceMock::ExpectCreatePixelShader(
+      20, pixel_shader, sizeof(pixel_shader));
+  Renderer::RegisterVertexDecl(vertex_decl, sizeof(vertex_decl), nullptr, 0);
+  Renderer::RegisterShaderData(shader, sizeof(shader),
+                               shader_variant, sizeof(shader_variant),
+                               vertex_decl, sizeof(vertex_decl),
+                               0, nullptr, nullptr,
+                               vertex_shader, sizeof(vertex_shader),
+                               0, nullptr, nullptr,
+                               pixel_shader, sizeof(pixel_shader));
+
+  // Nearest first, the far object splits the first viewport into two runs.
+  const float opaque_depths[] = { 0.0f, 0.0f, 1.0f };
+  Renderer::ActivateRenderPasses(opaque_passes, sizeof(opaque_passes));
+  Renderer::EnqueueRenderObjectHandles(handles, ARRAY_SIZE(handles),
+                                       opaque_depths);
+
+  render_device::RenderBlendState blend_state_copy = blend_state;
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectCreateViewPort(1, 1, 2, 3, 4,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectCreateViewPort(5, 5, 6, 7, 8,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1, 2);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(5);
+  render_device::RenderDeviceMock::ExpectCreateRenderBlendState(
+      2, blend_state_copy);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectCreateRenderTarget(
+      3, 1, 1, static_cast<render_device::PixelFormat>(1));
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectCreateVertexDeclaration(4, nullptr,
+                                                                 0);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(6);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(2u + 2u, Renderer::GetNumSkippedStateChanges());
+
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(6);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(6);
+  Renderer::ExecuteDraws();
+  Renderer::DeactivateRenderPasses();
+
+  // Farthest first gives the same order for the inverted depths.
+  const float transparent_depths[] = { 1.0f, 1.0f, 0.0f };
+  Renderer::ActivateRenderPasses(transparent_passes,
+                                 sizeof(transparent_passes));
+  Renderer::EnqueueRenderObjectHandles(handles, ARRAY_SIZE(handles),
+                                       transparent_depths);
+
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1, 2);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(5);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(7);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(2u + 2u, Renderer::GetNumSkippedStateChanges());
+
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(7);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(7);
+  Renderer::ExecuteDraws();
+  Renderer::DeactivateRenderPasses();
+
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    EXPECT_TRUE(Renderer::ReleaseRenderObject(render_objects[i],
+                                              strlen(render_objects[i]) + 1));
+  }
+  render_device::RenderDeviceMock::ExpectReleasePixelShader(20);
+  render_device::RenderDeviceMock::ExpectReleaseVertexShader(10);
+  EXPECT_TRUE(Renderer::ReleaseShaderData(shader, sizeof(shader),
+                                          shader_variant,
+                                          sizeof(shader_variant)));
+  render_device::RenderDeviceMock::ExpectReleaseVertexDeclaration(4);
+  EXPECT_TRUE(Renderer::ReleaseVertexDecl(vertex_decl, sizeof(vertex_decl)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(transparent_passes,
+                                            sizeof(transparent_passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(opaque_passes,
+                                            sizeof(opaque_passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(transparent_pass,
+                                          sizeof(transparent_pass)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(opaque_pass, sizeof(opaque_pass)));
+  render_device::RenderDeviceMock::ExpectReleaseRenderTarget(3);
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(5);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport2, sizeof(viewport2)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(1);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport1, sizeof(viewport1)));
+}
+
+TEST_F(RendererTest, WideRenderKeyTest) {
+  const char viewport1[] = "test_viewport1";
+  const char viewport2[] = "test_viewport2";
+  const char render_target[] = "test_render_target";
+  const char render_pass[] = "test_render_pass";
+  const char shader_variant[] = "test_variant";
+  const char passes[] = "test_render_passes";
+  const char render_type[] = "test_render_type_name";
+  const char shader[] = "test_shader_name";
+  const char vertex_decl[] = "vertex_decl_name";
+  const char vertex_shader[] = "test vertex shader";
+  const char pixel_shader[] = "test pixel shader";
+  const char vertex_data[] = "test_vertex_data_name";
+
+  // Fields use every bit of the high word, the index is in the low word.
+  const RenderKeyField fields[] = {
+    { 40, kRenderKeyFieldType_Depth },
+    { 2, kRenderKeyFieldType_ViewPort },
+    { 4, kRenderKeyFieldType_RenderPass },
+    { 6, kRenderKeyFieldType_VertexDecl },
+    { 12, kRenderKeyFieldType_Shader },
+  };
+  Renderer::SetupRenderKey(fields, ARRAY_SIZE(fields), true);
+
+  Renderer::RegisterViewPort(viewport1, sizeof(viewport1),
+                             kDimensionType_Absolute, 1.0f,
+                             kDimensionType_Absolute, 2.0f,
+                             kDimensionType_Absolute, 3.0f,
+                             kDimensionType_Absolute, 4.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterViewPort(viewport2, sizeof(viewport2),
+                             kDimensionType_Absolute, 5.0f,
+                             kDimensionType_Absolute, 6.0f,
+                             kDimensionType_Absolute, 7.0f,
+                             kDimensionType_Absolute, 8.0f,
+                             0.1f, 1.0f);
+  Renderer::RegisterRenderTarget(render_target, sizeof(render_target),
+                                 static_cast<render_device::PixelFormat>(1),
+                                 kDimensionType_Absolute, 1.0f,
+                                 kDimensionType_Absolute, 1.0f);
+  render_device::RenderBlendState blend_state;
+  const char* render_targets[] = { render_target };
+  size_t render_target_sizes[] = { sizeof(render_target) };
+  Renderer::RegisterRenderPass(render_pass, sizeof(render_pass),
+                               shader_variant, sizeof(shader_variant),
+                               blend_state,
+                               render_targets, render_target_sizes, 1);
+  const char* passes_names[] = { render_pass };
+  size_t passes_sizes[] = { sizeof(render_pass) };
+  Renderer::RegisterRenderPasses(passes, sizeof(passes),
+                                 passes_names, passes_sizes, 1);
+  Renderer::RegisterRenderType(render_type, sizeof(render_type),
+                               shader, sizeof(shader));
+  Renderer::RegisterVertexData(vertex_data, sizeof(vertex_data));
+
+  // Objects 0 and 2 are in the first viewport, object 1 in the second.
+  const char* render_objects[] = {
+    "test_render_object1", "test_render_object2", "test_render_object3"
+  };
+  RenderObjectHandle handles[ARRAY_SIZE(render_objects)];
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    handles[i] = Renderer::RegisterRenderObject(
+        render_objects[i], strlen(render_objects[i]) + 1,
+        i == 1 ? viewport2 : viewport1, sizeof(viewport1),
+        render_type, sizeof(render_type),
+        vertex_data, sizeof(vertex_data),
+        0, nullptr, nullptr);
+  }
+
+  render_device::RenderDeviceMock::ExpectCreateVertexShader(
+      10, vertex_shader, sizeof(vertex_shader));
+  render_device::RenderDeviceMock::ExpectCreatePixelShader(
+      20, pixel_shader, sizeof(pixel_shader));
+  Renderer::RegisterVertexDecl(vertex_decl, sizeof(vertex_decl), nullptr, 0);
+  Renderer::RegisterShaderData(shader, sizeof(shader),
+                               shader_variant, sizeof(shader_variant),
+                               vertex_decl, sizeof(vertex_decl),
+                               0, nullptr, nullptr,
+                               vertex_shader, sizeof(vertex_shader),
+                               0, nullptr, nullptr,
+                               pixel_shader, sizeof(pixel_shader));
+
+  // The shared queue and a bucket are sorted separately and merged.
+  Renderer::ActivateRenderPasses(passes, sizeof(passes));
+  Renderer::EnqueueRenderObjectHandle(handles[0], 0.0f);
+  ASSERT_TRUE(Renderer::RegisterEnqueueThread());
+  Renderer::EnqueueRenderObjectHandle(handles[2], 1.0f);
+  Renderer::EnqueueRenderObjectHandle(handles[1], 0.5f);
+  Renderer::ReleaseEnqueueThread();
+
+  // Nearest first, the far object splits the first viewport into two runs.
+  render_device::RenderBlendState blend_state_copy = blend_state;
+  render_device::RenderDeviceMock::ExpectBeginRecord();
+  render_device::RenderDeviceMock::ExpectCreateViewPort(1, 1, 2, 3, 4,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectCreateViewPort(5, 5, 6, 7, 8,
+                                                        0.1f, 1.0f);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(1, 2);
+  render_device::RenderDeviceMock::ExpectActivateViewPort(5);
+  render_device::RenderDeviceMock::ExpectCreateRenderBlendState(
+      2, blend_state_copy);
+  render_device::RenderDeviceMock::ExpectActivateRenderBlendState(2);
+  render_device::RenderDeviceMock::ExpectCreateRenderTarget(
+      3, 1, 1, static_cast<render_device::PixelFormat>(1));
+  render_device::RenderDeviceMock::ExpectActivateRenderTarget(0, 3);
+  render_device::RenderDeviceMock::ExpectCreateVertexDeclaration(4, nullptr,
+                                                                 0);
+  render_device::RenderDeviceMock::ExpectActivateVertexDeclaration(4);
+  render_device::RenderDeviceMock::ExpectActivateVertexShader(10);
+  render_device::RenderDeviceMock::ExpectActivatePixelShader(20);
+  render_device::RenderDeviceMock::ExpectEndRecord(6);
+  Renderer::PrepareDraw();
+  EXPECT_EQ(2u + 2u, Renderer::GetNumSkippedStateChanges());
+
+  render_device::RenderDeviceMock::ExpectExecuteCommandList(6);
+  render_device::RenderDeviceMock::ExpectReleaseCommandList(6);
+  Renderer::ExecuteDraws();
+  Renderer::DeactivateRenderPasses();
+
+  for (size_t i = 0; i < ARRAY_SIZE(render_objects); ++i) {
+    EXPECT_TRUE(Renderer::ReleaseRenderObject(render_objects[i],
+                                              strlen(render_objects[i]) + 1));
+  }
+  render_device::RenderDeviceMock::ExpectReleasePixelShader(20);
+  render_device::RenderDeviceMock::ExpectReleaseVertexShader(10);
+  EXPECT_TRUE(Renderer::ReleaseShaderData(shader, sizeof(shader),
+                                          shader_variant,
+                                          sizeof(shader_variant)));
+  render_device::RenderDeviceMock::ExpectReleaseVertexDeclaration(4);
+  EXPECT_TRUE(Renderer::ReleaseVertexDecl(vertex_decl, sizeof(vertex_decl)));
+  EXPECT_TRUE(Renderer::ReleaseVertexData(vertex_data, sizeof(vertex_data)));
+  EXPECT_TRUE(Renderer::ReleaseRenderType(render_type, sizeof(render_type)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPasses(passes, sizeof(passes)));
+  EXPECT_TRUE(Renderer::ReleaseRenderPass(render_pass, sizeof(render_pass)));
+  render_device::RenderDeviceMock::ExpectReleaseRenderTarget(3);
+  EXPECT_TRUE(Renderer::ReleaseRenderTarget(render_target,
+                                            sizeof(render_target)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(5);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport2, sizeof(viewport2)));
+  render_device::RenderDeviceMock::ExpectReleaseViewPort(1);
+  EXPECT_TRUE(Renderer::ReleaseViewPort(viewport1, sizeof(viewport1)));
+}
+
 }} // namespace yengine { namespace renderer {
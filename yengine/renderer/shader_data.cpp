@@ -156,15 +156,19 @@ void ShaderTextureArg::FillMips(uint8_t mip_levels,
   }
 }
 
+void ShaderTextureArg::Update() {
+  if (mSamplerStateHash != mTextureParam->mSamplerStateHash) {
+    mSamplerStateHash = mTextureParam->mSamplerStateHash;
+    mSamplerStateID = RenderStateCache::GetSamplerStateID(mSamplerStateHash);
+  }
+}
+
 void ShaderTextureArg::ActivateVertexShaderTexture(
     RenderDeviceState& device_state) {
   YASSERT(mTextureIDs[mActiveIndex] != INVALID_TEXTURE,
           "Cannot activate texture which has not been filled.");
   const uint8_t slot_num = mTextureParam->mSlot;
-  if (mSamplerStateHash != mTextureParam->mSamplerStateHash) {
-    mSamplerStateHash = mTextureParam->mSamplerStateHash;
-    mSamplerStateID = RenderStateCache::GetSamplerStateID(mSamplerStateHash);
-  }
+  Update();
 
   device_state.ActivateVertexSamplerState(slot_num, mSamplerStateID);
   device_state.ActivateVertexTexture(slot_num, mTextureIDs[mActiveIndex]);
@@ -175,10 +179,7 @@ void ShaderTextureArg::ActivatePixelShaderTexture(
   YASSERT(mTextureIDs[mActiveIndex] != INVALID_TEXTURE,
           "Cannot activate texture which has not been filled.");
   const uint8_t slot_num = mTextureParam->mSlot;
-  if (mSamplerStateHash != mTextureParam->mSamplerStateHash) {
-    mSamplerStateHash = mTextureParam->mSamplerStateHash;
-    mSamplerStateID = RenderStateCache::GetSamplerStateID(mSamplerStateHash);
-  }
+  Update();
 
   device_state.ActivatePixelSamplerState(slot_num, mSamplerStateID);
   device_state.ActivatePixelTexture(slot_num, mTextureIDs[mActiveIndex]);
@@ -67,6 +67,8 @@ class ShaderTextureArg {
   void Fill(const void* data, uint32_t data_size);
   void FillMips(uint8_t mip_levels, const void** datas,
                 const uint32_t* data_sizes);
+  // Resolves the sampler state, the activations call this as well.
+  void Update();
   void ActivateVertexShaderTexture(RenderDeviceState& device_state);
   void ActivatePixelShaderTexture(RenderDeviceState& device_state);
 
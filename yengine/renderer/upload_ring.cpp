@@ -0,0 +1,254 @@
+#include "yengine/renderer/upload_ring.h"
+
+#include <string.h>
+
+#include "ycommon/headers/atomics.h"
+#include "ycommon/utils/assert.h"
+
+#define MAX_UPLOAD_RING_STRIDES 8
+
+#define INVALID_INDEX_BUFFER static_cast<render_device::IndexBufferID>(-1)
+#define INVALID_VERTEX_BUFFER static_cast<render_device::VertexBufferID>(-1)
+
+namespace yengine { namespace renderer {
+
+namespace {
+  // A page is claimed by setting its stride, the thread which claimed it
+  // creates the device buffer while others wait for the buffer ID.
+  struct VertexPage {
+    volatile uint32_t mStride;
+    volatile uint32_t mUsedCount;
+    volatile render_device::VertexBufferID mVertexBufferID;
+  };
+
+  struct RingFrame {
+    VertexPage mVertexPages[MAX_UPLOAD_RING_STRIDES];
+    volatile uint32_t mUsedIndexes;
+    volatile uint32_t mIndexLock;
+    volatile render_device::IndexBufferID mIndexBufferID;
+    volatile uint32_t mAllocationsInFlight;
+  };
+
+  bool gInitialized = false;
+  uint32_t gVertexFrameSize = 0;
+  uint32_t gIndexFrameCount = 0;
+  volatile uint32_t gFrameCount = 0;
+  volatile uint32_t gNumAllocations = 0;
+  volatile uint64_t gAllocatedSize = 0;
+  RingFrame gRingFrames[NUM_UPLOAD_RING_FRAMES];
+
+  // Each frame count owns the ring frame at its slot, allocations hold the
+  // frame until their data is filled so EndFrame() never resets it under
+  // them.
+  RingFrame& BeginAllocation(uint32_t& frame_count) {
+    for (;;) {
+      frame_count = gFrameCount;
+      RingFrame& frame = gRingFrames[frame_count % NUM_UPLOAD_RING_FRAMES];
+      ycommon::AtomicAdd32(&frame.mAllocationsInFlight, 1u);
+      if (gFrameCount == frame_count)
+        return frame;
+
+      // The frame ended before EndFrame() could see this allocation.
+      ycommon::AtomicAdd32(&frame.mAllocationsInFlight,
+                           static_cast<uint32_t>(-1));
+    }
+  }
+
+  void EndAllocation(RingFrame& frame) {
+    YASSERT(frame.mAllocationsInFlight != 0,
+            "Upload ring frame was finished more times than allocated.");
+    ycommon::AtomicAdd32(&frame.mAllocationsInFlight,
+                         static_cast<uint32_t>(-1));
+  }
+
+  // Failed allocations leave the cursor alone so smaller ones still fit.
+  bool AllocateRange(volatile uint32_t* used, uint32_t count,
+                     uint32_t max_count, uint32_t& first) {
+    for (;;) {
+      const uint32_t used_count = *used;
+      if (used_count + count > max_count)
+        return false;
+      if (ycommon::AtomicCmpSet32(used, used_count, used_count + count)) {
+        first = used_count;
+        return true;
+      }
+    }
+  }
+
+  void CountAllocation(uint64_t size) {
+    ycommon::AtomicAdd32(&gNumAllocations, 1u);
+    ycommon::AtomicAdd64(&gAllocatedSize, size);
+  }
+
+  VertexPage* GetVertexPage(RingFrame& frame, uint32_t stride,
+                            uint32_t page_count) {
+    for (uint32_t i = 0; i < MAX_UPLOAD_RING_STRIDES; ++i) {
+      VertexPage& page = frame.mVertexPages[i];
+      if (page.mStride == 0 &&
+          ycommon::AtomicCmpSet32(&page.mStride, 0u, stride)) {
+        const render_device::VertexBufferID vertex_buffer =
+            render_device::RenderDevice::CreateVertexBuffer(
+                render_device::kUsageType_Dynamic, stride, page_count);
+        ycommon::ReleaseFence();
+        page.mVertexBufferID = vertex_buffer;
+        return &page;
+      }
+
+      if (page.mStride == stride) {
+        while (page.mVertexBufferID == INVALID_VERTEX_BUFFER)
+          ycommon::CpuPause();
+        ycommon::AcquireFence();
+        return &page;
+      }
+    }
+    return nullptr;
+  }
+}
+
+void UploadRing::Initialize(uint32_t vertex_frame_size,
+                            uint32_t index_frame_count) {
+  memset(gRingFrames, 0, sizeof(gRingFrames));
+  for (uint32_t i = 0; i < NUM_UPLOAD_RING_FRAMES; ++i) {
+    RingFrame& frame = gRingFrames[i];
+    for (uint32_t n = 0; n < MAX_UPLOAD_RING_STRIDES; ++n) {
+      frame.mVertexPages[n].mVertexBufferID = INVALID_VERTEX_BUFFER;
+    }
+    frame.mIndexBufferID = INVALID_INDEX_BUFFER;
+  }
+  gVertexFrameSize = vertex_frame_size;
+  gIndexFrameCount = index_frame_count;
+  gNumAllocations = 0;
+  gAllocatedSize = 0;
+  gInitialized = true;
+}
+
+void UploadRing::Terminate() {
+  for (uint32_t i = 0; i < NUM_UPLOAD_RING_FRAMES; ++i) {
+    RingFrame& frame = gRingFrames[i];
+    YASSERT(frame.mAllocationsInFlight == 0,
+            "Upload ring terminated during an allocation.");
+    for (uint32_t n = 0; n < MAX_UPLOAD_RING_STRIDES; ++n) {
+      VertexPage& page = frame.mVertexPages[n];
+      if (page.mStride) {
+        render_device::RenderDevice::ReleaseVertexBuffer(
+            page.mVertexBufferID);
+        page.mStride = 0;
+        page.mVertexBufferID = INVALID_VERTEX_BUFFER;
+      }
+    }
+    if (frame.mIndexBufferID != INVALID_INDEX_BUFFER) {
+      render_device::RenderDevice::ReleaseIndexBuffer(frame.mIndexBufferID);
+      frame.mIndexBufferID = INVALID_INDEX_BUFFER;
+    }
+    frame.mIndexLock = 0;
+  }
+  gVertexFrameSize = 0;
+  gIndexFrameCount = 0;
+  gInitialized = false;
+}
+
+bool UploadRing::IsInitialized() {
+  return gInitialized;
+}
+
+bool UploadRing::AllocateVertexes(uint32_t stride, uint32_t count,
+                                  render_device::VertexBufferID& vertex_buffer,
+                                  uint32_t& first_vertex,
+                                  uint32_t& frame_count) {
+  YASSERT(gInitialized, "Upload ring has not been initialized.");
+  YASSERT(stride > 0, "Invalid vertex buffer stride: %u", stride);
+  const uint32_t page_count = gVertexFrameSize / stride;
+  if (count > page_count)
+    return false;
+
+  // Vertex strides are fixed per device buffer, each stride gets a page.
+  RingFrame& frame = BeginAllocation(frame_count);
+  VertexPage* page = GetVertexPage(frame, stride, page_count);
+  const bool allocated = page &&
+      AllocateRange(&page->mUsedCount, count, page_count, first_vertex);
+  if (!allocated) {
+    EndAllocation(frame);
+    return false;
+  }
+
+  vertex_buffer = page->mVertexBufferID;
+  CountAllocation(static_cast<uint64_t>(stride) * count);
+  return true;
+}
+
+bool UploadRing::AllocateIndexes(uint32_t count,
+                                 render_device::IndexBufferID& index_buffer,
+                                 uint32_t& first_index,
+                                 uint32_t& frame_count) {
+  YASSERT(gInitialized, "Upload ring has not been initialized.");
+  if (count > gIndexFrameCount)
+    return false;
+
+  RingFrame& frame = BeginAllocation(frame_count);
+  if (!AllocateRange(&frame.mUsedIndexes, count, gIndexFrameCount,
+                     first_index)) {
+    EndAllocation(frame);
+    return false;
+  }
+
+  // The first allocation of the frame creates the device buffer.
+  if (frame.mIndexBufferID == INVALID_INDEX_BUFFER) {
+    if (ycommon::AtomicCmpSet32(&frame.mIndexLock, 0u, 1u)) {
+      const render_device::IndexBufferID new_index_buffer =
+          render_device::RenderDevice::CreateIndexBuffer(
+              render_device::kUsageType_Dynamic, gIndexFrameCount);
+      ycommon::ReleaseFence();
+      frame.mIndexBufferID = new_index_buffer;
+    } else {
+      while (frame.mIndexBufferID == INVALID_INDEX_BUFFER)
+        ycommon::CpuPause();
+    }
+  }
+  ycommon::AcquireFence();
+  index_buffer = frame.mIndexBufferID;
+  CountAllocation(sizeof(uint16_t) * count);
+  return true;
+}
+
+void UploadRing::FinishFill(uint32_t frame_count) {
+  EndAllocation(gRingFrames[frame_count % NUM_UPLOAD_RING_FRAMES]);
+}
+
+void UploadRing::EndFrame() {
+  if (!gInitialized)
+    return;
+
+  // Fills allocated NUM_UPLOAD_RING_FRAMES frames ago may still be writing
+  // the next frame, wait for them before resetting it.
+  const uint32_t next_frame_count = gFrameCount + 1;
+  RingFrame& frame = gRingFrames[next_frame_count % NUM_UPLOAD_RING_FRAMES];
+  while (frame.mAllocationsInFlight)
+    ycommon::CpuPause();
+  ycommon::AcquireFence();
+
+  for (uint32_t i = 0; i < MAX_UPLOAD_RING_STRIDES; ++i) {
+    frame.mVertexPages[i].mUsedCount = 0;
+  }
+  frame.mUsedIndexes = 0;
+  ycommon::AtomicSet32(&gFrameCount, next_frame_count);
+}
+
+uint32_t UploadRing::GetFrameCount() {
+  return gFrameCount;
+}
+
+bool UploadRing::IsFrameValid(uint32_t frame_count) {
+  // The frame's buffers are written again once the ring wraps around to it.
+  return gInitialized &&
+         gFrameCount - frame_count < NUM_UPLOAD_RING_FRAMES;
+}
+
+uint32_t UploadRing::GetNumAllocations() {
+  return gNumAllocations;
+}
+
+uint64_t UploadRing::GetAllocatedSize() {
+  return gAllocatedSize;
+}
+
+}} // namespace yengine { namespace renderer {
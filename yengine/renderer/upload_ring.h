@@ -0,0 +1,57 @@
+#ifndef YENGINE_RENDERER_UPLOAD_RING_H
+#define YENGINE_RENDERER_UPLOAD_RING_H
+
+#include <stdint.h>
+
+#include "yengine/render_device/render_device.h"
+
+/*******
+* Frame ring for dynamic vertex and index data.
+*  - Each frame owns one dynamic device buffer per vertex stride plus one
+*    index buffer, allocations are linear offsets into those buffers.
+*  - EndFrame() moves to the next frame of the ring, a frame's buffers are
+*    only written again NUM_UPLOAD_RING_FRAMES frames later so the device may
+*    still be reading the frames in between.
+*  - Device buffers are created on the first allocation of each frame.
+*  - Allocations fail when the frame is full, callers then fall back to
+*    their own buffers.
+*  - Allocations only stay valid for NUM_UPLOAD_RING_FRAMES frames, data
+*    drawn for longer must be allocated and filled again.
+********/
+#define NUM_UPLOAD_RING_FRAMES 3
+
+namespace yengine { namespace renderer {
+
+namespace UploadRing {
+  void Initialize(uint32_t vertex_frame_size, uint32_t index_frame_count);
+  void Terminate();
+  bool IsInitialized();
+
+  // Allocations may be made from any thread, frame_count is the frame the
+  // allocation belongs to. Successful allocations hold their frame until
+  // FinishFill() is called once the data has been written.
+  bool AllocateVertexes(uint32_t stride, uint32_t count,
+                        render_device::VertexBufferID& vertex_buffer,
+                        uint32_t& first_vertex, uint32_t& frame_count);
+  bool AllocateIndexes(uint32_t count,
+                       render_device::IndexBufferID& index_buffer,
+                       uint32_t& first_index, uint32_t& frame_count);
+  void FinishFill(uint32_t frame_count);
+
+  // Called from a single thread, waits for fills which may still be writing
+  // the frame it reuses.
+  void EndFrame();
+
+  // Number of frames ended so far, it is not reset by Initialize() so older
+  // allocations never look valid again.
+  uint32_t GetFrameCount();
+  bool IsFrameValid(uint32_t frame_count);
+
+  // Allocations made and bytes allocated since Initialize().
+  uint32_t GetNumAllocations();
+  uint64_t GetAllocatedSize();
+}
+
+}} // namespace yengine { namespace renderer {
+
+#endif // YENGINE_RENDERER_UPLOAD_RING_H
@@ -0,0 +1,198 @@
+#include "yengine/renderer/upload_ring.h"
+
+#include <gtest/gtest.h>
+
+#include "ycommon/headers/test_helpers.h"
+#include "ycommon/platform/thread.h"
+#include "yengine/render_device/render_device_mock.h"
+#include "yengine/renderer/basic_renderer_test.h"
+
+namespace yengine { namespace renderer {
+
+class UploadRingTest : public BasicRendererTest {};
+
+namespace {
+  uintptr_t EndFrameRoutine(void* /*arg*/) {
+    UploadRing::EndFrame();
+    return 0;
+  }
+}
+
+TEST_F(UploadRingTest, InitializeTerminate) {
+  UploadRing::Initialize(64, 16);
+  EXPECT_TRUE(UploadRing::IsInitialized());
+  UploadRing::Terminate();
+  EXPECT_FALSE(UploadRing::IsInitialized());
+}
+
+TEST_F(UploadRingTest, AllocateVertexesTest) {
+  UploadRing::Initialize(64, 16);
+
+  const render_device::VertexBufferID kVertexBufferID = 123;
+  render_device::RenderDeviceMock::ExpectCreateVertexBuffer(
+      kVertexBufferID, render_device::kUsageType_Dynamic, 4, 16);
+
+  render_device::VertexBufferID vertex_buffer = 0;
+  uint32_t first_vertex = 0;
+  uint32_t frame_count = 0;
+  ASSERT_TRUE(UploadRing::AllocateVertexes(4, 10, vertex_buffer,
+                                           first_vertex, frame_count));
+  EXPECT_EQ(kVertexBufferID, vertex_buffer);
+  EXPECT_EQ(0u, first_vertex);
+  UploadRing::FinishFill(frame_count);
+
+  // Allocations continue linearly until the frame is full.
+  ASSERT_TRUE(UploadRing::AllocateVertexes(4, 6, vertex_buffer,
+                                           first_vertex, frame_count));
+  EXPECT_EQ(kVertexBufferID, vertex_buffer);
+  EXPECT_EQ(10u, first_vertex);
+  UploadRing::FinishFill(frame_count);
+  EXPECT_FALSE(UploadRing::AllocateVertexes(4, 1, vertex_buffer,
+                                            first_vertex, frame_count));
+  EXPECT_EQ(2u, UploadRing::GetNumAllocations());
+  EXPECT_EQ(64u, UploadRing::GetAllocatedSize());
+
+  render_device::RenderDeviceMock::ExpectReleaseVertexBuffer(kVertexBufferID);
+  UploadRing::Terminate();
+}
+
+TEST_F(UploadRingTest, VertexStridePagesTest) {
+  UploadRing::Initialize(64, 16);
+
+  const render_device::VertexBufferID kVertexBufferID1 = 123;
+  const render_device::VertexBufferID kVertexBufferID2 = 234;
+  render_device::RenderDeviceMock::ExpectCreateVertexBuffer(
+      kVertexBufferID1, render_device::kUsageType_Dynamic, 4, 16);
+  render_device::RenderDeviceMock::ExpectCreateVertexBuffer(
+      kVertexBufferID2, render_device::kUsageType_Dynamic, 8, 8);
+
+  render_device::VertexBufferID vertex_buffer = 0;
+  uint32_t first_vertex = 0;
+  uint32_t frame_count = 0;
+  ASSERT_TRUE(UploadRing::AllocateVertexes(4, 2, vertex_buffer,
+                                           first_vertex, frame_count));
+  EXPECT_EQ(kVertexBufferID1, vertex_buffer);
+  UploadRing::FinishFill(frame_count);
+
+  ASSERT_TRUE(UploadRing::AllocateVertexes(8, 2, vertex_buffer,
+                                           first_vertex, frame_count));
+  EXPECT_EQ(kVertexBufferID2, vertex_buffer);
+  EXPECT_EQ(0u, first_vertex);
+  UploadRing::FinishFill(frame_count);
+
+  render_device::RenderDeviceMock::ExpectReleaseVertexBuffer(kVertexBufferID1);
+  render_device::RenderDeviceMock::ExpectReleaseVertexBuffer(kVertexBufferID2);
+  UploadRing::Terminate();
+}
+
+TEST_F(UploadRingTest, AllocateIndexesTest) {
+  UploadRing::Initialize(64, 16);
+
+  const render_device::IndexBufferID kIndexBufferID = 123;
+  render_device::RenderDeviceMock::ExpectCreateIndexBuffer(
+      kIndexBufferID, render_device::kUsageType_Dynamic, 16);
+
+  render_device::IndexBufferID index_buffer = 0;
+  uint32_t first_index = 0;
+  uint32_t frame_count = 0;
+  ASSERT_TRUE(UploadRing::AllocateIndexes(12, index_buffer, first_index,
+                                          frame_count));
+  EXPECT_EQ(kIndexBufferID, index_buffer);
+  EXPECT_EQ(0u, first_index);
+  UploadRing::FinishFill(frame_count);
+
+  ASSERT_TRUE(UploadRing::AllocateIndexes(4, index_buffer, first_index,
+                                          frame_count));
+  EXPECT_EQ(12u, first_index);
+  UploadRing::FinishFill(frame_count);
+  EXPECT_FALSE(UploadRing::AllocateIndexes(1, index_buffer, first_index,
+                                           frame_count));
+
+  // Failed allocations are not counted.
+  EXPECT_EQ(2u, UploadRing::GetNumAllocations());
+  EXPECT_EQ(16u * sizeof(uint16_t), UploadRing::GetAllocatedSize());
+
+  render_device::RenderDeviceMock::ExpectReleaseIndexBuffer(kIndexBufferID);
+  UploadRing::Terminate();
+}
+
+TEST_F(UploadRingTest, FrameRotationTest) {
+  UploadRing::Initialize(64, 16);
+
+  const render_device::IndexBufferID kIndexBufferIDs[] = { 12, 23, 34 };
+  static_assert(ARRAY_SIZE(kIndexBufferIDs) == NUM_UPLOAD_RING_FRAMES,
+                "Expected an index buffer per ring frame.");
+
+  // Every frame of the ring gets its own buffer.
+  render_device::IndexBufferID index_buffer = 0;
+  uint32_t first_index = 0;
+  uint32_t frame_count = 0;
+  for (uint32_t i = 0; i < NUM_UPLOAD_RING_FRAMES; ++i) {
+    render_device::RenderDeviceMock::ExpectCreateIndexBuffer(
+        kIndexBufferIDs[i], render_device::kUsageType_Dynamic, 16);
+    ASSERT_TRUE(UploadRing::AllocateIndexes(16, index_buffer, first_index,
+                                            frame_count));
+    EXPECT_EQ(kIndexBufferIDs[i], index_buffer);
+    UploadRing::FinishFill(frame_count);
+    UploadRing::EndFrame();
+  }
+
+  // The first frame is reused from the start of its buffer.
+  ASSERT_TRUE(UploadRing::AllocateIndexes(16, index_buffer, first_index,
+                                          frame_count));
+  EXPECT_EQ(kIndexBufferIDs[0], index_buffer);
+  EXPECT_EQ(0u, first_index);
+  UploadRing::FinishFill(frame_count);
+
+  for (uint32_t i = 0; i < NUM_UPLOAD_RING_FRAMES; ++i) {
+    render_device::RenderDeviceMock::ExpectReleaseIndexBuffer(
+        kIndexBufferIDs[i]);
+  }
+  UploadRing::Terminate();
+}
+
+TEST_F(UploadRingTest, EndFrameWaitsForFillTest) {
+  UploadRing::Initialize(64, 16);
+
+  const render_device::IndexBufferID kIndexBufferID = 123;
+  render_device::RenderDeviceMock::ExpectCreateIndexBuffer(
+      kIndexBufferID, render_device::kUsageType_Dynamic, 16);
+
+  render_device::IndexBufferID index_buffer = 0;
+  uint32_t first_index = 0;
+  uint32_t frame_count = 0;
+  ASSERT_TRUE(UploadRing::AllocateIndexes(16, index_buffer, first_index,
+                                          frame_count));
+  EXPECT_EQ(UploadRing::GetFrameCount(), frame_count);
+
+  // Frames in between do not wait for the fill.
+  for (uint32_t i = 1; i < NUM_UPLOAD_RING_FRAMES; ++i) {
+    UploadRing::EndFrame();
+  }
+
+  // The frame which reuses the filled frame waits until it is finished.
+  ycommon::platform::Thread thread(EndFrameRoutine, nullptr);
+  ASSERT_EQ(kStatusCode_OK, thread.Run());
+  EXPECT_FALSE(thread.Join(10));
+  EXPECT_EQ(frame_count + NUM_UPLOAD_RING_FRAMES - 1,
+            UploadRing::GetFrameCount());
+
+  UploadRing::FinishFill(frame_count);
+  EXPECT_TRUE(thread.Join());
+  EXPECT_EQ(frame_count + NUM_UPLOAD_RING_FRAMES,
+            UploadRing::GetFrameCount());
+
+  render_device::RenderDeviceMock::ExpectReleaseIndexBuffer(kIndexBufferID);
+  UploadRing::Terminate();
+}
+
+TEST_FAILURE_F(UploadRingTest, AllocateNoInitializeFails,
+               "not been initialized") {
+  UploadRing::Terminate();
+  render_device::IndexBufferID index_buffer = 0;
+  uint32_t first_index = 0;
+  uint32_t frame_count = 0;
+  UploadRing::AllocateIndexes(1, index_buffer, first_index, frame_count);
+}
+
+}} // namespace yengine { namespace renderer {
@@ -4,6 +4,7 @@
 
 #include "ycommon/utils/assert.h"
 #include "yengine/renderer/render_device_state.h"
+#include "yengine/renderer/upload_ring.h"
 
 #define INVALID_VERTEX_DECL static_cast<render_device::VertexDeclID>(-1)
 #define INVALID_INDEX_BUFFER static_cast<render_device::IndexBufferID>(-1)
@@ -29,13 +30,16 @@ void VertexDecl::Release() {
   }
 }
 
-void VertexDecl::Activate(RenderDeviceState& device_state) {
+void VertexDecl::Update() {
   if (mVertexDeclID == INVALID_VERTEX_DECL) {
     mVertexDeclID =
         render_device::RenderDevice::CreateVertexDeclaration(
             mVertexElements, mNumVertexElements);
   }
+}
 
+void VertexDecl::Activate(RenderDeviceState& device_state) {
+  Update();
   device_state.ActivateVertexDecl(mVertexDeclID);
 }
 
@@ -44,7 +48,11 @@ IndexBuffer::IndexBuffer()
     mActiveIndex(0),
     mUsageType(render_device::kUsageType_Invalid),
     mTotalCount(0),
-    mFillCount(0) {
+    mFillCount(0),
+    mFirstIndex(0),
+    mRingFrame(0),
+    mRingBufferID(INVALID_INDEX_BUFFER),
+    mRingData(nullptr) {
   for (int i = 0; i < ARRAY_SIZE(mIndexBufferIDs); ++i) {
     mIndexBufferIDs[i] = INVALID_INDEX_BUFFER;
   }
@@ -57,6 +65,9 @@ void IndexBuffer::Release() {
       mIndexBufferIDs[i] = INVALID_INDEX_BUFFER;
     }
   }
+  mRingBufferID = INVALID_INDEX_BUFFER;
+  delete [] mRingData;
+  mRingData = nullptr;
   mDirty = false;
 }
 
@@ -93,28 +104,80 @@ void IndexBuffer::FillMulti(uint32_t arrays,
     Release();
   }
 
-  mActiveIndex = !mActiveIndex;
-  if (mIndexBufferIDs[mActiveIndex] == INVALID_INDEX_BUFFER) {
-    mIndexBufferIDs[mActiveIndex] =
-        render_device::RenderDevice::CreateIndexBuffer(mUsageType, mTotalCount);
+  render_device::IndexBufferID index_buffer_id = INVALID_INDEX_BUFFER;
+  mFirstIndex = 0;
+  if (mUsageType == render_device::kUsageType_Dynamic &&
+      UploadRing::IsInitialized() &&
+      UploadRing::AllocateIndexes(mFillCount, index_buffer_id, mFirstIndex,
+                                  mRingFrame)) {
+    mRingBufferID = index_buffer_id;
+    if (mRingData == nullptr) {
+      mRingData = new uint16_t[mTotalCount];
+    }
+  } else {
+    mRingBufferID = INVALID_INDEX_BUFFER;
+    mActiveIndex = !mActiveIndex;
+    if (mIndexBufferIDs[mActiveIndex] == INVALID_INDEX_BUFFER) {
+      mIndexBufferIDs[mActiveIndex] =
+          render_device::RenderDevice::CreateIndexBuffer(mUsageType,
+                                                         mTotalCount);
+    }
+    index_buffer_id = mIndexBufferIDs[mActiveIndex];
   }
 
-  uint32_t current_offset = 0;
+  uint32_t current_offset = mFirstIndex;
   for (uint32_t i = 0; i < arrays; ++i) {
     const uint16_t* data = datas[i];
     const uint32_t count = num_ints[i];
-    render_device::RenderDevice::FillIndexBuffer(mIndexBufferIDs[mActiveIndex],
+    render_device::RenderDevice::FillIndexBuffer(index_buffer_id,
                                                  count,
                                                  data,
                                                  sizeof(data[0]) * count,
                                                  float_index_offsets[i],
                                                  current_offset);
+
+    // The copy has the vertex offsets applied so it can be filled as is.
+    if (mRingBufferID != INVALID_INDEX_BUFFER) {
+      uint16_t* ring_data = mRingData + current_offset - mFirstIndex;
+      for (uint32_t n = 0; n < count; ++n) {
+        ring_data[n] = static_cast<uint16_t>(data[n] +
+                                             float_index_offsets[i]);
+      }
+    }
     current_offset += count;
   }
+
+  if (mRingBufferID != INVALID_INDEX_BUFFER) {
+    UploadRing::FinishFill(mRingFrame);
+  }
+}
+
+void IndexBuffer::Update() {
+  if (mRingBufferID == INVALID_INDEX_BUFFER ||
+      UploadRing::IsFrameValid(mRingFrame))
+    return;
+
+  // The ring has reused the fill's frame, fill the copy into our own buffer.
+  mRingBufferID = INVALID_INDEX_BUFFER;
+  mFirstIndex = 0;
+  mActiveIndex = !mActiveIndex;
+  if (mIndexBufferIDs[mActiveIndex] == INVALID_INDEX_BUFFER) {
+    mIndexBufferIDs[mActiveIndex] =
+        render_device::RenderDevice::CreateIndexBuffer(mUsageType,
+                                                       mTotalCount);
+  }
+  render_device::RenderDevice::FillIndexBuffer(mIndexBufferIDs[mActiveIndex],
+                                               mFillCount,
+                                               mRingData,
+                                               sizeof(mRingData[0]) *
+                                               mFillCount);
 }
 
 void IndexBuffer::Activate(RenderDeviceState& device_state) {
-  const render_device::IndexBufferID id = mIndexBufferIDs[mActiveIndex];
+  Update();
+  const render_device::IndexBufferID id =
+      mRingBufferID != INVALID_INDEX_BUFFER ? mRingBufferID :
+                                              mIndexBufferIDs[mActiveIndex];
   YASSERT(id != INVALID_INDEX_BUFFER,
           "Index buffer has not been filled yet.");
   device_state.ActivateIndexStream(id);
@@ -126,7 +189,11 @@ VertexBuffer::VertexBuffer()
     mUsageType(render_device::kUsageType_Invalid),
     mStride(1),
     mTotalSize(0),
-    mFillSize(0) {
+    mFillSize(0),
+    mFirstVertex(0),
+    mRingFrame(0),
+    mRingBufferID(INVALID_VERTEX_BUFFER),
+    mRingData(nullptr) {
   for (int i = 0; i < ARRAY_SIZE(mVertexBufferIDs); ++i) {
     mVertexBufferIDs[i] = INVALID_VERTEX_BUFFER;
   }
@@ -139,6 +206,9 @@ void VertexBuffer::Release() {
       mVertexBufferIDs[i] = INVALID_VERTEX_BUFFER;
     }
   }
+  mRingBufferID = INVALID_VERTEX_BUFFER;
+  delete [] mRingData;
+  mRingData = nullptr;
   mDirty = false;
 }
 
@@ -188,18 +258,30 @@ void VertexBuffer::FillMulti(uint32_t arrays,
     Release();
   }
 
-  mActiveIndex = !mActiveIndex;
-  if (mVertexBufferIDs[mActiveIndex] == INVALID_VERTEX_BUFFER) {
-    mVertexBufferIDs[mActiveIndex] =
-        render_device::RenderDevice::CreateVertexBuffer(mUsageType,
-                                                        mStride,
-                                                        mTotalSize / mStride);
+  render_device::VertexBufferID vertex_buffer_id = INVALID_VERTEX_BUFFER;
+  mFirstVertex = 0;
+  if (mUsageType == render_device::kUsageType_Dynamic &&
+      UploadRing::IsInitialized() &&
+      UploadRing::AllocateVertexes(mStride, mFillSize / mStride,
+                                   vertex_buffer_id, mFirstVertex,
+                                   mRingFrame)) {
+    mRingBufferID = vertex_buffer_id;
+    if (mRingData == nullptr) {
+      mRingData = new uint8_t[mTotalSize];
+    }
+  } else {
+    mRingBufferID = INVALID_VERTEX_BUFFER;
+    mActiveIndex = !mActiveIndex;
+    if (mVertexBufferIDs[mActiveIndex] == INVALID_VERTEX_BUFFER) {
+      mVertexBufferIDs[mActiveIndex] =
+          render_device::RenderDevice::CreateVertexBuffer(mUsageType,
+                                                          mStride,
+                                                          mTotalSize / mStride);
+    }
+    vertex_buffer_id = mVertexBufferIDs[mActiveIndex];
   }
 
-  const render_device::VertexBufferID vertex_buffer_id =
-      mVertexBufferIDs[mActiveIndex];
-
-  uint32_t current_offset = 0;
+  uint32_t current_offset = mFirstVertex;
   for (uint32_t i = 0; i < arrays; ++i) {
     const void* data = datas[i];
     const uint32_t data_size = data_sizes[i] * data_stride;
@@ -213,15 +295,46 @@ void VertexBuffer::FillMulti(uint32_t arrays,
                                                   data,
                                                   data_size,
                                                   current_offset);
+    if (mRingBufferID != INVALID_VERTEX_BUFFER) {
+      memcpy(mRingData + (current_offset - mFirstVertex) * mStride, data,
+             data_size);
+    }
     current_offset += count;
   }
+
+  if (mRingBufferID != INVALID_VERTEX_BUFFER) {
+    UploadRing::FinishFill(mRingFrame);
+  }
+}
+
+void VertexBuffer::Update() {
+  if (mRingBufferID == INVALID_VERTEX_BUFFER ||
+      UploadRing::IsFrameValid(mRingFrame))
+    return;
+
+  // The ring has reused the fill's frame, fill the copy into our own buffer.
+  mRingBufferID = INVALID_VERTEX_BUFFER;
+  mFirstVertex = 0;
+  mActiveIndex = !mActiveIndex;
+  if (mVertexBufferIDs[mActiveIndex] == INVALID_VERTEX_BUFFER) {
+    mVertexBufferIDs[mActiveIndex] =
+        render_device::RenderDevice::CreateVertexBuffer(mUsageType,
+                                                        mStride,
+                                                        mTotalSize / mStride);
+  }
+  render_device::RenderDevice::FillVertexBuffer(
+      mVertexBufferIDs[mActiveIndex], mFillSize / mStride, mRingData,
+      mFillSize);
 }
 
 void VertexBuffer::Activate(RenderDeviceState& device_state) {
-  const render_device::VertexBufferID id = mVertexBufferIDs[mActiveIndex];
+  Update();
+  const render_device::VertexBufferID id =
+      mRingBufferID != INVALID_VERTEX_BUFFER ? mRingBufferID :
+                                               mVertexBufferIDs[mActiveIndex];
   YASSERT(id != INVALID_VERTEX_BUFFER,
           "Vertex buffer has not been filled yet.");
-  device_state.ActivateVertexStream(mVertexBufferIDs[mActiveIndex]);
+  device_state.ActivateVertexStream(id);
 }
 
 }} // namespace yengine { namespace renderer {
@@ -15,6 +15,9 @@ class VertexDecl {
   VertexDecl(const render_device::VertexDeclElement* elements,
              uint8_t num_elements);
   void Release();
+
+  // Creates the device declaration, Activate() calls this as well.
+  void Update();
   void Activate(RenderDeviceState& device_state);
 
   const render_device::VertexDeclElement* GetVertexDeclElements() const {
@@ -28,6 +31,11 @@ class VertexDecl {
   render_device::VertexDeclID mVertexDeclID;
 };
 
+// Dynamic buffers are filled into the upload ring when it is initialized,
+// the fill then starts at an offset of a shared device buffer. Ring fills
+// keep a copy of their data, once the ring reuses the fill's frame
+// NUM_UPLOAD_RING_FRAMES frames later Update() fills the copy into the
+// buffer's own device buffer. Activate() calls Update() as well.
 class IndexBuffer {
  public:
   IndexBuffer();
@@ -35,12 +43,14 @@ class IndexBuffer {
 
   void Initialize(render_device::UsageType usage, uint32_t count);
   uint32_t GetFillCount() const { return mFillCount; }
+  uint32_t GetFirstIndex() const { return mFirstIndex; }
 
   void Fill(const uint16_t* data, uint32_t num_ints);
   void FillMulti(uint32_t arrays,
                  const uint16_t* const* datas,
                  const uint32_t* num_ints,
                  const uint16_t* float_index_offsets);
+  void Update();
   void Activate(RenderDeviceState& device_state);
 
  private:
@@ -49,7 +59,11 @@ class IndexBuffer {
   render_device::UsageType mUsageType;
   uint32_t mTotalCount;
   uint32_t mFillCount;
+  uint32_t mFirstIndex;
+  uint32_t mRingFrame;
+  render_device::IndexBufferID mRingBufferID;
   render_device::IndexBufferID mIndexBufferIDs[2];
+  uint16_t* mRingData;
 };
 
 class VertexBuffer {
@@ -61,6 +75,8 @@ class VertexBuffer {
                   uint32_t stride,
                   uint32_t count);
   uint32_t GetFillSize() const { return mFillSize; }
+  uint32_t GetFillCount() const { return mFillSize / mStride; }
+  uint32_t GetFirstVertex() const { return mFirstVertex; }
 
   void Fill(const void* data, uint32_t data_size);
   void FillMulti(uint32_t arrays,
@@ -70,6 +86,7 @@ class VertexBuffer {
                  const void* const* datas,
                  const uint32_t* data_sizes,
                  uint32_t data_stride = 1);
+  void Update();
   void Activate(RenderDeviceState& device_state);
 
  private:
@@ -79,7 +96,11 @@ class VertexBuffer {
   uint32_t mStride;
   uint32_t mTotalSize;
   uint32_t mFillSize;
+  uint32_t mFirstVertex;
+  uint32_t mRingFrame;
+  render_device::VertexBufferID mRingBufferID;
   render_device::VertexBufferID mVertexBufferIDs[2];
+  uint8_t* mRingData;
 };
 
 }} // namespace yengine { namespace renderer {
@@ -6,6 +6,7 @@
 #include "yengine/render_device/render_device_mock.h"
 #include "yengine/renderer/basic_renderer_test.h"
 #include "yengine/renderer/render_device_state.h"
+#include "yengine/renderer/upload_ring.h"
 
 namespace yengine { namespace renderer {
 
@@ -236,6 +237,8 @@ TEST_F(VertexBufferTest, BasicFillTest) {
       kVertexData,
       sizeof(kVertexData));
   vertex_buffer.Fill(kVertexData, sizeof(kVertexData));
+  EXPECT_EQ(static_cast<uint32_t>(ARRAY_SIZE(kVertexData)),
+            vertex_buffer.GetFillCount());
 }
 
 TEST_F(VertexBufferTest, FillMultiTest) {
@@ -380,4 +383,111 @@ TEST_F(VertexBufferTest, ActivationTest) {
   vertex_buffer.Activate(device_state);
 }
 
+TEST_F(VertexBufferTest, DynamicUploadRingTest) {
+  UploadRing::Initialize(sizeof(float) * 16, 16);
+  float kVertexData1[4] = { 0.0f };
+  float kVertexData2[6] = { 0.0f };
+  VertexBuffer vertex_buffer1;
+  VertexBuffer vertex_buffer2;
+  vertex_buffer1.Initialize(render_device::kUsageType_Dynamic,
+                            sizeof(kVertexData1[0]),
+                            ARRAY_SIZE(kVertexData1));
+  vertex_buffer2.Initialize(render_device::kUsageType_Dynamic,
+                            sizeof(kVertexData2[0]),
+                            ARRAY_SIZE(kVertexData2));
+
+  // Both buffers are filled into the same ring buffer one after another.
+  const render_device::VertexBufferID kRingBufferID = 123;
+  render_device::RenderDeviceMock::ExpectCreateVertexBuffer(
+      kRingBufferID,
+      render_device::kUsageType_Dynamic,
+      sizeof(float),
+      16);
+  render_device::RenderDeviceMock::ExpectFillVertexBuffer(
+      kRingBufferID,
+      ARRAY_SIZE(kVertexData1),
+      kVertexData1,
+      sizeof(kVertexData1),
+      0);
+  render_device::RenderDeviceMock::ExpectFillVertexBuffer(
+      kRingBufferID,
+      ARRAY_SIZE(kVertexData2),
+      kVertexData2,
+      sizeof(kVertexData2),
+      ARRAY_SIZE(kVertexData1));
+  vertex_buffer1.Fill(kVertexData1, sizeof(kVertexData1));
+  vertex_buffer2.Fill(kVertexData2, sizeof(kVertexData2));
+  EXPECT_EQ(0u, vertex_buffer1.GetFirstVertex());
+  EXPECT_EQ(static_cast<uint32_t>(ARRAY_SIZE(kVertexData1)),
+            vertex_buffer2.GetFirstVertex());
+
+  render_device::RenderDeviceMock::ExpectActivateVertexStream(0,
+                                                              kRingBufferID);
+  RenderDeviceState device_state;
+  vertex_buffer2.Activate(device_state);
+
+  // Ring buffers belong to the upload ring.
+  vertex_buffer1.Release();
+  vertex_buffer2.Release();
+  render_device::RenderDeviceMock::ExpectReleaseVertexBuffer(kRingBufferID);
+  UploadRing::Terminate();
+}
+
+TEST_F(VertexBufferTest, ActivateStaleUploadRingTest) {
+  UploadRing::Initialize(sizeof(float) * 16, 16);
+  float kVertexData[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  VertexBuffer vertex_buffer;
+  vertex_buffer.Initialize(render_device::kUsageType_Dynamic,
+                           sizeof(kVertexData[0]),
+                           ARRAY_SIZE(kVertexData));
+
+  const render_device::VertexBufferID kRingBufferID = 123;
+  render_device::RenderDeviceMock::ExpectCreateVertexBuffer(
+      kRingBufferID,
+      render_device::kUsageType_Dynamic,
+      sizeof(float),
+      16);
+  render_device::RenderDeviceMock::ExpectFillVertexBuffer(
+      kRingBufferID,
+      ARRAY_SIZE(kVertexData),
+      kVertexData,
+      sizeof(kVertexData),
+      0);
+  vertex_buffer.Fill(kVertexData, sizeof(kVertexData));
+
+  // The fill is drawn from the ring until the ring wraps around to its frame.
+  for (uint32_t i = 0; i < NUM_UPLOAD_RING_FRAMES; ++i) {
+    render_device::RenderDeviceMock::ExpectActivateVertexStream(
+        0, kRingBufferID);
+    RenderDeviceState device_state;
+    vertex_buffer.Activate(device_state);
+    UploadRing::EndFrame();
+  }
+
+  // The copy of the fill is then filled into the buffer's own buffer.
+  const render_device::VertexBufferID kVertexBufferID = 234;
+  render_device::RenderDeviceMock::ExpectCreateVertexBuffer(
+      kVertexBufferID,
+      render_device::kUsageType_Dynamic,
+      sizeof(kVertexData[0]),
+      ARRAY_SIZE(kVertexData));
+  render_device::RenderDeviceMock::ExpectFillVertexBufferData(
+      kVertexBufferID,
+      ARRAY_SIZE(kVertexData),
+      kVertexData,
+      sizeof(kVertexData));
+  vertex_buffer.Update();
+  EXPECT_EQ(0u, vertex_buffer.GetFirstVertex());
+
+  render_device::RenderDeviceMock::ExpectActivateVertexStream(
+      0, kVertexBufferID);
+  RenderDeviceState device_state;
+  vertex_buffer.Activate(device_state);
+
+  render_device::RenderDeviceMock::ExpectReleaseVertexBuffer(kVertexBufferID);
+  vertex_buffer.Release();
+  render_device::RenderDeviceMock::ExpectReleaseVertexBuffer(kRingBufferID);
+  UploadRing::Terminate();
+}
+
 }} // namespace yengine { namespace renderer {
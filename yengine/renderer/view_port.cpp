@@ -55,7 +55,7 @@ void ViewPort::SetViewPort(DimensionType top_type, float top,
   mDirty = true;
 }
 
-void ViewPort::Activate(RenderDeviceState& render_device_state) {
+void ViewPort::Update() {
   if (mDirty) {
     uint32_t frame_width, frame_height;
     render_device::RenderDevice::GetFrameBufferDimensions(frame_width,
@@ -76,9 +76,11 @@ void ViewPort::Activate(RenderDeviceState& render_device_state) {
 
     mDirty = false;
   }
+}
 
+void ViewPort::Activate(RenderDeviceState& render_device_state) {
+  Update();
   render_device_state.ActivateViewPort(mViewPortIDs[mActiveViewPortIndex]);
-  
 }
 
 }} // namespace yengine { namespace renderer {
@@ -23,6 +23,8 @@ class ViewPort {
                    DimensionType width_type, float width,
                    DimensionType height_type, float height,
                    float min_z, float max_z);
+  // Creates the device view port when dirty, Activate() calls this as well.
+  void Update();
   void Activate(RenderDeviceState& render_device_state);
 
  private:
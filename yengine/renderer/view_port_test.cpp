@@ -36,6 +36,12 @@ TEST_F(ViewPortTest, ViewPortActivationTest) {
                                                         0.1f, 1.0f);
   render_device::RenderDeviceMock::ExpectActivateViewPort(viewport_id);
   viewport.Activate(device_state);
+  EXPECT_EQ(1u, device_state.GetNumActivations(kDeviceStateType_ViewPort));
+
+  // Activating it again on the same device state is filtered.
+  viewport.Activate(device_state);
+  EXPECT_EQ(1u, device_state.GetNumActivations(kDeviceStateType_ViewPort));
+  EXPECT_EQ(1u, device_state.GetNumFiltered(kDeviceStateType_ViewPort));
 
   // Second activation should reuse the same viewport id.
   render_device::RenderDeviceMock::ExpectActivateViewPort(viewport_id);